@@ -28,12 +28,21 @@
 #include "AVQt/communication/VideoPadParams.hpp"
 
 #include "AVQt/common/ContainerFormat.hpp"
+#include "AVQt/common/LatencyProfile.hpp"
+#include "AVQt/common/MediaClock.hpp"
 #include "AVQt/common/PixelFormat.hpp"
 #include "AVQt/common/Platform.hpp"
 
 #include "AVQt/input/Demuxer.hpp"
+#include "AVQt/input/UdpStreamSource.hpp"
 
+#include "AVQt/output/ImageWriter.hpp"
 #include "AVQt/output/Muxer.hpp"
+#include "AVQt/output/ThumbnailGenerator.hpp"
+#include "AVQt/output/UdpStreamSink.hpp"
+
+#include "AVQt/ipc/SharedMemoryFrameReceiver.hpp"
+#include "AVQt/ipc/SharedMemoryFrameSender.hpp"
 
 #include "AVQt/decoder/AudioDecoder.hpp"
 #include "AVQt/decoder/AudioDecoderFactory.hpp"
@@ -45,13 +54,19 @@
 
 #include "AVQt/encoder/AudioEncoder.hpp"
 #include "AVQt/encoder/AudioEncoderFactory.hpp"
+#include "AVQt/encoder/ChunkedTranscoder.hpp"
+#include "AVQt/encoder/EncodeLadder.hpp"
 #include "AVQt/encoder/IAudioEncoderImpl.hpp"
 
 #include "AVQt/encoder/IVideoEncoderImpl.hpp"
 #include "AVQt/encoder/VideoEncoder.hpp"
 #include "AVQt/encoder/VideoEncoderFactory.hpp"
 
+#include "AVQt/filter/AudioConverter.hpp"
+#include "AVQt/filter/BitstreamFilter.hpp"
+#include "AVQt/filter/FilterGraph.hpp"
 #include "AVQt/filter/VaapiYuvToRgbMapper.hpp"
+#include "AVQt/filter/VideoScaler.hpp"
 
 #include "AVQt/renderers/AudioOutput.hpp"
 #include "AVQt/renderers/AudioOutputFactory.hpp"
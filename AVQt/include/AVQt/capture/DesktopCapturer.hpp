@@ -15,6 +15,12 @@
 
 namespace AVQt {
     class DesktopCapturerPrivate;
+    /**
+     * @brief Produces the frames of the platform's IDesktopCaptureImpl.
+     *
+     * DATA messages carry the changed areas of the frame as QVector<QRect> in the "damage" payload, which is the whole frame
+     * unless api::IDesktopCaptureImpl::Config::skipUnchanged is set.
+     */
     class DesktopCapturer : public QThread, public api::IComponent, public pgraph::impl::SimpleProducer {
         Q_OBJECT
         Q_INTERFACES(AVQt::api::IComponent)
@@ -27,6 +33,11 @@ namespace AVQt {
         bool isRunning() const override;
         bool isPaused() const override;
 
+        /**
+         * @return number of frames not forwarded, because they didn't change, see api::IDesktopCaptureImpl::Config::skipUnchanged
+         */
+        [[nodiscard]] uint64_t getSkippedFrameCount() const;
+
     public slots:
         bool init() override;
 
@@ -41,6 +41,14 @@ namespace AVQt::api {
         struct Config {
             SourceClass sourceClass{SourceClass::Any};
             int fps{30};
+            /**
+             * Don't forward software frames equal to the previous one, DesktopCapturer attaches the changed areas to the others
+             */
+            bool skipUnchanged{false};
+            /**
+             * Forward an unchanged frame anyway after this many milliseconds, so downstream components keep running, 0 never does
+             */
+            int unchangedKeepAlive{1000};
         };
         virtual ~IDesktopCaptureImpl() = default;
 
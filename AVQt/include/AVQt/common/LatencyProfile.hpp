@@ -0,0 +1,52 @@
+#ifndef LIBAVQT_LATENCYPROFILE_HPP
+#define LIBAVQT_LATENCYPROFILE_HPP
+
+#include <cstddef>
+
+namespace AVQt::common {
+    /**
+     * @brief Buffering and codec settings trading throughput for latency, shared by VideoDecoder, VideoEncoder and Muxer.
+     *
+     * Pass the same profile to the config of every component of a live pipeline. The default constructed profile keeps the
+     * throughput oriented defaults, lowLatency() minimizes the frames held back on the way from capture to output.
+     */
+    struct LatencyProfile {
+        /**
+         * Decoders output frames as soon as possible (AV_CODEC_FLAG_LOW_DELAY) and use slice instead of frame threading,
+         * encoders produce no B-frames and don't look ahead. Only applied when the codec is opened.
+         */
+        bool lowDelay{false};
+        /**
+         * Packets waiting in front of the decoder
+         */
+        int decoderQueueSize{32};
+        /**
+         * Frames waiting in front of the encoder
+         */
+        int encoderQueueSize{4};
+        /**
+         * Packets waiting in front of the muxer
+         */
+        int muxerQueueSize{32};
+        /**
+         * Interleave the streams in the muxer by timestamp, which holds packets back until every stream has data
+         */
+        bool interleave{true};
+        /**
+         * Write every packet to the output device immediately (flush_packets)
+         */
+        bool flushPackets{false};
+        /**
+         * Size of the buffer between libavformat and the output device in bytes
+         */
+        size_t ioBufferSize{32 * 1024};
+
+        /**
+         * @return a profile for live pipelines, with the shallowest queues that keep the components busy
+         */
+        static LatencyProfile lowLatency();
+    };
+}// namespace AVQt::common
+
+
+#endif//LIBAVQT_LATENCYPROFILE_HPP
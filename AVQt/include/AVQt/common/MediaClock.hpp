@@ -0,0 +1,101 @@
+#ifndef LIBAVQT_MEDIACLOCK_HPP
+#define LIBAVQT_MEDIACLOCK_HPP
+
+#include <QtCore/QtGlobal>
+
+#include <cstdint>
+#include <memory>
+
+namespace AVQt::common {
+    class MediaClockPrivate;
+    /**
+     * @brief Presentation clock shared by the outputs of a pipeline, in microseconds like all timestamps in AVQt.
+     *
+     * Without a master, the clock is a wall clock, which starts at the timestamp of the first synchronized frame.
+     * An audio output can become the master and drive the clock from the position of the samples actually played,
+     * the wall clock then only interpolates between its updates.
+     * Video renderers slave to the clock through syncFrame(), which also collects the A/V drift statistics.
+     * All methods are thread-safe.
+     */
+    class MediaClock {
+    public:
+        enum class FrameAction {
+            /**
+             * The frame is early, keep the current frame on screen
+             */
+            Wait,
+            /**
+             * The frame is due, present it
+             */
+            Show,
+            /**
+             * The frame is late and its successor is already due, discard it without presenting it
+             */
+            Drop
+        };
+
+        struct SyncStatistics {
+            uint64_t shownFrames{0};
+            uint64_t droppedFrames{0};
+            /**
+             * Number of syncFrame() calls, that kept the previous frame on screen, because the next one wasn't due yet
+             */
+            uint64_t repeatedFrames{0};
+            /**
+             * Clock time minus frame timestamp at presentation, positive values mean the video lags behind
+             */
+            int64_t lastDrift{0};
+            int64_t maxDrift{0};
+            int64_t meanAbsoluteDrift{0};
+        };
+
+        MediaClock();
+        ~MediaClock();
+
+        /**
+         * @return the current media time, or AV_NOPTS_VALUE, if the clock hasn't been started yet
+         */
+        [[nodiscard]] int64_t time() const;
+        [[nodiscard]] bool isStarted() const;
+        [[nodiscard]] bool isPaused() const;
+
+        /**
+         * @brief Sets the current media time, starting the clock, if it wasn't yet.
+         *
+         * Used by the master to report its position and by anybody to seek.
+         */
+        void setTime(int64_t time);
+        /**
+         * @brief Freezes the clock at its current time, or resumes it from there
+         */
+        void pause(bool state);
+        /**
+         * @brief Stops the clock, the next setTime() or syncFrame() starts it again. Statistics are kept.
+         */
+        void reset();
+
+        /**
+         * @brief Marks the clock as driven by a master, e.g. an AudioOutput. syncFrame() doesn't start a mastered clock.
+         */
+        void setMastered(bool mastered);
+        [[nodiscard]] bool isMastered() const;
+
+        /**
+         * @brief Decides what to do with the frame next in line for presentation and records the outcome in the statistics
+         * @param pts Timestamp of the frame
+         * @param nextPts Timestamp of the frame after it, AV_NOPTS_VALUE, if there is none queued yet
+         */
+        FrameAction syncFrame(int64_t pts, int64_t nextPts);
+
+        [[nodiscard]] SyncStatistics statistics() const;
+        void resetStatistics();
+
+    private:
+        std::unique_ptr<MediaClockPrivate> d_ptr;
+        Q_DECLARE_PRIVATE(MediaClock)
+        Q_DISABLE_COPY_MOVE(MediaClock)
+    };
+}// namespace AVQt::common
+
+
+#endif//LIBAVQT_MEDIACLOCK_HPP
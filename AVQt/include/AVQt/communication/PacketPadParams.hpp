@@ -52,6 +52,10 @@ namespace AVQt::communication {
         const AVCodec *codec{nullptr};
         std::shared_ptr<AVCodecParameters> codecParams{};
         int64_t streamIdx{};
+        /**
+         * Time base of the timestamps of the packets on the pad, microseconds unless the producer preserves the source time base
+         */
+        AVRational timeBase{1, 1000000};
     };
 }// namespace AVQt::communication
 
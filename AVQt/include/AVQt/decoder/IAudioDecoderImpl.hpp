@@ -21,7 +21,15 @@ namespace AVQt::api {
         virtual bool open(std::shared_ptr<AVCodecParameters> codecParams) = 0;
         virtual void close() = 0;
 
+        /**
+         * @brief Sends packet to the decoder and emits frameReady() for every frame it outputs
+         * @return EXIT_SUCCESS, EAGAIN if the packet wasn't accepted and has to be sent again, or another AVUNERROR()-ed error
+         */
         virtual int decode(std::shared_ptr<AVPacket> packet) = 0;
+        /**
+         * @brief Emits the frames the decoder still holds back and resets it for the next packets, e.g. when the stream loops
+         */
+        virtual void flush() = 0;
 
         [[nodiscard]] virtual common::AudioFormat getOutputFormat() const = 0;
         [[nodiscard]] virtual communication::AudioPadParams getAudioParams() const = 0;
@@ -32,6 +32,36 @@ extern "C" {
 #include <libavcodec/avcodec.h>
 }
 
+namespace AVQt {
+    /**
+     * @brief Trades decoding quality for speed, e.g. for thumbnails and previews
+     */
+    struct VideoDecodeMode {
+        /**
+         * Frames to skip, AVDISCARD_NONREF skips non-reference frames, AVDISCARD_NONKEY decodes keyframes only
+         */
+        AVDiscard skipFrame{AVDISCARD_DEFAULT};
+        /**
+         * Skip the in-loop deblocking filter, causes artifacts that accumulate until the next keyframe
+         */
+        bool skipLoopFilter{false};
+        /**
+         * Decode at 1/2^lowres of the resolution, clamped to what the codec supports (mostly MPEG-1/2/4 and MJPEG).
+         * Only applied when the decoder is opened.
+         */
+        int lowres{0};
+        /**
+         * Allow speed optimizations that don't comply with the specification (AV_CODEC_FLAG2_FAST). Only applied when the decoder is opened.
+         */
+        bool fast{false};
+        /**
+         * Output frames without delay (AV_CODEC_FLAG_LOW_DELAY) and thread over slices instead of frames, which holds back one
+         * frame per thread. Only applied when the decoder is opened, set from LatencyProfile::lowDelay by VideoDecoder.
+         */
+        bool lowDelay{false};
+    };
+}// namespace AVQt
+
 namespace AVQt::api {
     class IVideoDecoderImpl {
     public:
@@ -40,7 +70,21 @@ namespace AVQt::api {
         virtual bool open(std::shared_ptr<AVCodecParameters> codecParams) = 0;
         virtual void close() = 0;
 
+        /**
+         * @brief Sends packet to the decoder and emits frameReady() for every frame it outputs
+         * @return EXIT_SUCCESS, EAGAIN if the packet wasn't accepted and has to be sent again, or another AVUNERROR()-ed error
+         */
         virtual int decode(std::shared_ptr<AVPacket> packet) = 0;
+        /**
+         * @brief Emits the frames the decoder still holds back and resets it for the next packets, e.g. when the stream loops
+         */
+        virtual void flush() = 0;
+
+        /**
+         * @brief Changes the decode mode, may be called before open() and while decoding
+         * @return false, if the implementation doesn't support decode modes
+         */
+        virtual bool setDecodeMode(const VideoDecodeMode &mode);
 
         [[nodiscard]] virtual AVPixelFormat getOutputFormat() const = 0;
         [[nodiscard]] virtual AVPixelFormat getSwOutputFormat() const {// Defaults to getOutputFormat(), but can be overridden for HW decoding
@@ -51,6 +95,12 @@ namespace AVQt::api {
 
     signals:
         virtual void frameReady(std::shared_ptr<AVFrame> frame) = 0;
+
+    protected:
+        /**
+         * @brief Copies mode to the options of context, lowres and fast only if context isn't opened yet
+         */
+        static void applyDecodeMode(AVCodecContext *context, const VideoDecodeMode &mode);
     };
 
     struct VideoDecoderInfo {
@@ -17,6 +17,7 @@
 // TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
 // THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+#include "AVQt/common/LatencyProfile.hpp"
 #include "AVQt/communication/IComponent.hpp"
 #include "AVQt/decoder/IVideoDecoderImpl.hpp"
 
@@ -51,6 +52,14 @@ namespace AVQt {
     public:
         struct Config {
             QStringList decoderPriority{};
+            /**
+             * Initial decode mode, e.g. keyframes only for thumbnails
+             */
+            VideoDecodeMode decodeMode{};
+            /**
+             * Input queue size and low delay decoding, use the same profile for all components of a pipeline
+             */
+            common::LatencyProfile latency{};
         };
 
         explicit VideoDecoder(const Config &config, std::shared_ptr<pgraph::network::api::PadRegistry> padRegistry, QObject *parent = nullptr);
@@ -82,6 +91,17 @@ namespace AVQt {
 
         [[nodiscard]] int64_t getOutputPadId() const;
 
+        /*!
+         * \brief Switches the decode mode, skipping frames and the loop filter takes effect with the next packet
+         *
+         * Lowres and fast decoding are only applied when the decoder is opened, i.e. with the next INIT.
+         * @param mode New decode mode
+         * @return false, if the current decoder implementation doesn't support decode modes
+         */
+        Q_INVOKABLE bool setDecodeMode(const VideoDecodeMode &mode);
+
+        [[nodiscard]] VideoDecodeMode getDecodeMode() const;
+
         bool init() Q_DECL_OVERRIDE;
 
     protected slots:
@@ -0,0 +1,105 @@
+#ifndef LIBAVQT_CHUNKEDTRANSCODER_HPP
+#define LIBAVQT_CHUNKEDTRANSCODER_HPP
+
+#include "AVQt/communication/IComponent.hpp"
+#include "AVQt/encoder/IVideoEncoderImpl.hpp"
+
+#include <pgraph/impl/SimpleProcessor.hpp>
+#include <pgraph_network/api/PadRegistry.hpp>
+
+#include <QtCore/QThread>
+
+namespace AVQt {
+    class ChunkedTranscoderPrivate;
+    /**
+     * @brief Transcodes the video stream of a file in keyframe aligned chunks, which are processed in parallel.
+     *
+     * On open(), the keyframes of the input are indexed and grouped into chunks of at least Config::chunkDuration.
+     * Each chunk is demuxed, decoded and encoded independently by a worker pool, starting with a forced keyframe and a closed GOP.
+     * The encoded packets are produced in chunk order on a single packet output pad with continuous timestamps,
+     * so a Muxer can concatenate them into one output. Software encoders that scale poorly with threads
+     * thereby use all cores of the machine.
+     *
+     * The thread finishes after the last chunk was produced, close() afterwards finalizes the muxer.
+     * If a chunk fails, the transcoder emits chunkFailed() and stops itself, producing STOP after the packets of the preceding chunks.
+     */
+    class ChunkedTranscoder : public QThread, public api::IComponent, public pgraph::impl::SimpleProducer {
+        Q_OBJECT
+        Q_INTERFACES(AVQt::api::IComponent)
+        Q_DECLARE_PRIVATE(ChunkedTranscoder)
+        Q_DISABLE_COPY_MOVE(ChunkedTranscoder)
+    public:
+        struct Config {
+            /**
+             * Path of the input file, which is opened once per chunk, so it has to be seekable
+             */
+            QString inputPath{};
+            VideoCodec codec{VideoCodec::H264};
+            /**
+             * libavcodec encoder name, e.g. "libx264", the default encoder of codec is used, if empty
+             */
+            QString encoderName{};
+            VideoEncodeParameters encodeParameters{};
+            /**
+             * Minimum chunk duration in microseconds, chunks always start at a keyframe
+             */
+            int64_t chunkDuration{10 * 1000 * 1000};
+            /**
+             * Number of chunks transcoded in parallel, 0 selects the number of CPU cores
+             */
+            int maxParallelChunks{0};
+            /**
+             * Decoder and encoder threads used within each chunk
+             */
+            int threadsPerChunk{1};
+        };
+
+        explicit ChunkedTranscoder(const Config &config, std::shared_ptr<pgraph::network::api::PadRegistry> padRegistry, QObject *parent = nullptr);
+        explicit ChunkedTranscoder(const Config &config, QObject *parent = nullptr);
+        ~ChunkedTranscoder() Q_DECL_OVERRIDE;
+
+        bool init() Q_DECL_OVERRIDE;
+
+        bool isOpen() const Q_DECL_OVERRIDE;
+        bool isRunning() const Q_DECL_OVERRIDE;
+        bool isPaused() const Q_DECL_OVERRIDE;
+
+        [[nodiscard]] int64_t getOutputPadId() const;
+        /**
+         * @return the number of chunks, known after open()
+         */
+        [[nodiscard]] size_t chunkCount() const;
+
+    public slots:
+        Q_INVOKABLE bool open() Q_DECL_OVERRIDE;
+        Q_INVOKABLE void close() Q_DECL_OVERRIDE;
+        Q_INVOKABLE bool start() Q_DECL_OVERRIDE;
+        Q_INVOKABLE void stop() Q_DECL_OVERRIDE;
+        Q_INVOKABLE void pause(bool state) Q_DECL_OVERRIDE;
+
+    signals:
+        void started() Q_DECL_OVERRIDE;
+        void stopped() Q_DECL_OVERRIDE;
+        void paused(bool state) Q_DECL_OVERRIDE;
+        /**
+         * @brief Emitted after the packets of a chunk were produced
+         * @param chunk Index of the chunk
+         * @param count Number of chunks
+         */
+        void chunkFinished(size_t chunk, size_t count);
+        /**
+         * @brief Emitted, if a chunk couldn't be transcoded, the output ends with the preceding chunk
+         * @param chunk Index of the chunk
+         */
+        void chunkFailed(size_t chunk);
+
+    protected:
+        void run() Q_DECL_OVERRIDE;
+
+    private:
+        std::unique_ptr<ChunkedTranscoderPrivate> d_ptr;
+    };
+}// namespace AVQt
+
+
+#endif//LIBAVQT_CHUNKEDTRANSCODER_HPP
@@ -0,0 +1,95 @@
+#ifndef LIBAVQT_ENCODELADDER_HPP
+#define LIBAVQT_ENCODELADDER_HPP
+
+#include "AVQt/communication/IComponent.hpp"
+#include "AVQt/encoder/IVideoEncoderImpl.hpp"
+
+#include <pgraph/impl/SimpleProcessor.hpp>
+#include <pgraph_network/api/PadRegistry.hpp>
+
+#include <QtCore/QObject>
+#include <QtCore/QSize>
+
+extern "C" {
+#include <libswscale/swscale.h>
+}
+
+namespace AVQt {
+    class EncodeLadderPrivate;
+    /**
+     * @brief Encodes one decoded video stream into multiple renditions for adaptive bitrate streaming.
+     *
+     * Each rung is downscaled from the previous one instead of the input, so the input is decoded and downloaded once
+     * and every scaling step works on the smallest possible source. The rungs are encoded in parallel, one thread each,
+     * with keyframes forced on the same input frames, so segments can be cut at identical timestamps across all renditions.
+     *
+     * There is one packet output pad per rung, in the order of Config::rungs, each of which can be linked to its own Muxer.
+     */
+    class EncodeLadder : public QObject, public pgraph::impl::SimpleProcessor, public api::IComponent {
+        Q_OBJECT
+        Q_INTERFACES(AVQt::api::IComponent)
+        Q_DECLARE_PRIVATE(EncodeLadder)
+        Q_DISABLE_COPY_MOVE(EncodeLadder)
+    public:
+        struct Rung {
+            QSize size{};
+            /**
+             * The gop size is overridden by Config::gopSize
+             */
+            VideoEncodeParameters encodeParameters{};
+        };
+
+        struct Config {
+            /**
+             * Renditions ordered by descending size, e.g. 1080p, 720p, 480p, 360p
+             */
+            QList<Rung> rungs{};
+            VideoCodec codec{};
+            QStringList encoderPriority{};
+            /**
+             * Frames between two keyframes, shared by all rungs
+             */
+            int gopSize{60};
+            /**
+             * SWS_* scaling algorithm flags
+             */
+            int scaleFlags{SWS_BICUBIC};
+        };
+
+        explicit EncodeLadder(const Config &config, std::shared_ptr<pgraph::network::api::PadRegistry> padRegistry, QObject *parent = nullptr);
+        explicit EncodeLadder(const Config &config, QObject *parent = nullptr);
+        ~EncodeLadder() Q_DECL_OVERRIDE;
+
+        bool init() Q_DECL_OVERRIDE;
+
+        bool isOpen() const Q_DECL_OVERRIDE;
+        bool isRunning() const Q_DECL_OVERRIDE;
+        bool isPaused() const Q_DECL_OVERRIDE;
+
+        [[nodiscard]] int64_t getInputPadId() const;
+        /**
+         * @return the id of the packet output pad of rung, INVALID_PAD_ID if there is no such rung
+         */
+        [[nodiscard]] int64_t getRungPadId(int rung) const;
+
+        void consume(int64_t pad, std::shared_ptr<pgraph::api::Data> data) Q_DECL_OVERRIDE;
+
+    signals:
+        void started() Q_DECL_OVERRIDE;
+        void stopped() Q_DECL_OVERRIDE;
+        void paused(bool state) Q_DECL_OVERRIDE;
+
+    protected:
+        bool open() Q_DECL_OVERRIDE;
+        void close() Q_DECL_OVERRIDE;
+        bool start() Q_DECL_OVERRIDE;
+        void stop() Q_DECL_OVERRIDE;
+        void pause(bool state) Q_DECL_OVERRIDE;
+
+    private:
+        std::unique_ptr<EncodeLadderPrivate> d_ptr;
+    };
+}// namespace AVQt
+
+
+#endif//LIBAVQT_ENCODELADDER_HPP
@@ -36,10 +36,20 @@ namespace AVQt {
             virtual void close() = 0;
 
             virtual int encode(std::shared_ptr<AVFrame> frame) = 0;
+            /**
+             * @brief Emits the packets of all frames the encoder still holds back and resets it for the next frames.
+             * The encoder stays open with the same parameters, e.g. when the input loops.
+             */
+            virtual void flush() = 0;
 
             [[nodiscard]] virtual QVector<AVSampleFormat> getInputFormats() const = 0;
             [[nodiscard]] virtual std::shared_ptr<AVCodecParameters> getCodecParameters() const = 0;
             [[nodiscard]] virtual std::shared_ptr<communication::PacketPadParams> getPacketPadParams() const = 0;
+            /**
+             * @brief Number of samples every frame passed to encode() has to contain. Only valid while open.
+             * @return the frame size, or 0 if the encoder accepts frames of any size
+             */
+            [[nodiscard]] virtual int getFrameSize() const = 0;
         signals:
             virtual void packetReady(std::shared_ptr<AVPacket> packet) = 0;
 
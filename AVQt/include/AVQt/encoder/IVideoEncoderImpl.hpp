@@ -43,6 +43,19 @@ namespace AVQt {
     };
     struct VideoEncodeParameters {
         int32_t bitrate;
+        /**
+         * Peak bitrate for variable bitrate encoding, 0 encodes with constant bitrate
+         */
+        int32_t maxBitrate{0};
+        /**
+         * Frames between two keyframes, 0 selects the encoder's default
+         */
+        int32_t gopSize{0};
+        /**
+         * No B-frames, lookahead or asynchronous encoding, every frame leaves the encoder before the next one is submitted.
+         * Set from common::LatencyProfile::lowDelay by VideoEncoder.
+         */
+        bool lowDelay{false};
     };
     namespace api {
         class IVideoEncoderImpl {
@@ -56,7 +69,31 @@ namespace AVQt {
             virtual void close() = 0;
 
             [[nodiscard]] virtual std::shared_ptr<AVFrame> prepareFrame(std::shared_ptr<AVFrame> frame) = 0;
+            /**
+             * @brief Submits frame to the encoder, waiting for it to make room if it is full.
+             * Packets are received independently of submission and emitted with packetReady(), possibly from another thread.
+             * @return EXIT_SUCCESS, EAGAIN if the encoder is still full after waiting, or another errno value
+             */
             virtual int encode(std::shared_ptr<AVFrame> frame) = 0;
+            /**
+             * @brief Emits the packets of all frames the encoder still holds back and resets it, so the next frame starts a new GOP.
+             * The encoder stays open with the same parameters, e.g. when the input loops.
+             */
+            virtual void flush() = 0;
+            /**
+             * @brief Applies the bitrate and peak bitrate of parameters to the next frame, see isReconfigureSeamless().
+             * The other parameters are ignored. Thread-safe.
+             * @return false, if the implementation can't change them at runtime
+             */
+            virtual bool reconfigure(const VideoEncodeParameters &parameters) = 0;
+            /**
+             * @return true, if reconfigure() changes the rate in place, false, if it drains the encoder and starts with an IDR frame
+             */
+            [[nodiscard]] virtual bool isReconfigureSeamless() const = 0;
+            /**
+             * @brief Makes the next frame an IDR frame. Thread-safe.
+             */
+            virtual void requestKeyframe() = 0;
 
             [[nodiscard]] virtual bool isHWAccel() const = 0;
 
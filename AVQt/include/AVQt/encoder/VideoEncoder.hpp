@@ -21,6 +21,7 @@
 #ifndef LIBAVQT_VIDEOENCODER_HPP
 #define LIBAVQT_VIDEOENCODER_HPP
 
+#include "AVQt/common/LatencyProfile.hpp"
 #include "AVQt/communication/IComponent.hpp"
 #include "AVQt/encoder/IVideoEncoderImpl.hpp"
 
@@ -40,10 +41,63 @@ namespace AVQt {
         Q_INTERFACES(AVQt::api::IComponent)
         Q_DECLARE_PRIVATE(AVQt::VideoEncoder)
     public:
+        /**
+         * Degrades the stream instead of blocking the producer, when the encoder can't keep up with live input, e.g. from a DesktopCapturer
+         */
+        struct AdaptiveRate {
+            bool enabled{false};
+            /**
+             * Lowest bitrate in bit/s, 0 for a quarter of the configured bitrate
+             */
+            int32_t minBitrate{0};
+            /**
+             * Encode only every n-th input frame at most
+             */
+            int maxFrameInterval{4};
+        };
+
+        struct AdaptiveRateStatistics {
+            /**
+             * 0 while the encoder keeps up, every level lowers the bitrate or the frame rate
+             */
+            int level{0};
+            /**
+             * Current bitrate in bit/s, 0 if the encoder chooses it
+             */
+            int32_t bitrate{0};
+            /**
+             * Every frameInterval-th input frame is encoded
+             */
+            int frameInterval{1};
+            /**
+             * Mean time encode() takes per frame in microseconds
+             */
+            int64_t meanEncodeTime{0};
+            /**
+             * Mean distance of the input frames in microseconds
+             */
+            int64_t inputFrameDuration{0};
+            size_t queueDepth{0};
+            /**
+             * Input frames dropped to lower the frame rate
+             */
+            uint64_t decimatedFrames{0};
+            /**
+             * Input frames dropped, because the queue was full nevertheless
+             */
+            uint64_t droppedFrames{0};
+            uint64_t levelChanges{0};
+        };
+
         struct Config {
             QStringList encoderPriority{};
             VideoCodec codec{};
             VideoEncodeParameters encodeParameters{};
+            /**
+             * Input queue size and low delay encoding, use the same profile for all components of a pipeline
+             */
+            common::LatencyProfile latency{};
+            AdaptiveRate adaptiveRate{};
         };
 
         VideoEncoder(const Config &config, std::shared_ptr<pgraph::network::api::PadRegistry> padRegistry, QObject *parent = nullptr);
@@ -75,6 +129,24 @@ namespace AVQt {
 
         bool init() Q_DECL_OVERRIDE;
 
+        /**
+         * @brief Changes the bitrate from the next frame on without restarting the pipeline, e.g. for live adaptive streaming
+         * @param bitrate Target bitrate in bit/s
+         * @param maxBitrate Peak bitrate in bit/s, 0 encodes with constant bitrate
+         * @return false, if the encoder is not open or can't change its bitrate at runtime
+         */
+        Q_INVOKABLE bool setBitrate(int32_t bitrate, int32_t maxBitrate = 0);
+
+        /**
+         * @brief Makes the next frame an IDR frame, e.g. when a client joins a live stream
+         */
+        Q_INVOKABLE void requestKeyframe();
+
+        /**
+         * @return the decisions of the adaptive rate control, all zero unless Config::adaptiveRate is enabled
+         */
+        [[nodiscard]] AdaptiveRateStatistics getAdaptiveRateStatistics() const;
+
     signals:
         /*!
          * \brief Emitted after start() finished
@@ -0,0 +1,64 @@
+#ifndef LIBAVQT_AUDIOCONVERTER_HPP
+#define LIBAVQT_AUDIOCONVERTER_HPP
+
+#include "AVQt/common/AudioFormat.hpp"
+#include "AVQt/communication/IComponent.hpp"
+
+#include <pgraph/impl/SimpleProcessor.hpp>
+#include <pgraph_network/api/PadRegistry.hpp>
+
+#include <QtCore/QObject>
+
+namespace AVQt {
+    class AudioConverterPrivate;
+    /**
+     * @brief Converts sample format, sample rate and channel layout of audio frames using libswresample.
+     *
+     * Conversion happens synchronously in consume(), so the converter doesn't add a thread or a queue to the pipeline.
+     * The SwrContext is kept between frames and output buffers are taken from a pool.
+     */
+    class AudioConverter : public QObject, public pgraph::impl::SimpleProcessor, public api::IComponent {
+        Q_OBJECT
+        Q_INTERFACES(AVQt::api::IComponent)
+        Q_DECLARE_PRIVATE(AudioConverter)
+        Q_DISABLE_COPY_MOVE(AudioConverter)
+    public:
+        struct Config {
+            /**
+             * Target format. Properties left at their default (-1 or AV_SAMPLE_FMT_NONE) are taken from the input.
+             * If only the channel count is given, the default layout for it is used.
+             */
+            common::AudioFormat outputFormat{};
+        };
+
+        explicit AudioConverter(const Config &config, std::shared_ptr<pgraph::network::api::PadRegistry> padRegistry, QObject *parent = nullptr);
+        explicit AudioConverter(const Config &config, QObject *parent = nullptr);
+        ~AudioConverter() Q_DECL_OVERRIDE;
+
+        bool init() Q_DECL_OVERRIDE;
+
+        bool isOpen() const Q_DECL_OVERRIDE;
+        bool isRunning() const Q_DECL_OVERRIDE;
+        bool isPaused() const Q_DECL_OVERRIDE;
+
+        void consume(int64_t pad, std::shared_ptr<pgraph::api::Data> data) Q_DECL_OVERRIDE;
+
+    signals:
+        void started() Q_DECL_OVERRIDE;
+        void stopped() Q_DECL_OVERRIDE;
+        void paused(bool state) Q_DECL_OVERRIDE;
+
+    protected:
+        bool open() Q_DECL_OVERRIDE;
+        void close() Q_DECL_OVERRIDE;
+        bool start() Q_DECL_OVERRIDE;
+        void stop() Q_DECL_OVERRIDE;
+        void pause(bool state) Q_DECL_OVERRIDE;
+
+    private:
+        std::unique_ptr<AudioConverterPrivate> d_ptr;
+    };
+}// namespace AVQt
+
+
+#endif//LIBAVQT_AUDIOCONVERTER_HPP
@@ -0,0 +1,69 @@
+#ifndef LIBAVQT_BITSTREAMFILTER_HPP
+#define LIBAVQT_BITSTREAMFILTER_HPP
+
+#include "AVQt/communication/IComponent.hpp"
+
+#include <pgraph/impl/SimpleProcessor.hpp>
+#include <pgraph_network/api/PadRegistry.hpp>
+
+#include <QtCore/QObject>
+#include <QtCore/QString>
+
+namespace AVQt {
+    class BitstreamFilterPrivate;
+    /**
+     * @brief Runs encoded packets through a chain of libavcodec bitstream filters, without decoding them.
+     *
+     * Used between a Demuxer and a Muxer for stream copy, when the bitstream format differs between the containers,
+     * e.g. h264_mp4toannexb for MP4 to MPEG-TS or aac_adtstoasc for MPEG-TS to MP4.
+     * The codec parameters and time base of the output pad are the ones reported by the filters.
+     * Filtering happens synchronously in consume().
+     */
+    class BitstreamFilter : public QObject, public pgraph::impl::SimpleProcessor, public api::IComponent {
+        Q_OBJECT
+        Q_INTERFACES(AVQt::api::IComponent)
+        Q_DECLARE_PRIVATE(BitstreamFilter)
+        Q_DISABLE_COPY_MOVE(BitstreamFilter)
+    public:
+        struct Config {
+            /**
+             * Filter chain in the syntax of ffmpeg's -bsf option, e.g. "h264_mp4toannexb" or "h264_metadata=level=4.1,dump_extra".
+             * Packets are passed through unchanged, if empty.
+             */
+            QString filters{};
+        };
+
+        explicit BitstreamFilter(const Config &config, std::shared_ptr<pgraph::network::api::PadRegistry> padRegistry, QObject *parent = nullptr);
+        explicit BitstreamFilter(const Config &config, QObject *parent = nullptr);
+        ~BitstreamFilter() Q_DECL_OVERRIDE;
+
+        bool init() Q_DECL_OVERRIDE;
+
+        bool isOpen() const Q_DECL_OVERRIDE;
+        bool isRunning() const Q_DECL_OVERRIDE;
+        bool isPaused() const Q_DECL_OVERRIDE;
+
+        [[nodiscard]] int64_t getInputPadId() const;
+        [[nodiscard]] int64_t getOutputPadId() const;
+
+        void consume(int64_t pad, std::shared_ptr<pgraph::api::Data> data) Q_DECL_OVERRIDE;
+
+    signals:
+        void started() Q_DECL_OVERRIDE;
+        void stopped() Q_DECL_OVERRIDE;
+        void paused(bool state) Q_DECL_OVERRIDE;
+
+    protected:
+        bool open() Q_DECL_OVERRIDE;
+        void close() Q_DECL_OVERRIDE;
+        bool start() Q_DECL_OVERRIDE;
+        void stop() Q_DECL_OVERRIDE;
+        void pause(bool state) Q_DECL_OVERRIDE;
+
+    private:
+        std::unique_ptr<BitstreamFilterPrivate> d_ptr;
+    };
+}// namespace AVQt
+
+
+#endif//LIBAVQT_BITSTREAMFILTER_HPP
@@ -0,0 +1,86 @@
+#ifndef LIBAVQT_FILTERGRAPH_HPP
+#define LIBAVQT_FILTERGRAPH_HPP
+
+#include "AVQt/communication/IComponent.hpp"
+
+#include <pgraph/impl/SimpleProcessor.hpp>
+#include <pgraph_network/api/PadRegistry.hpp>
+
+#include <QtCore/QList>
+#include <QtCore/QObject>
+#include <QtCore/QString>
+
+extern "C" {
+#include <libavutil/avutil.h>
+}
+
+namespace AVQt {
+    class FilterGraphPrivate;
+    /**
+     * @brief Runs video and audio frames through a libavfilter graph, e.g. for denoising, cropping, frame rate conversion or overlays.
+     *
+     * Filtering happens synchronously in consume(). The graph is configured from the parameters the inputs are initialized with,
+     * and rebuilt lazily, when the size, format or hardware frames context of an input changes mid-stream.
+     * Hardware frames contexts and devices are only passed to the graph, if the inputs carry hardware frames.
+     *
+     * With multiple inputs, the graph is opened once all inputs are initialized,
+     * all other lifecycle messages are taken from the first input.
+     */
+    class FilterGraph : public QObject, public pgraph::impl::SimpleProcessor, public api::IComponent {
+        Q_OBJECT
+        Q_INTERFACES(AVQt::api::IComponent)
+        Q_DECLARE_PRIVATE(FilterGraph)
+        Q_DISABLE_COPY_MOVE(FilterGraph)
+    public:
+        struct Config {
+            /**
+             * Graph description in the syntax of ffmpeg's -filter_complex.
+             * The first input is labeled [in], further ones [in1], [in2] and so on, the outputs [out], [out1], ...
+             * The labels of the first input and output can be omitted, e.g. "hqdn3d,crop=1280:720".
+             */
+            QString description{};
+            /**
+             * Media type of each input pad, in the order of their labels
+             */
+            QList<AVMediaType> inputs{AVMEDIA_TYPE_VIDEO};
+            /**
+             * Media type of each output pad, in the order of their labels
+             */
+            QList<AVMediaType> outputs{AVMEDIA_TYPE_VIDEO};
+            /**
+             * Number of threads for slice threaded filters, 0 selects the number of CPU cores
+             */
+            int threads{0};
+        };
+
+        explicit FilterGraph(const Config &config, std::shared_ptr<pgraph::network::api::PadRegistry> padRegistry, QObject *parent = nullptr);
+        explicit FilterGraph(const Config &config, QObject *parent = nullptr);
+        ~FilterGraph() Q_DECL_OVERRIDE;
+
+        bool init() Q_DECL_OVERRIDE;
+
+        bool isOpen() const Q_DECL_OVERRIDE;
+        bool isRunning() const Q_DECL_OVERRIDE;
+        bool isPaused() const Q_DECL_OVERRIDE;
+
+        void consume(int64_t pad, std::shared_ptr<pgraph::api::Data> data) Q_DECL_OVERRIDE;
+
+    signals:
+        void started() Q_DECL_OVERRIDE;
+        void stopped() Q_DECL_OVERRIDE;
+        void paused(bool state) Q_DECL_OVERRIDE;
+
+    protected:
+        bool open() Q_DECL_OVERRIDE;
+        void close() Q_DECL_OVERRIDE;
+        bool start() Q_DECL_OVERRIDE;
+        void stop() Q_DECL_OVERRIDE;
+        void pause(bool state) Q_DECL_OVERRIDE;
+
+    private:
+        std::unique_ptr<FilterGraphPrivate> d_ptr;
+    };
+}// namespace AVQt
+
+
+#endif//LIBAVQT_FILTERGRAPH_HPP
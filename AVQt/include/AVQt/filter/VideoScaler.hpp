@@ -0,0 +1,82 @@
+#ifndef LIBAVQT_VIDEOSCALER_HPP
+#define LIBAVQT_VIDEOSCALER_HPP
+
+#include "AVQt/communication/IComponent.hpp"
+
+#include <pgraph/impl/SimpleProcessor.hpp>
+#include <pgraph_network/api/PadRegistry.hpp>
+
+#include <QtCore/QObject>
+#include <QtCore/QSize>
+
+extern "C" {
+#include <libavutil/pixfmt.h>
+#include <libswscale/swscale.h>
+}
+
+namespace AVQt {
+    class VideoScalerPrivate;
+    /**
+     * @brief Scales video frames and converts their pixel format on the CPU using libswscale.
+     *
+     * Hardware frames are downloaded first, the output is always in system memory.
+     * Scaling happens synchronously in consume(). SwsContexts are cached per input and output format and size,
+     * so alternating resolutions don't rebuild them, and output buffers are taken from a pool.
+     * With libswscale 6 and newer, each frame is converted in slices by multiple threads.
+     */
+    class VideoScaler : public QObject, public pgraph::impl::SimpleProcessor, public api::IComponent {
+        Q_OBJECT
+        Q_INTERFACES(AVQt::api::IComponent)
+        Q_DECLARE_PRIVATE(VideoScaler)
+        Q_DISABLE_COPY_MOVE(VideoScaler)
+    public:
+        struct Config {
+            /**
+             * Target size, the input size is used, if it is invalid
+             */
+            QSize outputSize{};
+            /**
+             * Target pixel format, the (software) input format is used, if it is AV_PIX_FMT_NONE
+             */
+            AVPixelFormat outputFormat{AV_PIX_FMT_NONE};
+            /**
+             * SWS_* scaling algorithm flags
+             */
+            int scaleFlags{SWS_BICUBIC};
+            /**
+             * Number of slice threads per frame, 0 selects the number of CPU cores
+             */
+            int threads{0};
+        };
+
+        explicit VideoScaler(const Config &config, std::shared_ptr<pgraph::network::api::PadRegistry> padRegistry, QObject *parent = nullptr);
+        explicit VideoScaler(const Config &config, QObject *parent = nullptr);
+        ~VideoScaler() Q_DECL_OVERRIDE;
+
+        bool init() Q_DECL_OVERRIDE;
+
+        bool isOpen() const Q_DECL_OVERRIDE;
+        bool isRunning() const Q_DECL_OVERRIDE;
+        bool isPaused() const Q_DECL_OVERRIDE;
+
+        void consume(int64_t pad, std::shared_ptr<pgraph::api::Data> data) Q_DECL_OVERRIDE;
+
+    signals:
+        void started() Q_DECL_OVERRIDE;
+        void stopped() Q_DECL_OVERRIDE;
+        void paused(bool state) Q_DECL_OVERRIDE;
+
+    protected:
+        bool open() Q_DECL_OVERRIDE;
+        void close() Q_DECL_OVERRIDE;
+        bool start() Q_DECL_OVERRIDE;
+        void stop() Q_DECL_OVERRIDE;
+        void pause(bool state) Q_DECL_OVERRIDE;
+
+    private:
+        std::unique_ptr<VideoScalerPrivate> d_ptr;
+    };
+}// namespace AVQt
+
+
+#endif//LIBAVQT_VIDEOSCALER_HPP
@@ -40,6 +40,17 @@ namespace AVQt {
         struct Config {
             bool loop{false};
             std::unique_ptr<QIODevice> inputDevice{};
+            /**
+             * Produce packets in the time base of their stream instead of microseconds, announced in PacketPadParams::timeBase.
+             * Used for stream copy, where the pads are linked to a Muxer (optionally through a BitstreamFilter) without decoding.
+             * Decoders expect microseconds, so this must stay disabled for decoding pipelines.
+             */
+            bool preserveTimestamps{false};
+            /**
+             * If false, all streams start discarded and have to be enabled with setStreamEnabled() once their pads are linked.
+             * Discarded streams are skipped by libavformat, so selecting a single track of a multi-track input saves parsing and allocating the others.
+             */
+            bool enableAllStreams{true};
         };
 
         explicit Demuxer(Config inputDevice, std::shared_ptr<pgraph::network::api::PadRegistry> padRegistry, QObject *parent = nullptr);
@@ -58,6 +69,18 @@ namespace AVQt {
 
         Q_INVOKABLE bool init() override;
 
+        /**
+         * @brief Enables or discards the stream of an output pad, takes effect with the next packet read.
+         *
+         * Call this when linking or unlinking the pad, streams nobody consumes are marked AVDISCARD_ALL.
+         * @param padId Output pad of the stream
+         * @param enabled false to discard the stream
+         * @return false, if padId is no output pad of this demuxer
+         */
+        Q_INVOKABLE bool setStreamEnabled(int64_t padId, bool enabled);
+
+        [[nodiscard]] bool isStreamEnabled(int64_t padId) const;
+
     public slots:
         Q_INVOKABLE bool open() override;
 
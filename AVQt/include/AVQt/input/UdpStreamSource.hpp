@@ -0,0 +1,115 @@
+#ifndef LIBAVQT_UDPSTREAMSOURCE_HPP
+#define LIBAVQT_UDPSTREAMSOURCE_HPP
+
+#include <QtCore/QIODevice>
+#include <QtCore/QString>
+
+#include <memory>
+
+namespace AVQt {
+    class UdpStreamSourcePrivate;
+    /**
+     * @brief Sequential QIODevice receiving a live MPEG-TS stream over UDP or RTP, to be used as Demuxer::Config::inputDevice.
+     *
+     * open() binds the socket (joining the group for multicast addresses) and starts a receiving thread, which reads batches of
+     * datagrams with recvmmsg directly into a ring of datagram slots. RTP packets are reordered by their sequence number in a
+     * jitter buffer, a gap is declared lost once the oldest buffered packet waited for Config::jitterLatency, packets arriving after
+     * their slot was passed on are counted as late and dropped. readData() copies the payload out of the slots, which is the only copy
+     * between the socket and the demuxer. It blocks until data arrives, if nothing arrives for Config::readTimeout, end of stream is reported.
+     */
+    class UdpStreamSource : public QIODevice {
+        Q_OBJECT
+        Q_DECLARE_PRIVATE(UdpStreamSource)
+        Q_DISABLE_COPY_MOVE(UdpStreamSource)
+    public:
+        enum class Protocol {
+            /**
+             * Detect RTP from the first datagram, plain UDP datagrams start with the TS sync byte
+             */
+            Auto,
+            UDP,
+            RTP
+        };
+
+        struct Config {
+            /**
+             * Local address to bind to, or a multicast group to join
+             */
+            QString address{"0.0.0.0"};
+            quint16 port{0};
+            Protocol protocol{Protocol::Auto};
+            /**
+             * Time in milliseconds a missing RTP packet is waited for before it is considered lost, 0 disables reordering
+             */
+            int jitterLatency{50};
+            /**
+             * Number of datagram slots, bounds the buffered data to slotCount * maxDatagramSize bytes
+             */
+            int slotCount{1024};
+            int maxDatagramSize{2048};
+            /**
+             * Datagrams received per system call
+             */
+            int batchSize{32};
+            /**
+             * Time in milliseconds readData() waits for data, before reporting end of stream
+             */
+            int readTimeout{5000};
+        };
+
+        struct Statistics {
+            uint64_t datagrams{0};
+            uint64_t bytes{0};
+            /**
+             * RTP packets never received within the jitter latency
+             */
+            uint64_t lost{0};
+            /**
+             * RTP packets received after their position was passed on
+             */
+            uint64_t late{0};
+            /**
+             * RTP packets reordered by the jitter buffer
+             */
+            uint64_t reordered{0};
+            /**
+             * Datagrams dropped because all slots were in use, the demuxer doesn't keep up
+             */
+            uint64_t overflows{0};
+            /**
+             * MPEG-TS continuity counter errors, also detects loss in plain UDP streams
+             */
+            uint64_t continuityErrors{0};
+            /**
+             * Jumps of the RTP sequence number, e.g. after the sender restarted, where the jitter buffer started over.
+             * The first packet after a jump is dropped, it is only accepted once the next one confirms the new sequence.
+             */
+            uint64_t resyncs{0};
+        };
+
+        explicit UdpStreamSource(const Config &config, QObject *parent = nullptr);
+        ~UdpStreamSource() Q_DECL_OVERRIDE;
+
+        bool open(OpenMode mode) Q_DECL_OVERRIDE;
+        void close() Q_DECL_OVERRIDE;
+
+        [[nodiscard]] bool isSequential() const Q_DECL_OVERRIDE;
+        [[nodiscard]] qint64 bytesAvailable() const Q_DECL_OVERRIDE;
+
+        [[nodiscard]] Statistics getStatistics() const;
+        /**
+         * @return the bound port, useful with Config::port 0
+         */
+        [[nodiscard]] quint16 getLocalPort() const;
+
+    protected:
+        qint64 readData(char *data, qint64 maxSize) Q_DECL_OVERRIDE;
+        qint64 writeData(const char *data, qint64 maxSize) Q_DECL_OVERRIDE;
+
+    private:
+        std::unique_ptr<UdpStreamSourcePrivate> d_ptr;
+    };
+}// namespace AVQt
+
+
+#endif//LIBAVQT_UDPSTREAMSOURCE_HPP
@@ -0,0 +1,75 @@
+#ifndef LIBAVQT_SHAREDMEMORYFRAMERECEIVER_HPP
+#define LIBAVQT_SHAREDMEMORYFRAMERECEIVER_HPP
+
+#include "AVQt/communication/IComponent.hpp"
+
+#include <pgraph/impl/SimpleProducer.hpp>
+#include <pgraph_network/api/PadRegistry.hpp>
+
+#include <QtCore/QString>
+#include <QtCore/QThread>
+
+namespace AVQt {
+    class SharedMemoryFrameReceiverPrivate;
+    /**
+     * @brief Produces the video frames of a SharedMemoryFrameSender in another process.
+     *
+     * Listens on Config::socketPath after open(), start() accepts a sender. The frames reference the shared ring directly,
+     * their slots are handed back to the sender once the last reference is dropped, so consumers holding frames throttle the sender.
+     * INIT, START, STOP, PAUSE, RESET and CLEANUP of the sending pipeline are forwarded to the output pad,
+     * a disconnecting sender stops and cleans up the downstream components. A new sender may connect afterwards.
+     */
+    class SharedMemoryFrameReceiver : public QThread, public api::IComponent, public pgraph::impl::SimpleProducer {
+        Q_OBJECT
+        Q_INTERFACES(AVQt::api::IComponent)
+        Q_DECLARE_PRIVATE(SharedMemoryFrameReceiver)
+        Q_DISABLE_COPY_MOVE(SharedMemoryFrameReceiver)
+    public:
+        struct Config {
+            /**
+             * Path of the unix socket to listen on, an existing socket file is replaced
+             */
+            QString socketPath{};
+        };
+
+        explicit SharedMemoryFrameReceiver(const Config &config, std::shared_ptr<pgraph::network::api::PadRegistry> padRegistry, QObject *parent = nullptr);
+        explicit SharedMemoryFrameReceiver(const Config &config, QObject *parent = nullptr);
+        ~SharedMemoryFrameReceiver() Q_DECL_OVERRIDE;
+
+        bool isOpen() const Q_DECL_OVERRIDE;
+        bool isRunning() const Q_DECL_OVERRIDE;
+        bool isPaused() const Q_DECL_OVERRIDE;
+
+        [[nodiscard]] int64_t getOutputPadId() const;
+
+    public slots:
+        bool init() Q_DECL_OVERRIDE;
+
+        bool open() Q_DECL_OVERRIDE;
+        void close() Q_DECL_OVERRIDE;
+
+        bool start() Q_DECL_OVERRIDE;
+        void stop() Q_DECL_OVERRIDE;
+
+        void pause(bool state) Q_DECL_OVERRIDE;
+
+    signals:
+        void started() Q_DECL_OVERRIDE;
+        void stopped() Q_DECL_OVERRIDE;
+        void paused(bool state) Q_DECL_OVERRIDE;
+        /**
+         * @brief Emitted from the receiving thread, when a sender connected or disconnected
+         */
+        void senderConnected();
+        void senderDisconnected();
+
+    protected:
+        void run() Q_DECL_OVERRIDE;
+
+    private:
+        std::unique_ptr<SharedMemoryFrameReceiverPrivate> d_ptr;
+    };
+}// namespace AVQt
+
+
+#endif//LIBAVQT_SHAREDMEMORYFRAMERECEIVER_HPP
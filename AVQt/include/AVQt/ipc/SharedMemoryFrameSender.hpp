@@ -0,0 +1,80 @@
+#ifndef LIBAVQT_SHAREDMEMORYFRAMESENDER_HPP
+#define LIBAVQT_SHAREDMEMORYFRAMESENDER_HPP
+
+#include "AVQt/communication/IComponent.hpp"
+
+#include <pgraph/impl/SimpleConsumer.hpp>
+#include <pgraph_network/api/PadRegistry.hpp>
+
+#include <QtCore/QObject>
+#include <QtCore/QString>
+
+namespace AVQt {
+    class SharedMemoryFrameSenderPrivate;
+    /**
+     * @brief Forwards video frames to a SharedMemoryFrameReceiver in another process.
+     *
+     * Frames are copied once into a ring of slots in a memfd, the receiver maps the ring and wraps the slots into AVFrames without copying.
+     * Only slot indices pass the local socket. A slot is reused after the receiver dropped its last reference to the frame,
+     * if all slots are in use for longer than Config::slotTimeout, the frame is dropped.
+     * Hardware frames are downloaded first. The pipeline messages (INIT, START, STOP, ...) are forwarded, so the receiving graph
+     * follows the sending one.
+     */
+    class SharedMemoryFrameSender : public QObject, public pgraph::impl::SimpleConsumer, public api::IComponent {
+        Q_OBJECT
+        Q_INTERFACES(AVQt::api::IComponent)
+        Q_DECLARE_PRIVATE(SharedMemoryFrameSender)
+        Q_DISABLE_COPY_MOVE(SharedMemoryFrameSender)
+    public:
+        struct Config {
+            /**
+             * Path of the unix socket the SharedMemoryFrameReceiver listens on
+             */
+            QString socketPath{};
+            /**
+             * Frames the receiving process may hold at once
+             */
+            uint32_t slotCount{4};
+            /**
+             * Time to wait for a free slot in milliseconds, before the frame is dropped
+             */
+            int slotTimeout{100};
+        };
+
+        explicit SharedMemoryFrameSender(const Config &config, std::shared_ptr<pgraph::network::api::PadRegistry> padRegistry, QObject *parent = nullptr);
+        explicit SharedMemoryFrameSender(const Config &config, QObject *parent = nullptr);
+        ~SharedMemoryFrameSender() Q_DECL_OVERRIDE;
+
+        bool init() Q_DECL_OVERRIDE;
+
+        bool isOpen() const Q_DECL_OVERRIDE;
+        bool isRunning() const Q_DECL_OVERRIDE;
+        bool isPaused() const Q_DECL_OVERRIDE;
+
+        [[nodiscard]] int64_t getInputPadId() const;
+        /**
+         * @return the number of frames dropped, because no slot was released in time
+         */
+        [[nodiscard]] uint64_t getDroppedFrames() const;
+
+        void consume(int64_t pad, std::shared_ptr<pgraph::api::Data> data) Q_DECL_OVERRIDE;
+
+    signals:
+        void started() Q_DECL_OVERRIDE;
+        void stopped() Q_DECL_OVERRIDE;
+        void paused(bool state) Q_DECL_OVERRIDE;
+
+    protected:
+        bool open() Q_DECL_OVERRIDE;
+        void close() Q_DECL_OVERRIDE;
+        bool start() Q_DECL_OVERRIDE;
+        void stop() Q_DECL_OVERRIDE;
+        void pause(bool state) Q_DECL_OVERRIDE;
+
+    private:
+        std::unique_ptr<SharedMemoryFrameSenderPrivate> d_ptr;
+    };
+}// namespace AVQt
+
+
+#endif//LIBAVQT_SHAREDMEMORYFRAMESENDER_HPP
@@ -0,0 +1,112 @@
+#ifndef LIBAVQT_IMAGEWRITER_HPP
+#define LIBAVQT_IMAGEWRITER_HPP
+
+#include "AVQt/communication/IComponent.hpp"
+
+#include <pgraph/impl/SimpleConsumer.hpp>
+#include <pgraph_network/api/PadRegistry.hpp>
+
+#include <QtCore/QObject>
+#include <QtCore/QString>
+
+namespace AVQt {
+    class ImageWriterPrivate;
+    /**
+     * @brief Encodes video frames to image files on a bounded worker pool.
+     *
+     * consume() only queues the frames, downloading hardware frames, pixel format conversion, encoding with libavcodec and writing
+     * happen on the workers, so the decoder never waits for the disk. Frames arriving while Config::maxQueued frames are pending are dropped.
+     * YUV frames are passed to the JPEG encoder without a round-trip through RGB.
+     */
+    class ImageWriter : public QObject, public pgraph::impl::SimpleConsumer, public api::IComponent {
+        Q_OBJECT
+        Q_INTERFACES(AVQt::api::IComponent)
+        Q_DECLARE_PRIVATE(ImageWriter)
+        Q_DISABLE_COPY_MOVE(ImageWriter)
+    public:
+        enum class Format {
+            JPEG,
+            PNG,
+            WebP
+        };
+
+        struct Config {
+            /**
+             * Path of the written files, "{index}" is replaced by the number of the frame in the stream,
+             * "{timestamp}" by its presentation timestamp in microseconds. Missing directories are created.
+             */
+            QString pathTemplate{"frame-{index}.jpg"};
+            Format format{Format::JPEG};
+            /**
+             * qscale from 2 (best) to 31 for JPEG, 0 to 100 (best) for WebP, ignored for PNG. -1 keeps the encoder's default.
+             */
+            int quality{-1};
+            /**
+             * Write every n-th frame
+             */
+            int interval{1};
+            /**
+             * Number of worker threads, 0 selects the number of CPU cores
+             */
+            int threads{0};
+            /**
+             * Frames waiting for or being written, before further frames are dropped
+             */
+            int maxQueued{8};
+        };
+
+        struct Statistics {
+            uint64_t written{0};
+            /**
+             * Frames dropped because the queue was full
+             */
+            uint64_t dropped{0};
+            /**
+             * Frames that could not be converted, encoded or written
+             */
+            uint64_t failed{0};
+            uint64_t bytesWritten{0};
+            /**
+             * Images written per second since start()
+             */
+            double throughput{0};
+        };
+
+        explicit ImageWriter(const Config &config, std::shared_ptr<pgraph::network::api::PadRegistry> padRegistry, QObject *parent = nullptr);
+        explicit ImageWriter(const Config &config, QObject *parent = nullptr);
+        ~ImageWriter() Q_DECL_OVERRIDE;
+
+        bool init() Q_DECL_OVERRIDE;
+
+        bool isOpen() const Q_DECL_OVERRIDE;
+        bool isRunning() const Q_DECL_OVERRIDE;
+        bool isPaused() const Q_DECL_OVERRIDE;
+
+        [[nodiscard]] int64_t getInputPadId() const;
+        [[nodiscard]] Statistics getStatistics() const;
+
+        void consume(int64_t pad, std::shared_ptr<pgraph::api::Data> data) Q_DECL_OVERRIDE;
+
+    signals:
+        void started() Q_DECL_OVERRIDE;
+        void stopped() Q_DECL_OVERRIDE;
+        void paused(bool state) Q_DECL_OVERRIDE;
+        /**
+         * @brief Emitted from the worker threads after an image was written
+         */
+        void imageWritten(const QString &path, qint64 timestamp);
+
+    protected:
+        bool open() Q_DECL_OVERRIDE;
+        void close() Q_DECL_OVERRIDE;
+        bool start() Q_DECL_OVERRIDE;
+        void stop() Q_DECL_OVERRIDE;
+        void pause(bool state) Q_DECL_OVERRIDE;
+
+    private:
+        std::unique_ptr<ImageWriterPrivate> d_ptr;
+    };
+}// namespace AVQt
+
+
+#endif//LIBAVQT_IMAGEWRITER_HPP
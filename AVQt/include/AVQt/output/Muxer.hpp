@@ -7,6 +7,7 @@
 #ifndef LIBAVQT_MUXER_HPP
 #define LIBAVQT_MUXER_HPP
 
+#include "AVQt/common/LatencyProfile.hpp"
 #include "AVQt/communication/IComponent.hpp"
 #include "AVQt/communication/PacketPadParams.hpp"
 
@@ -38,6 +39,19 @@ namespace AVQt {
              * @note The device will be closed when the muxer is destroyed.
              */
             std::unique_ptr<QIODevice> outputDevice;
+
+            /**
+             * @brief Write the timestamps of the packets as received instead of deriving them from packet durations.
+             *
+             * Required for stream copy, where packets may be reordered (B-frames). Timestamps are rescaled from PacketPadParams::timeBase
+             * of each stream in either mode.
+             */
+            bool copyTimestamps{false};
+
+            /**
+             * Input queue size, interleaving, flushing and the IO buffer size, use the same profile for all components of a pipeline
+             */
+            common::LatencyProfile latency{};
         };
 
         explicit Muxer(Config config, std::shared_ptr<pgraph::network::api::PadRegistry> padRegistry, QObject *parent = nullptr);
@@ -0,0 +1,84 @@
+#ifndef LIBAVQT_THUMBNAILGENERATOR_HPP
+#define LIBAVQT_THUMBNAILGENERATOR_HPP
+
+#include <QtCore/QList>
+#include <QtCore/QObject>
+#include <QtCore/QSize>
+#include <QtCore/QString>
+#include <QtGui/QImage>
+
+#include <memory>
+
+namespace AVQt {
+    class ThumbnailGeneratorPrivate;
+    /**
+     * @brief Creates evenly spaced thumbnails of a video file and tiles them into a sprite sheet.
+     *
+     * Instead of decoding the file linearly, the generator seeks to every target timestamp and decodes only the keyframe before it.
+     * The seek points are split into contiguous groups, each processed by its own demuxer and CPU decoder on a worker pool.
+     */
+    class ThumbnailGenerator : public QObject {
+        Q_OBJECT
+        Q_DECLARE_PRIVATE(ThumbnailGenerator)
+        Q_DISABLE_COPY_MOVE(ThumbnailGenerator)
+    public:
+        struct Config {
+            /**
+             * Path of the input file, which is opened once per worker, so it has to be seekable
+             */
+            QString inputPath{};
+            /**
+             * Number of thumbnails, spaced evenly over the duration of the file
+             */
+            int count{10};
+            /**
+             * Bounding box of every thumbnail, the display aspect ratio of the video is kept
+             */
+            QSize size{160, 90};
+            /**
+             * Decode only the keyframe before each timestamp. If false, decoding continues up to the exact timestamp, which is slower.
+             */
+            bool keyframesOnly{true};
+            /**
+             * Number of workers, 0 selects the number of CPU cores
+             */
+            int maxParallel{0};
+        };
+
+        struct Thumbnail {
+            /**
+             * Presentation timestamp of the decoded frame in microseconds, relative to the start of the file
+             */
+            int64_t timestamp{0};
+            QImage image{};
+        };
+
+        explicit ThumbnailGenerator(const Config &config, QObject *parent = nullptr);
+        ~ThumbnailGenerator() Q_DECL_OVERRIDE;
+
+        /**
+         * @brief Generates all thumbnails, blocks until they are done
+         * @return the thumbnails in timestamp order, failed seek points are left out
+         */
+        QList<Thumbnail> generate();
+
+        /**
+         * @brief Tiles thumbnails row by row into a single image, each centered in a cell of the largest thumbnail's size
+         * @param columns Number of columns, 0 selects a square grid
+         */
+        [[nodiscard]] static QImage createSprite(const QList<Thumbnail> &thumbnails, int columns = 0);
+
+    signals:
+        /**
+         * @brief Emitted from the worker threads for every thumbnail, before generate() returns
+         * @param index Index of the seek point
+         */
+        void thumbnailReady(int index, qint64 timestamp, const QImage &image);
+
+    private:
+        std::unique_ptr<ThumbnailGeneratorPrivate> d_ptr;
+    };
+}// namespace AVQt
+
+
+#endif//LIBAVQT_THUMBNAILGENERATOR_HPP
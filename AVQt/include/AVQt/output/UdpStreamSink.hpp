@@ -0,0 +1,107 @@
+#ifndef LIBAVQT_UDPSTREAMSINK_HPP
+#define LIBAVQT_UDPSTREAMSINK_HPP
+
+#include <QtCore/QIODevice>
+#include <QtCore/QString>
+
+#include <memory>
+
+namespace AVQt {
+    class UdpStreamSinkPrivate;
+    /**
+     * @brief Sequential QIODevice sending the output of an "mpegts" Muxer as paced UDP or RTP datagrams, to be used as Muxer::Config::outputDevice.
+     *
+     * The TS packets are grouped into datagrams of Config::packetsPerDatagram packets. Every datagram gets a send time from the PCRs
+     * of the stream, datagrams between two PCRs are spread according to the bitrate measured between the previous two (or Config::muxRate).
+     * A sending thread waits for these times and sends all due datagrams with one sendmmsg call, so the stream leaves the host at
+     * its own rate instead of in bursts of the muxer's buffer size. writeData() blocks while Config::queueSize datagrams are waiting,
+     * which also paces a muxer fed faster than realtime, e.g. from a file.
+     */
+    class UdpStreamSink : public QIODevice {
+        Q_OBJECT
+        Q_DECLARE_PRIVATE(UdpStreamSink)
+        Q_DISABLE_COPY_MOVE(UdpStreamSink)
+    public:
+        struct Config {
+            /**
+             * Destination, unicast or multicast IPv4 address
+             */
+            QString address{};
+            quint16 port{0};
+            /**
+             * Prepend an RTP header (RFC 2250, payload type 33)
+             */
+            bool rtp{false};
+            /**
+             * 7 packets fill a datagram within the common 1500 byte MTU
+             */
+            int packetsPerDatagram{7};
+            /**
+             * Bitrate in bits per second used between PCRs, 0 measures it from the PCRs
+             */
+            int64_t muxRate{0};
+            /**
+             * Datagrams buffered before writeData() blocks
+             */
+            int queueSize{512};
+            /**
+             * Datagrams sent per system call at most
+             */
+            int batchSize{16};
+            /**
+             * Socket send buffer in bytes, 0 keeps the system default
+             */
+            int sendBufferSize{0};
+            int multicastTtl{1};
+            /**
+             * Falling further behind the PCR schedule (in milliseconds) restarts the schedule instead of sending a burst to catch up
+             */
+            int maxLag{200};
+        };
+
+        struct Statistics {
+            uint64_t datagrams{0};
+            uint64_t bytes{0};
+            uint64_t sendErrors{0};
+            /**
+             * Times the schedule was restarted, because of PCR discontinuities or exceeding Config::maxLag
+             */
+            uint64_t resyncs{0};
+            /**
+             * Bits per second sent during the last second
+             */
+            double sendRate{0};
+            /**
+             * Highest rate within a 10 ms window, in bits per second
+             */
+            double peakRate{0};
+            /**
+             * peakRate divided by the average rate since open(), 1 for a perfectly smooth stream
+             */
+            double burstiness{0};
+        };
+
+        explicit UdpStreamSink(const Config &config, QObject *parent = nullptr);
+        ~UdpStreamSink() Q_DECL_OVERRIDE;
+
+        bool open(OpenMode mode) Q_DECL_OVERRIDE;
+        /**
+         * @brief Sends the remaining datagrams on schedule, then closes the socket
+         */
+        void close() Q_DECL_OVERRIDE;
+
+        [[nodiscard]] bool isSequential() const Q_DECL_OVERRIDE;
+
+        [[nodiscard]] Statistics getStatistics() const;
+
+    protected:
+        qint64 readData(char *data, qint64 maxSize) Q_DECL_OVERRIDE;
+        qint64 writeData(const char *data, qint64 maxSize) Q_DECL_OVERRIDE;
+
+    private:
+        std::unique_ptr<UdpStreamSinkPrivate> d_ptr;
+    };
+}// namespace AVQt
+
+
+#endif//LIBAVQT_UDPSTREAMSINK_HPP
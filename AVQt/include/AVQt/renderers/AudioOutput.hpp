@@ -1,6 +1,7 @@
 #ifndef LIBAVQT_AUDIOOUTPUT_HPP
 #define LIBAVQT_AUDIOOUTPUT_HPP
 
+#include "AVQt/common/MediaClock.hpp"
 #include "AVQt/communication/IComponent.hpp"
 
 #include <pgraph/impl/SimpleConsumer.hpp>
@@ -25,6 +26,22 @@ namespace AVQt {
         bool isRunning() const override;
         bool isPaused() const override;
 
+        /**
+         * @return the number of times the audio device ran out of buffered audio, 0 if not running
+         */
+        [[nodiscard]] uint64_t underrunCount() const;
+        /**
+         * @return the number of frames dropped, because the audio device didn't drain the buffer in time, 0 if not running
+         */
+        [[nodiscard]] uint64_t overrunCount() const;
+
+        /**
+         * @brief Makes this output the master of clock, which then follows the position of the samples actually played.
+         * Pass nullptr to release the clock.
+         */
+        void setClock(std::shared_ptr<common::MediaClock> clock);
+        [[nodiscard]] std::shared_ptr<common::MediaClock> clock() const;
+
         void consume(int64_t pad, std::shared_ptr<pgraph::api::Data> data) override;
 
     signals:
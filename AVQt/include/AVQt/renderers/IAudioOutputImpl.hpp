@@ -19,6 +19,19 @@ namespace AVQt::api {
         virtual void write(const std::shared_ptr<AVFrame> &frame) = 0;
         virtual void resetBuffer() = 0;
         virtual void pause(bool state) = 0;
+
+        /**
+         * @return the number of times the device ran out of buffered audio
+         */
+        [[nodiscard]] virtual uint64_t underrunCount() const = 0;
+        /**
+         * @return the number of frames dropped, because the buffer didn't drain in time
+         */
+        [[nodiscard]] virtual uint64_t overrunCount() const = 0;
+        /**
+         * @return the duration in microseconds of the audio written, but not played yet
+         */
+        [[nodiscard]] virtual int64_t queuedDuration() const = 0;
     };
 
     struct AudioOutputImplInfo {
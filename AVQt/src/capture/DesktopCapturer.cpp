@@ -12,6 +12,10 @@
 
 #include <pgraph_network/impl/RegisteringPadFactory.hpp>
 
+extern "C" {
+#include <libavutil/time.h>
+}
+
 namespace AVQt {
     DesktopCapturer::DesktopCapturer(const api::IDesktopCaptureImpl::Config &config, std::shared_ptr<pgraph::network::api::PadRegistry> padRegistry, QObject *parent)
         : QThread(parent),
@@ -44,6 +48,11 @@ namespace AVQt {
         return d->paused;
     }
 
+    uint64_t DesktopCapturer::getSkippedFrameCount() const {
+        Q_D(const DesktopCapturer);
+        return d->skippedFrames;
+    }
+
     bool DesktopCapturer::init() {
         Q_D(DesktopCapturer);
 
@@ -114,6 +123,8 @@ namespace AVQt {
 
         bool shouldBe = false;
         if (d->running.compare_exchange_strong(shouldBe, true)) {
+            d->changeDetector.reset();
+            d->lastForwardTime = 0;
             if (!(d->frameReadyConnection =
                           connect(std::dynamic_pointer_cast<QObject>(d->impl).get(),
                                   SIGNAL(frameReady(std::shared_ptr<AVFrame>)),
@@ -206,7 +217,26 @@ namespace AVQt {
                 lastFrameSize = QSize(frame->width, frame->height);
                 *outputPadUserData = impl->getVideoParams();
             }
-            q->produce(communication::Message::builder().withAction(communication::Message::Action::DATA).withPayload("frame", QVariant::fromValue(frame)).build(), outputPadId);
+
+            // Hardware frames aren't CPU accessible and always count as changed completely
+            QVector<QRect> damage{QRect{0, 0, frame->width, frame->height}};
+            const int64_t now = av_gettime_relative();
+            if (config.skipUnchanged && internal::FrameChangeDetector::isSupported(static_cast<AVPixelFormat>(frame->format))) {
+                damage = changeDetector.detect(frame.get());
+                const bool keepAlive = config.unchangedKeepAlive > 0 && now - lastForwardTime >= int64_t{config.unchangedKeepAlive} * 1000;
+                if (damage.isEmpty() && !keepAlive) {
+                    ++skippedFrames;
+                    return;
+                }
+            }
+            lastForwardTime = now;
+
+            q->produce(communication::Message::builder()
+                               .withAction(communication::Message::Action::DATA)
+                               .withPayload("frame", QVariant::fromValue(frame))
+                               .withPayload("damage", QVariant::fromValue(damage))
+                               .build(),
+                       outputPadId);
         }
     }
 }// namespace AVQt
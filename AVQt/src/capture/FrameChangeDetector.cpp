@@ -0,0 +1,154 @@
+#include "FrameChangeDetector.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+extern "C" {
+#include <libavutil/common.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+}
+
+namespace AVQt::internal {
+    FrameChangeDetector::FrameChangeDetector(int tileSize)
+        : m_tileSize(std::max(tileSize, 8)) {
+    }
+
+    bool FrameChangeDetector::isSupported(AVPixelFormat format) {
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(format);
+        if (!desc || desc->nb_components == 0 || (desc->flags & (AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_BITSTREAM))) {
+            return false;
+        }
+
+        // Tiles have to start at byte boundaries
+        constexpr int testWidth = 64;
+        int lineSizes[4];
+        if (av_image_fill_linesizes(lineSizes, format, testWidth) < 0) {
+            return false;
+        }
+        const bool rgb = desc->flags & AV_PIX_FMT_FLAG_RGB;
+        for (int plane = 0; plane < av_pix_fmt_count_planes(format); ++plane) {
+            const bool chroma = (plane == 1 || plane == 2) && !rgb;
+            const int planeWidth = chroma ? AV_CEIL_RSHIFT(testWidth, desc->log2_chroma_w) : testWidth;
+            if (lineSizes[plane] <= 0 || lineSizes[plane] % planeWidth != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    QVector<QRect> FrameChangeDetector::detect(const AVFrame *frame) {
+        const QRect frameRect{0, 0, frame->width, frame->height};
+        if (frame->width != m_width || frame->height != m_height || frame->format != m_format || m_planes.empty()) {
+            if (!initReference(frame)) {
+                reset();
+            }
+            return {frameRect};
+        }
+
+        QVector<QRect> damage{};
+        for (int y = 0; y < m_height; y += m_tileSize) {
+            const int tileHeight = std::min(m_tileSize, m_height - y);
+            const int tileColumns = (m_width + m_tileSize - 1) / m_tileSize;
+            int runStart = -1;
+            // The extra column closes a run at the right edge
+            for (int column = 0; column <= tileColumns; ++column) {
+                const int x = column * m_tileSize;
+                const bool changed = column < tileColumns && updateTile(frame, x, y, std::min(m_tileSize, m_width - x), tileHeight);
+                if (changed && runStart < 0) {
+                    runStart = x;
+                } else if (!changed && runStart >= 0) {
+                    const QRect rect{runStart, y, std::min(x, m_width) - runStart, tileHeight};
+                    // Extend a rectangle of the tile rows above with the same horizontal extent
+                    auto above = std::find_if(damage.begin(), damage.end(), [&rect](const QRect &r) {
+                        return r.left() == rect.left() && r.width() == rect.width() && r.bottom() + 1 == rect.top();
+                    });
+                    if (above != damage.end()) {
+                        above->setBottom(rect.bottom());
+                    } else {
+                        damage.append(rect);
+                    }
+                    runStart = -1;
+                }
+            }
+        }
+        return damage;
+    }
+
+    void FrameChangeDetector::reset() {
+        m_width = 0;
+        m_height = 0;
+        m_format = AV_PIX_FMT_NONE;
+        m_planes.clear();
+    }
+
+    bool FrameChangeDetector::initReference(const AVFrame *frame) {
+        const auto format = static_cast<AVPixelFormat>(frame->format);
+        if (!isSupported(format) || frame->width <= 0 || frame->height <= 0) {
+            return false;
+        }
+
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(format);
+        int lineSizes[4];
+        if (av_image_fill_linesizes(lineSizes, format, frame->width) < 0) {
+            return false;
+        }
+
+        const bool rgb = desc->flags & AV_PIX_FMT_FLAG_RGB;
+        m_planes.clear();
+        m_planes.resize(static_cast<size_t>(av_pix_fmt_count_planes(format)));
+        for (size_t i = 0; i < m_planes.size(); ++i) {
+            auto &plane = m_planes[i];
+            const bool chroma = (i == 1 || i == 2) && !rgb;
+            plane.log2Width = chroma ? desc->log2_chroma_w : 0;
+            plane.log2Height = chroma ? desc->log2_chroma_h : 0;
+            plane.rowBytes = lineSizes[i];
+            plane.bytesPerPixel = plane.rowBytes / AV_CEIL_RSHIFT(frame->width, plane.log2Width);
+            plane.data.resize(static_cast<size_t>(plane.rowBytes) * static_cast<size_t>(AV_CEIL_RSHIFT(frame->height, plane.log2Height)));
+        }
+
+        m_width = frame->width;
+        m_height = frame->height;
+        m_format = format;
+
+        // The reference starts zeroed, so only tiles with content are copied
+        for (int y = 0; y < m_height; y += m_tileSize) {
+            for (int x = 0; x < m_width; x += m_tileSize) {
+                updateTile(frame, x, y, std::min(m_tileSize, m_width - x), std::min(m_tileSize, m_height - y));
+            }
+        }
+        return true;
+    }
+
+    bool FrameChangeDetector::updateTile(const AVFrame *frame, int x, int y, int width, int height) {
+        bool changed = false;
+        for (size_t i = 0; i < m_planes.size() && !changed; ++i) {
+            const auto &plane = m_planes[i];
+            const int byteOffset = (x >> plane.log2Width) * plane.bytesPerPixel;
+            const auto byteCount = static_cast<size_t>((AV_CEIL_RSHIFT(x + width, plane.log2Width) - (x >> plane.log2Width)) * plane.bytesPerPixel);
+            const int rowEnd = AV_CEIL_RSHIFT(y + height, plane.log2Height);
+            for (int row = y >> plane.log2Height; row < rowEnd; ++row) {
+                const uint8_t *current = frame->data[i] + static_cast<ptrdiff_t>(row) * frame->linesize[i] + byteOffset;
+                const uint8_t *reference = plane.data.data() + static_cast<ptrdiff_t>(row) * plane.rowBytes + byteOffset;
+                if (std::memcmp(current, reference, byteCount) != 0) {
+                    changed = true;
+                    break;
+                }
+            }
+        }
+
+        if (changed) {
+            for (size_t i = 0; i < m_planes.size(); ++i) {
+                auto &plane = m_planes[i];
+                const int byteOffset = (x >> plane.log2Width) * plane.bytesPerPixel;
+                const auto byteCount = static_cast<size_t>((AV_CEIL_RSHIFT(x + width, plane.log2Width) - (x >> plane.log2Width)) * plane.bytesPerPixel);
+                const int rowEnd = AV_CEIL_RSHIFT(y + height, plane.log2Height);
+                for (int row = y >> plane.log2Height; row < rowEnd; ++row) {
+                    std::memcpy(plane.data.data() + static_cast<ptrdiff_t>(row) * plane.rowBytes + byteOffset,
+                                frame->data[i] + static_cast<ptrdiff_t>(row) * frame->linesize[i] + byteOffset, byteCount);
+                }
+            }
+        }
+        return changed;
+    }
+}// namespace AVQt::internal
@@ -0,0 +1,66 @@
+#ifndef LIBAVQT_FRAMECHANGEDETECTOR_HPP
+#define LIBAVQT_FRAMECHANGEDETECTOR_HPP
+
+#include <QtCore/QRect>
+#include <QtCore/QVector>
+
+#include <vector>
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+}
+
+namespace AVQt::internal {
+    /**
+     * @brief Finds the tiles of a software frame that changed since the previous frame, e.g. to skip captures of a static desktop.
+     *
+     * Tiles are compared with memcmp() against a reference copy of the previous frame, which stops at the first difference and
+     * is vectorized by the C library. Only changed tiles are copied into the reference. Not thread-safe.
+     */
+    class FrameChangeDetector {
+    public:
+        explicit FrameChangeDetector(int tileSize = 64);
+
+        /**
+         * @return true for CPU accessible formats with whole bytes per pixel in every plane
+         */
+        static bool isSupported(AVPixelFormat format);
+
+        /**
+         * @brief Compares frame with the previous one and keeps it as reference for the next call
+         * @return the changed areas in pixels, merged from the changed tiles, empty if nothing changed. The whole frame for the first
+         * frame, after reset() and after the size or format changed.
+         */
+        QVector<QRect> detect(const AVFrame *frame);
+
+        /**
+         * @brief Forgets the reference, so the next frame counts as changed completely
+         */
+        void reset();
+
+    private:
+        struct Plane {
+            std::vector<uint8_t> data{};
+            int rowBytes{0};
+            int bytesPerPixel{0};
+            int log2Width{0};
+            int log2Height{0};
+        };
+
+        bool initReference(const AVFrame *frame);
+        /**
+         * @brief Compares the tile with the reference and copies it into the reference, if it changed
+         * @return true, if the tile changed
+         */
+        bool updateTile(const AVFrame *frame, int x, int y, int width, int height);
+
+        int m_tileSize;
+        int m_width{0};
+        int m_height{0};
+        AVPixelFormat m_format{AV_PIX_FMT_NONE};
+        std::vector<Plane> m_planes{};
+    };
+}// namespace AVQt::internal
+
+#endif//LIBAVQT_FRAMECHANGEDETECTOR_HPP
@@ -0,0 +1,488 @@
+#include "X11DesktopCaptureImpl.hpp"
+#include "private/X11DesktopCaptureImpl_p.hpp"
+
+#include "capture/DesktopCaptureFactory.hpp"
+
+#include <QtDebug>
+
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+extern "C" {
+#include <libavutil/imgutils.h>
+#include <libavutil/time.h>
+}
+
+// Xlib defines macros like None and Bool, which clash with Qt, so it is included last
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+
+namespace AVQt {
+    namespace internal {
+        struct X11Connection {
+            explicit X11Connection(Display *display) : display(display) {}
+            ~X11Connection() {
+                if (display) {
+                    XCloseDisplay(display);
+                }
+            }
+            X11Connection(const X11Connection &) = delete;
+            X11Connection &operator=(const X11Connection &) = delete;
+
+            Display *display;
+            /**
+             * Xlib isn't initialized for threads, but images are destroyed on whichever thread frees the last frame using them
+             */
+            std::mutex mutex{};
+        };
+
+        /**
+         * @brief Collects the X errors of display while alive, instead of passing them to Xlib's default handler, which exits the process
+         *
+         * The error handler is global to the process, so only one trap may be active at a time.
+         */
+        class X11ErrorTrap {
+        public:
+            explicit X11ErrorTrap(Display *display) : m_lock(s_mutex) {
+                // Errors of earlier requests still belong to the previous handler
+                XSync(display, False);
+                s_display = display;
+                s_errorCode = Success;
+                s_previousHandler = XSetErrorHandler(&X11ErrorTrap::handleError);
+            }
+            ~X11ErrorTrap() {
+                XSync(s_display, False);
+                XSetErrorHandler(s_previousHandler);
+                s_display = nullptr;
+                s_previousHandler = nullptr;
+            }
+            X11ErrorTrap(const X11ErrorTrap &) = delete;
+            X11ErrorTrap &operator=(const X11ErrorTrap &) = delete;
+
+            /**
+             * @brief Waits until the X server processed all requests sent so far
+             * @return the code of the first error since the trap was created, or Success
+             */
+            int sync() {
+                XSync(s_display, False);
+                return s_errorCode;
+            }
+
+        private:
+            static int handleError(Display *display, XErrorEvent *event) {
+                if (display != s_display) {
+                    return s_previousHandler ? s_previousHandler(display, event) : 0;
+                }
+                if (s_errorCode == Success) {
+                    s_errorCode = event->error_code;
+                }
+                return 0;
+            }
+
+            static inline std::mutex s_mutex{};
+            static inline Display *s_display{nullptr};
+            static inline int s_errorCode{Success};
+            static inline XErrorHandler s_previousHandler{nullptr};
+
+            std::lock_guard<std::mutex> m_lock;
+        };
+
+        struct ShmImage {
+            explicit ShmImage(std::shared_ptr<X11Connection> connection) : connection(std::move(connection)) {}
+            ~ShmImage() {
+                std::lock_guard lock(connection->mutex);
+                if (attached) {
+                    XShmDetach(connection->display, &info);
+                    XSync(connection->display, False);
+                }
+                if (info.shmaddr) {
+                    shmdt(info.shmaddr);
+                }
+                if (image) {
+                    // Doesn't free the shared memory, XShmCreateImage() installs its own destructor
+                    XDestroyImage(image);
+                }
+            }
+            ShmImage(const ShmImage &) = delete;
+            ShmImage &operator=(const ShmImage &) = delete;
+
+            std::shared_ptr<X11Connection> connection;
+            XShmSegmentInfo info{};
+            XImage *image{nullptr};
+            bool attached{false};
+        };
+
+        struct PooledImage {
+            std::shared_ptr<ShmImage> image;
+            std::weak_ptr<ShmImagePool> pool;
+            uint64_t generation;
+        };
+    }// namespace internal
+
+    X11DesktopCaptureImpl::X11DesktopCaptureImpl(QObject *parent)
+        : QObject(parent), d_ptr(new X11DesktopCaptureImplPrivate(this)) {
+    }
+
+    X11DesktopCaptureImpl::~X11DesktopCaptureImpl() {
+        X11DesktopCaptureImpl::close();
+    }
+
+    bool X11DesktopCaptureImpl::open(const api::IDesktopCaptureImpl::Config &config) {
+        Q_D(X11DesktopCaptureImpl);
+
+        if (d->connection) {
+            qWarning() << "X11DesktopCapture is already open";
+            return false;
+        }
+        if (config.fps <= 0) {
+            qWarning() << "Invalid frame rate" << config.fps;
+            return false;
+        }
+        if (config.sourceClass == SourceClass::Window) {
+            qWarning() << "X11DesktopCapture can't capture single windows, capturing the screen instead";
+        }
+
+        Display *display = XOpenDisplay(nullptr);
+        if (!display) {
+            qWarning() << "Could not open X display" << qgetenv("DISPLAY");
+            return false;
+        }
+        d->connection = std::make_shared<internal::X11Connection>(display);
+
+        d->config = config;
+        d->useShm = XShmQueryExtension(display);
+        if (!d->useShm) {
+            qWarning() << "X server doesn't support MIT-SHM, capturing with XGetImage instead";
+        }
+        d->pool = std::make_shared<internal::ShmImagePool>();
+        if (!d->updateGeometry()) {
+            d->pool.reset();
+            d->connection.reset();
+            return false;
+        }
+
+        d->timer = std::make_unique<QTimer>();
+        d->timer->setInterval(1000 / config.fps);
+        d->timer->setTimerType(Qt::PreciseTimer);
+        d->timer->setSingleShot(false);
+        return true;
+    }
+
+    bool X11DesktopCaptureImpl::start() {
+        Q_D(X11DesktopCaptureImpl);
+
+        if (!d->timer) {
+            qWarning() << "X11DesktopCapture is not open";
+            return false;
+        }
+
+        d->startTime = av_gettime_relative();
+        connect(d->timer.get(), &QTimer::timeout, this, &X11DesktopCaptureImpl::captureFrame, Qt::QueuedConnection);
+        d->timer->start();
+        return true;
+    }
+
+    void X11DesktopCaptureImpl::close() {
+        Q_D(X11DesktopCaptureImpl);
+
+        if (d->timer) {
+            d->timer->stop();
+            d->timer.reset();
+        }
+        if (d->droppedFrames > 0) {
+            qDebug("X11DesktopCapture: Dropped %lu frames, because all shared memory images were in use", static_cast<unsigned long>(d->droppedFrames));
+            d->droppedFrames = 0;
+        }
+        // Images of frames still in use keep the connection open until they are freed
+        d->pool.reset();
+        d->connection.reset();
+    }
+
+    AVPixelFormat X11DesktopCaptureImpl::getOutputFormat() const {
+        Q_D(const X11DesktopCaptureImpl);
+        return d->pixelFormat;
+    }
+
+    bool X11DesktopCaptureImpl::isHWAccel() const {
+        return false;
+    }
+
+    communication::VideoPadParams X11DesktopCaptureImpl::getVideoParams() const {
+        Q_D(const X11DesktopCaptureImpl);
+
+        communication::VideoPadParams params{};
+        params.hwDeviceContext = nullptr;
+        params.hwFramesContext = nullptr;
+        params.isHWAccel = false;
+        params.pixelFormat = d->pixelFormat;
+        params.swPixelFormat = d->pixelFormat;
+        params.frameSize = d->frameSize;
+        return params;
+    }
+
+    void X11DesktopCaptureImpl::captureFrame() {
+        Q_D(X11DesktopCaptureImpl);
+
+        if (!d->connection || !d->updateGeometry()) {
+            return;
+        }
+
+        if (!d->useShm) {
+            if (auto frame = d->getImage()) {
+                emit frameReady(std::move(frame));
+            }
+            return;
+        }
+
+        uint64_t generation;
+        {
+            std::lock_guard poolLock(d->pool->mutex);
+            generation = d->pool->generation;
+        }
+        auto image = d->acquireImage();
+        if (!image) {
+            if (!d->useShm) {
+                // The X server refused the segment, acquireImage() switched to XGetImage()
+                if (auto frame = d->getImage()) {
+                    emit frameReady(std::move(frame));
+                }
+                return;
+            }
+            ++d->droppedFrames;
+            return;
+        }
+
+        bool captured;
+        {
+            std::lock_guard lock(d->connection->mutex);
+            internal::X11ErrorTrap errorTrap(d->connection->display);
+            // BadMatch, if the root window shrank since the image was created
+            captured = XShmGetImage(d->connection->display, XDefaultRootWindow(d->connection->display), image->image, 0, 0, ~0UL) &&
+                       errorTrap.sync() == Success;
+        }
+        if (!captured) {
+            {
+                std::lock_guard poolLock(d->pool->mutex);
+                d->pool->freeImages.push_back(image);
+            }
+            qWarning() << "XShmGetImage failed, capturing the frame with XGetImage";
+            // The image size no longer matches, so the pool is recreated for the new size
+            if (d->updateGeometry()) {
+                if (auto frame = d->getImage()) {
+                    emit frameReady(std::move(frame));
+                }
+            }
+            return;
+        }
+
+        auto frame = d->wrapImage(image, generation);
+        if (!frame) {
+            qWarning() << "Could not allocate frame";
+            std::lock_guard poolLock(d->pool->mutex);
+            d->pool->freeImages.push_back(image);
+            return;
+        }
+        emit frameReady(std::move(frame));
+    }
+
+    bool X11DesktopCaptureImplPrivate::updateGeometry() {
+        std::unique_lock lock(connection->mutex);
+        Display *display = connection->display;
+
+        XWindowAttributes attributes{};
+        if (!XGetWindowAttributes(display, XDefaultRootWindow(display), &attributes)) {
+            qWarning() << "Could not query the root window";
+            return false;
+        }
+
+        const QSize size{attributes.width, attributes.height};
+        if (size == frameSize && pixelFormat != AV_PIX_FMT_NONE) {
+            return true;
+        }
+
+        // Only ZPixmaps with 32 bits per pixel and byte aligned channels map to an AVPixelFormat without conversion
+        int formatCount = 0;
+        XPixmapFormatValues *formats = XListPixmapFormats(display, &formatCount);
+        int bitsPerPixel = 0;
+        for (int i = 0; i < formatCount; ++i) {
+            if (formats[i].depth == attributes.depth) {
+                bitsPerPixel = formats[i].bits_per_pixel;
+            }
+        }
+        XFree(formats);
+
+        const bool lsbFirst = XImageByteOrder(display) == LSBFirst;
+        const unsigned long redMask = attributes.visual->red_mask;
+        AVPixelFormat format = AV_PIX_FMT_NONE;
+        if (bitsPerPixel == 32 && redMask == 0xff0000 && attributes.visual->blue_mask == 0xff) {
+            format = lsbFirst ? AV_PIX_FMT_BGR0 : AV_PIX_FMT_0RGB;
+        } else if (bitsPerPixel == 32 && redMask == 0xff && attributes.visual->blue_mask == 0xff0000) {
+            format = lsbFirst ? AV_PIX_FMT_RGB0 : AV_PIX_FMT_0BGR;
+        }
+        if (format == AV_PIX_FMT_NONE) {
+            qWarning() << "Unsupported X visual with depth" << attributes.depth << "and" << bitsPerPixel << "bits per pixel";
+            return false;
+        }
+
+        lock.unlock();
+
+        frameSize = size;
+        pixelFormat = format;
+
+        // Destroying the images locks the connection, so they are destroyed after both locks are released
+        std::vector<std::shared_ptr<internal::ShmImage>> oldImages{};
+        {
+            std::lock_guard poolLock(pool->mutex);
+            oldImages.swap(pool->freeImages);
+            pool->allocated = 0;
+            ++pool->generation;
+        }
+        return true;
+    }
+
+    std::shared_ptr<internal::ShmImage> X11DesktopCaptureImplPrivate::acquireImage() {
+        {
+            std::lock_guard poolLock(pool->mutex);
+            if (!pool->freeImages.empty()) {
+                auto image = std::move(pool->freeImages.back());
+                pool->freeImages.pop_back();
+                return image;
+            }
+            if (pool->allocated >= PoolSize) {
+                return nullptr;
+            }
+            ++pool->allocated;
+        }
+
+        auto image = std::make_shared<internal::ShmImage>(connection);
+        bool success = false, attachFailed = false;
+        {
+            std::lock_guard lock(connection->mutex);
+            Display *display = connection->display;
+            const int screen = XDefaultScreen(display);
+
+            image->image = XShmCreateImage(display, XDefaultVisual(display, screen), static_cast<unsigned int>(XDefaultDepth(display, screen)), ZPixmap,
+                                           nullptr, &image->info, static_cast<unsigned int>(frameSize.width()), static_cast<unsigned int>(frameSize.height()));
+            if (image->image) {
+                const auto size = static_cast<size_t>(image->image->bytes_per_line) * static_cast<size_t>(image->image->height);
+                image->info.shmid = shmget(IPC_PRIVATE, size, IPC_CREAT | 0600);
+                if (image->info.shmid >= 0) {
+                    void *address = shmat(image->info.shmid, nullptr, 0);
+                    if (address != reinterpret_cast<void *>(intptr_t{-1})) {
+                        image->info.shmaddr = static_cast<char *>(address);
+                        image->image->data = image->info.shmaddr;
+                        image->info.readOnly = False;
+                        internal::X11ErrorTrap errorTrap(display);
+                        // Fails with BadAccess, if the X server can't access the segment, e.g. when it runs on another host
+                        image->attached = XShmAttach(display, &image->info) && errorTrap.sync() == Success;
+                        success = image->attached;
+                        attachFailed = !success;
+                    }
+                    // The segment is removed once the X server and this process detached from it, even if the process crashes
+                    shmctl(image->info.shmid, IPC_RMID, nullptr);
+                }
+            }
+        }
+
+        if (!success) {
+            if (attachFailed) {
+                qWarning() << "X server can't attach shared memory, capturing with XGetImage instead";
+                useShm = false;
+            } else {
+                qWarning() << "Could not create shared memory image";
+            }
+            std::lock_guard poolLock(pool->mutex);
+            --pool->allocated;
+            return nullptr;
+        }
+        return image;
+    }
+
+    std::shared_ptr<AVFrame> X11DesktopCaptureImplPrivate::getImage() {
+        XImage *image;
+        {
+            std::lock_guard lock(connection->mutex);
+            Display *display = connection->display;
+            internal::X11ErrorTrap errorTrap(display);
+            image = XGetImage(display, XDefaultRootWindow(display), 0, 0, static_cast<unsigned int>(frameSize.width()),
+                              static_cast<unsigned int>(frameSize.height()), AllPlanes, ZPixmap);
+            if (image && errorTrap.sync() != Success) {
+                XDestroyImage(image);
+                image = nullptr;
+            }
+        }
+        if (!image) {
+            qWarning() << "XGetImage failed";
+            return nullptr;
+        }
+
+        std::shared_ptr<AVFrame> frame{av_frame_alloc(), [](AVFrame *frame) {
+                                           av_frame_free(&frame);
+                                       }};
+        if (frame) {
+            frame->format = pixelFormat;
+            frame->width = image->width;
+            frame->height = image->height;
+        }
+        // The XImage's memory belongs to Xlib, so it is copied instead of wrapped
+        if (!frame || av_frame_get_buffer(frame.get(), 0) < 0) {
+            qWarning() << "Could not allocate frame";
+            XDestroyImage(image);
+            return nullptr;
+        }
+        av_image_copy_plane(frame->data[0], frame->linesize[0], reinterpret_cast<const uint8_t *>(image->data), image->bytes_per_line,
+                            image->width * 4, image->height);
+        XDestroyImage(image);
+
+        frame->pts = av_gettime_relative() - startTime;
+        return frame;
+    }
+
+    std::shared_ptr<AVFrame> X11DesktopCaptureImplPrivate::wrapImage(const std::shared_ptr<internal::ShmImage> &image, uint64_t generation) {
+        std::shared_ptr<AVFrame> frame{av_frame_alloc(), [](AVFrame *frame) {
+                                           av_frame_free(&frame);
+                                       }};
+        if (!frame) {
+            return nullptr;
+        }
+
+        auto *pooledImage = new internal::PooledImage{image, pool, generation};
+        auto *data = reinterpret_cast<uint8_t *>(image->image->data);
+        const auto size = static_cast<size_t>(image->image->bytes_per_line) * static_cast<size_t>(image->image->height);
+        frame->buf[0] = av_buffer_create(data, size, &X11DesktopCaptureImplPrivate::releaseImage, pooledImage, AV_BUFFER_FLAG_READONLY);
+        if (!frame->buf[0]) {
+            delete pooledImage;
+            return nullptr;
+        }
+
+        frame->format = pixelFormat;
+        frame->width = frameSize.width();
+        frame->height = frameSize.height();
+        frame->data[0] = data;
+        frame->linesize[0] = image->image->bytes_per_line;
+        frame->pts = av_gettime_relative() - startTime;
+        return frame;
+    }
+
+    void X11DesktopCaptureImplPrivate::releaseImage(void *opaque, uint8_t *data) {
+        Q_UNUSED(data)
+        auto *pooledImage = static_cast<internal::PooledImage *>(opaque);
+        if (auto imagePool = pooledImage->pool.lock()) {
+            std::lock_guard poolLock(imagePool->mutex);
+            if (pooledImage->generation == imagePool->generation) {
+                imagePool->freeImages.push_back(std::move(pooledImage->image));
+            }
+        }
+        // Images of an older size or a closed capture are destroyed with the last reference
+        delete pooledImage;
+    }
+}// namespace AVQt
+
+#if defined(Q_OS_LINUX) && !defined(Q_OS_ANDROID)
+static_block {
+    AVQt::DesktopCaptureFactory::getInstance().registerCapture({.metaObject = AVQt::X11DesktopCaptureImpl::staticMetaObject,
+                                                                .name = "AVQt::X11DesktopCapture",
+                                                                .platform = AVQt::common::Platform::Linux_X11});
+};
+#endif
@@ -0,0 +1,46 @@
+#ifndef LIBAVQT_X11DESKTOPCAPTUREIMPL_HPP
+#define LIBAVQT_X11DESKTOPCAPTUREIMPL_HPP
+
+#include "AVQt/capture/IDesktopCaptureImpl.hpp"
+
+#include <QObject>
+
+namespace AVQt {
+    class X11DesktopCaptureImplPrivate;
+    /**
+     * @brief Captures the root window of the X server in $DISPLAY with MIT-SHM.
+     *
+     * Frames are read into shared memory segments of a recycled pool, which are released back to the pool with the last reference
+     * to the frame, so capturing doesn't allocate per frame. Works headless under Xvfb, e.g. DISPLAY=:99 after `Xvfb :99`.
+     * Falls back to copying the frames with XGetImage, if the X server doesn't support or can't attach the shared memory.
+     */
+    class X11DesktopCaptureImpl : public QObject, public api::IDesktopCaptureImpl {
+        Q_OBJECT
+        Q_DECLARE_PRIVATE(X11DesktopCaptureImpl)
+        Q_INTERFACES(AVQt::api::IDesktopCaptureImpl)
+    public:
+        Q_INVOKABLE explicit X11DesktopCaptureImpl(QObject *parent = nullptr);
+        ~X11DesktopCaptureImpl() override;
+
+        bool open(const api::IDesktopCaptureImpl::Config &config) override;
+        bool start() override;
+        void close() override;
+
+        [[nodiscard]] AVPixelFormat getOutputFormat() const override;
+
+        [[nodiscard]] bool isHWAccel() const override;
+        [[nodiscard]] communication::VideoPadParams getVideoParams() const override;
+
+    signals:
+        void frameReady(std::shared_ptr<AVFrame> frame) override;
+
+    private slots:
+        void captureFrame();
+
+    private:
+        QScopedPointer<X11DesktopCaptureImplPrivate> d_ptr;
+    };
+}// namespace AVQt
+
+
+#endif//LIBAVQT_X11DESKTOPCAPTUREIMPL_HPP
@@ -6,6 +6,7 @@
 #define LIBAVQT_DESKTOPCAPTURER_P_HPP
 
 #include "AVQt/capture/IDesktopCaptureImpl.hpp"
+#include "capture/FrameChangeDetector.hpp"
 
 #include <QObject>
 #include <pgraph/api/Pad.hpp>
@@ -33,6 +34,11 @@ namespace AVQt {
 
         QSize lastFrameSize{};
 
+        // Only used on the capture thread
+        internal::FrameChangeDetector changeDetector{};
+        int64_t lastForwardTime{0};
+        std::atomic_uint64_t skippedFrames{0};
+
         QMetaObject::Connection frameReadyConnection{};
         QThread *afterStopThread{};
 
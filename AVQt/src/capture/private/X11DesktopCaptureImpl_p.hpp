@@ -0,0 +1,76 @@
+#ifndef LIBAVQT_X11DESKTOPCAPTUREIMPL_P_HPP
+#define LIBAVQT_X11DESKTOPCAPTUREIMPL_P_HPP
+
+#include "AVQt/capture/IDesktopCaptureImpl.hpp"
+
+#include <QSize>
+#include <QTimer>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace AVQt {
+    namespace internal {
+        // Defined in X11DesktopCaptureImpl.cpp, which keeps the Xlib macros out of the headers
+        struct X11Connection;
+        struct ShmImage;
+
+        /**
+         * @brief Shared memory images of the current frame size, which return here when their frames are freed
+         */
+        struct ShmImagePool {
+            std::mutex mutex{};
+            std::vector<std::shared_ptr<ShmImage>> freeImages{};
+            size_t allocated{0};
+            /**
+             * Incremented on size changes, images of older generations are destroyed instead of returned
+             */
+            uint64_t generation{0};
+        };
+    }// namespace internal
+
+    class X11DesktopCaptureImpl;
+    class X11DesktopCaptureImplPrivate {
+        Q_DECLARE_PUBLIC(X11DesktopCaptureImpl)
+    private:
+        explicit X11DesktopCaptureImplPrivate(X11DesktopCaptureImpl *q) : q_ptr(q) {}
+
+        /**
+         * @brief Reads the root window's size and pixel layout, starting a new pool generation, if the size changed
+         */
+        bool updateGeometry();
+        /**
+         * @return a free image of the pool, a new one, if fewer than PoolSize are in use, or nullptr.
+         * Clears useShm, if the X server can't attach the shared memory.
+         */
+        std::shared_ptr<internal::ShmImage> acquireImage();
+        /**
+         * @brief Captures the root window with XGetImage(), if shared memory can't be used
+         * @return a copy of the root window's content, or nullptr on error
+         */
+        std::shared_ptr<AVFrame> getImage();
+        std::shared_ptr<AVFrame> wrapImage(const std::shared_ptr<internal::ShmImage> &image, uint64_t generation);
+
+        static void releaseImage(void *opaque, uint8_t *data);
+
+        static constexpr size_t PoolSize{8};
+
+        X11DesktopCaptureImpl *q_ptr;
+
+        api::IDesktopCaptureImpl::Config config{};
+
+        std::shared_ptr<internal::X11Connection> connection{};
+        std::shared_ptr<internal::ShmImagePool> pool{};
+        std::unique_ptr<QTimer> timer{};
+
+        QSize frameSize{};
+        AVPixelFormat pixelFormat{AV_PIX_FMT_NONE};
+        int64_t startTime{0};
+        uint64_t droppedFrames{0};
+        bool useShm{true};
+    };
+}// namespace AVQt
+
+
+#endif//LIBAVQT_X11DESKTOPCAPTUREIMPL_P_HPP
@@ -0,0 +1,16 @@
+#include "AVQt/common/LatencyProfile.hpp"
+
+namespace AVQt::common {
+    LatencyProfile LatencyProfile::lowLatency() {
+        LatencyProfile profile{};
+        profile.lowDelay = true;
+        profile.decoderQueueSize = 2;
+        profile.encoderQueueSize = 1;
+        profile.muxerQueueSize = 4;
+        profile.interleave = false;
+        profile.flushPackets = true;
+        // A single TS datagram, see UdpStreamSink
+        profile.ioBufferSize = 7 * 188;
+        return profile;
+    }
+}// namespace AVQt::common
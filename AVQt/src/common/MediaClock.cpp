@@ -0,0 +1,122 @@
+#include "AVQt/common/MediaClock.hpp"
+#include "private/MediaClock_p.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace AVQt::common {
+    MediaClock::MediaClock()
+        : d_ptr(new MediaClockPrivate(this)) {
+    }
+
+    MediaClock::~MediaClock() = default;
+
+    int64_t MediaClock::time() const {
+        Q_D(const MediaClock);
+        std::lock_guard lock(d->mutex);
+        return d->timeLocked(std::chrono::steady_clock::now());
+    }
+
+    bool MediaClock::isStarted() const {
+        Q_D(const MediaClock);
+        std::lock_guard lock(d->mutex);
+        return d->anchorTime != AV_NOPTS_VALUE;
+    }
+
+    bool MediaClock::isPaused() const {
+        Q_D(const MediaClock);
+        std::lock_guard lock(d->mutex);
+        return d->paused;
+    }
+
+    void MediaClock::setTime(int64_t time) {
+        Q_D(MediaClock);
+        std::lock_guard lock(d->mutex);
+        d->anchorTime = time;
+        d->anchorPoint = std::chrono::steady_clock::now();
+    }
+
+    void MediaClock::pause(bool state) {
+        Q_D(MediaClock);
+        std::lock_guard lock(d->mutex);
+        if (d->paused == state) {
+            return;
+        }
+        // Re-anchor, so the time doesn't advance while paused
+        const auto now = std::chrono::steady_clock::now();
+        d->anchorTime = d->timeLocked(now);
+        d->anchorPoint = now;
+        d->paused = state;
+    }
+
+    void MediaClock::reset() {
+        Q_D(MediaClock);
+        std::lock_guard lock(d->mutex);
+        d->anchorTime = AV_NOPTS_VALUE;
+    }
+
+    void MediaClock::setMastered(bool mastered) {
+        Q_D(MediaClock);
+        std::lock_guard lock(d->mutex);
+        d->mastered = mastered;
+    }
+
+    bool MediaClock::isMastered() const {
+        Q_D(const MediaClock);
+        std::lock_guard lock(d->mutex);
+        return d->mastered;
+    }
+
+    MediaClock::FrameAction MediaClock::syncFrame(int64_t pts, int64_t nextPts) {
+        Q_D(MediaClock);
+        std::lock_guard lock(d->mutex);
+
+        const auto now = std::chrono::steady_clock::now();
+        if (d->anchorTime == AV_NOPTS_VALUE) {
+            if (d->mastered) {
+                // The master hasn't started playing yet
+                return FrameAction::Wait;
+            }
+            d->anchorTime = pts;
+            d->anchorPoint = now;
+        }
+
+        const auto clockTime = d->timeLocked(now);
+        if (pts > clockTime) {
+            ++d->statistics.repeatedFrames;
+            return FrameAction::Wait;
+        }
+        if (nextPts != AV_NOPTS_VALUE && nextPts <= clockTime) {
+            ++d->statistics.droppedFrames;
+            return FrameAction::Drop;
+        }
+
+        const auto drift = clockTime - pts;
+        ++d->statistics.shownFrames;
+        d->statistics.lastDrift = drift;
+        d->statistics.maxDrift = std::max(d->statistics.maxDrift, std::abs(drift));
+        d->absoluteDriftSum += std::abs(drift);
+        d->statistics.meanAbsoluteDrift = d->absoluteDriftSum / static_cast<int64_t>(d->statistics.shownFrames);
+        return FrameAction::Show;
+    }
+
+    MediaClock::SyncStatistics MediaClock::statistics() const {
+        Q_D(const MediaClock);
+        std::lock_guard lock(d->mutex);
+        return d->statistics;
+    }
+
+    void MediaClock::resetStatistics() {
+        Q_D(MediaClock);
+        std::lock_guard lock(d->mutex);
+        d->statistics = {};
+        d->absoluteDriftSum = 0;
+    }
+
+    int64_t MediaClockPrivate::timeLocked(std::chrono::steady_clock::time_point now) const {
+        if (anchorTime == AV_NOPTS_VALUE || paused) {
+            return anchorTime;
+        }
+        return anchorTime + std::chrono::duration_cast<std::chrono::microseconds>(now - anchorPoint).count();
+    }
+}// namespace AVQt::common
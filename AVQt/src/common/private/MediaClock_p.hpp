@@ -0,0 +1,41 @@
+#ifndef LIBAVQT_MEDIACLOCK_P_HPP
+#define LIBAVQT_MEDIACLOCK_P_HPP
+
+#include "common/MediaClock.hpp"
+
+#include <chrono>
+#include <mutex>
+
+extern "C" {
+#include <libavutil/avutil.h>
+}
+
+namespace AVQt::common {
+    class MediaClockPrivate {
+        Q_DECLARE_PUBLIC(MediaClock)
+    private:
+        explicit MediaClockPrivate(MediaClock *q) : q_ptr(q) {}
+        MediaClock *q_ptr;
+
+        /**
+         * @brief Requires mutex to be locked
+         */
+        [[nodiscard]] int64_t timeLocked(std::chrono::steady_clock::time_point now) const;
+
+        mutable std::mutex mutex{};
+
+        // Media time anchorTime was reached at anchorPoint, the clock advances in real time from there, unless paused
+        int64_t anchorTime{AV_NOPTS_VALUE};
+        std::chrono::steady_clock::time_point anchorPoint{};
+        bool paused{false};
+        bool mastered{false};
+
+        MediaClock::SyncStatistics statistics{};
+        int64_t absoluteDriftSum{0};
+
+        friend class MediaClock;
+    };
+}// namespace AVQt::common
+
+
+#endif//LIBAVQT_MEDIACLOCK_P_HPP
@@ -36,6 +36,7 @@ namespace AVQt::communication {
         codec = other.codec;
         streamIdx = other.streamIdx;
         codecParams = other.codecParams;
+        timeBase = other.timeBase;
         return *this;
     }
 
@@ -57,6 +58,7 @@ namespace AVQt::communication {
         data["mediaType"] = mediaType;
         data["encoder"] = codec->name;
         data["streamIndex"] = static_cast<qint64>(streamIdx);
+        data["timeBase"] = QString("%1/%2").arg(timeBase.num).arg(timeBase.den);
         obj["data"] = data;
         return obj;
     }
@@ -104,16 +104,15 @@ namespace AVQt {
                 }
                 case communication::Message::Action::RESET: {
                     if (d->open) {
-                        std::unique_lock lock(d->inputQueueMutex);
-                        if (!d->inputQueue.empty()) {
-                            d->inputQueueCond.wait(lock, [d] { return d->inputQueue.empty(); });
+                        {
+                            std::unique_lock lock(d->inputQueueMutex);
+                            if (!d->inputQueue.empty()) {
+                                d->inputQueueCond.wait(lock, [d] { return d->inputQueue.empty() || !d->running; });
+                            }
                         }
-                        d->impl->close();
+                        // Emit the remaining frames and continue with a reset decoder instead of reopening it
+                        d->impl->flush();
                         pgraph::impl::SimpleProcessor::produce(communication::Message::builder().withAction(communication::Message::Action::RESET).build(), d->outputPadId);
-                        if (!d->impl->open(d->inputPadParams->codecParams)) {
-                            qWarning() << "Failed to open audio decoder";
-                            close();
-                        }
                     }
                     break;
                 }
@@ -210,6 +209,17 @@ namespace AVQt {
     void AudioDecoder::stop() {
         Q_D(AudioDecoder);
 
+        if (d->running && !d->paused) {
+            // At the end of the stream, decode the queued packets and emit the remaining frames before STOP
+            {
+                std::unique_lock lock(d->inputQueueMutex);
+                while (!d->inputQueue.empty() && d->running && !d->paused) {
+                    d->inputQueueCond.wait_for(lock, AudioDecoderPrivate::decoderRetryInterval);
+                }
+            }
+            d->impl->flush();
+        }
+
         bool shouldBe = true;
         if (d->running.compare_exchange_strong(shouldBe, false)) {
             d->paused = false;
@@ -269,21 +279,22 @@ namespace AVQt {
                     break;
                 }
             }
+            // The packet stays queued until the decoder took it, the impl drains the decoder before resending it when it's full
             std::shared_ptr<AVPacket> packet = d->inputQueue.front();
             inputLock.unlock();
             auto ret = d->impl->decode(packet);
             if (ret == EAGAIN) {
+                // The decoder neither took the packet nor returned a frame, wait before resending it, unless stop() wakes the thread
                 inputLock.lock();
-                d->inputQueue.pop();
+                d->inputQueueCond.wait_for(inputLock, AudioDecoderPrivate::decoderRetryInterval, [d] { return !d->running; });
+                continue;
             } else if (ret != EXIT_SUCCESS) {
                 char err[AV_ERROR_MAX_STRING_SIZE];
                 qWarning() << "AudioDecoder::run: error decoding packet" << av_make_error_string(err, AV_ERROR_MAX_STRING_SIZE, AVERROR(ret));
-                break;
-            } else {
-                inputLock.lock();
-                d->inputQueue.pop();
-                d->inputQueueCond.notify_all();
             }
+            inputLock.lock();
+            d->inputQueue.pop();
+            d->inputQueueCond.notify_all();
         }
     }
 
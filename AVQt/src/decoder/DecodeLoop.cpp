@@ -0,0 +1,55 @@
+#include "DecodeLoop.hpp"
+
+namespace AVQt::internal {
+    int DecodeLoop::decode(AVCodecContext *context, const AVPacket *packet, const FrameCallback &onFrame) {
+        int ret = avcodec_send_packet(context, packet);
+        if (ret == AVERROR(EAGAIN)) {
+            // Input and output are decoupled, the decoder accepts the packet again once its output is read
+            ret = drain(context, onFrame);
+            if (ret < 0) {
+                return ret;
+            }
+            ret = avcodec_send_packet(context, packet);
+        }
+        if (ret < 0) {
+            return ret;
+        }
+        return drain(context, onFrame);
+    }
+
+    int DecodeLoop::drain(AVCodecContext *context, const FrameCallback &onFrame) {
+        while (true) {
+            std::shared_ptr<AVFrame> frame{av_frame_alloc(), [](AVFrame *f) {
+                                               av_frame_free(&f);
+                                           }};
+            if (!frame) {
+                return AVERROR(ENOMEM);
+            }
+            int ret = avcodec_receive_frame(context, frame.get());
+            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+                return 0;
+            } else if (ret < 0) {
+                return ret;
+            }
+            onFrame(frame);
+        }
+    }
+
+    int DecodeLoop::flush(AVCodecContext *context, const FrameCallback &onFrame) {
+        int ret = avcodec_send_packet(context, nullptr);
+        if (ret == AVERROR(EAGAIN)) {
+            ret = drain(context, onFrame);
+            if (ret == 0) {
+                ret = avcodec_send_packet(context, nullptr);
+            }
+        }
+        // AVERROR_EOF: already flushed, no frames left
+        if (ret == 0) {
+            ret = drain(context, onFrame);
+        } else if (ret == AVERROR_EOF) {
+            ret = 0;
+        }
+        avcodec_flush_buffers(context);
+        return ret;
+    }
+}// namespace AVQt::internal
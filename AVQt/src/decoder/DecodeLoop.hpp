@@ -0,0 +1,45 @@
+#ifndef LIBAVQT_DECODELOOP_HPP
+#define LIBAVQT_DECODELOOP_HPP
+
+#include <functional>
+#include <memory>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+namespace AVQt::internal {
+    /**
+     * @brief Send/receive state machine around avcodec_send_packet() and avcodec_receive_frame(), shared by the decoder implementations.
+     *
+     * The decoder is always drained until it returns EAGAIN, so a packet rejected with EAGAIN is accepted when resent afterwards.
+     * Frames are passed to the callback on the calling thread, callers serialize access to the context themselves.
+     */
+    class DecodeLoop {
+    public:
+        using FrameCallback = std::function<void(const std::shared_ptr<AVFrame> &)>;
+
+        DecodeLoop() = delete;
+
+        /**
+         * @brief Sends packet, draining the decoded frames before resending it if the decoder is full, and drains again afterwards
+         * @return 0 or a negative FFmpeg error, AVERROR(EAGAIN) only if the decoder neither accepted the packet nor returned a frame
+         */
+        static int decode(AVCodecContext *context, const AVPacket *packet, const FrameCallback &onFrame);
+
+        /**
+         * @brief Receives frames until the decoder needs more input or reached the end of the stream
+         * @return 0 or a negative FFmpeg error
+         */
+        static int drain(AVCodecContext *context, const FrameCallback &onFrame);
+
+        /**
+         * @brief Decodes the frames the decoder still holds back and resets it with avcodec_flush_buffers() for the next packets,
+         * e.g. at the end of the stream before looping or seeking
+         * @return 0 or a negative FFmpeg error
+         */
+        static int flush(AVCodecContext *context, const FrameCallback &onFrame);
+    };
+}// namespace AVQt::internal
+
+#endif//LIBAVQT_DECODELOOP_HPP
@@ -1,6 +1,7 @@
 #include "GenericAudioDecoderImpl.hpp"
 #include "private/GenericAudioDecoderImplPrivate.hpp"
 
+#include "DecodeLoop.hpp"
 #include "decoder/AudioDecoderFactory.hpp"
 
 #include <static_block.hpp>
@@ -100,24 +101,32 @@ namespace AVQt {
             return ENODEV;
         }
 
-        int ret = avcodec_send_packet(d->codecContext.get(), packet.get());
-        if (ret < 0) {
+        int ret = internal::DecodeLoop::decode(d->codecContext.get(), packet.get(), [this](const std::shared_ptr<AVFrame> &frame) {
+            emit frameReady(frame);
+        });
+        if (ret < 0 && ret != AVERROR(EAGAIN)) {
             char err[AV_ERROR_MAX_STRING_SIZE];
-            throw std::runtime_error{std::string{"Could not send packet to decoder: "} + av_make_error_string(err, AV_ERROR_MAX_STRING_SIZE, ret)};
+            qWarning() << "GenericAudioDecoderImpl::decode() could not decode packet:" << av_make_error_string(err, AV_ERROR_MAX_STRING_SIZE, ret);
         }
+        return AVUNERROR(ret);
+    }
 
-        std::shared_ptr<AVFrame> frame{av_frame_alloc(), &GenericAudioDecoderImplPrivate::destroyAVFrame};
-        while (ret >= 0) {
-            ret = avcodec_receive_frame(d->codecContext.get(), frame.get());
-            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
-                break;
-            } else if (ret < 0) {
-                throw std::runtime_error{"Could not receive frame from decoder"};
-            }
+    void GenericAudioDecoderImpl::flush() {
+        Q_D(GenericAudioDecoderImpl);
+
+        std::unique_lock codecLock{d->codecMutex};
+
+        if (!d->open) {
+            return;
+        }
+
+        int ret = internal::DecodeLoop::flush(d->codecContext.get(), [this](const std::shared_ptr<AVFrame> &frame) {
             emit frameReady(frame);
-            frame.reset(av_frame_alloc());
+        });
+        if (ret < 0) {
+            char err[AV_ERROR_MAX_STRING_SIZE];
+            qWarning() << "GenericAudioDecoderImpl::flush() could not flush decoder:" << av_make_error_string(err, AV_ERROR_MAX_STRING_SIZE, ret);
         }
-        return EXIT_SUCCESS;
     }
 
     GenericAudioDecoderImplPrivate::GenericAudioDecoderImplPrivate(GenericAudioDecoderImpl *q) : q_ptr(q) {}
@@ -23,6 +23,7 @@ namespace AVQt {
         void close() Q_DECL_OVERRIDE;
 
         virtual int decode(std::shared_ptr<AVPacket> packet) Q_DECL_OVERRIDE;
+        void flush() Q_DECL_OVERRIDE;
 
         [[nodiscard]] common::AudioFormat getOutputFormat() const Q_DECL_OVERRIDE;
         [[nodiscard]] communication::AudioPadParams getAudioParams() const Q_DECL_OVERRIDE;
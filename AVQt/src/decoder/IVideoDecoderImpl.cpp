@@ -0,0 +1,29 @@
+#include "AVQt/decoder/IVideoDecoderImpl.hpp"
+
+namespace AVQt::api {
+    bool IVideoDecoderImpl::setDecodeMode(const VideoDecodeMode &mode) {
+        Q_UNUSED(mode)
+        return false;
+    }
+
+    void IVideoDecoderImpl::applyDecodeMode(AVCodecContext *context, const VideoDecodeMode &mode) {
+        if (!context) {
+            return;
+        }
+        context->skip_frame = mode.skipFrame;
+        context->skip_loop_filter = mode.skipLoopFilter ? AVDISCARD_ALL : AVDISCARD_DEFAULT;
+        if (!avcodec_is_open(context)) {
+            // These change the layout of the decoded frames or the threading of the decoder, so they can't be switched while decoding
+            context->lowres = mode.lowres;
+            if (mode.fast) {
+                context->flags2 |= AV_CODEC_FLAG2_FAST;
+            } else {
+                context->flags2 &= ~AV_CODEC_FLAG2_FAST;
+            }
+            if (mode.lowDelay) {
+                context->flags |= AV_CODEC_FLAG_LOW_DELAY;
+                context->thread_type = FF_THREAD_SLICE;
+            }
+        }
+    }
+}// namespace AVQt::api
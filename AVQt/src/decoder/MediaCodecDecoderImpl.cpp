@@ -2,6 +2,7 @@
 #include "private/MediaCodecDecoderImpl_p.hpp"
 
 #include "AVQt/decoder/VideoDecoderFactory.hpp"
+#include "DecodeLoop.hpp"
 
 #include <static_block.hpp>
 
@@ -115,6 +116,8 @@ namespace AVQt {
             d->codecContext->opaque = this;
             d->codecContext->pix_fmt = AV_PIX_FMT_MEDIACODEC;
 
+            applyDecodeMode(d->codecContext.get(), d->decodeMode);
+
             int ret = avcodec_open2(d->codecContext.get(), d->codec, nullptr);
             if (ret < 0) {
                 char errBuf[AV_ERROR_MAX_STRING_SIZE];
@@ -122,9 +125,6 @@ namespace AVQt {
                 goto failed;
             }
 
-            d->frameFetcher = std::make_unique<MediaCodecDecoderImplPrivate::FrameFetcher>(d);
-            d->frameFetcher->start();
-
             return true;
         }
 
@@ -138,47 +138,60 @@ namespace AVQt {
     void MediaCodecDecoderImpl::close() {
         Q_D(MediaCodecDecoderImpl);
 
-        if (d->frameFetcher) {
-            d->frameFetcher->stop();
-            d->frameFetcher.reset();
+        {
+            QMutexLocker lock(&d->codecMutex);
+            d->codecContext.reset();
         }
-
-        d->codecContext.reset();
         d->codecParameters.reset();
         d->hwFramesContext.reset();
     }
 
+    bool MediaCodecDecoderImpl::setDecodeMode(const VideoDecodeMode &mode) {
+        Q_D(MediaCodecDecoderImpl);
+        QMutexLocker lock(&d->codecMutex);
+        d->decodeMode = mode;
+        applyDecodeMode(d->codecContext.get(), mode);
+        return true;
+    }
+
     int MediaCodecDecoderImpl::decode(std::shared_ptr<AVPacket> packet) {
-        Q_UNUSED(packet)
         Q_D(MediaCodecDecoderImpl);
 
         if (!packet) {
             return EINVAL;
         }
 
+        QMutexLocker lock(&d->codecMutex);
         if (!d->codecContext) {
             qWarning() << "Codec context not initialized";
             return ENODEV;
         }
 
-        {
-            QMutexLocker lock(&d->codecMutex);
+        int ret = internal::DecodeLoop::decode(d->codecContext.get(), packet.get(), [this](const std::shared_ptr<AVFrame> &frame) {
+            frameReady(frame);
+        });
+        if (ret < 0 && ret != AVERROR(EAGAIN)) {
+            char errBuf[AV_ERROR_MAX_STRING_SIZE];
+            qWarning() << "Could not decode packet:" << av_make_error_string(errBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+        }
 
-            int ret = avcodec_send_packet(d->codecContext.get(), packet.get());
-            qDebug() << "Packet size:" << (packet ? packet->size : -1);
-            if (ret < 0 && ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) {
-                char errBuf[AV_ERROR_MAX_STRING_SIZE];
-                qWarning() << "Could not send packet to codec:" << av_make_error_string(errBuf, AV_ERROR_MAX_STRING_SIZE, ret);
-                return AVUNERROR(ret);
-            } else if (ret == 0) {
-                qDebug() << "Sent packet";
-            }
+        return AVUNERROR(ret);
+    }
 
-            d->firstFrame = false;
+    void MediaCodecDecoderImpl::flush() {
+        Q_D(MediaCodecDecoderImpl);
+        QMutexLocker lock(&d->codecMutex);
+        if (!d->codecContext) {
+            return;
         }
-        d->firstFrameCond.wakeAll();
 
-        return EXIT_SUCCESS;
+        int ret = internal::DecodeLoop::flush(d->codecContext.get(), [this](const std::shared_ptr<AVFrame> &frame) {
+            frameReady(frame);
+        });
+        if (ret < 0) {
+            char errBuf[AV_ERROR_MAX_STRING_SIZE];
+            qWarning() << "Could not flush decoder:" << av_make_error_string(errBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+        }
     }
 
     AVPixelFormat MediaCodecDecoderImpl::getOutputFormat() const {
@@ -304,65 +317,6 @@ namespace AVQt {
 
         return result;
     }
-
-    MediaCodecDecoderImplPrivate::FrameFetcher::FrameFetcher(MediaCodecDecoderImplPrivate *parent)
-        : p(parent) {
-        setObjectName("AVQt::mediacodecDecoderImpl::FrameFetcher");
-    }
-
-    void MediaCodecDecoderImplPrivate::FrameFetcher::start() {
-        bool shouldBe = false;
-        if (running.compare_exchange_strong(shouldBe, true)) {
-            QThread::start();
-        } else {
-            qWarning() << "FrameFetcher already running";
-        }
-    }
-
-    void MediaCodecDecoderImplPrivate::FrameFetcher::stop() {
-        bool shouldBe = true;
-        if (running.compare_exchange_strong(shouldBe, false)) {
-            p->firstFrameCond.wakeAll();
-            QThread::quit();
-            QThread::wait();
-        } else {
-            qWarning() << "FrameFetcher not running";
-        }
-    }
-
-    void MediaCodecDecoderImplPrivate::FrameFetcher::run() {
-        int ret;
-        char errBuf[AV_ERROR_MAX_STRING_SIZE];
-        while (running) {
-            QMutexLocker lock(&p->codecMutex);
-            if (p->firstFrame) {
-                p->firstFrameCond.wait(&p->codecMutex);
-                if (!running) {
-                    break;
-                }
-            }
-            std::shared_ptr<AVFrame> frame{av_frame_alloc(), [](AVFrame *f) {
-                                               av_frame_free(&f);
-                                           }};
-            if (!frame) {
-                qWarning() << "Could not allocate frame";
-                continue;
-            }
-            frame->format = AV_PIX_FMT_MEDIACODEC;
-            ret = avcodec_receive_frame(nullptr, frame.get());
-            if (ret == AVERROR(EAGAIN) || ret == AVERROR(ENOMEM)) {
-                usleep(500);
-                continue;
-            } else if (ret == AVERROR_EOF) {
-                break;
-            } else if (ret < 0) {
-                qWarning() << "Could not receive frame" << av_make_error_string(errBuf, AV_ERROR_MAX_STRING_SIZE, ret);
-                continue;
-            } else {
-                emit p->q_func()->frameReady(frame);
-            }
-        }
-    }
 }// namespace AVQt
 
 #ifdef Q_OS_ANDROID
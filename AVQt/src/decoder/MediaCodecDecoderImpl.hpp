@@ -18,6 +18,8 @@ namespace AVQt {
         bool open(std::shared_ptr<AVCodecParameters> codecParams) Q_DECL_OVERRIDE;
         void close() Q_DECL_OVERRIDE;
         int decode(std::shared_ptr<AVPacket> packet) Q_DECL_OVERRIDE;
+        void flush() Q_DECL_OVERRIDE;
+        bool setDecodeMode(const VideoDecodeMode &mode) Q_DECL_OVERRIDE;
         AVPixelFormat getOutputFormat() const Q_DECL_OVERRIDE;
         AVPixelFormat getSwOutputFormat() const Q_DECL_OVERRIDE;
         bool isHWAccel() const Q_DECL_OVERRIDE;
@@ -5,10 +5,10 @@
 #include "QSVDecoderImpl.hpp"
 #include "private/QSVDecoderImpl_p.hpp"
 
+#include "DecodeLoop.hpp"
 #include "common/PixelFormat.hpp"
 #include "decoder/VideoDecoderFactory.hpp"
 
-#include <QElapsedTimer>
 #include <static_block.hpp>
 
 namespace AVQt {
@@ -126,19 +126,14 @@ namespace AVQt {
             d->codecContext->opaque = d;
             d->codecContext->get_format = &QSVDecoderImplPrivate::getFormat;
 
+            applyDecodeMode(d->codecContext.get(), d->decodeMode);
+
             ret = avcodec_open2(d->codecContext.get(), d->pCodec, nullptr);
             if (ret < 0) {
                 qWarning() << "[AVQt::QSVDecoderImpl] Failed to open codec: " << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
                 goto fail;
             }
 
-            d->frameFetcher = std::make_unique<QSVDecoderImplPrivate::FrameFetcher>(d);
-            d->frameFetcher->start();
-            if (!d->frameFetcher->isRunning()) {
-                qWarning() << "[AVQt::QSVDecoderImpl] Failed to start frame fetcher";
-                goto fail;
-            }
-
             return true;
         } else {
             qWarning("[AVQt::QSVDecoderImpl] Already opened");
@@ -146,7 +141,6 @@ namespace AVQt {
         }
     fail:
         d->open = false;
-        d->frameFetcher.reset();
         d->codecContext.reset();
         d->hwDeviceContext.reset();
         d->hwFramesContext.reset();
@@ -158,13 +152,23 @@ namespace AVQt {
 
         bool shouldBe = false;
         if (d->open.compare_exchange_strong(shouldBe, false)) {
-            d->frameFetcher.reset();
-            d->codecContext.reset();
+            {
+                QMutexLocker lock(&d->codecMutex);
+                d->codecContext.reset();
+            }
             d->hwDeviceContext.reset();
             d->hwFramesContext.reset();
         }
     }
 
+    bool QSVDecoderImpl::setDecodeMode(const VideoDecodeMode &mode) {
+        Q_D(QSVDecoderImpl);
+        QMutexLocker lock(&d->codecMutex);
+        d->decodeMode = mode;
+        applyDecodeMode(d->codecContext.get(), mode);
+        return true;
+    }
+
     int QSVDecoderImpl::decode(std::shared_ptr<AVPacket> packet) {
         Q_D(QSVDecoderImpl);
 
@@ -178,22 +182,32 @@ namespace AVQt {
             return EINVAL;
         }
 
-        int ret = AVERROR(EXIT_SUCCESS);
-        char strBuf[AV_ERROR_MAX_STRING_SIZE];
-
-        {
-            QMutexLocker locker(&d->codecMutex);
-            ret = avcodec_send_packet(d->codecContext.get(), packet.get());
+        QMutexLocker lock(&d->codecMutex);
+        int ret = internal::DecodeLoop::decode(d->codecContext.get(), packet.get(), [this](const std::shared_ptr<AVFrame> &frame) {
+            frameReady(frame);
+        });
+        if (ret < 0 && ret != AVERROR(EAGAIN)) {
+            char errBuf[AV_ERROR_MAX_STRING_SIZE];
+            qWarning() << "[AVQt::QSVDecoderImpl] Failed to decode packet:" << av_make_error_string(errBuf, AV_ERROR_MAX_STRING_SIZE, ret);
         }
 
-        if (ret < 0 && ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) {
-            qWarning() << "[AVQt::QSVDecoderImpl] Failed to send packet: " << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
-            return AVUNERROR(ret);
-        }
+        return AVUNERROR(ret);
+    }
 
-        d->firstFrame = false;
+    void QSVDecoderImpl::flush() {
+        Q_D(QSVDecoderImpl);
+        QMutexLocker lock(&d->codecMutex);
+        if (!d->codecContext) {
+            return;
+        }
 
-        return AVUNERROR(ret);
+        int ret = internal::DecodeLoop::flush(d->codecContext.get(), [this](const std::shared_ptr<AVFrame> &frame) {
+            frameReady(frame);
+        });
+        if (ret < 0) {
+            char errBuf[AV_ERROR_MAX_STRING_SIZE];
+            qWarning() << "[AVQt::QSVDecoderImpl] Failed to flush decoder:" << av_make_error_string(errBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+        }
     }
 
     AVPixelFormat QSVDecoderImpl::getOutputFormat() const {
@@ -263,63 +277,6 @@ namespace AVQt {
             av_buffer_unref(&buffer);
         }
     }
-
-    QSVDecoderImplPrivate::FrameFetcher::FrameFetcher(QSVDecoderImplPrivate *d)
-        : p(d) {
-        setObjectName("AVQt::QSVDecoderImpl::FrameFetcher");
-    }
-
-    QSVDecoderImplPrivate::FrameFetcher::~FrameFetcher() {
-        if (isRunning()) {
-            stop();
-        }
-    }
-
-    void QSVDecoderImplPrivate::FrameFetcher::stop() {
-        bool shouldBe = false;
-        if (m_stop.compare_exchange_strong(shouldBe, true)) {
-            QThread::quit();
-            QThread::wait();
-        }
-    }
-
-    void QSVDecoderImplPrivate::FrameFetcher::run() {
-        qDebug() << "FrameFetcher started";
-        int ret;
-        constexpr size_t strBufSize = 256;
-        char strBuf[strBufSize];
-        while (!m_stop) {
-            QMutexLocker inputLock(&p->codecMutex);
-            if (p->firstFrame) {
-                inputLock.unlock();
-                msleep(2);
-                continue;
-            }
-            std::shared_ptr<AVFrame> frame = {av_frame_alloc(), [](AVFrame *frame) {
-                                                  av_frame_free(&frame);
-                                              }};
-            ret = avcodec_receive_frame(p->codecContext.get(), frame.get());
-            if (ret == 0) {
-                qDebug("Publishing frame with PTS %ld", frame->pts);
-                QElapsedTimer timer;
-                timer.start();
-                p->q_func()->frameReady(frame);
-                inputLock.unlock();
-                qDebug("Frame callback runtime: %lld ms", timer.elapsed());
-            } else if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF || ret == AVERROR(ENOMEM)) {
-                frame.reset();
-                inputLock.unlock();
-                msleep(4);
-            } else {
-                inputLock.unlock();
-                av_strerror(ret, strBuf, strBufSize);
-                qWarning("Error while receiving frame: %s", strBuf);
-                m_stop = true;
-                break;
-            }
-        }
-        qDebug() << "FrameFetcher stopped";
-    }
 }// namespace AVQt
 
 static_block {
@@ -23,6 +23,8 @@ namespace AVQt {
         bool open(std::shared_ptr<AVCodecParameters> codecParams) override;
         void close() override;
         int decode(std::shared_ptr<AVPacket> packet) override;
+        void flush() override;
+        bool setDecodeMode(const VideoDecodeMode &mode) override;
         [[nodiscard]] AVPixelFormat getOutputFormat() const override;
         [[nodiscard]] AVPixelFormat getSwOutputFormat() const override;
         [[nodiscard]] bool isHWAccel() const override;
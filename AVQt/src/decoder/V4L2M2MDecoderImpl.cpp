@@ -6,6 +6,7 @@
 #include "private/V4L2M2MDecoderImpl_p.hpp"
 
 #include "AVQt/decoder/VideoDecoderFactory.hpp"
+#include "DecodeLoop.hpp"
 
 #include <static_block.hpp>
 
@@ -109,14 +110,13 @@ namespace AVQt {
             d->codecContext->get_format = &V4L2M2MDecoderImplPrivate::getFormat;
             d->codecContext->opaque = this;
 
+            applyDecodeMode(d->codecContext.get(), d->decodeMode);
+
             if (avcodec_open2(d->codecContext.get(), d->codec, nullptr) < 0) {
                 qWarning() << "Could not open codec";
                 goto failed;
             }
 
-            d->frameFetcher = std::make_unique<V4L2M2MDecoderImplPrivate::FrameFetcher>(d);
-            d->frameFetcher->start();
-
             return true;
         }
 
@@ -130,44 +130,60 @@ namespace AVQt {
     void V4L2M2MDecoderImpl::close() {
         Q_D(V4L2M2MDecoderImpl);
 
-        if (d->frameFetcher) {
-            d->frameFetcher->stop();
-            d->frameFetcher.reset();
+        {
+            QMutexLocker lock(&d->codecMutex);
+            d->codecContext.reset();
         }
-
-        d->codecContext.reset();
         d->codecParameters.reset();
         d->hwFramesContext.reset();
     }
 
+    bool V4L2M2MDecoderImpl::setDecodeMode(const VideoDecodeMode &mode) {
+        Q_D(V4L2M2MDecoderImpl);
+        QMutexLocker lock(&d->codecMutex);
+        d->decodeMode = mode;
+        applyDecodeMode(d->codecContext.get(), mode);
+        return true;
+    }
+
     int V4L2M2MDecoderImpl::decode(std::shared_ptr<AVPacket> packet) {
-        Q_UNUSED(packet)
         Q_D(V4L2M2MDecoderImpl);
 
         if (!packet) {
             return EINVAL;
         }
 
+        QMutexLocker lock(&d->codecMutex);
         if (!d->codecContext) {
             qWarning() << "VideoCodec context not initialized";
             return ENODEV;
         }
 
-        {
-            QMutexLocker lock(&d->codecMutex);
+        int ret = internal::DecodeLoop::decode(d->codecContext.get(), packet.get(), [this](const std::shared_ptr<AVFrame> &frame) {
+            frameReady(frame);
+        });
+        if (ret < 0 && ret != AVERROR(EAGAIN)) {
+            char errBuf[AV_ERROR_MAX_STRING_SIZE];
+            qWarning() << "Could not decode packet:" << av_make_error_string(errBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+        }
 
-            int ret = avcodec_send_packet(d->codecContext.get(), packet.get());
-            if (ret < 0 && ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) {
-                char errBuf[AV_ERROR_MAX_STRING_SIZE];
-                qWarning() << "Could not send packet to codec:" << av_make_error_string(errBuf, AV_ERROR_MAX_STRING_SIZE, ret);
-                return AVUNERROR(ret);
-            }
+        return AVUNERROR(ret);
+    }
 
-            d->firstFrame = false;
+    void V4L2M2MDecoderImpl::flush() {
+        Q_D(V4L2M2MDecoderImpl);
+        QMutexLocker lock(&d->codecMutex);
+        if (!d->codecContext) {
+            return;
         }
-        d->firstFrameCond.wakeAll();
 
-        return EXIT_SUCCESS;
+        int ret = internal::DecodeLoop::flush(d->codecContext.get(), [this](const std::shared_ptr<AVFrame> &frame) {
+            frameReady(frame);
+        });
+        if (ret < 0) {
+            char errBuf[AV_ERROR_MAX_STRING_SIZE];
+            qWarning() << "Could not flush decoder:" << av_make_error_string(errBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+        }
     }
 
     bool V4L2M2MDecoderImpl::isHWAccel() const {
@@ -292,63 +308,6 @@ namespace AVQt {
 
         return result;
     }
-
-    V4L2M2MDecoderImplPrivate::FrameFetcher::FrameFetcher(V4L2M2MDecoderImplPrivate *parent)
-        : p(parent) {
-        setObjectName("AVQt::V4L2M2MDecoderImpl::FrameFetcher");
-    }
-
-    void V4L2M2MDecoderImplPrivate::FrameFetcher::start() {
-        bool shouldBe = false;
-        if (running.compare_exchange_strong(shouldBe, true)) {
-            QThread::start();
-        } else {
-            qWarning() << "FrameFetcher already running";
-        }
-    }
-
-    void V4L2M2MDecoderImplPrivate::FrameFetcher::stop() {
-        bool shouldBe = true;
-        if (running.compare_exchange_strong(shouldBe, false)) {
-            p->firstFrameCond.wakeAll();
-            QThread::quit();
-            QThread::wait();
-        } else {
-            qWarning() << "FrameFetcher not running";
-        }
-    }
-
-    void V4L2M2MDecoderImplPrivate::FrameFetcher::run() {
-        int ret;
-        char errBuf[AV_ERROR_MAX_STRING_SIZE];
-        while (running) {
-            QMutexLocker lock(&p->codecMutex);
-            if (p->firstFrame) {
-                p->firstFrameCond.wait(&p->codecMutex);
-                if (!running) {
-                    break;
-                }
-            }
-            std::shared_ptr<AVFrame> frame{av_frame_alloc(), [](AVFrame *f) {
-                                               av_frame_free(&f);
-                                           }};
-            if (!frame) {
-                qWarning() << "Could not allocate frame";
-                continue;
-            }
-            ret = avcodec_receive_frame(p->codecContext.get(), frame.get());
-            if (ret == AVERROR(EAGAIN) || ret == AVERROR(ENOMEM)) {
-                continue;
-            } else if (ret == AVERROR_EOF) {
-                break;
-            } else if (ret < 0) {
-                qWarning() << "Could not receive frame" << av_make_error_string(errBuf, AV_ERROR_MAX_STRING_SIZE, ret);
-                continue;
-            } else {
-                emit p->q_func()->frameReady(frame);
-            }
-        }
-    }
 }// namespace AVQt
 
 #ifdef Q_OS_LINUX
@@ -25,6 +25,8 @@ namespace AVQt {
         void close() override;
 
         int decode(std::shared_ptr<AVPacket> packet) override;
+        void flush() override;
+        bool setDecodeMode(const VideoDecodeMode &mode) override;
 
         [[nodiscard]] bool isHWAccel() const override;
         [[nodiscard]] AVPixelFormat getOutputFormat() const override;
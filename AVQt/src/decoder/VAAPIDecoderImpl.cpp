@@ -21,6 +21,7 @@
 #include "VAAPIDecoderImpl.hpp"
 #include "private/VAAPIDecoderImpl_p.hpp"
 
+#include "DecodeLoop.hpp"
 #include "decoder/VideoDecoderFactory.hpp"
 
 #include <QImage>
@@ -127,16 +128,13 @@ namespace AVQt {
             d->codecContext->get_format = &VAAPIDecoderImplPrivate::getFormat;
             d->codecContext->opaque = d;
 
+            applyDecodeMode(d->codecContext.get(), d->decodeMode);
+
             if (avcodec_open2(d->codecContext.get(), d->codec, nullptr) < 0) {
                 qWarning() << "Could not open encoder";
                 goto failed;
             }
 
-            d->frameFetcher = std::make_unique<VAAPIDecoderImplPrivate::FrameFetcher>(d);
-            d->frameFetcher->start();
-
-            //            connect(this, &VAAPIDecoderImpl::triggerFetchFrames, d->frameFetcher.get(), &VAAPIDecoderImplPrivate::FrameFetcher::fetchFrames, Qt::DirectConnection);
-
             return true;
         }
         return false;
@@ -152,12 +150,10 @@ namespace AVQt {
         if (d->initialized.compare_exchange_strong(shouldBe, false)) {
             qDebug() << "Stopping decoder";
 
-            if (d->frameFetcher) {
-                d->frameFetcher->stop();
-                d->frameFetcher.reset();
+            {
+                QMutexLocker lock(&d->codecMutex);
+                d->codecContext.reset();
             }
-
-            d->codecContext.reset();
             d->codecParams.reset();
 
             d->hwDeviceContext.reset();
@@ -167,30 +163,49 @@ namespace AVQt {
         }
     }
 
+    bool VAAPIDecoderImpl::setDecodeMode(const VideoDecodeMode &mode) {
+        Q_D(VAAPIDecoderImpl);
+        QMutexLocker lock(&d->codecMutex);
+        d->decodeMode = mode;
+        applyDecodeMode(d->codecContext.get(), mode);
+        return true;
+    }
+
     int VAAPIDecoderImpl::decode(std::shared_ptr<AVPacket> packet) {
         Q_D(VAAPIDecoderImpl);
+        QMutexLocker lock(&d->codecMutex);
         if (!d->codecContext) {
             qWarning() << "VideoCodec context not initialized";
             return ENODEV;
         }
 
-        int ret = AVERROR(EXIT_SUCCESS);
-
-        {
-            QMutexLocker lock(&d->codecMutex);
-            ret = avcodec_send_packet(d->codecContext.get(), packet.get());
-        }
-        if (ret < 0 && ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) {
+        int ret = internal::DecodeLoop::decode(d->codecContext.get(), packet.get(), [this](const std::shared_ptr<AVFrame> &frame) {
+            frameReady(frame);
+        });
+        if (ret < 0 && ret != AVERROR(EAGAIN)) {
             char errBuf[AV_ERROR_MAX_STRING_SIZE];
-            qWarning() << "Could not send packet to decoder:" << av_make_error_string(errBuf, AV_ERROR_MAX_STRING_SIZE, ret);
-            return AVUNERROR(ret);
+            qWarning() << "Could not decode packet:" << av_make_error_string(errBuf, AV_ERROR_MAX_STRING_SIZE, ret);
         }
 
-        d->firstFrame = false;
-
         return AVUNERROR(ret);
     }
 
+    void VAAPIDecoderImpl::flush() {
+        Q_D(VAAPIDecoderImpl);
+        QMutexLocker lock(&d->codecMutex);
+        if (!d->codecContext) {
+            return;
+        }
+
+        int ret = internal::DecodeLoop::flush(d->codecContext.get(), [this](const std::shared_ptr<AVFrame> &frame) {
+            frameReady(frame);
+        });
+        if (ret < 0) {
+            char errBuf[AV_ERROR_MAX_STRING_SIZE];
+            qWarning() << "Could not flush decoder:" << av_make_error_string(errBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+        }
+    }
+
     AVPixelFormat VAAPIDecoderImpl::getOutputFormat() const {
         return AV_PIX_FMT_VAAPI;
     }
@@ -279,103 +294,6 @@ namespace AVQt {
             avcodec_free_context(&codecContext);
         }
     }
-
-    VAAPIDecoderImplPrivate::FrameFetcher::FrameFetcher(VAAPIDecoderImplPrivate *p) : p(p) {
-        setObjectName("AVQt::VAAPIDecoderImpl::FrameFetcher");
-    }
-
-    void VAAPIDecoderImplPrivate::FrameFetcher::run() {
-        qDebug() << "FrameFetcher started";
-        int ret;
-        constexpr size_t strBufSize = 256;
-        char strBuf[strBufSize];
-
-        while (!m_stop) {
-            QMutexLocker inputLock(&p->codecMutex);
-            if (p->firstFrame) {
-                inputLock.unlock();
-                msleep(2);
-                continue;
-            }
-            std::shared_ptr<AVFrame> frame = {av_frame_alloc(), [](AVFrame *frame) {
-                                                  av_frame_free(&frame);
-                                              }};
-            ret = avcodec_receive_frame(p->codecContext.get(), frame.get());
-            //            qDebug("[AVQt::VAAPIDecoderImpl::Fetcher] Unlocked frame pool mutex: %p", hwFramesMutex);
-            if (ret == 0) {
-                //                auto t = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
-                //                qWarning("Frame decoded at: %ld us since epoch", t);
-                //                frame->opaque = reinterpret_cast<void *>(t);
-                //                frame->pts = av_rescale_q(frame->pts, p->timeBase, av_make_q(1, 1000000));
-                qDebug("Publishing frame with PTS %ld", frame->pts);
-                QElapsedTimer timer;
-                timer.start();
-                p->q_func()->frameReady(frame);
-                inputLock.unlock();
-                //                qDebug("Frame ref count: %ld", sharedFrame.use_count());
-                //                qDebug("Frame callback runtime: %lld ms", timer.elapsed());
-                //                m_outputQueue.enqueue(frame);
-            } else if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF || ret == AVERROR(ENOMEM)) {
-                frame.reset();
-                inputLock.unlock();
-                msleep(4);
-            } else {
-                inputLock.unlock();
-                av_strerror(ret, strBuf, strBufSize);
-                qWarning("Error while receiving frame: %s", strBuf);
-                m_stop = true;
-                break;
-            }
-        }
-        //        exec();
-        //        if (m_afterStopThread) {
-        //            moveToThread(m_afterStopThread);
-        //        }
-        qDebug() << "FrameFetcher stopped";
-    }
-
-    //    void VAAPIDecoderImplPrivate::FrameFetcher::fetchFrames() {
-    //        int fetchRet;
-    //        while (true) {
-    //            std::shared_ptr<AVFrame> frame{av_frame_alloc(), *p->frameDestructor};
-    //            {
-    //                QMutexLocker lock(&p->codecMutex);
-    //                fetchRet = avcodec_receive_frame(p->codecContext.get(), frame.get());
-    //            }
-    //            if (fetchRet == 0) {
-    //                p->q_func()->frameReady(frame);
-    //            } else if (fetchRet == AVERROR(EAGAIN)) {
-    //                break;
-    //            } else if (fetchRet == AVERROR_EOF) {
-    //                qDebug() << "End of stream";
-    //                break;
-    //            } else {
-    //                char strBuf[AV_ERROR_MAX_STRING_SIZE];
-    //                qWarning() << "Could not receive frame:" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, fetchRet);
-    //                break;
-    //            }
-    //        }
-    //    }
-
-    void VAAPIDecoderImplPrivate::FrameFetcher::stop() {
-        if (isRunning()) {
-            m_stop = true;
-            QThread::quit();
-            QThread::wait();
-        } else {
-            qWarning("FrameFetcher not running");
-        }
-    }
-
-    void VAAPIDecoderImplPrivate::FrameFetcher::start() {
-        if (!isRunning()) {
-            m_stop = false;
-            //            moveToThread(this);
-            QThread::start();
-        } else {
-            qWarning("FrameFetcher already running");
-        }
-    }
 }// namespace AVQt
 
 static_block {
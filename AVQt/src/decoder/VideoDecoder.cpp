@@ -31,6 +31,8 @@
 
 #include <QCoreApplication>
 
+#include <algorithm>
+
 
 namespace AVQt {
     VideoDecoder::VideoDecoder(const Config &config, std::shared_ptr<pgraph::network::api::PadRegistry> padRegistry, QObject *parent)
@@ -63,6 +65,23 @@ namespace AVQt {
         return d->outputPadId;
     }
 
+    bool VideoDecoder::setDecodeMode(const VideoDecodeMode &mode) {
+        Q_D(VideoDecoder);
+        QMutexLocker lock(&d->decodeModeMutex);
+        d->config.decodeMode = mode;
+        if (d->impl && !d->impl->setDecodeMode(mode)) {
+            qWarning() << "VideoDecoderImpl doesn't support decode modes";
+            return false;
+        }
+        return true;
+    }
+
+    VideoDecodeMode VideoDecoder::getDecodeMode() const {
+        Q_D(const VideoDecoder);
+        QMutexLocker lock(&d->decodeModeMutex);
+        return d->config.decodeMode;
+    }
+
     bool VideoDecoder::isPaused() const {
         Q_D(const VideoDecoder);
         return d->paused;
@@ -113,11 +132,15 @@ namespace AVQt {
                 }
                 case communication::Message::Action::RESET: {
                     if (d->open) {
-                        QMutexLocker locker(&d->inputQueueMutex);
-                        while (!d->inputQueue.empty()) {
-                            qDebug() << "Waiting for input queue to be empty" << d->inputQueue.size();
-                            d->packetProcessed.wait(&d->inputQueueMutex);
+                        {
+                            QMutexLocker locker(&d->inputQueueMutex);
+                            while (!d->inputQueue.empty()) {
+                                qDebug() << "Waiting for input queue to be empty" << d->inputQueue.size();
+                                d->packetProcessed.wait(&d->inputQueueMutex);
+                            }
                         }
+                        // Emit the frames held back for reordering and continue with a reset decoder instead of reopening it
+                        d->impl->flush();
                         pgraph::impl::SimpleProcessor::produce(communication::Message::builder().withAction(communication::Message::Action::RESET).build(), d->outputPadId);
                     }
                     break;
@@ -180,6 +203,15 @@ namespace AVQt {
                 return false;
             }
 
+            {
+                QMutexLocker lock(&d->decodeModeMutex);
+                auto decodeMode = d->config.decodeMode;
+                decodeMode.lowDelay = decodeMode.lowDelay || d->config.latency.lowDelay;
+                if (!d->impl->setDecodeMode(decodeMode)) {
+                    qDebug() << "VideoDecoderImpl doesn't support decode modes, decoding all frames";
+                }
+            }
+
             if (!d->impl->open(d->codecParams)) {
                 d->impl.reset();
                 qWarning() << "Failed to open VideoDecoderImpl";
@@ -251,6 +283,17 @@ namespace AVQt {
             return;
         }
 
+        if (!d->paused) {
+            // At the end of the stream, decode the queued packets and emit the frames held back for reordering before STOP
+            {
+                QMutexLocker locker(&d->inputQueueMutex);
+                while (!d->inputQueue.empty() && d->running && !d->paused) {
+                    d->packetProcessed.wait(&d->inputQueueMutex, VideoDecoderPrivate::decoderRetryInterval);
+                }
+            }
+            d->impl->flush();
+        }
+
         bool shouldBe = true;
         if (d->running.compare_exchange_strong(shouldBe, false)) {
             d->paused = false;
@@ -300,20 +343,26 @@ namespace AVQt {
                     continue;
                 }
             }
-            auto packet = d->inputQueue.dequeue();
+            // The packet stays queued until the decoder took it, so RESET only proceeds once it is decoded
+            auto packet = d->inputQueue.head();
             lock.unlock();
+            // The impl drains the decoded frames when the decoder is full and resends the packet,
+            // EAGAIN is only left if the decoder returned no frame either, e.g. while a hardware decoder still works on them
             int ret = d->impl->decode(packet);
             if (ret == EAGAIN) {
+                // Nothing signals when such frames are done, sleep until the next attempt, unless stop() wakes the thread
                 lock.relock();
-                d->inputQueue.prepend(packet);
-                lock.unlock();
-                msleep(1);
+                if (d->running) {
+                    d->packetAvailable.wait(&d->inputQueueMutex, VideoDecoderPrivate::decoderRetryInterval);
+                }
                 continue;
             } else if (ret != EXIT_SUCCESS) {
                 char strBuf[256];
                 qWarning() << "VideoDecoder error" << av_make_error_string(strBuf, sizeof(strBuf), AVERROR(ret));
             }
-            d->packetProcessed.wakeOne();
+            lock.relock();
+            d->inputQueue.dequeue();
+            d->packetProcessed.wakeAll();
         }
     }
 
@@ -329,11 +378,12 @@ namespace AVQt {
 
     void VideoDecoderPrivate::enqueueData(const std::shared_ptr<AVPacket> &packet) {
         QMutexLocker lock(&inputQueueMutex);
-        if (inputQueue.size() > 32) {
-            packetProcessed.wait(&inputQueueMutex);
-            if (inputQueue.size() > 32) {
+        const auto maxQueueSize = std::max(config.latency.decoderQueueSize, 1);
+        while (inputQueue.size() >= maxQueueSize) {
+            if (!running) {
                 return;
             }
+            packetProcessed.wait(&inputQueueMutex);
         }
         inputQueue.enqueue(packet);
         packetAvailable.wakeOne();
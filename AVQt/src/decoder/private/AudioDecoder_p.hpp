@@ -6,6 +6,7 @@
 
 #include <QObject>
 
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 #include <queue>
@@ -37,6 +38,8 @@ namespace AVQt {
         std::mutex inputQueueMutex;
         std::condition_variable inputQueueCond;
         std::queue<std::shared_ptr<AVPacket>> inputQueue;
+        // Wait before sending a packet again, that a full decoder rejected without returning a frame
+        static constexpr std::chrono::milliseconds decoderRetryInterval{5};
 
         std::mutex pausedMutex;
         std::condition_variable pausedCond;
@@ -3,8 +3,6 @@
 
 #include <QMutex>
 #include <QObject>
-#include <QThread>
-#include <QWaitCondition>
 
 #include <memory>
 
@@ -24,26 +22,14 @@ namespace AVQt {
         static AVPixelFormat getFormat(AVCodecContext *ctx, const AVPixelFormat *fmt);
 
     private:
-        class FrameFetcher : public QThread {
-        public:
-            explicit FrameFetcher(MediaCodecDecoderImplPrivate *parent);
-            void start();
-            void stop();
-
-        protected:
-            void run() override;
-
-        private:
-            MediaCodecDecoderImplPrivate *p;
-            std::atomic_bool running{false};
-        };
-
         explicit MediaCodecDecoderImplPrivate(MediaCodecDecoderImpl *q) : q_ptr(q) {}
         MediaCodecDecoderImpl *q_ptr;
 
         void init();
 
         QMutex codecMutex{};
+        // Guarded by codecMutex
+        VideoDecodeMode decodeMode{};
 
         AVCodecID codecId{AV_CODEC_ID_NONE};
         const AVCodec *codec{nullptr};
@@ -52,11 +38,7 @@ namespace AVQt {
         std::shared_ptr<AVBufferRef> hwDeviceContext{nullptr, &destroyAVBufferRef};
         std::shared_ptr<AVBufferRef> hwFramesContext{nullptr, &destroyAVBufferRef};
 
-        std::unique_ptr<FrameFetcher> frameFetcher{};
-
         std::atomic_bool open{false};
-        std::atomic_bool firstFrame{true};
-        QWaitCondition firstFrameCond{};
     };
 }// namespace AVQt
 
@@ -6,7 +6,6 @@
 #define LIBAVQT_QSVDECODERIMPL_P_HPP
 
 #include <QMutex>
-#include <QThread>
 #include <memory>
 
 extern "C" {
@@ -27,32 +26,19 @@ namespace AVQt {
         explicit QSVDecoderImplPrivate(QSVDecoderImpl *q) : q_ptr(q) {}
         QSVDecoderImpl *q_ptr;
 
-        class FrameFetcher : public QThread {
-        public:
-            explicit FrameFetcher(QSVDecoderImplPrivate *d);
-            ~FrameFetcher() override;
-
-            void run() override;
-            void stop();
-
-        private:
-            QSVDecoderImplPrivate *p;
-            std::atomic_bool m_stop{false};
-        };
-
         AVCodecID codecId{};
         const AVCodec *pCodec{};
         std::shared_ptr<AVCodecParameters> codecParams{};
 
         QMutex codecMutex{};
+        // Guarded by codecMutex
+        VideoDecodeMode decodeMode{};
         std::shared_ptr<AVCodecContext> codecContext{nullptr, &destroyAVCodecContext};
 
         std::shared_ptr<AVBufferRef> hwDeviceContext{nullptr, &destroyAVBufferRef};
         std::shared_ptr<AVBufferRef> hwFramesContext{nullptr, &destroyAVBufferRef};
 
-        std::atomic_bool open{false}, firstFrame{true};
-
-        std::unique_ptr<FrameFetcher> frameFetcher{};
+        std::atomic_bool open{false};
     };
 }// namespace AVQt
 
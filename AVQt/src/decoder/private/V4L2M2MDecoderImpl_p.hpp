@@ -9,8 +9,6 @@
 
 #include <QMutex>
 #include <QObject>
-#include <QThread>
-#include <QWaitCondition>
 
 extern "C" {
 #include <libavcodec/avcodec.h>
@@ -21,20 +19,6 @@ namespace AVQt {
     class V4L2M2MDecoderImplPrivate {
         Q_DECLARE_PUBLIC(V4L2M2MDecoderImpl)
     protected:
-        class FrameFetcher : public QThread {
-        public:
-            explicit FrameFetcher(V4L2M2MDecoderImplPrivate *parent);
-            void start();
-            void stop();
-
-        protected:
-            void run() override;
-
-        private:
-            V4L2M2MDecoderImplPrivate *p;
-            std::atomic_bool running{false};
-        };
-
         explicit V4L2M2MDecoderImplPrivate(V4L2M2MDecoderImpl *q) : q_ptr(q) {}
 
         void init();
@@ -48,6 +32,8 @@ namespace AVQt {
         V4L2M2MDecoderImpl *q_ptr;
 
         QMutex codecMutex{};
+        // Guarded by codecMutex
+        VideoDecodeMode decodeMode{};
 
         AVCodecID codecId{AV_CODEC_ID_NONE};
         const AVCodec *codec{nullptr};
@@ -56,11 +42,7 @@ namespace AVQt {
         std::shared_ptr<AVBufferRef> hwDeviceContext{nullptr, &destroyAVBufferRef};
         std::shared_ptr<AVBufferRef> hwFramesContext{nullptr, &destroyAVBufferRef};
 
-        std::unique_ptr<FrameFetcher> frameFetcher{};
-
         std::atomic_bool open{false};
-        std::atomic_bool firstFrame{true};
-        QWaitCondition firstFrameCond{};
     };
 }// namespace AVQt
 
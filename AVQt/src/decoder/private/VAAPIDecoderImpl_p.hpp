@@ -25,7 +25,6 @@
 
 #include <QMutex>
 #include <QQueue>
-#include <QThread>
 #include <QtGlobal>
 
 extern "C" {
@@ -46,21 +45,6 @@ namespace AVQt {
 
         static AVPixelFormat getFormat(AVCodecContext *ctx, const AVPixelFormat *pix_fmts);
 
-        class FrameFetcher : public QThread {
-        public:
-            explicit FrameFetcher(VAAPIDecoderImplPrivate *p);
-
-            void run() override;
-
-            void start();
-
-            void stop();
-
-        private:
-            VAAPIDecoderImplPrivate *p;
-            std::atomic_bool m_stop{false};
-        };
-
         VAAPIDecoderImpl *q_ptr;
 
         std::shared_ptr<AVCodecParameters> codecParams{nullptr};
@@ -72,11 +56,12 @@ namespace AVQt {
 
         QMutex decodedFramesMutex{};
         QQueue<std::shared_ptr<AVFrame>> decodedFrames{};
-        std::unique_ptr<FrameFetcher> frameFetcher{nullptr};
         std::shared_ptr<internal::FrameDestructor> frameDestructor{};
 
         QMutex codecMutex;
-        std::atomic_bool initialized{false}, firstFrame{true};
+        // Guarded by codecMutex
+        VideoDecodeMode decodeMode{};
+        std::atomic_bool initialized{false};
 
         friend class VAAPIDecoderImpl;
     };
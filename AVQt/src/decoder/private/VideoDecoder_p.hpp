@@ -69,9 +69,13 @@ namespace AVQt {
 
         QMutex inputQueueMutex{};
         QWaitCondition packetProcessed{}, packetAvailable{};
+        // Wait before sending a packet again, that a full decoder rejected without returning a frame, in ms
+        static constexpr unsigned long decoderRetryInterval{5};
         QQueue<std::shared_ptr<AVPacket>> inputQueue{};
 
         VideoDecoder::Config config{};
+        // Guards config.decodeMode and switching it on impl
+        mutable QMutex decodeModeMutex{};
 
         std::shared_ptr<AVCodecParameters> codecParams{};
         std::shared_ptr<api::IVideoDecoderImpl> impl{};
@@ -101,14 +101,15 @@ namespace AVQt {
                         break;
                     case communication::Message::Action::RESET: {
                         if (d->open) {
-                            std::unique_lock lock{d->inputQueueMutex};
-                            d->inputQueueCond.wait(lock, [d] { return d->inputQueue.empty() || !d->running; });
-                            d->impl->close();
-                            pgraph::impl::SimpleProcessor::produce(communication::Message::builder().withAction(communication::Message::Action::RESET).build(), d->outputPadId);
-                            if (!d->impl->open(d->inputParams)) {
-                                qWarning("AudioEncoder: Failed to open");
-                                close();
+                            {
+                                std::unique_lock lock{d->inputQueueMutex};
+                                // While paused, the queued frames are encoded after the flush
+                                d->inputQueueCond.wait(lock, [d] { return ((d->inputQueue.empty() || d->paused) && !d->encoding) || !d->running; });
                             }
+                            // The timestamps continue, so the samples left in the rechunker are prepended to the next frames instead of padded
+                            d->impl->flush();
+                            d->timestampStitcher.restart();
+                            pgraph::impl::SimpleProcessor::produce(communication::Message::builder().withAction(communication::Message::Action::RESET).build(), d->outputPadId);
                         }
                         break;
                     }
@@ -146,6 +147,13 @@ namespace AVQt {
                 return false;
             }
 
+            if (!d->initRechunker()) {
+                d->impl->close();
+                d->impl.reset();
+                d->open = false;
+                return false;
+            }
+
             connect(std::dynamic_pointer_cast<QObject>(d->impl).get(), SIGNAL(packetReady(std::shared_ptr<AVPacket>)),
                     this, SLOT(onPacketReady(std::shared_ptr<AVPacket>)), Qt::DirectConnection);
 
@@ -183,6 +191,12 @@ namespace AVQt {
                                                            .withAction(communication::Message::Action::CLEANUP)
                                                            .build(),
                                                    d->outputPadId);
+            {
+                std::lock_guard rechunkerLock(d->rechunkerMutex);
+                d->drainRechunker(true);
+                d->pendingChunk.reset();
+                d->rechunker.reset();
+            }
             d->impl->close();
             d->codecParams.reset();
         } else {
@@ -302,6 +316,7 @@ namespace AVQt {
             }
 
             auto frame = d->inputQueue.front();
+            d->encoding = true;
             lock.unlock();
 
             if (d->inputParams.format.sampleFormat() != frame->format ||
@@ -309,19 +324,20 @@ namespace AVQt {
                 d->inputParams.format.channelLayout() != frame->channel_layout ||
                 d->inputParams.format.channels() != frame->channels) {
                 qWarning("AudioEncoder: Input format mismatch");
-                continue;
-            }
-
-            int ret = d->impl->encode(frame);
-            if (ret != EXIT_SUCCESS && ret != EAGAIN && ret < 0) {
-                char strBuf[AV_ERROR_MAX_STRING_SIZE];
-                qWarning("AudioEncoder: Failed to encode frame: %s", av_make_error_string(strBuf, sizeof(strBuf), AVERROR(ret)));
             } else {
-                lock.lock();
-                d->inputQueue.pop();
-                d->inputQueueCond.notify_all();
-                lock.unlock();
+                int ret = d->encode(frame);
+                if (ret != EXIT_SUCCESS) {
+                    char strBuf[AV_ERROR_MAX_STRING_SIZE];
+                    qWarning("AudioEncoder: Failed to encode frame: %s", av_make_error_string(strBuf, sizeof(strBuf), AVERROR(ret)));
+                }
             }
+
+            // Frames that could not be encoded are dropped, retrying them immediately would only spin
+            lock.lock();
+            d->inputQueue.pop();
+            d->encoding = false;
+            d->inputQueueCond.notify_all();
+            lock.unlock();
         }
     }
 
@@ -337,6 +353,10 @@ namespace AVQt {
     void AudioEncoderPrivate::enqueueData(std::shared_ptr<AVFrame> frame) {
         Q_Q(AudioEncoder);
 
+        if (frame && frame->sample_rate > 0) {
+            frame = timestampStitcher.stitch(frame, av_rescale(frame->nb_samples, 1000000, frame->sample_rate));
+        }
+
         std::unique_lock lock(inputQueueMutex);
         if (inputQueue.size() >= inputQueueMaxSize) {
             inputQueueCond.notify_all();
@@ -350,4 +370,58 @@ namespace AVQt {
         inputQueue.push(std::move(frame));
         inputQueueCond.notify_all();
     }
+
+    bool AudioEncoderPrivate::initRechunker() {
+        const auto frameSize = impl->getFrameSize();
+        if (frameSize <= 0) {
+            rechunker.reset();
+            return true;
+        }
+
+        const auto &format = inputParams.format;
+        const auto channelLayout = format.channelLayout() < 0 ? av_get_default_channel_layout(format.channels()) : static_cast<int64_t>(format.channelLayout());
+        rechunker = std::make_unique<internal::AudioRechunker>(format.sampleFormat(), format.sampleRate(), format.channels(), static_cast<uint64_t>(channelLayout), frameSize);
+        if (!rechunker->isValid()) {
+            qWarning("AudioEncoder: Failed to create rechunker for frame size %d", frameSize);
+            rechunker.reset();
+            return false;
+        }
+        return true;
+    }
+
+    int AudioEncoderPrivate::encode(const std::shared_ptr<AVFrame> &frame) {
+        std::lock_guard lock(rechunkerMutex);
+        if (!rechunker) {
+            return impl->encode(frame);
+        }
+
+        if (!rechunker->push(frame)) {
+            return ENOMEM;
+        }
+        drainRechunker(false);
+        return EXIT_SUCCESS;
+    }
+
+    void AudioEncoderPrivate::drainRechunker(bool flush) {
+        if (!rechunker) {
+            return;
+        }
+
+        // The samples already left the fifo, so a chunk the encoder doesn't accept is kept and sent before all later ones
+        while (pendingChunk || (pendingChunk = rechunker->pop(flush))) {
+            int ret = impl->encode(pendingChunk);
+            if (ret == EAGAIN) {
+                // The impl already received its pending packets before giving up, so the chunk is retried with the next input
+                break;
+            } else if (ret != EXIT_SUCCESS) {
+                char strBuf[AV_ERROR_MAX_STRING_SIZE];
+                qWarning("AudioEncoder: Failed to encode frame: %s", av_make_error_string(strBuf, sizeof(strBuf), AVERROR(ret)));
+            }
+            pendingChunk.reset();
+        }
+
+        if (flush && pendingChunk) {
+            qWarning("AudioEncoder: Encoder didn't accept the last %d samples, dropping them", pendingChunk->nb_samples);
+        }
+    }
 }// namespace AVQt
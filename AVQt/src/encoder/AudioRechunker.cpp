@@ -0,0 +1,169 @@
+#include "AudioRechunker.hpp"
+
+#include <QtGlobal>
+
+#include <algorithm>
+#include <cstdlib>
+
+extern "C" {
+#include <libavutil/mathematics.h>
+#include <libavutil/samplefmt.h>
+}
+
+namespace AVQt::internal {
+    AudioRechunker::AudioRechunker(AVSampleFormat sampleFormat, int sampleRate, int channels, uint64_t channelLayout, int frameSize)
+        : m_sampleFormat(sampleFormat),
+          m_sampleRate(sampleRate),
+          m_channels(channels),
+          m_channelLayout(channelLayout),
+          m_frameSize(frameSize) {
+        if (frameSize <= 0 || sampleRate <= 0 || channels <= 0) {
+            qWarning("AudioRechunker: Invalid parameters, frame size %d, sample rate %d, channels %d", frameSize, sampleRate, channels);
+            return;
+        }
+
+        // The fifo grows on demand, two frames cover the usual case of input frames smaller than the encoder frame size
+        m_fifo.reset(av_audio_fifo_alloc(sampleFormat, channels, 2 * frameSize));
+        if (!m_fifo) {
+            qWarning("AudioRechunker: Failed to allocate audio fifo");
+            return;
+        }
+
+        const bool planar = av_sample_fmt_is_planar(sampleFormat);
+        const auto planeSize = av_samples_get_buffer_size(&m_linesize, planar ? 1 : channels, frameSize, sampleFormat, 0);
+        if (planeSize < 0) {
+            qWarning("AudioRechunker: Invalid sample format %d", sampleFormat);
+            m_fifo.reset();
+            return;
+        }
+        m_bufferPool.reset(av_buffer_pool_init(planeSize, nullptr));
+    }
+
+    bool AudioRechunker::isValid() const {
+        return m_fifo && m_bufferPool;
+    }
+
+    int AudioRechunker::frameSize() const {
+        return m_frameSize;
+    }
+
+    int AudioRechunker::bufferedSamples() const {
+        return m_fifo ? av_audio_fifo_size(m_fifo.get()) : 0;
+    }
+
+    bool AudioRechunker::push(const std::shared_ptr<AVFrame> &frame) {
+        if (!isValid()) {
+            return false;
+        }
+        if (!frame || frame->nb_samples <= 0) {
+            return true;
+        }
+
+        if (frame->pts != AV_NOPTS_VALUE) {
+            // Timestamp the first buffered sample would have according to this frame
+            const auto frontPts = frame->pts - samplesToDuration(bufferedSamples());
+            const auto expectedPts = m_basePts + samplesToDuration(m_samplesSinceBase);
+            if (m_basePts == AV_NOPTS_VALUE || std::abs(frontPts - expectedPts) > samplesToDuration(m_frameSize)) {
+                m_basePts = frontPts;
+                m_samplesSinceBase = 0;
+            }
+        }
+
+        const auto written = av_audio_fifo_write(m_fifo.get(), reinterpret_cast<void **>(frame->extended_data), frame->nb_samples);
+        if (written < frame->nb_samples) {
+            qWarning("AudioRechunker: Failed to buffer %d samples", frame->nb_samples);
+            return false;
+        }
+        return true;
+    }
+
+    std::shared_ptr<AVFrame> AudioRechunker::pop(bool flush) {
+        const auto buffered = bufferedSamples();
+        if (buffered == 0 || (buffered < m_frameSize && !flush)) {
+            return {};
+        }
+
+        auto frame = allocateFrame();
+        if (!frame) {
+            qWarning("AudioRechunker: Failed to allocate frame");
+            return {};
+        }
+
+        const auto read = av_audio_fifo_read(m_fifo.get(), reinterpret_cast<void **>(frame->extended_data), std::min(buffered, m_frameSize));
+        if (read < 0) {
+            qWarning("AudioRechunker: Failed to read from audio fifo");
+            return {};
+        }
+        if (read < m_frameSize) {
+            av_samples_set_silence(frame->extended_data, read, m_frameSize - read, m_channels, m_sampleFormat);
+        }
+
+        frame->pts = m_basePts == AV_NOPTS_VALUE ? AV_NOPTS_VALUE : m_basePts + samplesToDuration(m_samplesSinceBase);
+        m_samplesSinceBase += read;
+        return frame;
+    }
+
+    void AudioRechunker::clear() {
+        if (m_fifo) {
+            av_audio_fifo_reset(m_fifo.get());
+        }
+        m_basePts = AV_NOPTS_VALUE;
+        m_samplesSinceBase = 0;
+    }
+
+    int64_t AudioRechunker::samplesToDuration(int64_t samples) const {
+        return av_rescale(samples, 1000000, m_sampleRate);
+    }
+
+    std::shared_ptr<AVFrame> AudioRechunker::allocateFrame() {
+        const bool planar = av_sample_fmt_is_planar(m_sampleFormat);
+        const int planes = planar ? m_channels : 1;
+
+        std::shared_ptr<AVFrame> frame{av_frame_alloc(), &destroyAVFrame};
+        if (!frame) {
+            return {};
+        }
+        frame->format = m_sampleFormat;
+        frame->sample_rate = m_sampleRate;
+        frame->channels = m_channels;
+        frame->channel_layout = m_channelLayout;
+        frame->nb_samples = m_frameSize;
+
+        if (planes > AV_NUM_DATA_POINTERS) {
+            // Would need extended_buf, which isn't worth pooling for such exotic layouts
+            if (av_frame_get_buffer(frame.get(), 0) < 0) {
+                return {};
+            }
+            return frame;
+        }
+
+        for (int plane = 0; plane < planes; ++plane) {
+            frame->buf[plane] = av_buffer_pool_get(m_bufferPool.get());
+            if (!frame->buf[plane]) {
+                return {};
+            }
+            frame->data[plane] = frame->buf[plane]->data;
+        }
+        frame->extended_data = frame->data;
+        frame->linesize[0] = m_linesize;
+        return frame;
+    }
+
+    void AudioRechunker::destroyAVAudioFifo(AVAudioFifo *fifo) {
+        if (fifo) {
+            av_audio_fifo_free(fifo);
+        }
+    }
+
+    void AudioRechunker::destroyAVBufferPool(AVBufferPool *bufferPool) {
+        if (bufferPool) {
+            av_buffer_pool_uninit(&bufferPool);
+        }
+    }
+
+    void AudioRechunker::destroyAVFrame(AVFrame *frame) {
+        if (frame) {
+            av_frame_free(&frame);
+        }
+    }
+}// namespace AVQt::internal
@@ -0,0 +1,75 @@
+#ifndef LIBAVQT_AUDIORECHUNKER_HPP
+#define LIBAVQT_AUDIORECHUNKER_HPP
+
+#include <memory>
+
+extern "C" {
+#include <libavutil/audio_fifo.h>
+#include <libavutil/buffer.h>
+#include <libavutil/frame.h>
+}
+
+namespace AVQt::internal {
+    /**
+     * @brief Splits and merges audio frames into frames of exactly frameSize samples, as fixed frame size encoders expect them.
+     *
+     * Samples are buffered in an AVAudioFifo, output frames are backed by pooled buffers.
+     * Timestamps are in microseconds and derived from the sample count since the last input timestamp,
+     * so they don't drift when frameSize isn't a multiple of the input frame size.
+     * Not thread-safe, push() and pop() have to be called from the same thread.
+     */
+    class AudioRechunker {
+    public:
+        AudioRechunker(AVSampleFormat sampleFormat, int sampleRate, int channels, uint64_t channelLayout, int frameSize);
+
+        AudioRechunker(const AudioRechunker &) = delete;
+        AudioRechunker &operator=(const AudioRechunker &) = delete;
+
+        [[nodiscard]] bool isValid() const;
+        [[nodiscard]] int frameSize() const;
+        [[nodiscard]] int bufferedSamples() const;
+
+        /**
+         * @brief Appends the samples of frame. The timestamp of the frame resynchronizes the output timestamps,
+         * if it deviates from the expected one by more than one output frame.
+         * @return false, if the samples couldn't be buffered
+         */
+        bool push(const std::shared_ptr<AVFrame> &frame);
+
+        /**
+         * @brief Takes the next frame of frameSize samples.
+         * @param flush If true, remaining samples are returned as well, padded with silence to frameSize
+         * @return the frame, or nullptr if not enough samples are buffered
+         */
+        std::shared_ptr<AVFrame> pop(bool flush = false);
+
+        /**
+         * @brief Discards all buffered samples and the timestamp base
+         */
+        void clear();
+
+    private:
+        static void destroyAVAudioFifo(AVAudioFifo *fifo);
+        static void destroyAVBufferPool(AVBufferPool *bufferPool);
+        static void destroyAVFrame(AVFrame *frame);
+
+        [[nodiscard]] int64_t samplesToDuration(int64_t samples) const;
+        std::shared_ptr<AVFrame> allocateFrame();
+
+        AVSampleFormat m_sampleFormat;
+        int m_sampleRate, m_channels;
+        uint64_t m_channelLayout;
+        int m_frameSize;
+        int m_linesize{0};
+
+        std::unique_ptr<AVAudioFifo, decltype(&destroyAVAudioFifo)> m_fifo{nullptr, &destroyAVAudioFifo};
+        std::unique_ptr<AVBufferPool, decltype(&destroyAVBufferPool)> m_bufferPool{nullptr, &destroyAVBufferPool};
+
+        // Timestamp of the first buffered sample is m_basePts + duration of m_samplesSinceBase
+        int64_t m_basePts{AV_NOPTS_VALUE};
+        int64_t m_samplesSinceBase{0};
+    };
+}// namespace AVQt::internal
+
+
+#endif//LIBAVQT_AUDIORECHUNKER_HPP
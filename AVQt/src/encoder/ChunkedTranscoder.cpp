@@ -0,0 +1,651 @@
+#include "encoder/ChunkedTranscoder.hpp"
+#include "private/ChunkedTranscoder_p.hpp"
+
+#include "communication/Message.hpp"
+#include "global.hpp"
+
+#include <pgraph/impl/SimplePadFactory.hpp>
+#include <pgraph_network/impl/RegisteringPadFactory.hpp>
+
+#include <algorithm>
+
+namespace AVQt {
+    ChunkedTranscoder::ChunkedTranscoder(const Config &config, std::shared_ptr<pgraph::network::api::PadRegistry> padRegistry, QObject *parent)
+        : QThread(parent),
+          pgraph::impl::SimpleProducer(pgraph::network::impl::RegisteringPadFactory::factoryFor(padRegistry)),
+          d_ptr(new ChunkedTranscoderPrivate(this)) {
+        Q_D(ChunkedTranscoder);
+        d->config = config;
+    }
+
+    ChunkedTranscoder::ChunkedTranscoder(const Config &config, QObject *parent)
+        : QThread(parent),
+          pgraph::impl::SimpleProducer(pgraph::impl::SimplePadFactory::getInstance()),
+          d_ptr(new ChunkedTranscoderPrivate(this)) {
+        Q_D(ChunkedTranscoder);
+        d->config = config;
+    }
+
+    ChunkedTranscoder::~ChunkedTranscoder() {
+        Q_D(ChunkedTranscoder);
+        if (d->open) {
+            ChunkedTranscoder::close();
+        }
+    }
+
+    bool ChunkedTranscoder::init() {
+        Q_D(ChunkedTranscoder);
+
+        bool shouldBe = false;
+        if (d->initialized.compare_exchange_strong(shouldBe, true)) {
+            d->workerPool.setMaxThreadCount(d->config.maxParallelChunks > 0 ? d->config.maxParallelChunks : QThread::idealThreadCount());
+
+            d->outputPadParams = std::make_shared<communication::PacketPadParams>();
+            d->outputPadId = pgraph::impl::SimpleProducer::createOutputPad(d->outputPadParams);
+            if (d->outputPadId == pgraph::api::INVALID_PAD_ID) {
+                qWarning() << "ChunkedTranscoder: failed to create output pad";
+                d->initialized = false;
+                return false;
+            }
+            return true;
+        } else {
+            qWarning() << "ChunkedTranscoder::init() called multiple times";
+            return false;
+        }
+    }
+
+    bool ChunkedTranscoder::isOpen() const {
+        Q_D(const ChunkedTranscoder);
+        return d->open;
+    }
+
+    bool ChunkedTranscoder::isRunning() const {
+        Q_D(const ChunkedTranscoder);
+        return d->running;
+    }
+
+    bool ChunkedTranscoder::isPaused() const {
+        Q_D(const ChunkedTranscoder);
+        return d->paused;
+    }
+
+    int64_t ChunkedTranscoder::getOutputPadId() const {
+        Q_D(const ChunkedTranscoder);
+        return d->outputPadId;
+    }
+
+    size_t ChunkedTranscoder::chunkCount() const {
+        Q_D(const ChunkedTranscoder);
+        std::unique_lock lock(d->chunkMutex);
+        return d->chunks.size();
+    }
+
+    bool ChunkedTranscoder::open() {
+        Q_D(ChunkedTranscoder);
+
+        if (!d->initialized) {
+            qWarning() << "ChunkedTranscoder::open() called before init()";
+            return false;
+        }
+
+        bool shouldBe = false;
+        if (d->open.compare_exchange_strong(shouldBe, true)) {
+            if (!d->config.encoderName.isEmpty()) {
+                d->encoder = avcodec_find_encoder_by_name(qPrintable(d->config.encoderName));
+            } else {
+                d->encoder = avcodec_find_encoder(getVideoCodecId(d->config.codec));
+            }
+            if (!d->encoder) {
+                qWarning() << "ChunkedTranscoder: encoder not found" << d->config.encoderName;
+                d->open = false;
+                return false;
+            }
+
+            if (!d->buildChunks()) {
+                d->open = false;
+                return false;
+            }
+
+            // Every chunk is encoded with the same settings, so the parameters of a probe encoder apply to all of them
+            auto encoderContext = d->openEncoder();
+            if (!encoderContext) {
+                std::unique_lock lock(d->chunkMutex);
+                d->chunks.clear();
+                d->open = false;
+                return false;
+            }
+            d->outputPadParams->codec = d->encoder;
+            d->outputPadParams->mediaType = AVMEDIA_TYPE_VIDEO;
+            d->outputPadParams->codecParams = std::shared_ptr<AVCodecParameters>(avcodec_parameters_alloc(), [](AVCodecParameters *p) {
+                avcodec_parameters_free(&p);
+            });
+            avcodec_parameters_from_context(d->outputPadParams->codecParams.get(), encoderContext.get());
+
+            qDebug("ChunkedTranscoder: %zu chunks, %d in parallel", d->chunks.size(), d->workerPool.maxThreadCount());
+
+            produce(communication::Message::builder()
+                            .withAction(communication::Message::Action::INIT)
+                            .withPayload("packetParams", QVariant::fromValue(std::const_pointer_cast<const communication::PacketPadParams>(d->outputPadParams)))
+                            .withPayload("encodeParams", QVariant::fromValue(d->config.encodeParameters))
+                            .build(),
+                    d->outputPadId);
+            return true;
+        } else {
+            qWarning() << "ChunkedTranscoder::open() called multiple times";
+            return false;
+        }
+    }
+
+    void ChunkedTranscoder::close() {
+        Q_D(ChunkedTranscoder);
+
+        if (d->running) {
+            stop();
+        }
+
+        bool shouldBe = true;
+        if (d->open.compare_exchange_strong(shouldBe, false)) {
+            produce(communication::Message::builder().withAction(communication::Message::Action::CLEANUP).build(), d->outputPadId);
+            std::unique_lock lock(d->chunkMutex);
+            d->chunks.clear();
+        } else {
+            qWarning() << "ChunkedTranscoder::close() called multiple times";
+        }
+    }
+
+    bool ChunkedTranscoder::start() {
+        Q_D(ChunkedTranscoder);
+
+        if (!d->open) {
+            qWarning() << "ChunkedTranscoder::start() called before open()";
+            return false;
+        }
+
+        bool shouldBe = false;
+        if (d->running.compare_exchange_strong(shouldBe, true)) {
+            d->paused = false;
+            {
+                std::unique_lock lock(d->chunkMutex);
+                for (auto &chunk : d->chunks) {
+                    chunk.packets.clear();
+                    chunk.finished = false;
+                    chunk.failed = false;
+                }
+                d->nextChunkToSubmit = 0;
+                d->nextChunkToProduce = 0;
+            }
+            produce(communication::Message::builder().withAction(communication::Message::Action::START).build(), d->outputPadId);
+            QThread::start();
+            return true;
+        } else {
+            qWarning() << "ChunkedTranscoder::start() called multiple times";
+            return false;
+        }
+    }
+
+    void ChunkedTranscoder::stop() {
+        Q_D(ChunkedTranscoder);
+
+        bool shouldBe = true;
+        if (d->running.compare_exchange_strong(shouldBe, false)) {
+            {
+                std::unique_lock lock(d->chunkMutex);
+                d->paused = false;
+                d->chunkCond.notify_all();
+            }
+            QThread::quit();
+            QThread::wait();
+            // Workers abort their chunks, once running is cleared
+            d->workerPool.waitForDone();
+            produce(communication::Message::builder().withAction(communication::Message::Action::STOP).build(), d->outputPadId);
+            emit stopped();
+        } else {
+            qWarning() << "ChunkedTranscoder::stop() called multiple times";
+        }
+    }
+
+    void ChunkedTranscoder::pause(bool state) {
+        Q_D(ChunkedTranscoder);
+
+        bool shouldBe = !state;
+        if (d->paused.compare_exchange_strong(shouldBe, state)) {
+            produce(communication::Message::builder()
+                            .withAction(communication::Message::Action::PAUSE)
+                            .withPayload("state", state)
+                            .build(),
+                    d->outputPadId);
+            {
+                // Wakes the producing thread, which waits for the resume on chunkCond
+                std::unique_lock lock(d->chunkMutex);
+                d->chunkCond.notify_all();
+            }
+            emit paused(state);
+        } else {
+            qDebug() << "ChunkedTranscoder::pause: state already" << state;
+        }
+    }
+
+    void ChunkedTranscoder::run() {
+        Q_D(ChunkedTranscoder);
+
+        emit started();
+
+        {
+            std::unique_lock lock(d->chunkMutex);
+            d->submitChunks();
+        }
+
+        while (d->running) {
+            std::unique_lock lock(d->chunkMutex);
+            if (d->nextChunkToProduce >= d->chunks.size()) {
+                break;
+            }
+            d->chunkCond.wait(lock, [d] { return d->chunks[d->nextChunkToProduce].finished || !d->running; });
+            if (!d->running) {
+                break;
+            }
+
+            const auto index = d->nextChunkToProduce++;
+            const auto count = d->chunks.size();
+            auto &chunk = d->chunks[index];
+            const bool failed = chunk.failed;
+            auto packets = std::move(chunk.packets);
+            chunk.packets.clear();
+            d->submitChunks();
+            lock.unlock();
+
+            if (failed) {
+                // Concatenating the remaining chunks would leave a gap in the output, so the stream ends here.
+                // stop() can't be called from this thread, it waits for it
+                qWarning("ChunkedTranscoder: chunk %zu failed, aborting", index);
+                emit chunkFailed(index);
+                bool shouldBe = true;
+                if (d->running.compare_exchange_strong(shouldBe, false)) {
+                    // Workers abort their chunks, once running is cleared
+                    d->workerPool.waitForDone();
+                    produce(communication::Message::builder().withAction(communication::Message::Action::STOP).build(), d->outputPadId);
+                    emit stopped();
+                }
+                break;
+            }
+
+            for (const auto &packet : packets) {
+                if (d->paused) {
+                    std::unique_lock pausedLock(d->chunkMutex);
+                    d->chunkCond.wait(pausedLock, [d] { return !d->paused || !d->running; });
+                }
+                if (!d->running) {
+                    break;
+                }
+                produce(communication::Message::builder()
+                                .withAction(communication::Message::Action::DATA)
+                                .withPayload("packet", QVariant::fromValue(packet))
+                                .build(),
+                        d->outputPadId);
+            }
+            emit chunkFinished(index, count);
+        }
+    }
+
+    ChunkedTranscoderPrivate::ChunkedTranscoderPrivate(ChunkedTranscoder *q) : q_ptr(q) {}
+
+    ChunkedTranscoderPrivate::FormatContextPtr ChunkedTranscoderPrivate::openInput() const {
+        char strBuf[AV_ERROR_MAX_STRING_SIZE];
+
+        AVFormatContext *formatContext = nullptr;
+        int ret = avformat_open_input(&formatContext, config.inputPath.toLocal8Bit().constData(), nullptr, nullptr);
+        if (ret < 0) {
+            qWarning() << "ChunkedTranscoder: failed to open" << config.inputPath << ":" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+            return {nullptr, &destroyAVFormatContext};
+        }
+        FormatContextPtr result{formatContext, &destroyAVFormatContext};
+
+        ret = avformat_find_stream_info(result.get(), nullptr);
+        if (ret < 0) {
+            qWarning() << "ChunkedTranscoder: failed to find stream info:" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+            return {nullptr, &destroyAVFormatContext};
+        }
+        return result;
+    }
+
+    bool ChunkedTranscoderPrivate::buildChunks() {
+        auto input = openInput();
+        if (!input) {
+            return false;
+        }
+
+        videoStreamIndex = av_find_best_stream(input.get(), AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+        if (videoStreamIndex < 0) {
+            qWarning() << "ChunkedTranscoder: no video stream in" << config.inputPath;
+            return false;
+        }
+        for (unsigned int i = 0; i < input->nb_streams; ++i) {
+            if (static_cast<int>(i) != videoStreamIndex) {
+                input->streams[i]->discard = AVDISCARD_ALL;
+            }
+        }
+
+        auto *stream = input->streams[videoStreamIndex];
+        width = stream->codecpar->width;
+        height = stream->codecpar->height;
+        frameRate = av_guess_frame_rate(input.get(), stream, nullptr);
+
+        encoderFormat = static_cast<AVPixelFormat>(stream->codecpar->format);
+        if (encoder->pix_fmts) {
+            bool supported = false;
+            for (auto *format = encoder->pix_fmts; *format != AV_PIX_FMT_NONE; ++format) {
+                supported |= *format == encoderFormat;
+            }
+            if (!supported) {
+                encoderFormat = encoder->pix_fmts[0];
+            }
+        }
+
+        // Only the packet headers are read, nothing is decoded
+        std::vector<int64_t> keyframes{};
+        std::unique_ptr<AVPacket, decltype(&destroyAVPacket)> packet{av_packet_alloc(), &destroyAVPacket};
+        while (av_read_frame(input.get(), packet.get()) >= 0) {
+            if (packet->stream_index == videoStreamIndex && (packet->flags & AV_PKT_FLAG_KEY)) {
+                const auto timestamp = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+                if (timestamp != AV_NOPTS_VALUE) {
+                    keyframes.push_back(av_rescale_q(timestamp, stream->time_base, {1, 1000000}));
+                }
+            }
+            av_packet_unref(packet.get());
+        }
+        if (keyframes.empty()) {
+            qWarning() << "ChunkedTranscoder: no keyframes found in" << config.inputPath;
+            return false;
+        }
+        std::sort(keyframes.begin(), keyframes.end());
+
+        std::unique_lock lock(chunkMutex);
+        chunks.clear();
+        startTime = keyframes.front();
+        Chunk chunk{};
+        chunk.start = keyframes.front();
+        for (const auto &keyframe : keyframes) {
+            if (keyframe - chunk.start >= config.chunkDuration) {
+                chunk.end = keyframe;
+                chunks.push_back(chunk);
+                chunk = Chunk{};
+                chunk.start = keyframe;
+            }
+        }
+        chunks.push_back(chunk);
+        return true;
+    }
+
+    ChunkedTranscoderPrivate::CodecContextPtr ChunkedTranscoderPrivate::openEncoder() const {
+        CodecContextPtr context{avcodec_alloc_context3(encoder), &destroyAVCodecContext};
+        if (!context) {
+            qWarning() << "ChunkedTranscoder: failed to allocate encoder context";
+            return context;
+        }
+
+        context->width = width;
+        context->height = height;
+        context->pix_fmt = encoderFormat;
+        context->time_base = {1, 1000000};// microseconds
+        context->framerate = frameRate;
+        if (config.encodeParameters.bitrate > 0) {
+            context->bit_rate = config.encodeParameters.bitrate;
+        }
+        if (config.encodeParameters.gopSize > 0) {
+            context->gop_size = config.encodeParameters.gopSize;
+        }
+        // The Muxer derives timestamps from packet durations, reordering must not cross chunk boundaries
+        context->max_b_frames = 0;
+        context->flags |= AV_CODEC_FLAG_GLOBAL_HEADER | AV_CODEC_FLAG_CLOSED_GOP;
+        context->thread_count = config.threadsPerChunk;
+
+        int ret = avcodec_open2(context.get(), encoder, nullptr);
+        if (ret < 0) {
+            char strBuf[AV_ERROR_MAX_STRING_SIZE];
+            qWarning() << "ChunkedTranscoder: failed to open encoder" << encoder->name << ":" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+            context.reset();
+        }
+        return context;
+    }
+
+    void ChunkedTranscoderPrivate::transcodeChunk(size_t index) {
+        char strBuf[AV_ERROR_MAX_STRING_SIZE];
+        int64_t start, end;
+        {
+            std::unique_lock lock(chunkMutex);
+            start = chunks[index].start;
+            end = chunks[index].end;
+        }
+
+        std::vector<std::shared_ptr<AVPacket>> packets{};
+        const int64_t frameDuration = frameRate.num > 0 ? av_rescale_q(1, av_inv_q(frameRate), {1, 1000000}) : 0;
+
+        auto transcode = [&]() -> bool {
+            auto input = openInput();
+            if (!input) {
+                return false;
+            }
+            for (unsigned int i = 0; i < input->nb_streams; ++i) {
+                if (static_cast<int>(i) != videoStreamIndex) {
+                    input->streams[i]->discard = AVDISCARD_ALL;
+                }
+            }
+            auto *stream = input->streams[videoStreamIndex];
+
+            const auto *decoder = avcodec_find_decoder(stream->codecpar->codec_id);
+            CodecContextPtr decoderContext{avcodec_alloc_context3(decoder), &destroyAVCodecContext};
+            if (!decoder || !decoderContext) {
+                qWarning() << "ChunkedTranscoder: no decoder for" << avcodec_get_name(stream->codecpar->codec_id);
+                return false;
+            }
+            avcodec_parameters_to_context(decoderContext.get(), stream->codecpar);
+            decoderContext->thread_count = config.threadsPerChunk;
+            decoderContext->pkt_timebase = stream->time_base;
+            int ret = avcodec_open2(decoderContext.get(), decoder, nullptr);
+            if (ret < 0) {
+                qWarning() << "ChunkedTranscoder: failed to open decoder:" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+                return false;
+            }
+
+            auto encoderContext = openEncoder();
+            if (!encoderContext) {
+                return false;
+            }
+
+            const auto seekTarget = av_rescale_q(start, {1, 1000000}, stream->time_base);
+            ret = avformat_seek_file(input.get(), videoStreamIndex, INT64_MIN, seekTarget, seekTarget, 0);
+            if (ret < 0) {
+                qWarning() << "ChunkedTranscoder: failed to seek to" << start << ":" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+                return false;
+            }
+
+            std::unique_ptr<SwsContext, decltype(&destroySwsContext)> converter{nullptr, &destroySwsContext};
+            std::unique_ptr<AVPacket, decltype(&destroyAVPacket)> packet{av_packet_alloc(), &destroyAVPacket};
+            std::unique_ptr<AVFrame, decltype(&destroyAVFrame)> decoded{av_frame_alloc(), &destroyAVFrame};
+            bool firstFrame = true, reachedEnd = false;
+
+            auto receivePackets = [&]() -> bool {
+                while (true) {
+                    std::shared_ptr<AVPacket> encoded{av_packet_alloc(), &destroyAVPacket};
+                    ret = avcodec_receive_packet(encoderContext.get(), encoded.get());
+                    if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+                        return true;
+                    } else if (ret < 0) {
+                        qWarning() << "ChunkedTranscoder: failed to receive packet:" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+                        return false;
+                    }
+                    if (encoded->duration <= 0) {
+                        encoded->duration = frameDuration;
+                    }
+                    packets.push_back(std::move(encoded));
+                }
+            };
+
+            auto encodeFrame = [&]() -> bool {
+                if (decoded->best_effort_timestamp == AV_NOPTS_VALUE) {
+                    return true;
+                }
+                const auto pts = av_rescale_q(decoded->best_effort_timestamp, stream->time_base, {1, 1000000});
+                if (pts < start) {
+                    // Leading frames of an open GOP belong to the previous chunk
+                    return true;
+                } else if (pts >= end) {
+                    reachedEnd = true;
+                    return true;
+                }
+
+                std::unique_ptr<AVFrame, decltype(&destroyAVFrame)> frame{nullptr, &destroyAVFrame};
+                if (decoded->format != encoderFormat || decoded->width != width || decoded->height != height) {
+                    converter.reset(sws_getCachedContext(converter.release(), decoded->width, decoded->height, static_cast<AVPixelFormat>(decoded->format),
+                                                         width, height, encoderFormat, SWS_BICUBIC, nullptr, nullptr, nullptr));
+                    frame.reset(av_frame_alloc());
+                    if (!converter || !frame) {
+                        qWarning() << "ChunkedTranscoder: failed to convert frame";
+                        return false;
+                    }
+                    frame->format = encoderFormat;
+                    frame->width = width;
+                    frame->height = height;
+                    ret = av_frame_get_buffer(frame.get(), 0);
+                    if (ret < 0) {
+                        qWarning() << "ChunkedTranscoder: failed to allocate frame:" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+                        return false;
+                    }
+                    sws_scale(converter.get(), decoded->data, decoded->linesize, 0, decoded->height, frame->data, frame->linesize);
+                } else {
+                    frame.reset(av_frame_clone(decoded.get()));
+                    if (!frame) {
+                        return false;
+                    }
+                }
+
+                frame->pts = pts - startTime;
+                // Every chunk starts a new closed GOP, so chunks can be concatenated
+                frame->pict_type = firstFrame ? AV_PICTURE_TYPE_I : AV_PICTURE_TYPE_NONE;
+                firstFrame = false;
+
+                ret = avcodec_send_frame(encoderContext.get(), frame.get());
+                if (ret < 0) {
+                    qWarning() << "ChunkedTranscoder: failed to send frame:" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+                    return false;
+                }
+                return receivePackets();
+            };
+
+            auto receiveFrames = [&]() -> bool {
+                while (!reachedEnd) {
+                    ret = avcodec_receive_frame(decoderContext.get(), decoded.get());
+                    if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+                        return true;
+                    } else if (ret < 0) {
+                        qWarning() << "ChunkedTranscoder: failed to receive frame:" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+                        return false;
+                    }
+                    const bool encoded = encodeFrame();
+                    av_frame_unref(decoded.get());
+                    if (!encoded) {
+                        return false;
+                    }
+                }
+                return true;
+            };
+
+            while (!reachedEnd && running) {
+                ret = av_read_frame(input.get(), packet.get());
+                if (ret == AVERROR_EOF) {
+                    break;
+                } else if (ret < 0) {
+                    qWarning() << "ChunkedTranscoder: failed to read packet:" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+                    return false;
+                }
+                if (packet->stream_index == videoStreamIndex) {
+                    ret = avcodec_send_packet(decoderContext.get(), packet.get());
+                    if (ret == AVERROR(EAGAIN)) {
+                        // The decoder accepts the packet again once its frames are received, as in DecodeLoop::decode()
+                        if (!receiveFrames()) {
+                            return false;
+                        }
+                        ret = reachedEnd ? 0 : avcodec_send_packet(decoderContext.get(), packet.get());
+                    }
+                    if (ret < 0) {
+                        qWarning() << "ChunkedTranscoder: failed to send packet:" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+                    }
+                }
+                av_packet_unref(packet.get());
+                if (!receiveFrames()) {
+                    return false;
+                }
+            }
+            if (!running) {
+                return false;
+            }
+
+            if (!reachedEnd) {
+                // Last chunk, drain the decoder
+                if (avcodec_send_packet(decoderContext.get(), nullptr) == AVERROR(EAGAIN)) {
+                    if (!receiveFrames()) {
+                        return false;
+                    }
+                    avcodec_send_packet(decoderContext.get(), nullptr);
+                }
+                if (!receiveFrames()) {
+                    return false;
+                }
+            }
+            avcodec_send_frame(encoderContext.get(), nullptr);
+            return receivePackets();
+        };
+
+        const bool succeeded = transcode();
+
+        std::unique_lock lock(chunkMutex);
+        if (index < chunks.size()) {
+            auto &chunk = chunks[index];
+            chunk.packets = std::move(packets);
+            chunk.failed = !succeeded;
+            chunk.finished = true;
+        }
+        chunkCond.notify_all();
+    }
+
+    void ChunkedTranscoderPrivate::submitChunks() {
+        // Bounds the memory held by finished chunks, that wait for their predecessors
+        const auto window = static_cast<size_t>(workerPool.maxThreadCount()) + 1;
+        while (nextChunkToSubmit < chunks.size() && nextChunkToSubmit < nextChunkToProduce + window) {
+            const auto index = nextChunkToSubmit++;
+            workerPool.start([this, index] {
+                transcodeChunk(index);
+            });
+        }
+    }
+
+    void ChunkedTranscoderPrivate::destroyAVFormatContext(AVFormatContext *formatContext) {
+        if (formatContext) {
+            avformat_close_input(&formatContext);
+        }
+    }
+
+    void ChunkedTranscoderPrivate::destroyAVCodecContext(AVCodecContext *codecContext) {
+        if (codecContext) {
+            avcodec_free_context(&codecContext);
+        }
+    }
+
+    void ChunkedTranscoderPrivate::destroySwsContext(SwsContext *swsContext) {
+        if (swsContext) {
+            sws_freeContext(swsContext);
+        }
+    }
+
+    void ChunkedTranscoderPrivate::destroyAVFrame(AVFrame *frame) {
+        if (frame) {
+            av_frame_free(&frame);
+        }
+    }
+
+    void ChunkedTranscoderPrivate::destroyAVPacket(AVPacket *packet) {
+        if (packet) {
+            av_packet_free(&packet);
+        }
+    }
+}// namespace AVQt
@@ -0,0 +1,545 @@
+#include "encoder/EncodeLadder.hpp"
+#include "private/EncodeLadder_p.hpp"
+
+#include "AVQt/encoder/VideoEncoderFactory.hpp"
+#include "global.hpp"
+
+#include <pgraph/api/Data.hpp>
+#include <pgraph/impl/SimplePadFactory.hpp>
+#include <pgraph_network/impl/RegisteringPadFactory.hpp>
+
+extern "C" {
+#include <libavutil/hwcontext.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+}
+
+namespace AVQt {
+    EncodeLadder::EncodeLadder(const Config &config, QObject *parent)
+        : QObject(parent),
+          pgraph::impl::SimpleProcessor(pgraph::impl::SimplePadFactory::getInstance()),
+          d_ptr(new EncodeLadderPrivate(this)) {
+        Q_D(EncodeLadder);
+        d->config = config;
+    }
+
+    EncodeLadder::EncodeLadder(const Config &config, std::shared_ptr<pgraph::network::api::PadRegistry> padRegistry, QObject *parent)
+        : QObject(parent),
+          pgraph::impl::SimpleProcessor(pgraph::network::impl::RegisteringPadFactory::factoryFor(padRegistry)),
+          d_ptr(new EncodeLadderPrivate(this)) {
+        Q_D(EncodeLadder);
+        d->config = config;
+    }
+
+    EncodeLadder::~EncodeLadder() {
+        Q_D(EncodeLadder);
+        if (d->open) {
+            close();
+        }
+    }
+
+    bool EncodeLadder::init() {
+        Q_D(EncodeLadder);
+
+        bool shouldBe = false;
+        if (d->initialized.compare_exchange_strong(shouldBe, true)) {
+            if (d->config.rungs.isEmpty()) {
+                qWarning() << "EncodeLadder: no rungs configured";
+                d->initialized = false;
+                return false;
+            }
+
+            d->inputPadId = pgraph::impl::SimpleProcessor::createInputPad(std::make_shared<communication::VideoPadParams>());
+            if (d->inputPadId == pgraph::api::INVALID_PAD_ID) {
+                qWarning() << "EncodeLadder: failed to create input pad";
+                d->initialized = false;
+                return false;
+            }
+
+            for (const auto &rungConfig : d->config.rungs) {
+                if (!rungConfig.size.isValid()) {
+                    qWarning() << "EncodeLadder: invalid rung size" << rungConfig.size;
+                    d->rungs.clear();
+                    d->initialized = false;
+                    return false;
+                }
+                EncodeLadderPrivate::Rung rung{};
+                rung.config = rungConfig;
+                rung.outputPadParams = std::make_shared<communication::PacketPadParams>();
+                rung.outputPadId = pgraph::impl::SimpleProcessor::createOutputPad(rung.outputPadParams);
+                if (rung.outputPadId == pgraph::api::INVALID_PAD_ID) {
+                    qWarning() << "EncodeLadder: failed to create output pad";
+                    d->rungs.clear();
+                    d->initialized = false;
+                    return false;
+                }
+                d->rungs.push_back(std::move(rung));
+            }
+            return true;
+        } else {
+            qWarning() << "EncodeLadder::init() called multiple times";
+            return false;
+        }
+    }
+
+    bool EncodeLadder::isOpen() const {
+        Q_D(const EncodeLadder);
+        return d->open;
+    }
+
+    bool EncodeLadder::isRunning() const {
+        Q_D(const EncodeLadder);
+        return d->running;
+    }
+
+    bool EncodeLadder::isPaused() const {
+        Q_D(const EncodeLadder);
+        return d->paused;
+    }
+
+    int64_t EncodeLadder::getInputPadId() const {
+        Q_D(const EncodeLadder);
+        return d->inputPadId;
+    }
+
+    int64_t EncodeLadder::getRungPadId(int rung) const {
+        Q_D(const EncodeLadder);
+        if (rung < 0 || static_cast<size_t>(rung) >= d->rungs.size()) {
+            return pgraph::api::INVALID_PAD_ID;
+        }
+        return d->rungs[static_cast<size_t>(rung)].outputPadId;
+    }
+
+    void EncodeLadder::consume(int64_t pad, std::shared_ptr<pgraph::api::Data> data) {
+        Q_D(EncodeLadder);
+        if (pad != d->inputPadId) {
+            qWarning() << "EncodeLadder: data on unknown pad" << pad;
+            return;
+        }
+
+        if (data->getType() == communication::Message::Type) {
+            auto message = std::static_pointer_cast<communication::Message>(data);
+            switch (static_cast<communication::Message::Action::Enum>(message->getAction())) {
+                case communication::Message::Action::INIT:
+                    d->inputParams = message->getPayload("videoParams").value<communication::VideoPadParams>();
+                    if (!open()) {
+                        qWarning() << "EncodeLadder: failed to open";
+                    }
+                    break;
+                case communication::Message::Action::CLEANUP:
+                    close();
+                    break;
+                case communication::Message::Action::START:
+                    if (!start()) {
+                        qWarning() << "EncodeLadder: failed to start";
+                    }
+                    break;
+                case communication::Message::Action::STOP:
+                    stop();
+                    break;
+                case communication::Message::Action::PAUSE:
+                    pause(message->getPayload("state").toBool());
+                    break;
+                case communication::Message::Action::RESET:
+                    if (d->open) {
+                        // The encoders keep their contexts, flush() emits the held back packets and the next frame starts a new GOP
+                        for (auto &rung : d->rungs) {
+                            if (rung.worker) {
+                                rung.worker->waitForEmptyQueue();
+                            }
+                            rung.impl->flush();
+                        }
+                        d->produceOnRungs(communication::Message::builder().withAction(communication::Message::Action::RESET).build());
+                        d->frameCount = 0;
+                    }
+                    break;
+                case communication::Message::Action::DATA:
+                    if (d->running) {
+                        d->processFrame(message->getPayload("frame").value<std::shared_ptr<AVFrame>>());
+                    }
+                    break;
+                case communication::Message::Action::RESIZE:
+                    // Rungs have fixed sizes, the scalers pick up the new input size with the next frame
+                    break;
+                case communication::Message::Action::NONE:
+                    break;
+            }
+        }
+    }
+
+    bool EncodeLadder::open() {
+        Q_D(EncodeLadder);
+
+        if (!d->initialized) {
+            qWarning() << "EncodeLadder::open() called before init()";
+            return false;
+        }
+
+        bool shouldBe = false;
+        if (d->open.compare_exchange_strong(shouldBe, true)) {
+            const auto format = d->resolveFormat();
+            for (size_t i = 0; i < d->rungs.size(); ++i) {
+                auto &rung = d->rungs[i];
+                // Chroma subsampled formats need even dimensions
+                rung.inputParams.frameSize = {rung.config.size.width() & ~1, rung.config.size.height() & ~1};
+                rung.inputParams.pixelFormat = format;
+                rung.inputParams.swPixelFormat = format;
+                rung.inputParams.isHWAccel = false;
+
+                auto encodeParameters = rung.config.encodeParameters;
+                encodeParameters.gopSize = d->config.gopSize;
+
+                rung.impl = VideoEncoderFactory::getInstance().create(common::PixelFormat{format, AV_PIX_FMT_NONE}, getVideoCodecId(d->config.codec),
+                                                                      encodeParameters, d->config.encoderPriority);
+                if (!rung.impl || !rung.impl->open(rung.inputParams)) {
+                    qWarning() << "EncodeLadder: failed to open encoder for" << rung.inputParams.frameSize << av_get_pix_fmt_name(format);
+                    rung.impl.reset();
+                    d->closeRungs();
+                    d->open = false;
+                    return false;
+                }
+
+                rung.worker = std::make_unique<internal::LadderRungWorker>(d, i);
+                connect(std::dynamic_pointer_cast<QObject>(rung.impl).get(), SIGNAL(packetReady(std::shared_ptr<AVPacket>)),
+                        rung.worker.get(), SLOT(onPacketReady(std::shared_ptr<AVPacket>)), Qt::DirectConnection);
+
+                *rung.outputPadParams = *rung.impl->getPacketPadParams();
+                produce(communication::Message::builder()
+                                .withAction(communication::Message::Action::INIT)
+                                .withPayload("packetParams", QVariant::fromValue(std::const_pointer_cast<const communication::PacketPadParams>(rung.outputPadParams)))
+                                .withPayload("encodeParams", QVariant::fromValue(encodeParameters))
+                                .build(),
+                        rung.outputPadId);
+            }
+            d->frameCount = 0;
+            return true;
+        } else {
+            qWarning() << "EncodeLadder::open() called multiple times";
+            return false;
+        }
+    }
+
+    void EncodeLadder::close() {
+        Q_D(EncodeLadder);
+
+        if (d->running) {
+            stop();
+        }
+
+        bool shouldBe = true;
+        if (d->open.compare_exchange_strong(shouldBe, false)) {
+            d->produceOnRungs(communication::Message::builder().withAction(communication::Message::Action::CLEANUP).build());
+            d->closeRungs();
+        } else {
+            qWarning() << "EncodeLadder::close() called multiple times";
+        }
+    }
+
+    bool EncodeLadder::start() {
+        Q_D(EncodeLadder);
+
+        if (!d->open) {
+            qWarning() << "EncodeLadder::start() called before open()";
+            return false;
+        }
+
+        bool shouldBe = false;
+        if (d->running.compare_exchange_strong(shouldBe, true)) {
+            d->paused = false;
+            d->produceOnRungs(communication::Message::builder().withAction(communication::Message::Action::START).build());
+            for (auto &rung : d->rungs) {
+                rung.worker->setPaused(false);
+                rung.worker->start();
+            }
+            emit started();
+            return true;
+        } else {
+            qWarning() << "EncodeLadder::start() called multiple times";
+            return false;
+        }
+    }
+
+    void EncodeLadder::stop() {
+        Q_D(EncodeLadder);
+
+        bool shouldBe = true;
+        if (d->running.compare_exchange_strong(shouldBe, false)) {
+            // Encode the queued frames and emit the held back packets before STOP, a paused ladder discards its queues instead
+            for (auto &rung : d->rungs) {
+                rung.worker->waitForEmptyQueue();
+                rung.impl->flush();
+                rung.worker->stop();
+            }
+            d->paused = false;
+            d->produceOnRungs(communication::Message::builder().withAction(communication::Message::Action::STOP).build());
+            emit stopped();
+        } else {
+            qWarning() << "EncodeLadder::stop() called multiple times";
+        }
+    }
+
+    void EncodeLadder::pause(bool state) {
+        Q_D(EncodeLadder);
+
+        bool shouldBe = !state;
+        if (d->paused.compare_exchange_strong(shouldBe, state)) {
+            d->produceOnRungs(communication::Message::builder()
+                                      .withAction(communication::Message::Action::PAUSE)
+                                      .withPayload("state", state)
+                                      .build());
+            for (auto &rung : d->rungs) {
+                if (rung.worker) {
+                    rung.worker->setPaused(state);
+                }
+            }
+            emit paused(state);
+        } else {
+            qDebug() << "EncodeLadder::pause: state already" << state;
+        }
+    }
+
+    EncodeLadderPrivate::EncodeLadderPrivate(EncodeLadder *q) : q_ptr(q) {}
+
+    AVPixelFormat EncodeLadderPrivate::resolveFormat() const {
+        const auto inputFormat = inputParams.isHWAccel ? inputParams.swPixelFormat : inputParams.pixelFormat;
+        if (inputFormat != AV_PIX_FMT_NONE && sws_isSupportedOutput(inputFormat)) {
+            return inputFormat;
+        }
+        return AV_PIX_FMT_YUV420P;
+    }
+
+    std::shared_ptr<AVFrame> EncodeLadderPrivate::scale(Rung &rung, const std::shared_ptr<AVFrame> &frame) {
+        const auto &size = rung.inputParams.frameSize;
+        const auto format = rung.inputParams.pixelFormat;
+        if (frame->width == size.width() && frame->height == size.height() && frame->format == format) {
+            return frame;
+        }
+
+        rung.scaler.reset(sws_getCachedContext(rung.scaler.release(),
+                                               frame->width, frame->height, static_cast<AVPixelFormat>(frame->format),
+                                               size.width(), size.height(), format,
+                                               config.scaleFlags, nullptr, nullptr, nullptr));
+        if (!rung.scaler) {
+            qWarning() << "EncodeLadder: failed to create scaler for" << QSize{frame->width, frame->height} << "to" << size;
+            return {};
+        }
+
+        auto result = allocateFrame(rung);
+        if (!result) {
+            qWarning() << "EncodeLadder: failed to allocate frame for" << size << av_get_pix_fmt_name(format);
+            return {};
+        }
+
+        int ret = sws_scale(rung.scaler.get(), frame->data, frame->linesize, 0, frame->height, result->data, result->linesize);
+        if (ret < 0) {
+            char strBuf[AV_ERROR_MAX_STRING_SIZE];
+            qWarning() << "EncodeLadder: failed to scale frame:" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+            return {};
+        }
+        av_frame_copy_props(result.get(), frame.get());
+        return result;
+    }
+
+    std::shared_ptr<AVFrame> EncodeLadderPrivate::allocateFrame(Rung &rung) {
+        const auto &size = rung.inputParams.frameSize;
+        const auto format = rung.inputParams.pixelFormat;
+        if (!rung.framePool) {
+            // Size and format of a rung are fixed while open, buffers still held by the encoder keep a released pool alive
+            const auto bufferSize = av_image_get_buffer_size(format, size.width(), size.height(), frameAlignment);
+            if (bufferSize < 0) {
+                return {};
+            }
+            rung.framePool.reset(av_buffer_pool_init(bufferSize, nullptr));
+            if (!rung.framePool) {
+                return {};
+            }
+        }
+
+        std::shared_ptr<AVFrame> frame{av_frame_alloc(), &destroyAVFrame};
+        frame->format = format;
+        frame->width = size.width();
+        frame->height = size.height();
+        frame->buf[0] = av_buffer_pool_get(rung.framePool.get());
+        if (!frame->buf[0]) {
+            return {};
+        }
+        if (av_image_fill_arrays(frame->data, frame->linesize, frame->buf[0]->data, format, size.width(), size.height(), frameAlignment) < 0) {
+            return {};
+        }
+        frame->extended_data = frame->data;
+        return frame;
+    }
+
+    void EncodeLadderPrivate::processFrame(const std::shared_ptr<AVFrame> &frame) {
+        if (!frame) {
+            return;
+        }
+
+        std::shared_ptr<AVFrame> source{frame};
+        if (frame->hw_frames_ctx) {
+            // Downloaded once for all rungs
+            source.reset(av_frame_alloc(), &destroyAVFrame);
+            int ret = av_hwframe_transfer_data(source.get(), frame.get(), 0);
+            if (ret < 0) {
+                char strBuf[AV_ERROR_MAX_STRING_SIZE];
+                qWarning() << "EncodeLadder: failed to download frame:" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+                return;
+            }
+            av_frame_copy_props(source.get(), frame.get());
+        }
+
+        // The same input frame starts a GOP on every rung, decoder picture types must not leak into the encoders
+        const bool keyframe = config.gopSize <= 0 || frameCount % config.gopSize == 0;
+        ++frameCount;
+
+        for (auto &rung : rungs) {
+            auto scaled = scale(rung, source);
+            if (!scaled) {
+                return;
+            }
+            if (scaled == source) {
+                // Don't touch the picture type of a frame shared with other consumers or rungs
+                scaled.reset(av_frame_clone(source.get()), &destroyAVFrame);
+                if (!scaled) {
+                    return;
+                }
+            }
+            scaled->pict_type = keyframe ? AV_PICTURE_TYPE_I : AV_PICTURE_TYPE_NONE;
+            rung.worker->enqueue(scaled);
+            // The next rung is downscaled from this one
+            source = scaled;
+        }
+    }
+
+    void EncodeLadderPrivate::produceOnRungs(const std::shared_ptr<communication::Message> &message) {
+        Q_Q(EncodeLadder);
+        for (const auto &rung : rungs) {
+            q->produce(message, rung.outputPadId);
+        }
+    }
+
+    void EncodeLadderPrivate::producePacket(size_t rung, const std::shared_ptr<AVPacket> &packet) {
+        Q_Q(EncodeLadder);
+        q->produce(communication::Message::builder()
+                           .withAction(communication::Message::Action::DATA)
+                           .withPayload("packet", QVariant::fromValue(packet))
+                           .build(),
+                   rungs[rung].outputPadId);
+    }
+
+    void EncodeLadderPrivate::closeRungs() {
+        for (auto &rung : rungs) {
+            if (rung.worker) {
+                rung.worker->stop();
+            }
+            if (rung.impl) {
+                rung.impl->close();
+            }
+            rung.worker.reset();
+            rung.impl.reset();
+            rung.scaler.reset();
+            rung.framePool.reset();
+        }
+    }
+
+    void EncodeLadderPrivate::destroySwsContext(SwsContext *swsContext) {
+        if (swsContext) {
+            sws_freeContext(swsContext);
+        }
+    }
+
+    void EncodeLadderPrivate::destroyAVBufferPool(AVBufferPool *bufferPool) {
+        if (bufferPool) {
+            av_buffer_pool_uninit(&bufferPool);
+        }
+    }
+
+    void EncodeLadderPrivate::destroyAVFrame(AVFrame *frame) {
+        if (frame) {
+            av_frame_free(&frame);
+        }
+    }
+
+    internal::LadderRungWorker::LadderRungWorker(EncodeLadderPrivate *p, size_t rung)
+        : QThread(), p(p), m_rung(rung) {
+    }
+
+    void internal::LadderRungWorker::enqueue(const std::shared_ptr<AVFrame> &frame) {
+        std::unique_lock lock(m_queueMutex);
+        m_queueCond.wait(lock, [this] { return m_queue.size() < maxQueueSize || m_stop; });
+        if (m_stop) {
+            return;
+        }
+        m_queue.push(frame);
+        m_queueCond.notify_all();
+    }
+
+    void internal::LadderRungWorker::waitForEmptyQueue() {
+        std::unique_lock lock(m_queueMutex);
+        // A paused worker doesn't drain its queue, but it is idle once it isn't encoding anymore
+        m_queueCond.wait(lock, [this] { return ((m_queue.empty() || m_paused) && !m_encoding) || m_stop || !isRunning(); });
+    }
+
+    void internal::LadderRungWorker::setPaused(bool state) {
+        std::unique_lock lock(m_queueMutex);
+        m_paused = state;
+        m_queueCond.notify_all();
+    }
+
+    void internal::LadderRungWorker::stop() {
+        {
+            std::unique_lock lock(m_queueMutex);
+            m_stop = true;
+            m_queueCond.notify_all();
+        }
+        if (isRunning()) {
+            QThread::quit();
+            QThread::wait();
+        }
+
+        // Ready to be started again
+        std::unique_lock lock(m_queueMutex);
+        m_queue = {};
+        m_stop = false;
+    }
+
+    void internal::LadderRungWorker::run() {
+        auto &rung = p->rungs[m_rung];
+        while (true) {
+            std::unique_lock lock(m_queueMutex);
+            m_queueCond.wait(lock, [this] { return m_stop || (!m_paused && !m_queue.empty()); });
+            if (m_stop) {
+                break;
+            }
+            auto frame = m_queue.front();
+            m_encoding = true;
+            lock.unlock();
+
+            // Uploads run in parallel as well
+            auto preparedFrame = rung.impl->prepareFrame(frame);
+            if (!preparedFrame) {
+                qWarning() << "EncodeLadder: failed to prepare frame for" << rung.inputParams.frameSize;
+            } else {
+                // encode() blocks until the encoder accepted the frame, EAGAIN only comes after the implementation's own wait
+                int ret;
+                do {
+                    ret = rung.impl->encode(preparedFrame);
+                } while (ret == EAGAIN && !m_stop);
+                if (ret != EXIT_SUCCESS && ret != EAGAIN) {
+                    char strBuf[AV_ERROR_MAX_STRING_SIZE];
+                    qWarning() << "EncodeLadder: failed to encode frame for" << rung.inputParams.frameSize << ":"
+                               << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, AVERROR(ret));
+                }
+            }
+
+            lock.lock();
+            m_queue.pop();
+            m_encoding = false;
+            m_queueCond.notify_all();
+        }
+    }
+
+    void internal::LadderRungWorker::onPacketReady(const std::shared_ptr<AVPacket> &packet) {
+        p->producePacket(m_rung, packet);
+    }
+}// namespace AVQt
@@ -0,0 +1,133 @@
+#include "EncodeRateController.hpp"
+
+#include <algorithm>
+#include <limits>
+
+extern "C" {
+#include <libavutil/avutil.h>
+}
+
+namespace AVQt::internal {
+    EncodeRateController::EncodeRateController(int32_t bitrate, int32_t minBitrate, int maxFrameInterval, bool seamlessBitrateChanges)
+        : m_bitrate(std::max(bitrate, 0)), m_minBitrate(std::max(minBitrate, 0)), m_maxFrameInterval(std::max(maxFrameInterval, 1)),
+          m_decimateFirst(!seamlessBitrateChanges), m_bitrateChangeInterval(seamlessBitrateChanges ? SeamlessBitrateChangeInterval : DrainingBitrateChangeInterval),
+          m_lastPts(AV_NOPTS_VALUE), m_lastChange(-1), m_lastBitrateChange(-1), m_headroomSince(-1) {
+        setBitrate(bitrate);
+    }
+
+    void EncodeRateController::setBitrate(int32_t bitrate) {
+        m_bitrate = std::max(bitrate, 0);
+        // Steps are bounded by the minimum bitrate and the maximum frame interval, so this terminates early
+        m_maxLevel = stateForLevel(std::numeric_limits<int>::max()).level;
+        m_state = stateForLevel(std::min(m_state.level, m_maxLevel));
+    }
+
+    bool EncodeRateController::admitFrame(int64_t pts) {
+        if (pts != AV_NOPTS_VALUE && m_lastPts != AV_NOPTS_VALUE) {
+            const int64_t duration = pts - m_lastPts;
+            // Jumps, e.g. after a RESET, don't tell anything about the frame rate
+            if (duration > 0 && duration < 1000000) {
+                m_inputFrameDuration = m_inputFrameDuration > 0 ? m_inputFrameDuration + (duration - m_inputFrameDuration) / 8 : duration;
+            }
+        }
+        m_lastPts = pts;
+
+        if (m_frameCounter++ % static_cast<uint64_t>(m_state.frameInterval) == 0) {
+            return true;
+        }
+        ++m_decimatedFrames;
+        return false;
+    }
+
+    void EncodeRateController::frameEncoded(int64_t encodeTime) {
+        m_meanEncodeTime = m_meanEncodeTime > 0 ? m_meanEncodeTime + (encodeTime - m_meanEncodeTime) / 8 : encodeTime;
+    }
+
+    bool EncodeRateController::update(size_t queueDepth, size_t queueSize, int64_t now) {
+        const int64_t budget = m_inputFrameDuration * m_state.frameInterval;
+        const bool overloaded = (queueSize > 1 && queueDepth * 2 >= queueSize) || (budget > 0 && m_meanEncodeTime * 10 > budget * 9);
+
+        if (overloaded) {
+            m_headroomSince = -1;
+            if (m_state.level < m_maxLevel && (m_lastChange < 0 || now - m_lastChange >= StepUpInterval)) {
+                return changeLevel(m_state.level + 1, now);
+            }
+            return false;
+        }
+
+        if (m_state.level == 0) {
+            return false;
+        }
+
+        // Only step down, if the encoder would still have 40 % of the time per frame left at the lower level
+        const int64_t lowerBudget = m_inputFrameDuration * stateForLevel(m_state.level - 1).frameInterval;
+        if (queueDepth > 0 || lowerBudget <= 0 || m_meanEncodeTime * 10 >= lowerBudget * 6) {
+            m_headroomSince = -1;
+            return false;
+        }
+        if (m_headroomSince < 0) {
+            m_headroomSince = now;
+        }
+        if (now - m_headroomSince >= StepDownInterval && changeLevel(m_state.level - 1, now)) {
+            m_headroomSince = now;
+            return true;
+        }
+        return false;
+    }
+
+    bool EncodeRateController::changeLevel(int level, int64_t now) {
+        const auto state = stateForLevel(level);
+        if (state.bitrate != m_state.bitrate) {
+            if (m_lastBitrateChange >= 0 && now - m_lastBitrateChange < m_bitrateChangeInterval) {
+                return false;
+            }
+            m_lastBitrateChange = now;
+        }
+        m_state = state;
+        m_lastChange = now;
+        ++m_levelChanges;
+        return true;
+    }
+
+    EncodeRateController::State EncodeRateController::state() const {
+        return m_state;
+    }
+
+    int64_t EncodeRateController::meanEncodeTime() const {
+        return m_meanEncodeTime;
+    }
+
+    int64_t EncodeRateController::inputFrameDuration() const {
+        return m_inputFrameDuration;
+    }
+
+    uint64_t EncodeRateController::decimatedFrames() const {
+        return m_decimatedFrames;
+    }
+
+    uint64_t EncodeRateController::levelChanges() const {
+        return m_levelChanges;
+    }
+
+    EncodeRateController::State EncodeRateController::stateForLevel(int level) const {
+        const int64_t minBitrate = m_minBitrate > 0 ? m_minBitrate : m_bitrate / 4;
+
+        State state{0, m_bitrate, 1};
+        for (int i = 0; i < level; ++i) {
+            const int64_t lowerBitrate = static_cast<int64_t>(state.bitrate) * 3 / 4;
+            const bool canLowerBitrate = m_bitrate > 0 && lowerBitrate >= minBitrate;
+            const bool canDecimate = state.frameInterval < m_maxFrameInterval;
+            // Alternate, starting with the bitrate, which degrades the stream less than judder, unless bitrate changes drain the encoder
+            const bool preferBitrate = m_decimateFirst ? !canDecimate : (i % 2 == 0 || !canDecimate);
+            if (canLowerBitrate && preferBitrate) {
+                state.bitrate = static_cast<int32_t>(lowerBitrate);
+            } else if (canDecimate) {
+                ++state.frameInterval;
+            } else {
+                break;
+            }
+            state.level = i + 1;
+        }
+        return state;
+    }
+}// namespace AVQt::internal
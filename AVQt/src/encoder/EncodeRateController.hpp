@@ -0,0 +1,100 @@
+#ifndef LIBAVQT_ENCODERATECONTROLLER_HPP
+#define LIBAVQT_ENCODERATECONTROLLER_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace AVQt::internal {
+    /**
+     * @brief Decides how far a live VideoEncoder degrades, when it can't keep up with its input.
+     *
+     * Each level either lowers the bitrate by a quarter, down to the minimum bitrate, or encodes one input frame less out of a
+     * group, up to the maximum frame interval. The controller steps up as soon as the input queue is half full or the mean encode
+     * time exceeds the time available per encoded frame, and steps down after the encoder had enough headroom for a while.
+     *
+     * Bitrate changes are spaced further apart than frame rate changes. If the encoder has to drain and start a new GOP to change
+     * its bitrate, which costs more than it saves while overloaded, the frame rate is lowered first and the bitrate only changes
+     * rarely.
+     *
+     * Times are in microseconds. Not thread-safe.
+     */
+    class EncodeRateController {
+    public:
+        struct State {
+            int level{0};
+            /**
+             * 0, if the encoder chooses the bitrate
+             */
+            int32_t bitrate{0};
+            /**
+             * Every frameInterval-th input frame is encoded
+             */
+            int frameInterval{1};
+        };
+
+        /**
+         * @param seamlessBitrateChanges false, if changing the bitrate drains the encoder, see IVideoEncoderImpl::isReconfigureSeamless()
+         */
+        EncodeRateController(int32_t bitrate, int32_t minBitrate, int maxFrameInterval, bool seamlessBitrateChanges);
+
+        /**
+         * @brief Changes the bitrate at level 0, e.g. after VideoEncoder::setBitrate()
+         */
+        void setBitrate(int32_t bitrate);
+
+        /**
+         * @return true, if the frame should be encoded, false, if it is dropped to lower the frame rate
+         */
+        bool admitFrame(int64_t pts);
+        void frameEncoded(int64_t encodeTime);
+
+        /**
+         * @brief Reevaluates the level
+         * @param queueDepth Frames waiting in front of the encoder
+         * @param queueSize Frames the queue holds at most
+         * @param now Monotonic time
+         * @return true, if the level changed
+         */
+        bool update(size_t queueDepth, size_t queueSize, int64_t now);
+
+        [[nodiscard]] State state() const;
+        [[nodiscard]] int64_t meanEncodeTime() const;
+        [[nodiscard]] int64_t inputFrameDuration() const;
+        [[nodiscard]] uint64_t decimatedFrames() const;
+        [[nodiscard]] uint64_t levelChanges() const;
+
+    private:
+        [[nodiscard]] State stateForLevel(int level) const;
+        /**
+         * @return false, if the level would change the bitrate again too soon
+         */
+        bool changeLevel(int level, int64_t now);
+
+        static constexpr int64_t StepUpInterval{250000};
+        static constexpr int64_t StepDownInterval{2000000};
+        static constexpr int64_t SeamlessBitrateChangeInterval{1000000};
+        static constexpr int64_t DrainingBitrateChangeInterval{10000000};
+
+        int32_t m_bitrate;
+        int32_t m_minBitrate;
+        int m_maxFrameInterval;
+        bool m_decimateFirst;
+        int64_t m_bitrateChangeInterval;
+
+        State m_state{};
+        int m_maxLevel{0};
+
+        int64_t m_lastPts;
+        int64_t m_inputFrameDuration{0};
+        int64_t m_meanEncodeTime{0};
+        uint64_t m_frameCounter{0};
+        uint64_t m_decimatedFrames{0};
+        uint64_t m_levelChanges{0};
+
+        int64_t m_lastChange;
+        int64_t m_lastBitrateChange;
+        int64_t m_headroomSince;
+    };
+}// namespace AVQt::internal
+
+#endif//LIBAVQT_ENCODERATECONTROLLER_HPP
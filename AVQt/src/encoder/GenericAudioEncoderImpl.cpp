@@ -49,22 +49,7 @@ namespace AVQt {
         if (d->open.compare_exchange_strong(shouldBe, true)) {
             d->inputParameters = params;
 
-            d->codecContext.reset(avcodec_alloc_context3(d->codec));
-            if (!d->codecContext) {
-                throw std::runtime_error("Could not allocate codec context");
-            }
-
-            d->codecContext->sample_fmt = params.format.sampleFormat();
-            d->codecContext->sample_rate = params.format.sampleRate();
-            d->codecContext->channel_layout = params.format.channelLayout() < 0 ? av_get_default_channel_layout(params.format.channels()) : params.format.channelLayout();
-            d->codecContext->channels = params.format.channels();
-            d->codecContext->time_base = {1, 1000000};// Microseconds
-            d->codecContext->bit_rate = d->encodeParameters.bitrate;
-
-            int ret = avcodec_open2(d->codecContext.get(), d->codec, nullptr);
-            if (ret < 0) {
-                char err[AV_ERROR_MAX_STRING_SIZE];
-                qWarning("Could not open codec: %s", av_make_error_string(err, AV_ERROR_MAX_STRING_SIZE, ret));
+            if (!d->openCodecContext()) {
                 d->open = false;
                 return false;
             }
@@ -110,30 +95,25 @@ namespace AVQt {
         }
 
         int ret = avcodec_send_frame(d->codecContext.get(), frame.get());
-        if (ret < 0 && ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) {
-            char err[AV_ERROR_MAX_STRING_SIZE];
-            qWarning("Could not send frame: %s", av_make_error_string(err, AV_ERROR_MAX_STRING_SIZE, ret));
-            return AVUNERROR(ret);
-        } else if (ret == AVERROR(EAGAIN)) {
+        if (ret == AVERROR(EAGAIN)) {
+            // The encoder accepts the frame again once its pending packets are received
+            ret = d->receivePackets();
+            if (ret == 0) {
+                ret = avcodec_send_frame(d->codecContext.get(), frame.get());
+            }
+        }
+        if (ret == AVERROR(EAGAIN)) {
             return EAGAIN;
         } else if (ret == AVERROR_EOF) {
             return EOF;
+        } else if (ret < 0) {
+            char err[AV_ERROR_MAX_STRING_SIZE];
+            qWarning("Could not send frame: %s", av_make_error_string(err, AV_ERROR_MAX_STRING_SIZE, ret));
+            return AVUNERROR(ret);
         }
 
-        std::shared_ptr<AVPacket> pkt(av_packet_alloc(), [](AVPacket *pkt) {
-            av_packet_free(&pkt);
-        });
-        ret = avcodec_receive_packet(d->codecContext.get(), pkt.get());
-        while (ret == 0 && pkt->pts != AV_NOPTS_VALUE) {
-            if (pkt->data == nullptr) {
-                qWarning("GenericAudioEncoderImpl::encode: Received empty packet");
-                continue;
-            }
-            packetReady(pkt);
-            pkt.reset(av_packet_alloc());
-            ret = avcodec_receive_packet(d->codecContext.get(), pkt.get());
-        }
-        if (ret < 0 && ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) {
+        ret = d->receivePackets();
+        if (ret < 0) {
             char err[AV_ERROR_MAX_STRING_SIZE];
             qWarning("Could not receive packet: %s", av_make_error_string(err, AV_ERROR_MAX_STRING_SIZE, ret));
             return AVUNERROR(ret);
@@ -142,6 +122,41 @@ namespace AVQt {
         return EXIT_SUCCESS;
     }
 
+    void GenericAudioEncoderImpl::flush() {
+        Q_D(GenericAudioEncoderImpl);
+
+        if (!d->open) {
+            qWarning("GenericAudioEncoderImpl::flush: Encoder is not open");
+            return;
+        }
+
+        int ret = avcodec_send_frame(d->codecContext.get(), nullptr);
+        // While draining, avcodec_receive_packet() returns packets until AVERROR_EOF and never EAGAIN
+        while (ret >= 0) {
+            std::shared_ptr<AVPacket> pkt(av_packet_alloc(), [](AVPacket *pkt) {
+                av_packet_free(&pkt);
+            });
+            ret = avcodec_receive_packet(d->codecContext.get(), pkt.get());
+            if (ret == 0) {
+                packetReady(pkt);
+            }
+        }
+        if (ret != AVERROR_EOF) {
+            char err[AV_ERROR_MAX_STRING_SIZE];
+            qWarning("Could not drain encoder: %s", av_make_error_string(err, AV_ERROR_MAX_STRING_SIZE, ret));
+        }
+
+#ifdef AV_CODEC_CAP_ENCODER_FLUSH
+        if (d->codec->capabilities & AV_CODEC_CAP_ENCODER_FLUSH) {
+            avcodec_flush_buffers(d->codecContext.get());
+            return;
+        }
+#endif
+        if (!d->openCodecContext()) {
+            qWarning("GenericAudioEncoderImpl::flush: Could not reopen codec");
+        }
+    }
+
     QVector<AVSampleFormat> GenericAudioEncoderImpl::getInputFormats() const {
         Q_D(const GenericAudioEncoderImpl);
 
@@ -180,6 +195,60 @@ namespace AVQt {
         return params;
     }
 
+    int GenericAudioEncoderImpl::getFrameSize() const {
+        Q_D(const GenericAudioEncoderImpl);
+        if (!d->codecContext || (d->codec->capabilities & AV_CODEC_CAP_VARIABLE_FRAME_SIZE)) {
+            return 0;
+        }
+        return d->codecContext->frame_size;
+    }
+
+    int GenericAudioEncoderImplPrivate::receivePackets() {
+        Q_Q(GenericAudioEncoderImpl);
+        while (true) {
+            std::shared_ptr<AVPacket> pkt(av_packet_alloc(), [](AVPacket *pkt) {
+                av_packet_free(&pkt);
+            });
+            int ret = avcodec_receive_packet(codecContext.get(), pkt.get());
+            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+                return 0;
+            } else if (ret < 0) {
+                return ret;
+            }
+            if (pkt->data == nullptr || pkt->pts == AV_NOPTS_VALUE) {
+                qWarning("GenericAudioEncoderImpl::encode: Received empty packet");
+                continue;
+            }
+            q->packetReady(pkt);
+        }
+    }
+
+    bool GenericAudioEncoderImplPrivate::openCodecContext() {
+        std::unique_ptr<AVCodecContext, decltype(&destroyAVCodecContext)> context{avcodec_alloc_context3(codec), &destroyAVCodecContext};
+        if (!context) {
+            qWarning("Could not allocate codec context");
+            return false;
+        }
+
+        const auto &format = inputParameters.format;
+        context->sample_fmt = format.sampleFormat();
+        context->sample_rate = format.sampleRate();
+        context->channel_layout = format.channelLayout() < 0 ? av_get_default_channel_layout(format.channels()) : format.channelLayout();
+        context->channels = format.channels();
+        context->time_base = {1, 1000000};// Microseconds
+        context->bit_rate = encodeParameters.bitrate;
+
+        int ret = avcodec_open2(context.get(), codec, nullptr);
+        if (ret < 0) {
+            char err[AV_ERROR_MAX_STRING_SIZE];
+            qWarning("Could not open codec: %s", av_make_error_string(err, AV_ERROR_MAX_STRING_SIZE, ret));
+            return false;
+        }
+
+        codecContext = std::move(context);
+        return true;
+    }
+
     void GenericAudioEncoderImplPrivate::destroyAVCodecContext(AVCodecContext *codecContext) {
         if (codecContext) {
             if (avcodec_is_open(codecContext)) {
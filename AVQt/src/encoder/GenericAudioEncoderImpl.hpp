@@ -20,9 +20,11 @@ namespace AVQt {
         bool open(const communication::AudioPadParams &params) override;
         void close() override;
         int encode(std::shared_ptr<AVFrame> frame) override;
+        void flush() override;
         [[nodiscard]] QVector<AVSampleFormat> getInputFormats() const override;
         [[nodiscard]] std::shared_ptr<AVCodecParameters> getCodecParameters() const override;
         [[nodiscard]] std::shared_ptr<communication::PacketPadParams> getPacketPadParams() const override;
+        [[nodiscard]] int getFrameSize() const override;
 
     signals:
         void packetReady(std::shared_ptr<AVPacket> packet) override;
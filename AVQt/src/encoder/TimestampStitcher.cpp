@@ -0,0 +1,41 @@
+#include "TimestampStitcher.hpp"
+
+namespace AVQt::internal {
+    void TimestampStitcher::restart() {
+        m_restartPending = true;
+    }
+
+    std::shared_ptr<AVFrame> TimestampStitcher::stitch(const std::shared_ptr<AVFrame> &frame, int64_t duration) {
+        if (!frame || frame->pts == AV_NOPTS_VALUE) {
+            return frame;
+        }
+
+        if (m_restartPending) {
+            m_restartPending = false;
+            if (m_lastPts != AV_NOPTS_VALUE) {
+                m_offset = m_lastPts + m_lastDuration - frame->pts;
+            }
+        }
+
+        const int64_t pts = frame->pts + m_offset;
+        if (duration > 0) {
+            m_lastDuration = duration;
+        } else if (m_lastPts != AV_NOPTS_VALUE && pts > m_lastPts) {
+            m_lastDuration = pts - m_lastPts;
+        }
+        m_lastPts = pts;
+
+        if (m_offset == 0) {
+            return frame;
+        }
+
+        std::shared_ptr<AVFrame> shifted{av_frame_clone(frame.get()), [](AVFrame *f) {
+                                             av_frame_free(&f);
+                                         }};
+        if (!shifted) {
+            return frame;
+        }
+        shifted->pts = pts;
+        return shifted;
+    }
+}// namespace AVQt::internal
@@ -0,0 +1,41 @@
+#ifndef LIBAVQT_TIMESTAMPSTITCHER_HPP
+#define LIBAVQT_TIMESTAMPSTITCHER_HPP
+
+#include <memory>
+
+extern "C" {
+#include <libavutil/frame.h>
+}
+
+namespace AVQt::internal {
+    /**
+     * @brief Keeps the timestamps of an encoder's input continuous across RESETs, e.g. when a Demuxer loops and starts over at the
+     * first timestamp of the file. After restart(), frames are shifted so the next one follows the last frame before it.
+     *
+     * Timestamps are in microseconds. Shifted frames are clones sharing the buffers of the input frame, which may be used elsewhere.
+     * Not thread-safe.
+     */
+    class TimestampStitcher {
+    public:
+        TimestampStitcher() = default;
+
+        /**
+         * @brief Lets the next frame continue after the last one
+         */
+        void restart();
+
+        /**
+         * @param duration Duration of frame in microseconds, 0 estimates it from the distance of the previous frames
+         * @return frame, or a clone of it with the shifted timestamp
+         */
+        std::shared_ptr<AVFrame> stitch(const std::shared_ptr<AVFrame> &frame, int64_t duration = 0);
+
+    private:
+        int64_t m_offset{0};
+        int64_t m_lastPts{AV_NOPTS_VALUE};
+        int64_t m_lastDuration{0};
+        bool m_restartPending{false};
+    };
+}// namespace AVQt::internal
+
+#endif//LIBAVQT_TIMESTAMPSTITCHER_HPP
@@ -31,6 +31,7 @@
 #include <va/va.h>
 #include <va/va_drmcommon.h>
 
+#include <algorithm>
 #include <iostream>
 #include <unistd.h>
 
@@ -39,6 +40,7 @@
 extern "C" {
 #include <libavutil/hwcontext_drm.h>
 #include <libavutil/hwcontext_vaapi.h>
+#include <libavutil/opt.h>
 #include <libavutil/pixdesc.h>
 }
 
@@ -128,11 +130,7 @@ namespace AVQt {
             char strBuf[256];
             bool createContext = false;
 
-            d->codecContext = {avcodec_alloc_context3(d->codec), &VAAPIEncoderImplPrivate::destroyAVCodecContext};
-            if (!d->codecContext) {
-                qWarning() << "Could not allocate video encoder context";
-                return false;
-            }
+            d->inputParams = params;
 
             if (params.hwDeviceContext && AVQt::VAAPIEncoderImplPrivate::supportedPixelFormats.contains(params.pixelFormat)) {
                 d->derivedContext = true;
@@ -217,20 +215,7 @@ namespace AVQt {
                 }
             }
 
-            d->codecContext->pix_fmt = params.pixelFormat;
-            d->codecContext->sw_pix_fmt = params.swPixelFormat;
-            d->codecContext->width = params.frameSize.width();
-            d->codecContext->height = params.frameSize.height();
-            d->codecContext->max_b_frames = 0;
-            d->codecContext->gop_size = 20;
-            d->codecContext->time_base = {1, 1000000};// microseconds
-            d->codecContext->hw_device_ctx = av_buffer_ref(d->hwDeviceContext.get());
-            d->codecContext->hw_frames_ctx = av_buffer_ref(d->hwFramesContext.get());
-            d->codecContext->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
-
-            ret = avcodec_open2(d->codecContext.get(), d->codec, nullptr);
-            if (ret < 0) {
-                qWarning() << "Could not open codec:" << av_make_error_string(strBuf, sizeof(strBuf), ret);
+            if (!d->openCodecContext()) {
                 goto fail;
             }
 
@@ -249,7 +234,7 @@ namespace AVQt {
     fail:
         close();
         d->initialized = false;
-        return EXIT_FAILURE;
+        return false;
     }
 
     void VAAPIEncoderImpl::close() {
@@ -261,6 +246,8 @@ namespace AVQt {
                 d->packetFetcher.reset();
             }
             d->hwFrame.reset();
+            d->pendingPacket.reset();
+            d->reconfigurePending = false;
             d->codecContext.reset();
             d->codecParams.reset();
             d->hwDeviceContext.reset();
@@ -297,10 +284,32 @@ namespace AVQt {
 
         {
             QMutexLocker codecLocker(&d->codecMutex);
-            auto t1 = std::chrono::high_resolution_clock::now();
+            if (d->reconfigurePending) {
+                // Rate control parameters are fixed once the codec is open, so the GOP is closed and the codec context recreated
+                d->reconfigurePending = false;
+                d->drainCodec();
+                if (!d->openCodecContext()) {
+                    qWarning() << "Could not reopen codec with the new parameters";
+                    return ENODEV;
+                }
+                d->forceKeyframe = true;
+            }
+            if (d->forceKeyframe) {
+                frame->pict_type = AV_PICTURE_TYPE_I;
+            }
             ret = avcodec_send_frame(d->codecContext.get(), frame.get());
-            auto t2 = std::chrono::high_resolution_clock::now();
-            //            qDebug("[AVQt::VAAPIEncoderImpl2] avcodec_send_frame took %ld ns", std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count());
+            // The encoder is full until the PacketFetcher received a packet, which wakes codecCond
+            while (ret == AVERROR(EAGAIN) && d->initialized) {
+                if (!d->codecCond.wait(&d->codecMutex, 100)) {
+                    break;
+                }
+                ret = avcodec_send_frame(d->codecContext.get(), frame.get());
+            }
+            if (ret == 0) {
+                d->forceKeyframe = false;
+                d->firstFrame = false;
+                d->codecCond.wakeAll();
+            }
         }
         if (ret == AVERROR(EAGAIN)) {
             return EAGAIN;
@@ -315,11 +324,54 @@ namespace AVQt {
         }
         ++frameCount;
 
-        d->firstFrame = false;
-
         return EXIT_SUCCESS;
     }
 
+    void VAAPIEncoderImpl::flush() {
+        Q_D(VAAPIEncoderImpl);
+
+        QMutexLocker codecLocker(&d->codecMutex);
+        if (!d->codecContext) {
+            return;
+        }
+
+        d->drainCodec();
+
+#ifdef AV_CODEC_CAP_ENCODER_FLUSH
+        if (d->codec->capabilities & AV_CODEC_CAP_ENCODER_FLUSH) {
+            avcodec_flush_buffers(d->codecContext.get());
+        } else
+#endif
+        {
+            // Only the codec context is recreated, the device and frames contexts and their surface pools are kept
+            if (!d->openCodecContext()) {
+                qWarning() << "Could not reopen codec after flushing";
+            }
+        }
+        d->forceKeyframe = true;
+    }
+
+    bool VAAPIEncoderImpl::reconfigure(const VideoEncodeParameters &parameters) {
+        Q_D(VAAPIEncoderImpl);
+        QMutexLocker codecLocker(&d->codecMutex);
+        d->encodeParameters.bitrate = parameters.bitrate;
+        d->encodeParameters.maxBitrate = parameters.maxBitrate;
+        d->reconfigurePending = static_cast<bool>(d->codecContext);
+        return true;
+    }
+
+    void VAAPIEncoderImpl::requestKeyframe() {
+        Q_D(VAAPIEncoderImpl);
+        QMutexLocker codecLocker(&d->codecMutex);
+        d->forceKeyframe = true;
+    }
+
+    VideoEncodeParameters VAAPIEncoderImpl::getEncodeParameters() const {
+        Q_D(const VAAPIEncoderImpl);
+        QMutexLocker codecLocker(&d->codecMutex);
+        return d->encodeParameters;
+    }
+
     QVector<AVPixelFormat> VAAPIEncoderImpl::getInputFormats() const {
         Q_D(const VAAPIEncoderImpl);
         if (d->firstFrame) {
@@ -330,6 +382,11 @@ namespace AVQt {
         }
     }
 
+    bool VAAPIEncoderImpl::isReconfigureSeamless() const {
+        // The rate control of the VAAPI encoders is set up when opening the codec
+        return false;
+    }
+
     bool VAAPIEncoderImpl::isHWAccel() const {
         return true;
     }
@@ -359,6 +416,87 @@ namespace AVQt {
         return params;
     }
 
+    bool VAAPIEncoderImplPrivate::openCodecContext() {
+        char strBuf[AV_ERROR_MAX_STRING_SIZE];
+
+        std::unique_ptr<AVCodecContext, decltype(&destroyAVCodecContext)> context{avcodec_alloc_context3(codec), &destroyAVCodecContext};
+        if (!context) {
+            qWarning() << "Could not allocate video encoder context";
+            return false;
+        }
+
+        context->pix_fmt = inputParams.pixelFormat;
+        context->sw_pix_fmt = inputParams.swPixelFormat;
+        context->width = inputParams.frameSize.width();
+        context->height = inputParams.frameSize.height();
+        context->max_b_frames = 0;
+        context->gop_size = encodeParameters.gopSize > 0 ? encodeParameters.gopSize : 20;
+        if (encodeParameters.bitrate > 0) {
+            context->bit_rate = encodeParameters.bitrate;
+        }
+        if (encodeParameters.maxBitrate > 0) {
+            context->rc_max_rate = std::max(encodeParameters.maxBitrate, encodeParameters.bitrate);
+        }
+        context->time_base = {1, 1000000};// microseconds
+        context->hw_device_ctx = av_buffer_ref(hwDeviceContext.get());
+        context->hw_frames_ctx = av_buffer_ref(hwFramesContext.get());
+        context->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+        if (encodeParameters.lowDelay) {
+            context->flags |= AV_CODEC_FLAG_LOW_DELAY;
+            // Don't queue frames in the driver, older libavcodec versions lack the option
+            av_opt_set_int(context->priv_data, "async_depth", 1, 0);
+        }
+
+        int ret = avcodec_open2(context.get(), codec, nullptr);
+        if (ret < 0) {
+            qWarning() << "Could not open codec:" << av_make_error_string(strBuf, sizeof(strBuf), ret);
+            return false;
+        }
+
+        codecContext = std::move(context);
+        return true;
+    }
+
+    void VAAPIEncoderImplPrivate::drainCodec() {
+        Q_Q(VAAPIEncoderImpl);
+        char strBuf[AV_ERROR_MAX_STRING_SIZE];
+
+        int ret = avcodec_send_frame(codecContext.get(), nullptr);
+        if (ret < 0 && ret != AVERROR_EOF) {
+            qWarning() << "Could not enter draining mode:" << av_make_error_string(strBuf, sizeof(strBuf), ret);
+        }
+        // While draining, avcodec_receive_packet() returns packets until AVERROR_EOF and never EAGAIN
+        while (ret >= 0) {
+            std::shared_ptr<AVPacket> packet{av_packet_alloc(), [](AVPacket *pak) {
+                                                 av_packet_free(&pak);
+                                             }};
+            ret = avcodec_receive_packet(codecContext.get(), packet.get());
+            if (ret == 0) {
+                av_packet_rescale_ts(packet.get(), codecContext->time_base, {1, 1000000});
+                queuePacket(std::move(packet));
+            } else if (ret != AVERROR_EOF) {
+                qWarning() << "Could not receive packet:" << av_make_error_string(strBuf, sizeof(strBuf), ret);
+            }
+        }
+        if (pendingPacket) {
+            q->packetReady(pendingPacket);
+            pendingPacket.reset();
+        }
+    }
+
+    void VAAPIEncoderImplPrivate::queuePacket(std::shared_ptr<AVPacket> packet) {
+        Q_Q(VAAPIEncoderImpl);
+        if (pendingPacket) {
+            auto newDuration = packet->pts - pendingPacket->pts;
+            if (newDuration > 0) {
+                pendingPacket->duration = newDuration;
+                packet->duration = newDuration;
+            }
+            q->packetReady(pendingPacket);
+        }
+        pendingPacket = std::move(packet);
+    }
+
     int VAAPIEncoderImplPrivate::mapFrameToHW(std::shared_ptr<AVFrame> &output, const std::shared_ptr<AVFrame> &frame) {
         int ret;
         char strBuf[256];
@@ -593,13 +731,12 @@ namespace AVQt {
         constexpr size_t strBufSize = 256;
         char strBuf[strBufSize];
 
+        QMutexLocker codecLock(&p->codecMutex);
         while (!m_stop) {
-            if (p->firstFrame) {
-                msleep(10);
+            if (p->firstFrame || !p->codecContext) {
+                p->codecCond.wait(&p->codecMutex);
                 continue;
             }
-            QElapsedTimer timer;
-            timer.start();
 
             std::shared_ptr<AVPacket> nextPacket{av_packet_alloc(), [](AVPacket *pak) {
                                                      av_packet_free(&pak);
@@ -609,33 +746,23 @@ namespace AVQt {
                 return;
             }
 
-            {
-                QMutexLocker codecLock(&p->codecMutex);
-                ret = avcodec_receive_packet(p->codecContext.get(), nextPacket.get());
-            }
-
-            av_packet_rescale_ts(nextPacket.get(), p->codecContext->time_base, {1, 1000000});
-
-            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
-                msleep(1);
-            } else if (ret < 0) {
-                qWarning() << "Could not receive nextPacket:" << av_make_error_string(strBuf, sizeof(strBuf), ret);
+            ret = avcodec_receive_packet(p->codecContext.get(), nextPacket.get());
+            if (ret == 0) {
+                av_packet_rescale_ts(nextPacket.get(), p->codecContext->time_base, {1, 1000000});
+                p->queuePacket(std::move(nextPacket));
+                // The encoder has room for the next frame again
+                p->codecCond.wakeAll();
+            } else if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+                p->codecCond.wait(&p->codecMutex);
             } else {
-                if (packet) {
-                    //                    qDebug() << "Packet duration:" << nextPacket->duration << "us";
-                    auto newDuration = nextPacket->pts - packet->pts;
-                    if (newDuration > 0) {
-                        packet->duration = newDuration;
-                        nextPacket->duration = newDuration;
-                    }
-                    p->q_func()->packetReady(packet);
-                }
-                packet = std::move(nextPacket);
+                qWarning() << "Could not receive nextPacket:" << av_make_error_string(strBuf, sizeof(strBuf), ret);
+                p->codecCond.wait(&p->codecMutex, 10);
             }
         }
 
-        if (packet) {
-            p->q_func()->packetReady(packet);
+        if (p->pendingPacket) {
+            p->q_func()->packetReady(p->pendingPacket);
+            p->pendingPacket.reset();
         }
 
         qDebug() << "PacketFetcher stopped";
@@ -643,7 +770,11 @@ namespace AVQt {
 
     void internal::PacketFetcher::stop() {
         if (isRunning()) {
-            m_stop = true;
+            {
+                QMutexLocker codecLock(&p->codecMutex);
+                m_stop = true;
+                p->codecCond.wakeAll();
+            }
             QThread::quit();
             QThread::wait();
         } else {
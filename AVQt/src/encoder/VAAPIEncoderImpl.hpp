@@ -45,6 +45,12 @@ namespace AVQt {
 
         [[nodiscard]] std::shared_ptr<AVFrame> prepareFrame(std::shared_ptr<AVFrame> frame) override;
         int encode(std::shared_ptr<AVFrame> frame) override;
+        void flush() override;
+
+        bool reconfigure(const VideoEncodeParameters &parameters) override;
+        [[nodiscard]] bool isReconfigureSeamless() const override;
+        void requestKeyframe() override;
+        [[nodiscard]] VideoEncodeParameters getEncodeParameters() const override;
 
         [[nodiscard]] bool isHWAccel() const override;
 
@@ -29,6 +29,12 @@
 
 #include <pgraph_network/impl/RegisteringPadFactory.hpp>
 
+#include <algorithm>
+
+extern "C" {
+#include <libavutil/time.h>
+}
+
 namespace AVQt {
     VideoEncoder::VideoEncoder(const Config &config, std::shared_ptr<pgraph::network::api::PadRegistry> padRegistry, QObject *parent)
         : QThread(parent),
@@ -99,6 +105,63 @@ namespace AVQt {
         return false;
     }
 
+    bool VideoEncoder::setBitrate(int32_t bitrate, int32_t maxBitrate) {
+        Q_D(VideoEncoder);
+
+        if (!d->open || !d->impl) {
+            qWarning("VideoEncoder: Not open");
+            return false;
+        }
+
+        auto encodeParameters = d->impl->getEncodeParameters();
+        encodeParameters.bitrate = bitrate;
+        encodeParameters.maxBitrate = maxBitrate;
+        {
+            // The adaptive rate control scales from the new bitrate
+            std::lock_guard rateLock(d->rateMutex);
+            if (d->rateController) {
+                d->rateController->setBitrate(bitrate);
+                encodeParameters.bitrate = d->rateController->state().bitrate;
+            }
+        }
+        return d->impl->reconfigure(encodeParameters);
+    }
+
+    void VideoEncoder::requestKeyframe() {
+        Q_D(VideoEncoder);
+
+        if (!d->open || !d->impl) {
+            qWarning("VideoEncoder: Not open");
+            return;
+        }
+
+        d->impl->requestKeyframe();
+    }
+
+    VideoEncoder::AdaptiveRateStatistics VideoEncoder::getAdaptiveRateStatistics() const {
+        Q_D(const VideoEncoder);
+
+        AdaptiveRateStatistics statistics{};
+        {
+            std::lock_guard lock(d->inputQueueMutex);
+            statistics.queueDepth = d->inputQueue.size();
+        }
+        statistics.droppedFrames = d->droppedFrames;
+
+        std::lock_guard rateLock(d->rateMutex);
+        if (d->rateController) {
+            const auto state = d->rateController->state();
+            statistics.level = state.level;
+            statistics.bitrate = state.bitrate;
+            statistics.frameInterval = state.frameInterval;
+            statistics.meanEncodeTime = d->rateController->meanEncodeTime();
+            statistics.inputFrameDuration = d->rateController->inputFrameDuration();
+            statistics.decimatedFrames = d->rateController->decimatedFrames();
+            statistics.levelChanges = d->rateController->levelChanges();
+        }
+        return statistics;
+    }
+
     bool VideoEncoder::open() {
         Q_D(VideoEncoder);
 
@@ -113,7 +176,9 @@ namespace AVQt {
                     d->inputParams.isHWAccel
                             ? common::PixelFormat{d->inputParams.swPixelFormat, d->inputParams.pixelFormat}
                             : common::PixelFormat{d->inputParams.swPixelFormat, AV_PIX_FMT_NONE};
-            d->impl = VideoEncoderFactory::getInstance().create(inputFormat, getVideoCodecId(d->config.codec), d->config.encodeParameters, d->config.encoderPriority);
+            auto encodeParameters = d->config.encodeParameters;
+            encodeParameters.lowDelay = encodeParameters.lowDelay || d->config.latency.lowDelay;
+            d->impl = VideoEncoderFactory::getInstance().create(inputFormat, getVideoCodecId(d->config.codec), encodeParameters, d->config.encoderPriority);
 
             if (!d->impl) {
                 qFatal("No VideoEncoderImpl found");
@@ -126,6 +191,13 @@ namespace AVQt {
             }
             d->inputPadParams->isHWAccel = d->impl->isHWAccel();
 
+            if (d->config.adaptiveRate.enabled) {
+                std::lock_guard rateLock(d->rateMutex);
+                d->rateController = std::make_unique<internal::EncodeRateController>(encodeParameters.bitrate, d->config.adaptiveRate.minBitrate,
+                                                                                     d->config.adaptiveRate.maxFrameInterval, d->impl->isReconfigureSeamless());
+                d->droppedFrames = 0;
+            }
+
             connect(std::dynamic_pointer_cast<QObject>(d->impl).get(), SIGNAL(packetReady(std::shared_ptr<AVPacket>)),
                     this, SLOT(onPacketReady(std::shared_ptr<AVPacket>)), Qt::DirectConnection);
 
@@ -294,19 +366,21 @@ namespace AVQt {
                         break;
                     case communication::Message::Action::RESET: {
                         if (d->open) {
-                            std::unique_lock lock{d->inputQueueMutex};
-                            if (!d->inputQueue.empty()) {
-                                d->inputQueueCond.wait(lock, [d] { return d->inputQueue.empty() || !d->running; });
+                            {
+                                std::unique_lock lock{d->inputQueueMutex};
+                                // While paused, the queued frames are encoded after the flush
+                                d->inputQueueCond.wait(lock, [d] { return ((d->inputQueue.empty() || d->paused) && !d->encoding) || !d->running; });
                             }
-                            d->impl->close();
+                            // Keeps the codec and its frame pools, the next frame starts a new GOP and continues the timestamps
+                            d->impl->flush();
+                            d->timestampStitcher.restart();
                             pgraph::impl::SimpleProcessor::produce(communication::Message::builder().withAction(communication::Message::Action::RESET).build(), d->outputPadId);
-                            if (!d->impl->open(d->inputParams)) {
-                                qWarning("VideoEncoder: Failed to open");
-                                close();
-                            }
                         }
                         break;
                     }
+                    case communication::Message::Action::RESIZE:
+                        // The encoder is reopened lazily with the first frame of the new size
+                        break;
                     default:
                         qFatal("Unimplemented action %s", message->getAction().name().toLocal8Bit().data());
                 }
@@ -344,25 +418,39 @@ namespace AVQt {
             }
 
             auto frame = d->inputQueue.front();
+            d->encoding = true;
             lock.unlock();
 
+            int ret;
             if (d->inputParams.frameSize.width() != frame->width || d->inputParams.frameSize.height() != frame->height) {
                 qWarning("VideoEncoder: Frame size mismatch");
-                continue;
+                ret = EINVAL;
+            } else {
+                // Blocks until the encoder accepted the frame, the packets are emitted by the implementation's receive thread
+                const int64_t encodeStart = av_gettime_relative();
+                ret = d->impl->encode(frame);
+                if (ret == EXIT_SUCCESS) {
+                    d->updateRateControl(av_gettime_relative() - encodeStart);
+                }
             }
-
-            int ret = d->impl->encode(frame);
             if (ret == EAGAIN) {
+                // Still full after the implementation's wait, retry the same frame
+                lock.lock();
+                d->encoding = false;
+                d->inputQueueCond.notify_all();
+                lock.unlock();
                 continue;
             } else if (ret != EXIT_SUCCESS) {
                 char strBuf[AV_ERROR_MAX_STRING_SIZE];
                 qWarning("VideoEncoder: Failed to encode frame: %s", av_make_error_string(strBuf, sizeof(strBuf), AVERROR(ret)));
-            } else {
-                lock.lock();
-                d->inputQueue.pop();
-                d->inputQueueCond.notify_all();
-                lock.unlock();
             }
+
+            // Failed frames are dropped as well, retrying them would never succeed
+            lock.lock();
+            d->inputQueue.pop();
+            d->encoding = false;
+            d->inputQueueCond.notify_all();
+            lock.unlock();
         }
     }
 
@@ -372,7 +460,27 @@ namespace AVQt {
     }
 
     void VideoEncoderPrivate::enqueueData(const std::shared_ptr<AVFrame> &frame) {
-        auto preparedFrame = impl->prepareFrame(frame);
+        Q_Q(VideoEncoder);
+        if (!open || !frame) {
+            return;
+        }
+
+        if (frame->width != inputParams.frameSize.width() || frame->height != inputParams.frameSize.height()) {
+            if (!reopenForFrame(frame)) {
+                qWarning("VideoEncoder: Failed to reopen encoder for %dx%d frames", frame->width, frame->height);
+                q->close();
+                return;
+            }
+        }
+
+        {
+            std::lock_guard rateLock(rateMutex);
+            if (rateController && !rateController->admitFrame(frame->pts)) {
+                return;
+            }
+        }
+
+        auto preparedFrame = impl->prepareFrame(timestampStitcher.stitch(frame));
         if (!preparedFrame) {
             qWarning("VideoEncoder: Failed to prepare frame");
             return;
@@ -380,9 +488,15 @@ namespace AVQt {
 
         {
             std::unique_lock lock(inputQueueMutex);
-            if (inputQueue.size() >= 4) {
+            const auto maxQueueSize = static_cast<size_t>(std::max(config.latency.encoderQueueSize, 1));
+            if (inputQueue.size() >= maxQueueSize && config.adaptiveRate.enabled) {
+                // Live input must not back up into the producer, the rate control catches up with the next frames
+                ++droppedFrames;
+                return;
+            }
+            if (inputQueue.size() >= maxQueueSize) {
                 inputQueueCond.notify_all();
-                inputQueueCond.wait(lock, [this] { return inputQueue.size() < 4 || !running; });
+                inputQueueCond.wait(lock, [this, maxQueueSize] { return inputQueue.size() < maxQueueSize || !running; });
                 if (!running) {
                     qDebug("VideoEncoder: Stopped");
                     return;
@@ -392,4 +506,73 @@ namespace AVQt {
             inputQueueCond.notify_all();
         }
     }
+
+    bool VideoEncoderPrivate::reopenForFrame(const std::shared_ptr<AVFrame> &frame) {
+        Q_Q(VideoEncoder);
+
+        {
+            // A paused run thread doesn't drain the queue, but it has to finish the frame it is encoding
+            std::unique_lock lock{inputQueueMutex};
+            inputQueueCond.wait(lock, [this] { return ((inputQueue.empty() || paused) && !encoding) || !running; });
+            if (!inputQueue.empty()) {
+                // Can't be encoded at the new size
+                qWarning("VideoEncoder: Discarding %zu queued %dx%d frames for the resize", inputQueue.size(), inputParams.frameSize.width(), inputParams.frameSize.height());
+                inputQueue = {};
+                inputQueueCond.notify_all();
+            }
+        }
+
+        const QSize lastSize = inputParams.frameSize;
+        impl->flush();
+        impl->close();
+
+        inputParams.frameSize = QSize{frame->width, frame->height};
+        if (frame->hw_frames_ctx) {
+            // Frames of a new size come from a new frames context
+            inputParams.hwFramesContext = {av_buffer_ref(frame->hw_frames_ctx), [](AVBufferRef *buffer) {
+                                               av_buffer_unref(&buffer);
+                                           }};
+        }
+        if (!impl->open(inputParams)) {
+            return false;
+        }
+
+        *outputPadParams = *impl->getPacketPadParams();
+        q->produce(communication::Message::builder()
+                           .withAction(communication::Message::Action::RESIZE)
+                           .withPayload("size", inputParams.frameSize)
+                           .withPayload("lastSize", lastSize)
+                           .withPayload("packetParams", QVariant::fromValue(std::const_pointer_cast<const communication::PacketPadParams>(outputPadParams)))
+                           .build(),
+                   outputPadId);
+        return true;
+    }
+
+    void VideoEncoderPrivate::updateRateControl(int64_t encodeTime) {
+        size_t queueDepth;
+        {
+            std::lock_guard lock(inputQueueMutex);
+            queueDepth = inputQueue.size();
+        }
+
+        std::unique_lock rateLock(rateMutex);
+        if (!rateController) {
+            return;
+        }
+        rateController->frameEncoded(encodeTime);
+        const auto queueSize = static_cast<size_t>(std::max(config.latency.encoderQueueSize, 1));
+        if (!rateController->update(queueDepth, queueSize, av_gettime_relative())) {
+            return;
+        }
+        const auto state = rateController->state();
+        rateLock.unlock();
+
+        if (state.bitrate > 0) {
+            auto encodeParameters = impl->getEncodeParameters();
+            if (encodeParameters.bitrate != state.bitrate) {
+                encodeParameters.bitrate = state.bitrate;
+                impl->reconfigure(encodeParameters);
+            }
+        }
+    }
 }// namespace AVQt
@@ -2,7 +2,9 @@
 #define LIBAVQT_AUDIOENCODER_P_HPP
 
 #include "encoder/AudioEncoder.hpp"
+#include "encoder/AudioRechunker.hpp"
 #include "encoder/IAudioEncoderImpl.hpp"
+#include "encoder/TimestampStitcher.hpp"
 
 #include <QObject>
 
@@ -25,6 +27,19 @@ namespace AVQt {
 
         void enqueueData(std::shared_ptr<AVFrame> frame);
 
+        /**
+         * @brief (Re-)creates the rechunker for the frame size of the opened impl, or removes it, if the impl accepts any frame size
+         */
+        bool initRechunker();
+        /**
+         * @brief Passes frame to the impl, split into frames of the encoder's frame size if necessary
+         */
+        int encode(const std::shared_ptr<AVFrame> &frame);
+        /**
+         * @brief Encodes all complete frames in the rechunker, and the padded remainder, if flush is true. Requires rechunkerMutex.
+         */
+        void drainRechunker(bool flush);
+
         AudioEncoder::Config config;
 
         int64_t inputPadId{pgraph::api::INVALID_PAD_ID};
@@ -37,11 +52,20 @@ namespace AVQt {
         communication::AudioPadParams inputParams;
 
         std::shared_ptr<api::IAudioEncoderImpl> impl{};
+        // The rechunker isn't thread-safe, it is used from the run thread and from close()
+        std::mutex rechunkerMutex{};
+        std::unique_ptr<internal::AudioRechunker> rechunker{};
+        // Popped from the rechunker, but not accepted by the impl yet
+        std::shared_ptr<AVFrame> pendingChunk{};
+        // Only used from consume()
+        internal::TimestampStitcher timestampStitcher{};
 
         static constexpr auto inputQueueMaxSize = 64;
         std::mutex inputQueueMutex{};
         std::condition_variable inputQueueCond{};
         std::queue<std::shared_ptr<AVFrame>> inputQueue{};
+        // Set by run() while it passes the front of inputQueue to the impl, guarded by inputQueueMutex
+        bool encoding{false};
 
         std::mutex pausedMutex;
         std::condition_variable pausedCond;
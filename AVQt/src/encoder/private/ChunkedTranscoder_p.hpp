@@ -0,0 +1,92 @@
+#ifndef LIBAVQT_CHUNKEDTRANSCODER_P_HPP
+#define LIBAVQT_CHUNKEDTRANSCODER_P_HPP
+
+#include "encoder/ChunkedTranscoder.hpp"
+
+#include "communication/PacketPadParams.hpp"
+
+#include <pgraph/api/Pad.hpp>
+
+#include <QtCore/QThreadPool>
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libswscale/swscale.h>
+}
+
+namespace AVQt {
+    class ChunkedTranscoderPrivate {
+        Q_DECLARE_PUBLIC(ChunkedTranscoder)
+    public:
+        static void destroyAVFormatContext(AVFormatContext *formatContext);
+        static void destroyAVCodecContext(AVCodecContext *codecContext);
+        static void destroySwsContext(SwsContext *swsContext);
+        static void destroyAVFrame(AVFrame *frame);
+        static void destroyAVPacket(AVPacket *packet);
+
+    private:
+        struct Chunk {
+            // Presentation time range in microseconds, end is exclusive
+            int64_t start{0}, end{INT64_MAX};
+            std::vector<std::shared_ptr<AVPacket>> packets{};
+            bool finished{false}, failed{false};
+        };
+
+        using FormatContextPtr = std::unique_ptr<AVFormatContext, decltype(&destroyAVFormatContext)>;
+        using CodecContextPtr = std::unique_ptr<AVCodecContext, decltype(&destroyAVCodecContext)>;
+
+        explicit ChunkedTranscoderPrivate(ChunkedTranscoder *q);
+        ChunkedTranscoder *q_ptr;
+
+        /**
+         * @return the opened input, nullptr on error
+         */
+        [[nodiscard]] FormatContextPtr openInput() const;
+        /**
+         * @brief Reads all packets of the video stream and splits it into chunks at keyframes
+         */
+        bool buildChunks();
+        /**
+         * @return an encoder configured identically for every chunk, nullptr on error
+         */
+        [[nodiscard]] CodecContextPtr openEncoder() const;
+        /**
+         * @brief Transcodes the chunk at index, runs on the worker pool
+         */
+        void transcodeChunk(size_t index);
+        /**
+         * @brief Queues chunks on the worker pool, until as many are in flight as the pool has threads, plus one
+         */
+        void submitChunks();
+
+        ChunkedTranscoder::Config config{};
+
+        int64_t outputPadId{pgraph::api::INVALID_PAD_ID};
+        std::shared_ptr<communication::PacketPadParams> outputPadParams{};
+
+        const AVCodec *encoder{nullptr};
+        int videoStreamIndex{-1};
+        AVRational frameRate{0, 1};
+        AVPixelFormat encoderFormat{AV_PIX_FMT_NONE};
+        int width{0}, height{0};
+        // Subtracted from all timestamps, so the output starts at 0
+        int64_t startTime{0};
+
+        QThreadPool workerPool{};
+
+        mutable std::mutex chunkMutex{};
+        std::condition_variable chunkCond{};
+        std::vector<Chunk> chunks{};
+        size_t nextChunkToSubmit{0}, nextChunkToProduce{0};
+
+        std::atomic_bool initialized{false}, open{false}, running{false}, paused{false};
+    };
+}// namespace AVQt
+
+
+#endif//LIBAVQT_CHUNKEDTRANSCODER_P_HPP
@@ -0,0 +1,134 @@
+#ifndef LIBAVQT_ENCODELADDER_P_HPP
+#define LIBAVQT_ENCODELADDER_P_HPP
+
+#include "encoder/EncodeLadder.hpp"
+
+#include "communication/Message.hpp"
+#include "communication/PacketPadParams.hpp"
+#include "communication/VideoPadParams.hpp"
+
+#include <pgraph/api/Pad.hpp>
+
+#include <QtCore/QThread>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <vector>
+
+extern "C" {
+#include <libavutil/buffer.h>
+#include <libavutil/frame.h>
+#include <libswscale/swscale.h>
+}
+
+namespace AVQt {
+    namespace internal {
+        class LadderRungWorker;
+    }
+
+    class EncodeLadderPrivate {
+        Q_DECLARE_PUBLIC(EncodeLadder)
+    public:
+        static void destroySwsContext(SwsContext *swsContext);
+        static void destroyAVBufferPool(AVBufferPool *bufferPool);
+        static void destroyAVFrame(AVFrame *frame);
+
+    private:
+        struct Rung {
+            EncodeLadder::Rung config{};
+            int64_t outputPadId{pgraph::api::INVALID_PAD_ID};
+            std::shared_ptr<communication::PacketPadParams> outputPadParams{};
+            // Software frames at the size of the rung
+            communication::VideoPadParams inputParams{};
+            // Scales the frames of the previous rung, or the input for the first one
+            std::unique_ptr<SwsContext, decltype(&destroySwsContext)> scaler{nullptr, &destroySwsContext};
+            // Backs the scaled frames, so scaling doesn't allocate per frame
+            std::unique_ptr<AVBufferPool, decltype(&destroyAVBufferPool)> framePool{nullptr, &destroyAVBufferPool};
+            std::shared_ptr<api::IVideoEncoderImpl> impl{};
+            std::unique_ptr<internal::LadderRungWorker> worker{};
+        };
+
+        explicit EncodeLadderPrivate(EncodeLadder *q);
+        EncodeLadder *q_ptr;
+
+        /**
+         * @return the pixel format all rungs are encoded from, based on the input format
+         */
+        [[nodiscard]] AVPixelFormat resolveFormat() const;
+        /**
+         * @return frame scaled to size by the scaler of rung, frame itself, if it already matches, nullptr on error
+         */
+        std::shared_ptr<AVFrame> scale(Rung &rung, const std::shared_ptr<AVFrame> &frame);
+        /**
+         * @return a frame of the rung's size and format from its pool, nullptr on error
+         */
+        std::shared_ptr<AVFrame> allocateFrame(Rung &rung);
+        /**
+         * @brief Scales frame down the ladder and queues the result of every rung for encoding
+         */
+        void processFrame(const std::shared_ptr<AVFrame> &frame);
+        void produceOnRungs(const std::shared_ptr<communication::Message> &message);
+        void producePacket(size_t rung, const std::shared_ptr<AVPacket> &packet);
+        void closeRungs();
+
+        EncodeLadder::Config config{};
+
+        int64_t inputPadId{pgraph::api::INVALID_PAD_ID};
+        communication::VideoPadParams inputParams{};
+        std::vector<Rung> rungs{};
+
+        int64_t frameCount{0};
+
+        static constexpr int frameAlignment{64};
+
+        std::atomic_bool initialized{false}, open{false}, running{false}, paused{false};
+
+        friend class internal::LadderRungWorker;
+    };
+
+    namespace internal {
+        /**
+         * @brief Feeds the frames of one rung to its encoder and produces the resulting packets on the rung's pad
+         */
+        class LadderRungWorker : public QThread {
+            Q_OBJECT
+        public:
+            LadderRungWorker(EncodeLadderPrivate *p, size_t rung);
+
+            /**
+             * @brief Queues frame for encoding, blocks while the queue is full
+             */
+            void enqueue(const std::shared_ptr<AVFrame> &frame);
+            /**
+             * @brief Blocks until all queued frames were passed to the encoder, or until the encoder is idle while paused
+             */
+            void waitForEmptyQueue();
+            void setPaused(bool state);
+            void stop();
+
+            void run() override;
+
+        private slots:
+            void onPacketReady(const std::shared_ptr<AVPacket> &packet);
+
+        private:
+            static constexpr size_t maxQueueSize{4};
+
+            EncodeLadderPrivate *p;
+            const size_t m_rung;
+
+            std::mutex m_queueMutex{};
+            std::condition_variable m_queueCond{};
+            std::queue<std::shared_ptr<AVFrame>> m_queue{};
+            std::atomic_bool m_stop{false};
+            bool m_paused{false};
+            // Set while a frame is passed to the encoder
+            bool m_encoding{false};
+        };
+    }// namespace internal
+}// namespace AVQt
+
+
+#endif//LIBAVQT_ENCODELADDER_P_HPP
@@ -19,6 +19,16 @@ namespace AVQt {
         explicit GenericAudioEncoderImplPrivate(AVCodecID codecId, AudioEncodeParameters encodeParameters, GenericAudioEncoderImpl *q);
         GenericAudioEncoderImpl *q_ptr;
 
+        /**
+         * @brief (Re-)creates codecContext from inputParameters and encodeParameters
+         */
+        bool openCodecContext();
+        /**
+         * @brief Emits packets until the encoder needs more input
+         * @return 0 or a negative FFmpeg error
+         */
+        int receivePackets();
+
         AudioEncodeParameters encodeParameters{};
         communication::AudioPadParams inputParameters{};
 
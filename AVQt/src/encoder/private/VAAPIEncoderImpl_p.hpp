@@ -52,7 +52,21 @@ namespace AVQt {
 
         int allocateHWFrame(std::shared_ptr<AVFrame> &output);
 
+        /**
+         * @brief (Re-)creates codecContext from inputParams and encodeParameters on the existing device and frames contexts
+         */
+        bool openCodecContext();
+        /**
+         * @brief Drains all frames the encoder holds back and emits their packets, leaving the codec in EOF state. Called with codecMutex locked.
+         */
+        void drainCodec();
+        /**
+         * @brief Emits the held back packet with its duration derived from packet, and holds back packet instead. Called with codecMutex locked.
+         */
+        void queuePacket(std::shared_ptr<AVPacket> packet);
+
         VideoEncodeParameters encodeParameters{};
+        communication::VideoPadParams inputParams{};
 
         std::shared_ptr<AVCodecParameters> codecParams{};
         std::unique_ptr<AVCodecContext, decltype(&destroyAVCodecContext)> codecContext{nullptr, &destroyAVCodecContext};
@@ -68,7 +82,14 @@ namespace AVQt {
         std::condition_variable frameProcessed{}, frameAvailable{};
         std::unique_ptr<internal::PacketFetcher> packetFetcher{};
 
-        QMutex codecMutex;
+        mutable QMutex codecMutex;
+        // Woken whenever the encoder accepted a frame or returned a packet, so the submitting thread and the PacketFetcher block instead of polling
+        QWaitCondition codecCond{};
+        // Guarded by codecMutex
+        std::shared_ptr<AVPacket> pendingPacket{};
+        bool forceKeyframe{false};
+        // encodeParameters changed, the codec context is recreated before the next frame
+        bool reconfigurePending{false};
         std::atomic_bool initialized{false}, firstFrame{true}, running{false}, paused{false};
 
         const static QList<AVPixelFormat> supportedPixelFormats;
@@ -87,8 +108,7 @@ namespace AVQt {
 
         private:
             VAAPIEncoderImplPrivate *p;
-            bool m_stop{false};
-            std::shared_ptr<AVPacket> packet{};
+            std::atomic_bool m_stop{false};
         };
     }// namespace internal
 }// namespace AVQt
@@ -23,6 +23,8 @@
 
 #include "AVQt/communication/PacketPadParams.hpp"
 #include "AVQt/encoder/IVideoEncoderImpl.hpp"
+#include "encoder/EncodeRateController.hpp"
+#include "encoder/TimestampStitcher.hpp"
 #include <QtCore>
 
 #include <queue>
@@ -42,6 +44,15 @@ namespace AVQt {
         explicit VideoEncoderPrivate(VideoEncoder *q) : QObject(), q_ptr(q){};
 
         void enqueueData(const std::shared_ptr<AVFrame> &frame);
+        /**
+         * @brief Reopens the encoder for the size of frame once the queued frames are encoded and announces it with RESIZE.
+         * While paused, the queued frames are discarded instead.
+         */
+        bool reopenForFrame(const std::shared_ptr<AVFrame> &frame);
+        /**
+         * @brief Feeds the encode time of a frame to the rate controller and applies its decisions. Called from run().
+         */
+        void updateRateControl(int64_t encodeTime);
 
         VideoEncoder *q_ptr;
 
@@ -54,13 +65,22 @@ namespace AVQt {
         std::shared_ptr<api::IVideoEncoderImpl> impl{};
 
         communication::VideoPadParams inputParams{};
+        // Only used from consume()
+        internal::TimestampStitcher timestampStitcher{};
 
         std::shared_ptr<communication::PacketPadParams> outputPadParams{};
         std::shared_ptr<communication::VideoPadParams> inputPadParams{};
 
-        std::mutex inputQueueMutex{};
+        mutable std::mutex rateMutex{};
+        // Guarded by rateMutex, only set if Config::adaptiveRate is enabled
+        std::unique_ptr<internal::EncodeRateController> rateController{};
+        std::atomic_uint64_t droppedFrames{0};
+
+        mutable std::mutex inputQueueMutex{};
         std::condition_variable inputQueueCond{};
         std::queue<std::shared_ptr<AVFrame>> inputQueue{};
+        // Set by run() while it passes the front of inputQueue to the impl, guarded by inputQueueMutex
+        bool encoding{false};
 
         // Threading stuff
         std::condition_variable pausedCond{};
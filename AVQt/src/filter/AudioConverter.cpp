@@ -0,0 +1,445 @@
+#include "filter/AudioConverter.hpp"
+#include "private/AudioConverter_p.hpp"
+
+#include "global.hpp"
+
+#include "communication/Message.hpp"
+
+#include <pgraph/api/Data.hpp>
+#include <pgraph/impl/SimplePadFactory.hpp>
+#include <pgraph_network/impl/RegisteringPadFactory.hpp>
+
+extern "C" {
+#include <libavutil/channel_layout.h>
+#include <libavutil/mathematics.h>
+}
+
+namespace AVQt {
+    namespace {
+        /**
+         * @return the channel layout of format, or the default layout for its channel count, if it isn't known
+         */
+        uint64_t effectiveChannelLayout(const common::AudioFormat &format) {
+            const auto layout = format.channelLayout();
+            if (layout > 0 && layout != AV_CH_LAYOUT_NATIVE) {
+                return static_cast<uint64_t>(layout);
+            }
+            return static_cast<uint64_t>(av_get_default_channel_layout(format.channels()));
+        }
+    }// namespace
+
+    AudioConverter::AudioConverter(const Config &config, QObject *parent)
+        : QObject(parent),
+          pgraph::impl::SimpleProcessor(pgraph::impl::SimplePadFactory::getInstance()),
+          d_ptr(new AudioConverterPrivate(this)) {
+        Q_D(AudioConverter);
+        d->config = config;
+    }
+
+    AudioConverter::AudioConverter(const Config &config, std::shared_ptr<pgraph::network::api::PadRegistry> padRegistry, QObject *parent)
+        : QObject(parent),
+          pgraph::impl::SimpleProcessor(pgraph::network::impl::RegisteringPadFactory::factoryFor(padRegistry)),
+          d_ptr(new AudioConverterPrivate(this)) {
+        Q_D(AudioConverter);
+        d->config = config;
+    }
+
+    AudioConverter::~AudioConverter() {
+        Q_D(AudioConverter);
+        if (d->open) {
+            close();
+        }
+    }
+
+    bool AudioConverter::init() {
+        Q_D(AudioConverter);
+
+        bool shouldBe = false;
+        if (d->initialized.compare_exchange_strong(shouldBe, true)) {
+            d->outputPadParams = std::make_shared<communication::AudioPadParams>(common::AudioFormat{0, 0, AV_SAMPLE_FMT_NONE});
+
+            d->inputPadId = pgraph::impl::SimpleProcessor::createInputPad(std::make_shared<communication::AudioPadParams>());
+            d->outputPadId = pgraph::impl::SimpleProcessor::createOutputPad(d->outputPadParams);
+            if (d->inputPadId == pgraph::api::INVALID_PAD_ID || d->outputPadId == pgraph::api::INVALID_PAD_ID) {
+                qWarning() << "AudioConverter: failed to create pads";
+                d->initialized = false;
+                return false;
+            }
+            return true;
+        } else {
+            qWarning() << "AudioConverter::init() called multiple times";
+            return false;
+        }
+    }
+
+    bool AudioConverter::isOpen() const {
+        Q_D(const AudioConverter);
+        return d->open;
+    }
+
+    bool AudioConverter::isRunning() const {
+        Q_D(const AudioConverter);
+        return d->running;
+    }
+
+    bool AudioConverter::isPaused() const {
+        Q_D(const AudioConverter);
+        return d->paused;
+    }
+
+    void AudioConverter::consume(int64_t pad, std::shared_ptr<pgraph::api::Data> data) {
+        Q_D(AudioConverter);
+        Q_UNUSED(pad)
+        if (data->getType() == communication::Message::Type) {
+            auto message = std::static_pointer_cast<communication::Message>(data);
+            switch (static_cast<communication::Message::Action::Enum>(message->getAction())) {
+                case communication::Message::Action::INIT:
+                    d->inputFormat = message->getPayload("audioParams").value<communication::AudioPadParams>().format;
+                    if (!open()) {
+                        qWarning() << "AudioConverter: failed to open";
+                    }
+                    break;
+                case communication::Message::Action::CLEANUP:
+                    close();
+                    break;
+                case communication::Message::Action::START:
+                    if (!start()) {
+                        qWarning() << "AudioConverter: failed to start";
+                    }
+                    break;
+                case communication::Message::Action::STOP:
+                    stop();
+                    break;
+                case communication::Message::Action::PAUSE:
+                    pause(message->getPayload("state").toBool());
+                    break;
+                case communication::Message::Action::RESET:
+                    if (d->open) {
+                        {
+                            // Samples buffered for the old position must not leak into the new one
+                            std::unique_lock lock(d->resamplerMutex);
+                            if (d->swrContext && !d->initResampler(d->inputFormat.value())) {
+                                qWarning() << "AudioConverter: failed to reset resampler";
+                            }
+                            d->nextPts = AV_NOPTS_VALUE;
+                        }
+                        produce(communication::Message::builder().withAction(communication::Message::Action::RESET).build(), d->outputPadId);
+                    }
+                    break;
+                case communication::Message::Action::DATA:
+                    if (d->running) {
+                        auto frame = message->getPayload("frame").value<std::shared_ptr<AVFrame>>();
+                        if (!frame) {
+                            break;
+                        }
+                        auto converted = d->canPassThrough(*frame) ? frame : d->convert(frame);
+                        if (converted) {
+                            produce(communication::Message::builder()
+                                            .withAction(communication::Message::Action::DATA)
+                                            .withPayload("frame", QVariant::fromValue(converted))
+                                            .build(),
+                                    d->outputPadId);
+                        }
+                    }
+                    break;
+                case communication::Message::Action::RESIZE:
+                case communication::Message::Action::NONE:
+                    break;
+            }
+        }
+    }
+
+    bool AudioConverter::open() {
+        Q_D(AudioConverter);
+
+        if (!d->initialized) {
+            qWarning() << "AudioConverter::open() called before init()";
+            return false;
+        }
+
+        bool shouldBe = false;
+        if (d->open.compare_exchange_strong(shouldBe, true)) {
+            d->outputFormat = d->resolveOutputFormat(d->inputFormat.value());
+
+            // Without a resampler, frames in the output format are passed through
+            if (!d->isOutputFormat(d->inputFormat.value())) {
+                std::unique_lock lock(d->resamplerMutex);
+                if (!d->initResampler(d->inputFormat.value())) {
+                    d->open = false;
+                    return false;
+                }
+            }
+
+            d->outputPadParams->format = d->outputFormat.value();
+            produce(communication::Message::builder()
+                            .withAction(communication::Message::Action::INIT)
+                            .withPayload("audioParams", QVariant::fromValue(*d->outputPadParams))
+                            .build(),
+                    d->outputPadId);
+            return true;
+        } else {
+            qWarning() << "AudioConverter::open() called multiple times";
+            return false;
+        }
+    }
+
+    void AudioConverter::close() {
+        Q_D(AudioConverter);
+
+        if (d->running) {
+            stop();
+        }
+
+        bool shouldBe = true;
+        if (d->open.compare_exchange_strong(shouldBe, false)) {
+            produce(communication::Message::builder().withAction(communication::Message::Action::CLEANUP).build(), d->outputPadId);
+
+            std::unique_lock lock(d->resamplerMutex);
+            d->swrContext.reset();
+            d->bufferPool.reset();
+            d->bufferPoolSamples = 0;
+            d->nextPts = AV_NOPTS_VALUE;
+            d->outputFormat.reset();
+            d->outputPadParams->format = common::AudioFormat{0, 0, AV_SAMPLE_FMT_NONE};
+        } else {
+            qWarning() << "AudioConverter::close() called multiple times";
+        }
+    }
+
+    bool AudioConverter::start() {
+        Q_D(AudioConverter);
+
+        if (!d->open) {
+            qWarning() << "AudioConverter::start() called before open()";
+            return false;
+        }
+
+        bool shouldBe = false;
+        if (d->running.compare_exchange_strong(shouldBe, true)) {
+            d->paused = false;
+            produce(communication::Message::builder().withAction(communication::Message::Action::START).build(), d->outputPadId);
+            emit started();
+            return true;
+        } else {
+            qWarning() << "AudioConverter::start() called multiple times";
+            return false;
+        }
+    }
+
+    void AudioConverter::stop() {
+        Q_D(AudioConverter);
+
+        bool shouldBe = true;
+        if (d->running.compare_exchange_strong(shouldBe, false)) {
+            d->paused = false;
+            // Hand out the samples still buffered for resampling, before downstream stops
+            if (auto remaining = d->convert(nullptr)) {
+                produce(communication::Message::builder()
+                                .withAction(communication::Message::Action::DATA)
+                                .withPayload("frame", QVariant::fromValue(remaining))
+                                .build(),
+                        d->outputPadId);
+            }
+            produce(communication::Message::builder().withAction(communication::Message::Action::STOP).build(), d->outputPadId);
+            emit stopped();
+        } else {
+            qWarning() << "AudioConverter::stop() called multiple times";
+        }
+    }
+
+    void AudioConverter::pause(bool state) {
+        Q_D(AudioConverter);
+
+        bool shouldBe = !state;
+        if (d->paused.compare_exchange_strong(shouldBe, state)) {
+            produce(communication::Message::builder()
+                            .withAction(communication::Message::Action::PAUSE)
+                            .withPayload("state", state)
+                            .build(),
+                    d->outputPadId);
+            emit paused(state);
+        } else {
+            qDebug() << "AudioConverter::pause: state already" << state;
+        }
+    }
+
+    AudioConverterPrivate::AudioConverterPrivate(AudioConverter *q) : q_ptr(q) {}
+
+    common::AudioFormat AudioConverterPrivate::resolveOutputFormat(const common::AudioFormat &input) const {
+        const auto &requested = config.outputFormat;
+
+        const auto sampleRate = requested.sampleRate() > 0 ? requested.sampleRate() : input.sampleRate();
+        const auto sampleFormat = requested.sampleFormat() != AV_SAMPLE_FMT_NONE ? requested.sampleFormat() : input.sampleFormat();
+
+        uint64_t channelLayout;
+        if (requested.channelLayout() > 0 && requested.channelLayout() != AV_CH_LAYOUT_NATIVE) {
+            channelLayout = static_cast<uint64_t>(requested.channelLayout());
+        } else if (requested.channels() > 0 && requested.channels() != input.channels()) {
+            channelLayout = static_cast<uint64_t>(av_get_default_channel_layout(requested.channels()));
+        } else {
+            channelLayout = effectiveChannelLayout(input);
+        }
+
+        return {sampleRate, av_get_channel_layout_nb_channels(channelLayout), sampleFormat, channelLayout};
+    }
+
+    bool AudioConverterPrivate::isOutputFormat(const common::AudioFormat &format) const {
+        return effectiveChannelLayout(format) == effectiveChannelLayout(*outputFormat) &&
+               format.sampleRate() == outputFormat->sampleRate() &&
+               format.sampleFormat() == outputFormat->sampleFormat();
+    }
+
+    bool AudioConverterPrivate::canPassThrough(const AVFrame &frame) {
+        std::unique_lock lock(resamplerMutex);
+        // Once resampling, stay with it, so the buffered samples and the timestamps continue
+        return outputFormat && !swrContext &&
+               isOutputFormat({frame.sample_rate, frame.channels, static_cast<AVSampleFormat>(frame.format), frame.channel_layout});
+    }
+
+    bool AudioConverterPrivate::initResampler(const common::AudioFormat &input) {
+        swrContext.reset(swr_alloc_set_opts(swrContext.release(),
+                                            static_cast<int64_t>(effectiveChannelLayout(*outputFormat)),
+                                            outputFormat->sampleFormat(),
+                                            outputFormat->sampleRate(),
+                                            static_cast<int64_t>(effectiveChannelLayout(input)),
+                                            input.sampleFormat(),
+                                            input.sampleRate(),
+                                            0, nullptr));
+        if (!swrContext) {
+            qWarning() << "AudioConverter: failed to allocate resampler";
+            return false;
+        }
+
+        int ret = swr_init(swrContext.get());
+        if (ret < 0) {
+            char strBuf[AV_ERROR_MAX_STRING_SIZE];
+            qWarning() << "AudioConverter: failed to initialize resampler:" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+            swrContext.reset();
+            return false;
+        }
+        inputFormat = input;
+        return true;
+    }
+
+    std::shared_ptr<AVFrame> AudioConverterPrivate::allocateFrame(int nbSamples) {
+        const auto sampleFormat = outputFormat->sampleFormat();
+        const auto channels = outputFormat->channels();
+        const bool planar = av_sample_fmt_is_planar(sampleFormat);
+        const int planes = planar ? channels : 1;
+
+        std::shared_ptr<AVFrame> frame{av_frame_alloc(), &destroyAVFrame};
+        frame->format = sampleFormat;
+        frame->sample_rate = outputFormat->sampleRate();
+        frame->channels = channels;
+        frame->channel_layout = effectiveChannelLayout(*outputFormat);
+        frame->nb_samples = nbSamples;
+
+        if (planes > AV_NUM_DATA_POINTERS) {
+            // Would need extended_buf, which isn't worth pooling for such exotic layouts
+            if (av_frame_get_buffer(frame.get(), 0) < 0) {
+                return {};
+            }
+            return frame;
+        }
+
+        if (nbSamples > bufferPoolSamples) {
+            // Buffers still referenced by frames downstream keep the old pool alive until they are returned
+            const auto planeSize = av_samples_get_buffer_size(&bufferPoolLinesize, planar ? 1 : channels, nbSamples, sampleFormat, 0);
+            if (planeSize < 0) {
+                return {};
+            }
+            bufferPool.reset(av_buffer_pool_init(planeSize, nullptr));
+            bufferPoolSamples = nbSamples;
+        }
+        if (!bufferPool) {
+            return {};
+        }
+
+        for (int plane = 0; plane < planes; ++plane) {
+            frame->buf[plane] = av_buffer_pool_get(bufferPool.get());
+            if (!frame->buf[plane]) {
+                return {};
+            }
+            frame->data[plane] = frame->buf[plane]->data;
+        }
+        frame->extended_data = frame->data;
+        frame->linesize[0] = bufferPoolLinesize;
+        return frame;
+    }
+
+    std::shared_ptr<AVFrame> AudioConverterPrivate::convert(const std::shared_ptr<AVFrame> &frame) {
+        std::unique_lock lock(resamplerMutex);
+        if (!outputFormat) {
+            return {};
+        }
+
+        if (frame) {
+            const common::AudioFormat frameFormat{frame->sample_rate, frame->channels, static_cast<AVSampleFormat>(frame->format), frame->channel_layout};
+            if (!swrContext ||
+                frameFormat.sampleRate() != inputFormat->sampleRate() ||
+                frameFormat.sampleFormat() != inputFormat->sampleFormat() ||
+                effectiveChannelLayout(frameFormat) != effectiveChannelLayout(*inputFormat)) {
+                // The input changed mid-stream, the output format stays the same for downstream
+                if (!initResampler(frameFormat)) {
+                    return {};
+                }
+            }
+        } else if (!swrContext) {
+            return {};
+        }
+
+        const auto inputSamples = frame ? frame->nb_samples : 0;
+        const auto outputSamples = swr_get_out_samples(swrContext.get(), inputSamples);
+        if (outputSamples <= 0) {
+            return {};
+        }
+
+        auto result = allocateFrame(outputSamples);
+        if (!result) {
+            qWarning() << "AudioConverter: failed to allocate output frame";
+            return {};
+        }
+
+        // Buffered input delays the output, all timestamps in the pipeline are in microseconds
+        const auto delay = swr_get_delay(swrContext.get(), 1000000);
+        int ret = swr_convert(swrContext.get(),
+                              result->extended_data, outputSamples,
+                              frame ? const_cast<const uint8_t **>(frame->extended_data) : nullptr, inputSamples);
+        if (ret < 0) {
+            char strBuf[AV_ERROR_MAX_STRING_SIZE];
+            qWarning() << "AudioConverter: failed to convert frame:" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+            return {};
+        } else if (ret == 0) {
+            return {};
+        }
+        result->nb_samples = ret;
+
+        if (frame && frame->pts != AV_NOPTS_VALUE) {
+            result->pts = frame->pts - delay;
+        } else {
+            result->pts = nextPts;
+        }
+        if (result->pts != AV_NOPTS_VALUE) {
+            nextPts = result->pts + av_rescale(ret, 1000000, outputFormat->sampleRate());
+        }
+        return result;
+    }
+
+    void AudioConverterPrivate::destroySwrContext(SwrContext *swrContext) {
+        if (swrContext) {
+            swr_free(&swrContext);
+        }
+    }
+
+    void AudioConverterPrivate::destroyAVBufferPool(AVBufferPool *bufferPool) {
+        if (bufferPool) {
+            av_buffer_pool_uninit(&bufferPool);
+        }
+    }
+
+    void AudioConverterPrivate::destroyAVFrame(AVFrame *frame) {
+        if (frame) {
+            av_frame_free(&frame);
+        }
+    }
+}// namespace AVQt
@@ -0,0 +1,345 @@
+#include "filter/BitstreamFilter.hpp"
+#include "private/BitstreamFilter_p.hpp"
+
+#include "communication/Message.hpp"
+
+#include <pgraph/api/Data.hpp>
+#include <pgraph/impl/SimplePadFactory.hpp>
+#include <pgraph_network/impl/RegisteringPadFactory.hpp>
+
+namespace AVQt {
+    BitstreamFilter::BitstreamFilter(const Config &config, QObject *parent)
+        : QObject(parent),
+          pgraph::impl::SimpleProcessor(pgraph::impl::SimplePadFactory::getInstance()),
+          d_ptr(new BitstreamFilterPrivate(this)) {
+        Q_D(BitstreamFilter);
+        d->config = config;
+    }
+
+    BitstreamFilter::BitstreamFilter(const Config &config, std::shared_ptr<pgraph::network::api::PadRegistry> padRegistry, QObject *parent)
+        : QObject(parent),
+          pgraph::impl::SimpleProcessor(pgraph::network::impl::RegisteringPadFactory::factoryFor(padRegistry)),
+          d_ptr(new BitstreamFilterPrivate(this)) {
+        Q_D(BitstreamFilter);
+        d->config = config;
+    }
+
+    BitstreamFilter::~BitstreamFilter() {
+        Q_D(BitstreamFilter);
+        if (d->open) {
+            close();
+        }
+    }
+
+    bool BitstreamFilter::init() {
+        Q_D(BitstreamFilter);
+
+        bool shouldBe = false;
+        if (d->initialized.compare_exchange_strong(shouldBe, true)) {
+            d->inputPadId = pgraph::impl::SimpleProcessor::createInputPad(std::make_shared<communication::PacketPadParams>());
+            d->outputPadParams = std::make_shared<communication::PacketPadParams>();
+            d->outputPadId = pgraph::impl::SimpleProcessor::createOutputPad(d->outputPadParams);
+            if (d->inputPadId == pgraph::api::INVALID_PAD_ID || d->outputPadId == pgraph::api::INVALID_PAD_ID) {
+                qWarning() << "BitstreamFilter: failed to create pads";
+                d->initialized = false;
+                return false;
+            }
+            return true;
+        } else {
+            qWarning() << "BitstreamFilter::init() called multiple times";
+            return false;
+        }
+    }
+
+    bool BitstreamFilter::isOpen() const {
+        Q_D(const BitstreamFilter);
+        return d->open;
+    }
+
+    bool BitstreamFilter::isRunning() const {
+        Q_D(const BitstreamFilter);
+        return d->running;
+    }
+
+    bool BitstreamFilter::isPaused() const {
+        Q_D(const BitstreamFilter);
+        return d->paused;
+    }
+
+    int64_t BitstreamFilter::getInputPadId() const {
+        Q_D(const BitstreamFilter);
+        return d->inputPadId;
+    }
+
+    int64_t BitstreamFilter::getOutputPadId() const {
+        Q_D(const BitstreamFilter);
+        return d->outputPadId;
+    }
+
+    void BitstreamFilter::consume(int64_t pad, std::shared_ptr<pgraph::api::Data> data) {
+        Q_D(BitstreamFilter);
+        if (pad != d->inputPadId) {
+            qWarning() << "BitstreamFilter: data on unknown pad" << pad;
+            return;
+        }
+
+        if (data->getType() == communication::Message::Type) {
+            auto message = std::static_pointer_cast<communication::Message>(data);
+            switch (static_cast<communication::Message::Action::Enum>(message->getAction())) {
+                case communication::Message::Action::INIT:
+                    d->inputParams = message->getPayload("packetParams").value<std::shared_ptr<const communication::PacketPadParams>>();
+                    if (!open()) {
+                        qWarning() << "BitstreamFilter: failed to open";
+                    }
+                    break;
+                case communication::Message::Action::CLEANUP:
+                    close();
+                    break;
+                case communication::Message::Action::START:
+                    if (!start()) {
+                        qWarning() << "BitstreamFilter: failed to start";
+                    }
+                    break;
+                case communication::Message::Action::STOP:
+                    stop();
+                    break;
+                case communication::Message::Action::PAUSE:
+                    pause(message->getPayload("state").toBool());
+                    break;
+                case communication::Message::Action::RESET:
+                    if (d->open) {
+                        {
+                            // Discards packets buffered in the filters, e.g. after a seek
+                            std::unique_lock lock(d->filterMutex);
+                            if (d->bsfContext) {
+                                av_bsf_flush(d->bsfContext.get());
+                            }
+                        }
+                        produce(communication::Message::builder().withAction(communication::Message::Action::RESET).build(), d->outputPadId);
+                    }
+                    break;
+                case communication::Message::Action::DATA:
+                    if (d->running) {
+                        auto packet = message->getPayload("packet").value<std::shared_ptr<AVPacket>>();
+                        if (!packet) {
+                            break;
+                        }
+                        std::unique_lock lock(d->filterMutex);
+                        if (d->sendPacket(packet)) {
+                            d->drainPackets();
+                        }
+                    }
+                    break;
+                case communication::Message::Action::RESIZE:
+                case communication::Message::Action::NONE:
+                    break;
+            }
+        }
+    }
+
+    bool BitstreamFilter::open() {
+        Q_D(BitstreamFilter);
+
+        if (!d->initialized) {
+            qWarning() << "BitstreamFilter::open() called before init()";
+            return false;
+        }
+
+        bool shouldBe = false;
+        if (d->open.compare_exchange_strong(shouldBe, true)) {
+            if (!d->inputParams || !d->inputParams->codecParams) {
+                qWarning() << "BitstreamFilter: no packet parameters";
+                d->open = false;
+                return false;
+            }
+
+            std::unique_lock lock(d->filterMutex);
+            if (!d->configureFilters()) {
+                d->open = false;
+                return false;
+            }
+            lock.unlock();
+
+            produce(communication::Message::builder()
+                            .withAction(communication::Message::Action::INIT)
+                            .withPayload("packetParams", QVariant::fromValue(std::const_pointer_cast<const communication::PacketPadParams>(d->outputPadParams)))
+                            .build(),
+                    d->outputPadId);
+            return true;
+        } else {
+            qWarning() << "BitstreamFilter::open() called multiple times";
+            return false;
+        }
+    }
+
+    void BitstreamFilter::close() {
+        Q_D(BitstreamFilter);
+
+        if (d->running) {
+            stop();
+        }
+
+        bool shouldBe = true;
+        if (d->open.compare_exchange_strong(shouldBe, false)) {
+            produce(communication::Message::builder().withAction(communication::Message::Action::CLEANUP).build(), d->outputPadId);
+
+            std::unique_lock lock(d->filterMutex);
+            d->bsfContext.reset();
+            d->inputParams.reset();
+        } else {
+            qWarning() << "BitstreamFilter::close() called multiple times";
+        }
+    }
+
+    bool BitstreamFilter::start() {
+        Q_D(BitstreamFilter);
+
+        if (!d->open) {
+            qWarning() << "BitstreamFilter::start() called before open()";
+            return false;
+        }
+
+        bool shouldBe = false;
+        if (d->running.compare_exchange_strong(shouldBe, true)) {
+            d->paused = false;
+            produce(communication::Message::builder().withAction(communication::Message::Action::START).build(), d->outputPadId);
+            emit started();
+            return true;
+        } else {
+            qWarning() << "BitstreamFilter::start() called multiple times";
+            return false;
+        }
+    }
+
+    void BitstreamFilter::stop() {
+        Q_D(BitstreamFilter);
+
+        bool shouldBe = true;
+        if (d->running.compare_exchange_strong(shouldBe, false)) {
+            d->paused = false;
+            {
+                // Filters may hold back packets until EOF, flushing afterwards allows to restart
+                std::unique_lock lock(d->filterMutex);
+                if (d->sendPacket(nullptr)) {
+                    d->drainPackets();
+                }
+                if (d->bsfContext) {
+                    av_bsf_flush(d->bsfContext.get());
+                }
+            }
+            produce(communication::Message::builder().withAction(communication::Message::Action::STOP).build(), d->outputPadId);
+            emit stopped();
+        } else {
+            qWarning() << "BitstreamFilter::stop() called multiple times";
+        }
+    }
+
+    void BitstreamFilter::pause(bool state) {
+        Q_D(BitstreamFilter);
+
+        bool shouldBe = !state;
+        if (d->paused.compare_exchange_strong(shouldBe, state)) {
+            produce(communication::Message::builder()
+                            .withAction(communication::Message::Action::PAUSE)
+                            .withPayload("state", state)
+                            .build(),
+                    d->outputPadId);
+            emit paused(state);
+        } else {
+            qDebug() << "BitstreamFilter::pause: state already" << state;
+        }
+    }
+
+    BitstreamFilterPrivate::BitstreamFilterPrivate(BitstreamFilter *q) : q_ptr(q) {}
+
+    bool BitstreamFilterPrivate::configureFilters() {
+        char strBuf[AV_ERROR_MAX_STRING_SIZE];
+
+        AVBSFContext *context = nullptr;
+        // An empty chain results in the null filter, which passes packets through
+        int ret = av_bsf_list_parse_str(config.filters.toUtf8().constData(), &context);
+        if (ret < 0) {
+            qWarning() << "BitstreamFilter: failed to parse" << config.filters << ":" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+            return false;
+        }
+        bsfContext.reset(context);
+
+        ret = avcodec_parameters_copy(bsfContext->par_in, inputParams->codecParams.get());
+        if (ret < 0) {
+            qWarning() << "BitstreamFilter: failed to copy codec parameters:" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+            bsfContext.reset();
+            return false;
+        }
+        bsfContext->time_base_in = inputParams->timeBase;
+
+        ret = av_bsf_init(bsfContext.get());
+        if (ret < 0) {
+            qWarning() << "BitstreamFilter: failed to initialize" << config.filters << ":" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+            bsfContext.reset();
+            return false;
+        }
+
+        *outputPadParams = *inputParams;
+        outputPadParams->codecParams = std::shared_ptr<AVCodecParameters>(avcodec_parameters_alloc(), [](AVCodecParameters *p) {
+            avcodec_parameters_free(&p);
+        });
+        avcodec_parameters_copy(outputPadParams->codecParams.get(), bsfContext->par_out);
+        outputPadParams->timeBase = bsfContext->time_base_out;
+        return true;
+    }
+
+    bool BitstreamFilterPrivate::sendPacket(const std::shared_ptr<AVPacket> &packet) {
+        if (!bsfContext) {
+            return false;
+        }
+
+        int ret;
+        if (packet) {
+            // The filters take ownership of the packet's data, which may be shared with other consumers
+            AVPacket *ref = av_packet_clone(packet.get());
+            if (!ref) {
+                qWarning() << "BitstreamFilter: failed to reference packet";
+                return false;
+            }
+            ret = av_bsf_send_packet(bsfContext.get(), ref);
+            av_packet_free(&ref);
+        } else {
+            ret = av_bsf_send_packet(bsfContext.get(), nullptr);
+        }
+        if (ret < 0) {
+            char strBuf[AV_ERROR_MAX_STRING_SIZE];
+            qWarning() << "BitstreamFilter: failed to send packet:" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+            return false;
+        }
+        return true;
+    }
+
+    void BitstreamFilterPrivate::drainPackets() {
+        Q_Q(BitstreamFilter);
+
+        while (true) {
+            std::shared_ptr<AVPacket> packet{av_packet_alloc(), [](AVPacket *p) {
+                                                 av_packet_free(&p);
+                                             }};
+            int ret = av_bsf_receive_packet(bsfContext.get(), packet.get());
+            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+                break;
+            } else if (ret < 0) {
+                char strBuf[AV_ERROR_MAX_STRING_SIZE];
+                qWarning() << "BitstreamFilter: failed to receive packet:" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+                break;
+            }
+            q->produce(communication::Message::builder()
+                               .withAction(communication::Message::Action::DATA)
+                               .withPayload("packet", QVariant::fromValue(packet))
+                               .build(),
+                       outputPadId);
+        }
+    }
+
+    void BitstreamFilterPrivate::destroyAVBSFContext(AVBSFContext *bsfContext) {
+        if (bsfContext) {
+            av_bsf_free(&bsfContext);
+        }
+    }
+}// namespace AVQt
@@ -0,0 +1,621 @@
+#include "filter/FilterGraph.hpp"
+#include "private/FilterGraph_p.hpp"
+
+#include "global.hpp"
+
+#include "communication/Message.hpp"
+
+#include <pgraph/api/Data.hpp>
+#include <pgraph/impl/SimplePadFactory.hpp>
+#include <pgraph_network/impl/RegisteringPadFactory.hpp>
+
+#include <algorithm>
+#include <cinttypes>
+
+extern "C" {
+#include <libavfilter/buffersink.h>
+#include <libavfilter/buffersrc.h>
+#include <libavutil/hwcontext.h>
+}
+
+namespace AVQt {
+    namespace {
+        /**
+         * @return the channel layout of format, or the default layout for its channel count, if it isn't known
+         */
+        uint64_t effectiveChannelLayout(const common::AudioFormat &format) {
+            const auto layout = format.channelLayout();
+            if (layout > 0 && layout != AV_CH_LAYOUT_NATIVE) {
+                return static_cast<uint64_t>(layout);
+            }
+            return static_cast<uint64_t>(av_get_default_channel_layout(format.channels()));
+        }
+    }// namespace
+
+    FilterGraph::FilterGraph(const Config &config, QObject *parent)
+        : QObject(parent),
+          pgraph::impl::SimpleProcessor(pgraph::impl::SimplePadFactory::getInstance()),
+          d_ptr(new FilterGraphPrivate(this)) {
+        Q_D(FilterGraph);
+        d->config = config;
+    }
+
+    FilterGraph::FilterGraph(const Config &config, std::shared_ptr<pgraph::network::api::PadRegistry> padRegistry, QObject *parent)
+        : QObject(parent),
+          pgraph::impl::SimpleProcessor(pgraph::network::impl::RegisteringPadFactory::factoryFor(padRegistry)),
+          d_ptr(new FilterGraphPrivate(this)) {
+        Q_D(FilterGraph);
+        d->config = config;
+    }
+
+    FilterGraph::~FilterGraph() {
+        Q_D(FilterGraph);
+        if (d->open) {
+            close();
+        }
+    }
+
+    bool FilterGraph::init() {
+        Q_D(FilterGraph);
+
+        bool shouldBe = false;
+        if (d->initialized.compare_exchange_strong(shouldBe, true)) {
+            if (d->config.description.isEmpty() || d->config.inputs.isEmpty() || d->config.outputs.isEmpty()) {
+                qWarning() << "FilterGraph: description, inputs and outputs must not be empty";
+                d->initialized = false;
+                return false;
+            }
+
+            for (const auto &type : d->config.inputs) {
+                FilterGraphPrivate::Input input{};
+                input.type = type;
+                if (type == AVMEDIA_TYPE_VIDEO) {
+                    input.padId = pgraph::impl::SimpleProcessor::createInputPad(std::make_shared<communication::VideoPadParams>());
+                } else if (type == AVMEDIA_TYPE_AUDIO) {
+                    input.padId = pgraph::impl::SimpleProcessor::createInputPad(std::make_shared<communication::AudioPadParams>());
+                } else {
+                    qWarning() << "FilterGraph: unsupported input media type" << av_get_media_type_string(type);
+                }
+                d->inputs.push_back(std::move(input));
+            }
+            for (const auto &type : d->config.outputs) {
+                FilterGraphPrivate::Output output{};
+                output.type = type;
+                if (type == AVMEDIA_TYPE_VIDEO) {
+                    output.videoParams = std::make_shared<communication::VideoPadParams>();
+                    output.padId = pgraph::impl::SimpleProcessor::createOutputPad(output.videoParams);
+                } else if (type == AVMEDIA_TYPE_AUDIO) {
+                    output.audioParams = std::make_shared<communication::AudioPadParams>(common::AudioFormat{0, 0, AV_SAMPLE_FMT_NONE});
+                    output.padId = pgraph::impl::SimpleProcessor::createOutputPad(output.audioParams);
+                } else {
+                    qWarning() << "FilterGraph: unsupported output media type" << av_get_media_type_string(type);
+                }
+                d->outputs.push_back(std::move(output));
+            }
+
+            const auto invalidInput = std::any_of(d->inputs.begin(), d->inputs.end(), [](const auto &input) {
+                return input.padId == pgraph::api::INVALID_PAD_ID;
+            });
+            const auto invalidOutput = std::any_of(d->outputs.begin(), d->outputs.end(), [](const auto &output) {
+                return output.padId == pgraph::api::INVALID_PAD_ID;
+            });
+            if (invalidInput || invalidOutput) {
+                qWarning() << "FilterGraph: failed to create pads";
+                d->inputs.clear();
+                d->outputs.clear();
+                d->initialized = false;
+                return false;
+            }
+            return true;
+        } else {
+            qWarning() << "FilterGraph::init() called multiple times";
+            return false;
+        }
+    }
+
+    bool FilterGraph::isOpen() const {
+        Q_D(const FilterGraph);
+        return d->open;
+    }
+
+    bool FilterGraph::isRunning() const {
+        Q_D(const FilterGraph);
+        return d->running;
+    }
+
+    bool FilterGraph::isPaused() const {
+        Q_D(const FilterGraph);
+        return d->paused;
+    }
+
+    void FilterGraph::consume(int64_t pad, std::shared_ptr<pgraph::api::Data> data) {
+        Q_D(FilterGraph);
+        auto input = std::find_if(d->inputs.begin(), d->inputs.end(), [pad](const auto &in) {
+            return in.padId == pad;
+        });
+        if (input == d->inputs.end()) {
+            qWarning() << "FilterGraph: data on unknown pad" << pad;
+            return;
+        }
+        const bool isFirstInput = input == d->inputs.begin();
+
+        if (data->getType() == communication::Message::Type) {
+            auto message = std::static_pointer_cast<communication::Message>(data);
+            switch (static_cast<communication::Message::Action::Enum>(message->getAction())) {
+                case communication::Message::Action::INIT: {
+                    if (input->type == AVMEDIA_TYPE_VIDEO) {
+                        input->videoParams = message->getPayload("videoParams").value<communication::VideoPadParams>();
+                    } else {
+                        input->audioParams = message->getPayload("audioParams").value<communication::AudioPadParams>();
+                    }
+                    const auto allInitialized = std::all_of(d->inputs.begin(), d->inputs.end(), [](const auto &in) {
+                        return in.videoParams.has_value() || in.audioParams.has_value();
+                    });
+                    if (allInitialized && !d->open && !open()) {
+                        qWarning() << "FilterGraph: failed to open";
+                    }
+                    break;
+                }
+                case communication::Message::Action::CLEANUP:
+                    if (isFirstInput) {
+                        close();
+                    }
+                    break;
+                case communication::Message::Action::START:
+                    if (isFirstInput && !start()) {
+                        qWarning() << "FilterGraph: failed to start";
+                    }
+                    break;
+                case communication::Message::Action::STOP:
+                    if (isFirstInput) {
+                        stop();
+                    }
+                    break;
+                case communication::Message::Action::PAUSE:
+                    if (isFirstInput) {
+                        pause(message->getPayload("state").toBool());
+                    }
+                    break;
+                case communication::Message::Action::RESET:
+                    if (isFirstInput && d->open) {
+                        {
+                            // Buffered frames are discarded, the graph is rebuilt with the next frame
+                            std::unique_lock lock(d->graphMutex);
+                            d->graph.reset();
+                        }
+                        for (const auto &output : d->outputs) {
+                            produce(communication::Message::builder().withAction(communication::Message::Action::RESET).build(), output.padId);
+                        }
+                    }
+                    break;
+                case communication::Message::Action::DATA:
+                    if (d->running) {
+                        auto frame = message->getPayload("frame").value<std::shared_ptr<AVFrame>>();
+                        if (!frame) {
+                            break;
+                        }
+                        std::unique_lock lock(d->graphMutex);
+                        if (FilterGraphPrivate::updateInputParams(*input, frame.get()) && d->graph) {
+                            d->flushGraph();
+                            d->graph.reset();
+                        }
+                        if (!d->graph) {
+                            if (!d->configureGraph()) {
+                                break;
+                            }
+                            d->updateOutputParams(true);
+                        }
+                        if (d->sendFrame(*input, frame)) {
+                            d->drainOutputs();
+                        }
+                    }
+                    break;
+                case communication::Message::Action::RESIZE:
+                    // Frames carry their size, the graph is reconfigured with the next one
+                    break;
+                case communication::Message::Action::NONE:
+                    break;
+            }
+        }
+    }
+
+    bool FilterGraph::open() {
+        Q_D(FilterGraph);
+
+        if (!d->initialized) {
+            qWarning() << "FilterGraph::open() called before init()";
+            return false;
+        }
+
+        bool shouldBe = false;
+        if (d->open.compare_exchange_strong(shouldBe, true)) {
+            std::unique_lock lock(d->graphMutex);
+            if (!d->configureGraph()) {
+                d->open = false;
+                return false;
+            }
+            d->updateOutputParams(false);
+            lock.unlock();
+
+            for (const auto &output : d->outputs) {
+                auto builder = communication::Message::builder().withAction(communication::Message::Action::INIT);
+                if (output.type == AVMEDIA_TYPE_VIDEO) {
+                    builder.withPayload("videoParams", QVariant::fromValue(*output.videoParams));
+                } else {
+                    builder.withPayload("audioParams", QVariant::fromValue(*output.audioParams));
+                }
+                produce(builder.build(), output.padId);
+            }
+            return true;
+        } else {
+            qWarning() << "FilterGraph::open() called multiple times";
+            return false;
+        }
+    }
+
+    void FilterGraph::close() {
+        Q_D(FilterGraph);
+
+        if (d->running) {
+            stop();
+        }
+
+        bool shouldBe = true;
+        if (d->open.compare_exchange_strong(shouldBe, false)) {
+            for (const auto &output : d->outputs) {
+                produce(communication::Message::builder().withAction(communication::Message::Action::CLEANUP).build(), output.padId);
+            }
+
+            std::unique_lock lock(d->graphMutex);
+            d->graph.reset();
+            for (auto &input : d->inputs) {
+                input.videoParams.reset();
+                input.audioParams.reset();
+            }
+        } else {
+            qWarning() << "FilterGraph::close() called multiple times";
+        }
+    }
+
+    bool FilterGraph::start() {
+        Q_D(FilterGraph);
+
+        if (!d->open) {
+            qWarning() << "FilterGraph::start() called before open()";
+            return false;
+        }
+
+        bool shouldBe = false;
+        if (d->running.compare_exchange_strong(shouldBe, true)) {
+            d->paused = false;
+            for (const auto &output : d->outputs) {
+                produce(communication::Message::builder().withAction(communication::Message::Action::START).build(), output.padId);
+            }
+            emit started();
+            return true;
+        } else {
+            qWarning() << "FilterGraph::start() called multiple times";
+            return false;
+        }
+    }
+
+    void FilterGraph::stop() {
+        Q_D(FilterGraph);
+
+        bool shouldBe = true;
+        if (d->running.compare_exchange_strong(shouldBe, false)) {
+            d->paused = false;
+            {
+                // Filters like fps or tpad hold back frames until EOF
+                std::unique_lock lock(d->graphMutex);
+                if (d->graph) {
+                    d->flushGraph();
+                    d->graph.reset();
+                }
+            }
+            for (const auto &output : d->outputs) {
+                produce(communication::Message::builder().withAction(communication::Message::Action::STOP).build(), output.padId);
+            }
+            emit stopped();
+        } else {
+            qWarning() << "FilterGraph::stop() called multiple times";
+        }
+    }
+
+    void FilterGraph::pause(bool state) {
+        Q_D(FilterGraph);
+
+        bool shouldBe = !state;
+        if (d->paused.compare_exchange_strong(shouldBe, state)) {
+            for (const auto &output : d->outputs) {
+                produce(communication::Message::builder()
+                                .withAction(communication::Message::Action::PAUSE)
+                                .withPayload("state", state)
+                                .build(),
+                        output.padId);
+            }
+            emit paused(state);
+        } else {
+            qDebug() << "FilterGraph::pause: state already" << state;
+        }
+    }
+
+    FilterGraphPrivate::FilterGraphPrivate(FilterGraph *q) : q_ptr(q) {}
+
+    QString FilterGraphPrivate::inputLabel(size_t index) {
+        // libavfilter connects an unlabeled first input to [in]
+        return index == 0 ? QStringLiteral("in") : QStringLiteral("in%1").arg(index);
+    }
+
+    QString FilterGraphPrivate::outputLabel(size_t index) {
+        return index == 0 ? QStringLiteral("out") : QStringLiteral("out%1").arg(index);
+    }
+
+    bool FilterGraphPrivate::configureGraph() {
+        char strBuf[AV_ERROR_MAX_STRING_SIZE];
+
+        graph.reset(avfilter_graph_alloc());
+        if (!graph) {
+            qWarning() << "FilterGraph: failed to allocate filter graph";
+            return false;
+        }
+        // 0 lets libavfilter pick the number of CPU cores
+        graph->nb_threads = config.threads;
+
+        std::unique_ptr<AVFilterInOut, decltype(&destroyAVFilterInOut)> sourceOutputs{nullptr, &destroyAVFilterInOut}, sinkInputs{nullptr, &destroyAVFilterInOut};
+        std::shared_ptr<AVBufferRef> hwDeviceContext{};
+
+        for (size_t i = inputs.size(); i-- > 0;) {
+            auto &input = inputs[i];
+            const auto label = inputLabel(i).toStdString();
+            char args[512];
+            const AVFilter *filter;
+            if (input.type == AVMEDIA_TYPE_VIDEO) {
+                if (!input.videoParams) {
+                    qWarning() << "FilterGraph: input" << i << "is not initialized";
+                    graph.reset();
+                    return false;
+                }
+                filter = avfilter_get_by_name("buffer");
+                snprintf(args, sizeof(args), "video_size=%dx%d:pix_fmt=%d:time_base=1/1000000:pixel_aspect=1/1",
+                         input.videoParams->frameSize.width(), input.videoParams->frameSize.height(), input.videoParams->pixelFormat);
+            } else {
+                if (!input.audioParams) {
+                    qWarning() << "FilterGraph: input" << i << "is not initialized";
+                    graph.reset();
+                    return false;
+                }
+                const auto &format = input.audioParams->format;
+                filter = avfilter_get_by_name("abuffer");
+                snprintf(args, sizeof(args), "time_base=1/1000000:sample_rate=%d:sample_fmt=%s:channel_layout=0x%" PRIx64,
+                         format.sampleRate(), av_get_sample_fmt_name(format.sampleFormat()), effectiveChannelLayout(format));
+            }
+
+            input.source = nullptr;
+            int ret = avfilter_graph_create_filter(&input.source, filter, label.c_str(), args, nullptr, graph.get());
+            if (ret < 0) {
+                qWarning() << "FilterGraph: failed to create source for input" << i << ":" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+                graph.reset();
+                return false;
+            }
+
+            if (input.type == AVMEDIA_TYPE_VIDEO && input.videoParams->isHWAccel && input.videoParams->hwFramesContext) {
+                // Software graphs must not get a frames context, the source would then only accept hardware frames
+                auto *sourceParams = av_buffersrc_parameters_alloc();
+                if (!sourceParams) {
+                    qWarning() << "FilterGraph: failed to allocate source parameters";
+                    graph.reset();
+                    return false;
+                }
+                sourceParams->format = input.videoParams->pixelFormat;
+                sourceParams->hw_frames_ctx = input.videoParams->hwFramesContext.get();
+                ret = av_buffersrc_parameters_set(input.source, sourceParams);
+                av_free(sourceParams);
+                if (ret < 0) {
+                    qWarning() << "FilterGraph: failed to set hardware frames context for input" << i << ":" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+                    graph.reset();
+                    return false;
+                }
+                if (!hwDeviceContext) {
+                    hwDeviceContext = input.videoParams->hwDeviceContext;
+                }
+            }
+
+            auto *inOut = avfilter_inout_alloc();
+            inOut->name = av_strdup(label.c_str());
+            inOut->filter_ctx = input.source;
+            inOut->pad_idx = 0;
+            inOut->next = sourceOutputs.release();
+            sourceOutputs.reset(inOut);
+        }
+
+        for (size_t i = outputs.size(); i-- > 0;) {
+            auto &output = outputs[i];
+            const auto label = outputLabel(i).toStdString();
+            const auto *filter = avfilter_get_by_name(output.type == AVMEDIA_TYPE_VIDEO ? "buffersink" : "abuffersink");
+
+            output.sink = nullptr;
+            int ret = avfilter_graph_create_filter(&output.sink, filter, label.c_str(), nullptr, nullptr, graph.get());
+            if (ret < 0) {
+                qWarning() << "FilterGraph: failed to create sink for output" << i << ":" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+                graph.reset();
+                return false;
+            }
+
+            auto *inOut = avfilter_inout_alloc();
+            inOut->name = av_strdup(label.c_str());
+            inOut->filter_ctx = output.sink;
+            inOut->pad_idx = 0;
+            inOut->next = sinkInputs.release();
+            sinkInputs.reset(inOut);
+        }
+
+        auto *openInputs = sinkInputs.release();
+        auto *openOutputs = sourceOutputs.release();
+        int ret = avfilter_graph_parse_ptr(graph.get(), config.description.toStdString().c_str(), &openInputs, &openOutputs, nullptr);
+        destroyAVFilterInOut(openInputs);
+        destroyAVFilterInOut(openOutputs);
+        if (ret < 0) {
+            qWarning() << "FilterGraph: failed to parse" << config.description << ":" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+            graph.reset();
+            return false;
+        }
+
+        if (hwDeviceContext) {
+            // Needed by filters creating their own hardware frames, e.g. scale_vaapi or hwupload
+            for (unsigned int i = 0; i < graph->nb_filters; ++i) {
+                if (!graph->filters[i]->hw_device_ctx) {
+                    graph->filters[i]->hw_device_ctx = av_buffer_ref(hwDeviceContext.get());
+                }
+            }
+        }
+
+        ret = avfilter_graph_config(graph.get(), nullptr);
+        if (ret < 0) {
+            qWarning() << "FilterGraph: failed to configure" << config.description << ":" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+            graph.reset();
+            return false;
+        }
+        return true;
+    }
+
+    void FilterGraphPrivate::updateOutputParams(bool announce) {
+        Q_Q(FilterGraph);
+        for (auto &output : outputs) {
+            if (output.type == AVMEDIA_TYPE_VIDEO) {
+                const QSize size{av_buffersink_get_w(output.sink), av_buffersink_get_h(output.sink)};
+                if (announce && output.videoParams->frameSize.isValid() && size != output.videoParams->frameSize) {
+                    q->produce(communication::Message::builder()
+                                       .withAction(communication::Message::Action::RESIZE)
+                                       .withPayload("size", size)
+                                       .withPayload("lastSize", output.videoParams->frameSize)
+                                       .build(),
+                               output.padId);
+                }
+                output.videoParams->frameSize = size;
+                output.videoParams->pixelFormat = static_cast<AVPixelFormat>(av_buffersink_get_format(output.sink));
+
+                auto *hwFramesContext = av_buffersink_get_hw_frames_ctx(output.sink);
+                output.videoParams->isHWAccel = hwFramesContext != nullptr;
+                if (hwFramesContext) {
+                    auto *framesContext = reinterpret_cast<AVHWFramesContext *>(hwFramesContext->data);
+                    output.videoParams->swPixelFormat = framesContext->sw_format;
+                    output.videoParams->hwFramesContext = {av_buffer_ref(hwFramesContext), &destroyAVBufferRef};
+                    output.videoParams->hwDeviceContext = {av_buffer_ref(framesContext->device_ref), &destroyAVBufferRef};
+                } else {
+                    output.videoParams->swPixelFormat = output.videoParams->pixelFormat;
+                    output.videoParams->hwFramesContext.reset();
+                    output.videoParams->hwDeviceContext.reset();
+                }
+            } else {
+                output.audioParams->format = common::AudioFormat{
+                        av_buffersink_get_sample_rate(output.sink),
+                        av_buffersink_get_channels(output.sink),
+                        static_cast<AVSampleFormat>(av_buffersink_get_format(output.sink)),
+                        av_buffersink_get_channel_layout(output.sink)};
+            }
+        }
+    }
+
+    bool FilterGraphPrivate::updateInputParams(Input &input, const AVFrame *frame) {
+        if (input.type == AVMEDIA_TYPE_VIDEO) {
+            const QSize size{frame->width, frame->height};
+            const auto format = static_cast<AVPixelFormat>(frame->format);
+            const auto *framesData = frame->hw_frames_ctx ? frame->hw_frames_ctx->data : nullptr;
+            if (input.videoParams && input.videoParams->frameSize == size && input.videoParams->pixelFormat == format &&
+                (input.videoParams->hwFramesContext ? input.videoParams->hwFramesContext->data : nullptr) == framesData) {
+                return false;
+            }
+
+            communication::VideoPadParams params{};
+            params.frameSize = size;
+            params.pixelFormat = format;
+            params.isHWAccel = frame->hw_frames_ctx != nullptr;
+            if (frame->hw_frames_ctx) {
+                auto *framesContext = reinterpret_cast<AVHWFramesContext *>(frame->hw_frames_ctx->data);
+                params.swPixelFormat = framesContext->sw_format;
+                params.hwFramesContext = {av_buffer_ref(frame->hw_frames_ctx), &destroyAVBufferRef};
+                params.hwDeviceContext = {av_buffer_ref(framesContext->device_ref), &destroyAVBufferRef};
+            } else {
+                params.swPixelFormat = format;
+            }
+            input.videoParams = params;
+            return true;
+        } else {
+            const common::AudioFormat format{frame->sample_rate, frame->channels, static_cast<AVSampleFormat>(frame->format), frame->channel_layout};
+            if (input.audioParams && input.audioParams->format == format) {
+                return false;
+            }
+            input.audioParams = communication::AudioPadParams{format};
+            return true;
+        }
+    }
+
+    bool FilterGraphPrivate::sendFrame(Input &input, const std::shared_ptr<AVFrame> &frame) {
+        int ret = av_buffersrc_add_frame_flags(input.source, frame.get(), frame ? AV_BUFFERSRC_FLAG_KEEP_REF : 0);
+        if (ret < 0) {
+            char strBuf[AV_ERROR_MAX_STRING_SIZE];
+            qWarning() << "FilterGraph: failed to send frame:" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+            return false;
+        }
+        return true;
+    }
+
+    void FilterGraphPrivate::drainOutputs() {
+        Q_Q(FilterGraph);
+        for (auto &output : outputs) {
+            const auto timeBase = av_buffersink_get_time_base(output.sink);
+            while (true) {
+                std::shared_ptr<AVFrame> frame{av_frame_alloc(), &destroyAVFrame};
+                int ret = av_buffersink_get_frame(output.sink, frame.get());
+                if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+                    break;
+                } else if (ret < 0) {
+                    char strBuf[AV_ERROR_MAX_STRING_SIZE];
+                    qWarning() << "FilterGraph: failed to receive frame:" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+                    break;
+                }
+                // Filters like fps change the time base
+                if (frame->pts != AV_NOPTS_VALUE) {
+                    frame->pts = av_rescale_q(frame->pts, timeBase, AVRational{1, 1000000});
+                }
+                q->produce(communication::Message::builder()
+                                   .withAction(communication::Message::Action::DATA)
+                                   .withPayload("frame", QVariant::fromValue(frame))
+                                   .build(),
+                           output.padId);
+            }
+        }
+    }
+
+    void FilterGraphPrivate::flushGraph() {
+        for (auto &input : inputs) {
+            sendFrame(input, nullptr);
+        }
+        drainOutputs();
+    }
+
+    void FilterGraphPrivate::destroyAVFilterGraph(AVFilterGraph *filterGraph) {
+        if (filterGraph) {
+            avfilter_graph_free(&filterGraph);
+        }
+    }
+
+    void FilterGraphPrivate::destroyAVFilterInOut(AVFilterInOut *filterInOut) {
+        if (filterInOut) {
+            avfilter_inout_free(&filterInOut);
+        }
+    }
+
+    void FilterGraphPrivate::destroyAVBufferRef(AVBufferRef *buffer) {
+        if (buffer) {
+            av_buffer_unref(&buffer);
+        }
+    }
+
+    void FilterGraphPrivate::destroyAVFrame(AVFrame *frame) {
+        if (frame) {
+            av_frame_free(&frame);
+        }
+    }
+}// namespace AVQt
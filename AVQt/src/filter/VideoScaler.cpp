@@ -0,0 +1,406 @@
+#include "filter/VideoScaler.hpp"
+#include "private/VideoScaler_p.hpp"
+
+#include "global.hpp"
+
+#include "communication/Message.hpp"
+
+#include <pgraph/api/Data.hpp>
+#include <pgraph/impl/SimplePadFactory.hpp>
+#include <pgraph_network/impl/RegisteringPadFactory.hpp>
+
+#include <QtCore/QThread>
+
+extern "C" {
+#include <libavutil/hwcontext.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/opt.h>
+}
+
+namespace AVQt {
+    VideoScaler::VideoScaler(const Config &config, QObject *parent)
+        : QObject(parent),
+          pgraph::impl::SimpleProcessor(pgraph::impl::SimplePadFactory::getInstance()),
+          d_ptr(new VideoScalerPrivate(this)) {
+        Q_D(VideoScaler);
+        d->config = config;
+    }
+
+    VideoScaler::VideoScaler(const Config &config, std::shared_ptr<pgraph::network::api::PadRegistry> padRegistry, QObject *parent)
+        : QObject(parent),
+          pgraph::impl::SimpleProcessor(pgraph::network::impl::RegisteringPadFactory::factoryFor(padRegistry)),
+          d_ptr(new VideoScalerPrivate(this)) {
+        Q_D(VideoScaler);
+        d->config = config;
+    }
+
+    VideoScaler::~VideoScaler() {
+        Q_D(VideoScaler);
+        if (d->open) {
+            close();
+        }
+    }
+
+    bool VideoScaler::init() {
+        Q_D(VideoScaler);
+
+        bool shouldBe = false;
+        if (d->initialized.compare_exchange_strong(shouldBe, true)) {
+            d->threads = d->config.threads > 0 ? d->config.threads : QThread::idealThreadCount();
+            d->outputPadParams = std::make_shared<communication::VideoPadParams>();
+
+            d->inputPadId = pgraph::impl::SimpleProcessor::createInputPad(std::make_shared<communication::VideoPadParams>());
+            d->outputPadId = pgraph::impl::SimpleProcessor::createOutputPad(d->outputPadParams);
+            if (d->inputPadId == pgraph::api::INVALID_PAD_ID || d->outputPadId == pgraph::api::INVALID_PAD_ID) {
+                qWarning() << "VideoScaler: failed to create pads";
+                d->initialized = false;
+                return false;
+            }
+            return true;
+        } else {
+            qWarning() << "VideoScaler::init() called multiple times";
+            return false;
+        }
+    }
+
+    bool VideoScaler::isOpen() const {
+        Q_D(const VideoScaler);
+        return d->open;
+    }
+
+    bool VideoScaler::isRunning() const {
+        Q_D(const VideoScaler);
+        return d->running;
+    }
+
+    bool VideoScaler::isPaused() const {
+        Q_D(const VideoScaler);
+        return d->paused;
+    }
+
+    void VideoScaler::consume(int64_t pad, std::shared_ptr<pgraph::api::Data> data) {
+        Q_D(VideoScaler);
+        Q_UNUSED(pad)
+        if (data->getType() == communication::Message::Type) {
+            auto message = std::static_pointer_cast<communication::Message>(data);
+            switch (static_cast<communication::Message::Action::Enum>(message->getAction())) {
+                case communication::Message::Action::INIT:
+                    d->inputParams = message->getPayload("videoParams").value<communication::VideoPadParams>();
+                    if (!open()) {
+                        qWarning() << "VideoScaler: failed to open";
+                    }
+                    break;
+                case communication::Message::Action::CLEANUP:
+                    close();
+                    break;
+                case communication::Message::Action::START:
+                    if (!start()) {
+                        qWarning() << "VideoScaler: failed to start";
+                    }
+                    break;
+                case communication::Message::Action::STOP:
+                    stop();
+                    break;
+                case communication::Message::Action::PAUSE:
+                    pause(message->getPayload("state").toBool());
+                    break;
+                case communication::Message::Action::RESET:
+                    if (d->open) {
+                        produce(communication::Message::builder().withAction(communication::Message::Action::RESET).build(), d->outputPadId);
+                    }
+                    break;
+                case communication::Message::Action::DATA:
+                    if (d->running) {
+                        auto scaled = d->scale(message->getPayload("frame").value<std::shared_ptr<AVFrame>>());
+                        if (!scaled) {
+                            break;
+                        }
+                        const QSize scaledSize{scaled->width, scaled->height};
+                        if (scaledSize != d->outputPadParams->frameSize) {
+                            // Only happens, if the output size follows the input
+                            produce(communication::Message::builder()
+                                            .withAction(communication::Message::Action::RESIZE)
+                                            .withPayload("size", scaledSize)
+                                            .withPayload("lastSize", d->outputPadParams->frameSize)
+                                            .build(),
+                                    d->outputPadId);
+                            d->outputPadParams->frameSize = scaledSize;
+                        }
+                        produce(communication::Message::builder()
+                                        .withAction(communication::Message::Action::DATA)
+                                        .withPayload("frame", QVariant::fromValue(scaled))
+                                        .build(),
+                                d->outputPadId);
+                    }
+                    break;
+                case communication::Message::Action::RESIZE:
+                    // Frames carry their size, scale() picks it up from the next one
+                    break;
+                case communication::Message::Action::NONE:
+                    break;
+            }
+        }
+    }
+
+    bool VideoScaler::open() {
+        Q_D(VideoScaler);
+
+        if (!d->initialized) {
+            qWarning() << "VideoScaler::open() called before init()";
+            return false;
+        }
+
+        bool shouldBe = false;
+        if (d->open.compare_exchange_strong(shouldBe, true)) {
+            const auto inputFormat = d->inputParams.isHWAccel ? d->inputParams.swPixelFormat : d->inputParams.pixelFormat;
+            const auto outputFormat = d->config.outputFormat != AV_PIX_FMT_NONE ? d->config.outputFormat : inputFormat;
+            if (!sws_isSupportedOutput(outputFormat)) {
+                qWarning() << "VideoScaler: unsupported output format" << av_get_pix_fmt_name(outputFormat);
+                d->open = false;
+                return false;
+            }
+
+            d->outputPadParams->frameSize = d->resolveOutputSize(d->inputParams.frameSize);
+            d->outputPadParams->pixelFormat = outputFormat;
+            d->outputPadParams->swPixelFormat = outputFormat;
+            d->outputPadParams->isHWAccel = false;
+            d->outputPadParams->hwDeviceContext.reset();
+            d->outputPadParams->hwFramesContext.reset();
+
+            produce(communication::Message::builder()
+                            .withAction(communication::Message::Action::INIT)
+                            .withPayload("videoParams", QVariant::fromValue(*d->outputPadParams))
+                            .build(),
+                    d->outputPadId);
+            return true;
+        } else {
+            qWarning() << "VideoScaler::open() called multiple times";
+            return false;
+        }
+    }
+
+    void VideoScaler::close() {
+        Q_D(VideoScaler);
+
+        if (d->running) {
+            stop();
+        }
+
+        bool shouldBe = true;
+        if (d->open.compare_exchange_strong(shouldBe, false)) {
+            produce(communication::Message::builder().withAction(communication::Message::Action::CLEANUP).build(), d->outputPadId);
+
+            std::unique_lock lock(d->scalerMutex);
+            d->contextCache.clear();
+            d->bufferPool.reset();
+            d->bufferPoolFormat = AV_PIX_FMT_NONE;
+            d->bufferPoolSize = {};
+        } else {
+            qWarning() << "VideoScaler::close() called multiple times";
+        }
+    }
+
+    bool VideoScaler::start() {
+        Q_D(VideoScaler);
+
+        if (!d->open) {
+            qWarning() << "VideoScaler::start() called before open()";
+            return false;
+        }
+
+        bool shouldBe = false;
+        if (d->running.compare_exchange_strong(shouldBe, true)) {
+            d->paused = false;
+            produce(communication::Message::builder().withAction(communication::Message::Action::START).build(), d->outputPadId);
+            emit started();
+            return true;
+        } else {
+            qWarning() << "VideoScaler::start() called multiple times";
+            return false;
+        }
+    }
+
+    void VideoScaler::stop() {
+        Q_D(VideoScaler);
+
+        bool shouldBe = true;
+        if (d->running.compare_exchange_strong(shouldBe, false)) {
+            d->paused = false;
+            produce(communication::Message::builder().withAction(communication::Message::Action::STOP).build(), d->outputPadId);
+            emit stopped();
+        } else {
+            qWarning() << "VideoScaler::stop() called multiple times";
+        }
+    }
+
+    void VideoScaler::pause(bool state) {
+        Q_D(VideoScaler);
+
+        bool shouldBe = !state;
+        if (d->paused.compare_exchange_strong(shouldBe, state)) {
+            produce(communication::Message::builder()
+                            .withAction(communication::Message::Action::PAUSE)
+                            .withPayload("state", state)
+                            .build(),
+                    d->outputPadId);
+            emit paused(state);
+        } else {
+            qDebug() << "VideoScaler::pause: state already" << state;
+        }
+    }
+
+    VideoScalerPrivate::VideoScalerPrivate(VideoScaler *q) : q_ptr(q) {}
+
+    bool VideoScalerPrivate::ScaleKey::operator==(const ScaleKey &other) const {
+        return inputFormat == other.inputFormat && inputSize == other.inputSize &&
+               outputFormat == other.outputFormat && outputSize == other.outputSize;
+    }
+
+    QSize VideoScalerPrivate::resolveOutputSize(const QSize &inputSize) const {
+        if (!config.outputSize.isValid()) {
+            return inputSize;
+        }
+        // Chroma subsampled formats need even dimensions
+        return {config.outputSize.width() & ~1, config.outputSize.height() & ~1};
+    }
+
+    SwsContext *VideoScalerPrivate::getContext(const ScaleKey &key) {
+        for (auto it = contextCache.begin(); it != contextCache.end(); ++it) {
+            if (it->key == key) {
+                contextCache.splice(contextCache.begin(), contextCache, it);
+                return contextCache.front().context.get();
+            }
+        }
+
+        std::unique_ptr<SwsContext, decltype(&destroySwsContext)> context{sws_alloc_context(), &destroySwsContext};
+        if (!context) {
+            qWarning() << "VideoScaler: failed to allocate scaler context";
+            return nullptr;
+        }
+        av_opt_set_int(context.get(), "srcw", key.inputSize.width(), 0);
+        av_opt_set_int(context.get(), "srch", key.inputSize.height(), 0);
+        av_opt_set_int(context.get(), "src_format", key.inputFormat, 0);
+        av_opt_set_int(context.get(), "dstw", key.outputSize.width(), 0);
+        av_opt_set_int(context.get(), "dsth", key.outputSize.height(), 0);
+        av_opt_set_int(context.get(), "dst_format", key.outputFormat, 0);
+        av_opt_set_int(context.get(), "sws_flags", config.scaleFlags, 0);
+#if LIBSWSCALE_VERSION_MAJOR >= 6
+        av_opt_set_int(context.get(), "threads", threads, 0);
+#endif
+
+        int ret = sws_init_context(context.get(), nullptr, nullptr);
+        if (ret < 0) {
+            char strBuf[AV_ERROR_MAX_STRING_SIZE];
+            qWarning() << "VideoScaler: failed to initialize scaler context for" << av_get_pix_fmt_name(key.inputFormat) << key.inputSize
+                       << "to" << av_get_pix_fmt_name(key.outputFormat) << key.outputSize << ":" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+            return nullptr;
+        }
+
+        contextCache.push_front({key, std::move(context)});
+        if (contextCache.size() > maxCachedContexts) {
+            contextCache.pop_back();
+        }
+        return contextCache.front().context.get();
+    }
+
+    std::shared_ptr<AVFrame> VideoScalerPrivate::allocateFrame(AVPixelFormat format, const QSize &size) {
+        if (!bufferPool || format != bufferPoolFormat || size != bufferPoolSize) {
+            // Buffers still referenced by frames downstream keep the old pool alive until they are returned
+            const auto bufferSize = av_image_get_buffer_size(format, size.width(), size.height(), bufferAlignment);
+            if (bufferSize < 0) {
+                return {};
+            }
+            bufferPool.reset(av_buffer_pool_init(bufferSize, nullptr));
+            bufferPoolFormat = format;
+            bufferPoolSize = size;
+        }
+        if (!bufferPool) {
+            return {};
+        }
+
+        std::shared_ptr<AVFrame> frame{av_frame_alloc(), &destroyAVFrame};
+        frame->format = format;
+        frame->width = size.width();
+        frame->height = size.height();
+        frame->buf[0] = av_buffer_pool_get(bufferPool.get());
+        if (!frame->buf[0]) {
+            return {};
+        }
+        if (av_image_fill_arrays(frame->data, frame->linesize, frame->buf[0]->data, format, size.width(), size.height(), bufferAlignment) < 0) {
+            return {};
+        }
+        frame->extended_data = frame->data;
+        return frame;
+    }
+
+    std::shared_ptr<AVFrame> VideoScalerPrivate::scale(const std::shared_ptr<AVFrame> &frame) {
+        if (!frame) {
+            return {};
+        }
+
+        std::shared_ptr<AVFrame> swFrame{frame};
+        if (frame->hw_frames_ctx) {
+            swFrame.reset(av_frame_alloc(), &destroyAVFrame);
+            int ret = av_hwframe_transfer_data(swFrame.get(), frame.get(), 0);
+            if (ret < 0) {
+                char strBuf[AV_ERROR_MAX_STRING_SIZE];
+                qWarning() << "VideoScaler: failed to download frame:" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+                return {};
+            }
+            av_frame_copy_props(swFrame.get(), frame.get());
+        }
+
+        const ScaleKey key{
+                static_cast<AVPixelFormat>(swFrame->format),
+                {swFrame->width, swFrame->height},
+                outputPadParams->pixelFormat,
+                resolveOutputSize({swFrame->width, swFrame->height}),
+        };
+
+        std::unique_lock lock(scalerMutex);
+        auto context = getContext(key);
+        if (!context) {
+            return {};
+        }
+
+        auto result = allocateFrame(key.outputFormat, key.outputSize);
+        if (!result) {
+            qWarning() << "VideoScaler: failed to allocate output frame";
+            return {};
+        }
+
+#if LIBSWSCALE_VERSION_MAJOR >= 6
+        // Slice threaded according to the context's thread count
+        int ret = sws_scale_frame(context, result.get(), swFrame.get());
+#else
+        int ret = sws_scale(context, swFrame->data, swFrame->linesize, 0, swFrame->height, result->data, result->linesize);
+#endif
+        if (ret < 0) {
+            char strBuf[AV_ERROR_MAX_STRING_SIZE];
+            qWarning() << "VideoScaler: failed to scale frame:" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+            return {};
+        }
+        lock.unlock();
+
+        av_frame_copy_props(result.get(), swFrame.get());
+        return result;
+    }
+
+    void VideoScalerPrivate::destroySwsContext(SwsContext *swsContext) {
+        if (swsContext) {
+            sws_freeContext(swsContext);
+        }
+    }
+
+    void VideoScalerPrivate::destroyAVBufferPool(AVBufferPool *bufferPool) {
+        if (bufferPool) {
+            av_buffer_pool_uninit(&bufferPool);
+        }
+    }
+
+    void VideoScalerPrivate::destroyAVFrame(AVFrame *frame) {
+        if (frame) {
+            av_frame_free(&frame);
+        }
+    }
+}// namespace AVQt
@@ -0,0 +1,63 @@
+#ifndef LIBAVQT_AUDIOCONVERTER_P_HPP
+#define LIBAVQT_AUDIOCONVERTER_P_HPP
+
+#include "filter/AudioConverter.hpp"
+
+#include "communication/AudioPadParams.hpp"
+
+#include <pgraph/api/Pad.hpp>
+
+#include <mutex>
+#include <optional>
+
+extern "C" {
+#include <libavutil/buffer.h>
+#include <libavutil/frame.h>
+#include <libswresample/swresample.h>
+}
+
+namespace AVQt {
+    class AudioConverterPrivate {
+        Q_DECLARE_PUBLIC(AudioConverter)
+    public:
+        static void destroySwrContext(SwrContext *swrContext);
+        static void destroyAVBufferPool(AVBufferPool *bufferPool);
+        static void destroyAVFrame(AVFrame *frame);
+
+    private:
+        explicit AudioConverterPrivate(AudioConverter *q);
+        AudioConverter *q_ptr;
+
+        [[nodiscard]] common::AudioFormat resolveOutputFormat(const common::AudioFormat &input) const;
+        [[nodiscard]] bool isOutputFormat(const common::AudioFormat &format) const;
+        /**
+         * @return true, if frame is in the output format and no resampler is in use
+         */
+        bool canPassThrough(const AVFrame &frame);
+        bool initResampler(const common::AudioFormat &input);
+        std::shared_ptr<AVFrame> allocateFrame(int nbSamples);
+        /**
+         * @brief Converts frame, or drains the resampler, if frame is nullptr
+         * @return the converted frame, nullptr if no samples are available (yet) or on error
+         */
+        std::shared_ptr<AVFrame> convert(const std::shared_ptr<AVFrame> &frame);
+
+        AudioConverter::Config config{};
+
+        int64_t inputPadId{pgraph::api::INVALID_PAD_ID}, outputPadId{pgraph::api::INVALID_PAD_ID};
+        std::shared_ptr<communication::AudioPadParams> outputPadParams{};
+
+        std::optional<common::AudioFormat> inputFormat{}, outputFormat{};
+
+        std::mutex resamplerMutex{};
+        std::unique_ptr<SwrContext, decltype(&destroySwrContext)> swrContext{nullptr, &destroySwrContext};
+        std::unique_ptr<AVBufferPool, decltype(&destroyAVBufferPool)> bufferPool{nullptr, &destroyAVBufferPool};
+        int bufferPoolSamples{0}, bufferPoolLinesize{0};
+        int64_t nextPts{AV_NOPTS_VALUE};
+
+        std::atomic_bool initialized{false}, open{false}, running{false}, paused{false};
+    };
+}// namespace AVQt
+
+
+#endif//LIBAVQT_AUDIOCONVERTER_P_HPP
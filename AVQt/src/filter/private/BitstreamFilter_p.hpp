@@ -0,0 +1,53 @@
+#ifndef LIBAVQT_BITSTREAMFILTER_P_HPP
+#define LIBAVQT_BITSTREAMFILTER_P_HPP
+
+#include "filter/BitstreamFilter.hpp"
+
+#include "communication/PacketPadParams.hpp"
+
+#include <pgraph/api/Pad.hpp>
+
+#include <mutex>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+namespace AVQt {
+    class BitstreamFilterPrivate {
+        Q_DECLARE_PUBLIC(BitstreamFilter)
+    public:
+        static void destroyAVBSFContext(AVBSFContext *bsfContext);
+
+    private:
+        explicit BitstreamFilterPrivate(BitstreamFilter *q);
+        BitstreamFilter *q_ptr;
+
+        /**
+         * @brief Creates the filter chain for inputParams and fills outputPadParams. Requires filterMutex to be locked.
+         */
+        bool configureFilters();
+        /**
+         * @brief Passes packet to the filters, nullptr signals EOF. Requires filterMutex to be locked.
+         */
+        bool sendPacket(const std::shared_ptr<AVPacket> &packet);
+        /**
+         * @brief Produces all packets available at the end of the chain. Requires filterMutex to be locked.
+         */
+        void drainPackets();
+
+        BitstreamFilter::Config config{};
+
+        int64_t inputPadId{pgraph::api::INVALID_PAD_ID}, outputPadId{pgraph::api::INVALID_PAD_ID};
+        std::shared_ptr<const communication::PacketPadParams> inputParams{};
+        std::shared_ptr<communication::PacketPadParams> outputPadParams{};
+
+        std::mutex filterMutex{};
+        std::unique_ptr<AVBSFContext, decltype(&destroyAVBSFContext)> bsfContext{nullptr, &destroyAVBSFContext};
+
+        std::atomic_bool initialized{false}, open{false}, running{false}, paused{false};
+    };
+}// namespace AVQt
+
+
+#endif//LIBAVQT_BITSTREAMFILTER_P_HPP
@@ -0,0 +1,94 @@
+#ifndef LIBAVQT_FILTERGRAPH_P_HPP
+#define LIBAVQT_FILTERGRAPH_P_HPP
+
+#include "filter/FilterGraph.hpp"
+
+#include "communication/AudioPadParams.hpp"
+#include "communication/VideoPadParams.hpp"
+
+#include <pgraph/api/Pad.hpp>
+
+#include <mutex>
+#include <optional>
+#include <vector>
+
+extern "C" {
+#include <libavfilter/avfilter.h>
+#include <libavutil/frame.h>
+}
+
+namespace AVQt {
+    class FilterGraphPrivate {
+        Q_DECLARE_PUBLIC(FilterGraph)
+    public:
+        static void destroyAVFilterGraph(AVFilterGraph *filterGraph);
+        static void destroyAVFilterInOut(AVFilterInOut *filterInOut);
+        static void destroyAVBufferRef(AVBufferRef *buffer);
+        static void destroyAVFrame(AVFrame *frame);
+
+    private:
+        struct Input {
+            AVMediaType type{AVMEDIA_TYPE_UNKNOWN};
+            int64_t padId{pgraph::api::INVALID_PAD_ID};
+            // Parameters the graph is configured for, taken from INIT and updated from the frames
+            std::optional<communication::VideoPadParams> videoParams{};
+            std::optional<communication::AudioPadParams> audioParams{};
+            // Owned by the graph
+            AVFilterContext *source{nullptr};
+        };
+
+        struct Output {
+            AVMediaType type{AVMEDIA_TYPE_UNKNOWN};
+            int64_t padId{pgraph::api::INVALID_PAD_ID};
+            std::shared_ptr<communication::VideoPadParams> videoParams{};
+            std::shared_ptr<communication::AudioPadParams> audioParams{};
+            // Owned by the graph
+            AVFilterContext *sink{nullptr};
+        };
+
+        explicit FilterGraphPrivate(FilterGraph *q);
+        FilterGraph *q_ptr;
+
+        [[nodiscard]] static QString inputLabel(size_t index);
+        [[nodiscard]] static QString outputLabel(size_t index);
+
+        /**
+         * @brief Builds the graph for the current input parameters. Requires graphMutex to be locked.
+         */
+        bool configureGraph();
+        /**
+         * @brief Copies the format of the sinks to the output pad params. Requires graphMutex to be locked.
+         * @param announce If true, size changes are sent downstream as RESIZE, other changes are carried by the frames
+         */
+        void updateOutputParams(bool announce);
+        /**
+         * @return true, if frame doesn't match the parameters input was configured with. Updates the parameters in that case.
+         */
+        static bool updateInputParams(Input &input, const AVFrame *frame);
+        /**
+         * @brief Passes frame to the source of input, nullptr signals EOF. Requires graphMutex to be locked.
+         */
+        bool sendFrame(Input &input, const std::shared_ptr<AVFrame> &frame);
+        /**
+         * @brief Produces all frames available at the sinks. Requires graphMutex to be locked.
+         */
+        void drainOutputs();
+        /**
+         * @brief Pushes EOF into all sources and produces the remaining frames. Requires graphMutex to be locked.
+         */
+        void flushGraph();
+
+        FilterGraph::Config config{};
+
+        std::vector<Input> inputs{};
+        std::vector<Output> outputs{};
+
+        std::mutex graphMutex{};
+        std::unique_ptr<AVFilterGraph, decltype(&destroyAVFilterGraph)> graph{nullptr, &destroyAVFilterGraph};
+
+        std::atomic_bool initialized{false}, open{false}, running{false}, paused{false};
+    };
+}// namespace AVQt
+
+
+#endif//LIBAVQT_FILTERGRAPH_P_HPP
@@ -0,0 +1,81 @@
+#ifndef LIBAVQT_VIDEOSCALER_P_HPP
+#define LIBAVQT_VIDEOSCALER_P_HPP
+
+#include "filter/VideoScaler.hpp"
+
+#include "communication/VideoPadParams.hpp"
+
+#include <pgraph/api/Pad.hpp>
+
+#include <list>
+#include <mutex>
+
+extern "C" {
+#include <libavutil/buffer.h>
+#include <libavutil/frame.h>
+#include <libswscale/swscale.h>
+}
+
+namespace AVQt {
+    class VideoScalerPrivate {
+        Q_DECLARE_PUBLIC(VideoScaler)
+    public:
+        static void destroySwsContext(SwsContext *swsContext);
+        static void destroyAVBufferPool(AVBufferPool *bufferPool);
+        static void destroyAVFrame(AVFrame *frame);
+
+    private:
+        struct ScaleKey {
+            AVPixelFormat inputFormat;
+            QSize inputSize;
+            AVPixelFormat outputFormat;
+            QSize outputSize;
+
+            bool operator==(const ScaleKey &other) const;
+        };
+
+        struct CachedContext {
+            ScaleKey key;
+            std::unique_ptr<SwsContext, decltype(&destroySwsContext)> context;
+        };
+
+        explicit VideoScalerPrivate(VideoScaler *q);
+        VideoScaler *q_ptr;
+
+        /**
+         * @return the cached context for key, or a newly created one, nullptr on error. Requires scalerMutex to be locked.
+         */
+        SwsContext *getContext(const ScaleKey &key);
+        /**
+         * @return a frame backed by a pooled buffer. Requires scalerMutex to be locked.
+         */
+        std::shared_ptr<AVFrame> allocateFrame(AVPixelFormat format, const QSize &size);
+        [[nodiscard]] QSize resolveOutputSize(const QSize &inputSize) const;
+        /**
+         * @return the scaled frame, nullptr on error
+         */
+        std::shared_ptr<AVFrame> scale(const std::shared_ptr<AVFrame> &frame);
+
+        VideoScaler::Config config{};
+        int threads{1};
+
+        int64_t inputPadId{pgraph::api::INVALID_PAD_ID}, outputPadId{pgraph::api::INVALID_PAD_ID};
+        std::shared_ptr<communication::VideoPadParams> outputPadParams{};
+        communication::VideoPadParams inputParams{};
+
+        std::mutex scalerMutex{};
+        // Most recently used first
+        std::list<CachedContext> contextCache{};
+        static constexpr size_t maxCachedContexts{4};
+
+        std::unique_ptr<AVBufferPool, decltype(&destroyAVBufferPool)> bufferPool{nullptr, &destroyAVBufferPool};
+        AVPixelFormat bufferPoolFormat{AV_PIX_FMT_NONE};
+        QSize bufferPoolSize{};
+        static constexpr int bufferAlignment{64};
+
+        std::atomic_bool initialized{false}, open{false}, running{false}, paused{false};
+    };
+}// namespace AVQt
+
+
+#endif//LIBAVQT_VIDEOSCALER_P_HPP
@@ -28,6 +28,8 @@
 #include <pgraph_network/api/PadRegistry.hpp>
 #include <pgraph_network/impl/RegisteringPadFactory.hpp>
 
+#include <algorithm>
+
 extern "C" {
 #include <libavformat/avformat.h>
 #include <libavutil/avutil.h>
@@ -43,6 +45,8 @@ namespace AVQt {
         Q_D(AVQt::Demuxer);
         d->inputDevice = std::move(config.inputDevice);
         d->loop = config.loop;
+        d->preserveTimestamps = config.preserveTimestamps;
+        d->enableAllStreams = config.enableAllStreams;
     }
 
     Demuxer::~Demuxer() noexcept {
@@ -120,6 +124,9 @@ namespace AVQt {
                 packetPadParams->mediaType = d->pFormatCtx->streams[si]->codecpar->codec_type;
                 packetPadParams->codec = avcodec_find_decoder(d->pFormatCtx->streams[si]->codecpar->codec_id);
                 packetPadParams->streamIdx = si;
+                if (d->preserveTimestamps) {
+                    packetPadParams->timeBase = d->pFormatCtx->streams[si]->time_base;
+                }
                 packetPadParams->codecParams = std::shared_ptr<AVCodecParameters>(avcodec_parameters_alloc(), [](AVCodecParameters *p) {
                     avcodec_parameters_free(&p);
                 });
@@ -132,6 +139,13 @@ namespace AVQt {
                 d->outputPadIds.insert(si, padId);
                 qDebug("Creating pad %ld for stream %ld", d->outputPadIds[si], si);
             }
+
+            if (d->enableAllStreams) {
+                for (const auto &pad : d->outputPadIds) {
+                    d->enabledPads.insert(pad);
+                }
+            }
+            d->applyStreamDiscard();
         } else {
             qWarning() << "Demuxer already initialized";
             return false;
@@ -139,6 +153,35 @@ namespace AVQt {
         return true;
     }
 
+    bool Demuxer::setStreamEnabled(int64_t padId, bool enabled) {
+        Q_D(AVQt::Demuxer);
+
+        if (std::find(d->outputPadIds.cbegin(), d->outputPadIds.cend(), padId) == d->outputPadIds.cend()) {
+            qWarning() << "Demuxer: unknown output pad" << padId;
+            return false;
+        }
+
+        std::unique_lock lock(d->discardMutex);
+        if (enabled) {
+            d->enabledPads.insert(padId);
+        } else {
+            d->enabledPads.remove(padId);
+        }
+        // Applied by the demuxing thread, AVStream::discard must not change during av_read_frame()
+        d->discardChanged = true;
+        if (!d->running) {
+            lock.unlock();
+            d->applyStreamDiscard();
+        }
+        return true;
+    }
+
+    bool Demuxer::isStreamEnabled(int64_t padId) const {
+        Q_D(const AVQt::Demuxer);
+        std::unique_lock lock(d->discardMutex);
+        return d->enabledPads.contains(padId);
+    }
+
     bool Demuxer::open() {
         Q_D(AVQt::Demuxer);
 
@@ -263,6 +306,10 @@ namespace AVQt {
                 continue;
             }
 
+            if (d->discardChanged) {
+                d->applyStreamDiscard();
+            }
+
             packet = {av_packet_alloc(), [](AVPacket *p) {
                           av_packet_free(&p);
                       }};
@@ -292,8 +339,11 @@ namespace AVQt {
                 break;
             }
 
-            if (d->outputPadIds.contains(packet->stream_index)) {
-                av_packet_rescale_ts(packet.get(), d->pFormatCtx->streams[packet->stream_index]->time_base, {1, 1000000});
+            // Some demuxers return packets of discarded streams anyway
+            if (d->outputPadIds.contains(packet->stream_index) && d->pFormatCtx->streams[packet->stream_index]->discard != AVDISCARD_ALL) {
+                if (!d->preserveTimestamps) {
+                    av_packet_rescale_ts(packet.get(), d->pFormatCtx->streams[packet->stream_index]->time_base, {1, 1000000});
+                }
                 auto message = communication::Message::builder()
                                        .withAction(communication::Message::Action::DATA)
                                        .withPayload("packet", QVariant::fromValue(packet))
@@ -303,6 +353,14 @@ namespace AVQt {
         }
     }
 
+    void DemuxerPrivate::applyStreamDiscard() {
+        std::unique_lock lock(discardMutex);
+        discardChanged = false;
+        for (auto it = outputPadIds.cbegin(); it != outputPadIds.cend(); ++it) {
+            pFormatCtx->streams[it.key()]->discard = enabledPads.contains(it.value()) ? AVDISCARD_DEFAULT : AVDISCARD_ALL;
+        }
+    }
+
     int DemuxerPrivate::readFromIO(void *opaque, uint8_t *buf, int bufSize) {
         auto *d = reinterpret_cast<DemuxerPrivate *>(opaque);
         if (buf && d && bufSize > 0) {
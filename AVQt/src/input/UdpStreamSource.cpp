@@ -0,0 +1,437 @@
+#include "input/UdpStreamSource.hpp"
+#include "private/UdpStreamSource_p.hpp"
+
+#include <QtCore/QDebug>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace AVQt {
+    namespace {
+        constexpr uint8_t TsSyncByte = 0x47;
+        constexpr uint32_t TsPacketSize = 188;
+        constexpr uint32_t RtpHeaderSize = 12;
+        // Sequence numbers further ahead or behind the expected one are a restart of the sender, not loss or reordering (RFC 3550, A.1)
+        constexpr int64_t MaxDropout = 3000;
+        constexpr int64_t MaxMisorder = 100;
+        // Poll interval of the receiving thread, bounds the precision of the jitter latency and the latency of close()
+        constexpr int PollTimeout = 10;
+
+        int64_t currentTimeMs() {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+    }// namespace
+
+    UdpStreamSource::UdpStreamSource(const Config &config, QObject *parent)
+        : QIODevice(parent),
+          d_ptr(new UdpStreamSourcePrivate(this)) {
+        Q_D(UdpStreamSource);
+        d->config = config;
+    }
+
+    UdpStreamSource::~UdpStreamSource() {
+        if (isOpen()) {
+            UdpStreamSource::close();
+        }
+    }
+
+    bool UdpStreamSource::open(OpenMode mode) {
+        Q_D(UdpStreamSource);
+
+        if (mode & WriteOnly) {
+            qWarning() << "UdpStreamSource: only ReadOnly is supported";
+            return false;
+        }
+        if (isOpen()) {
+            qWarning() << "UdpStreamSource::open() called multiple times";
+            return false;
+        }
+        if (d->config.slotCount <= 0 || d->config.maxDatagramSize <= 0 || d->config.batchSize <= 0) {
+            qWarning() << "UdpStreamSource: slotCount, maxDatagramSize and batchSize must be positive";
+            return false;
+        }
+
+        if (!d->openSocket()) {
+            return false;
+        }
+
+        const auto slotCount = static_cast<uint32_t>(d->config.slotCount);
+        d->slotMemory.assign(slotCount * static_cast<size_t>(d->config.maxDatagramSize), 0);
+        d->freeSlots.clear();
+        for (uint32_t i = slotCount; i > 0; --i) {
+            d->freeSlots.push_back(i - 1);
+        }
+        d->readable.clear();
+        d->readOffset = 0;
+        d->jitterBuffer.clear();
+        d->nextSequence = -1;
+        d->badSequence = -1;
+        d->protocol = d->config.protocol;
+        d->continuityCounters.fill(-1);
+        d->statistics = {};
+
+        // Unbuffered, QIODevice would copy every read through its own buffer
+        QIODevice::open(mode | Unbuffered);
+
+        d->receiving = true;
+        d->receiveThread.reset(QThread::create([d] { d->receiveLoop(); }));
+        d->receiveThread->start();
+        return true;
+    }
+
+    void UdpStreamSource::close() {
+        Q_D(UdpStreamSource);
+
+        d->receiving = false;
+        d->dataAvailable.notify_all();
+        if (d->receiveThread) {
+            d->receiveThread->wait();
+            d->receiveThread.reset();
+        }
+        if (d->socketFd >= 0) {
+            ::close(d->socketFd);
+            d->socketFd = -1;
+        }
+
+        {
+            std::lock_guard lock(d->mutex);
+            d->readable.clear();
+            d->jitterBuffer.clear();
+            d->freeSlots.clear();
+            d->slotMemory.clear();
+            d->slotMemory.shrink_to_fit();
+        }
+        QIODevice::close();
+    }
+
+    bool UdpStreamSource::isSequential() const {
+        return true;
+    }
+
+    qint64 UdpStreamSource::bytesAvailable() const {
+        Q_D(const UdpStreamSource);
+        std::lock_guard lock(d->mutex);
+        qint64 available = -static_cast<qint64>(d->readOffset);
+        for (const auto &datagram : d->readable) {
+            available += datagram.size;
+        }
+        return available + QIODevice::bytesAvailable();
+    }
+
+    UdpStreamSource::Statistics UdpStreamSource::getStatistics() const {
+        Q_D(const UdpStreamSource);
+        std::lock_guard lock(d->mutex);
+        return d->statistics;
+    }
+
+    quint16 UdpStreamSource::getLocalPort() const {
+        Q_D(const UdpStreamSource);
+        return d->localPort;
+    }
+
+    qint64 UdpStreamSource::readData(char *data, qint64 maxSize) {
+        Q_D(UdpStreamSource);
+
+        if (maxSize <= 0) {
+            return 0;
+        }
+
+        std::unique_lock lock(d->mutex);
+        if (!d->dataAvailable.wait_for(lock, std::chrono::milliseconds(d->config.readTimeout), [d] {
+                return !d->readable.empty() || !d->receiving;
+            })) {
+            qDebug() << "UdpStreamSource: no data for" << d->config.readTimeout << "ms, ending stream";
+            return 0;
+        }
+
+        qint64 copied = 0;
+        while (copied < maxSize && !d->readable.empty()) {
+            const auto &datagram = d->readable.front();
+            const auto count = std::min(static_cast<qint64>(datagram.size - d->readOffset), maxSize - copied);
+            std::memcpy(data + copied, d->slotData(datagram.slot) + datagram.offset + d->readOffset, static_cast<size_t>(count));
+            copied += count;
+            d->readOffset += static_cast<uint32_t>(count);
+            if (d->readOffset == datagram.size) {
+                d->freeSlots.push_back(datagram.slot);
+                d->readable.pop_front();
+                d->readOffset = 0;
+            }
+        }
+        return copied;
+    }
+
+    qint64 UdpStreamSource::writeData(const char *data, qint64 maxSize) {
+        Q_UNUSED(data)
+        Q_UNUSED(maxSize)
+        return -1;
+    }
+
+    UdpStreamSourcePrivate::UdpStreamSourcePrivate(UdpStreamSource *q) : q_ptr(q) {}
+
+    bool UdpStreamSourcePrivate::openSocket() {
+        in_addr address{};
+        if (inet_pton(AF_INET, config.address.toLatin1().constData(), &address) != 1) {
+            qWarning() << "UdpStreamSource: invalid IPv4 address" << config.address;
+            return false;
+        }
+        const bool multicast = IN_MULTICAST(ntohl(address.s_addr));
+
+        socketFd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        if (socketFd < 0) {
+            qWarning() << "UdpStreamSource: failed to create socket:" << strerror(errno);
+            return false;
+        }
+
+        int enable = 1;
+        setsockopt(socketFd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+        // Bursts of a live stream have to fit into the socket buffer while the demuxer is busy
+        int receiveBuffer = config.slotCount * config.maxDatagramSize;
+        setsockopt(socketFd, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+
+        sockaddr_in bindAddress{};
+        bindAddress.sin_family = AF_INET;
+        bindAddress.sin_port = htons(config.port);
+        bindAddress.sin_addr.s_addr = multicast ? htonl(INADDR_ANY) : address.s_addr;
+        if (bind(socketFd, reinterpret_cast<const sockaddr *>(&bindAddress), sizeof(bindAddress)) < 0) {
+            qWarning() << "UdpStreamSource: failed to bind to" << config.address << config.port << ":" << strerror(errno);
+            ::close(socketFd);
+            socketFd = -1;
+            return false;
+        }
+
+        if (multicast) {
+            ip_mreq membership{};
+            membership.imr_multiaddr = address;
+            membership.imr_interface.s_addr = htonl(INADDR_ANY);
+            if (setsockopt(socketFd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) < 0) {
+                qWarning() << "UdpStreamSource: failed to join" << config.address << ":" << strerror(errno);
+                ::close(socketFd);
+                socketFd = -1;
+                return false;
+            }
+        }
+
+        socklen_t length = sizeof(bindAddress);
+        getsockname(socketFd, reinterpret_cast<sockaddr *>(&bindAddress), &length);
+        localPort = ntohs(bindAddress.sin_port);
+        return true;
+    }
+
+    void UdpStreamSourcePrivate::receiveLoop() {
+        const auto batchSize = static_cast<size_t>(config.batchSize);
+        const auto datagramSize = static_cast<size_t>(config.maxDatagramSize);
+        std::vector<uint32_t> batchSlots;
+        batchSlots.reserve(batchSize);
+        std::vector<uint32_t> sizes;
+        sizes.reserve(batchSize);
+        std::vector<uint8_t> overflowBuffer(datagramSize);
+#ifdef __linux__
+        std::vector<iovec> iovecs(batchSize);
+        std::vector<mmsghdr> headers(batchSize);
+#endif
+
+        while (receiving) {
+            pollfd pfd{socketFd, POLLIN, 0};
+            const bool readableSocket = poll(&pfd, 1, PollTimeout) > 0 && (pfd.revents & POLLIN);
+
+            std::unique_lock lock(mutex);
+            if (readableSocket) {
+                // Receive directly into free slots, so datagrams are never copied before readData()
+                batchSlots.clear();
+                while (batchSlots.size() < batchSize && !freeSlots.empty()) {
+                    batchSlots.push_back(freeSlots.back());
+                    freeSlots.pop_back();
+                }
+                lock.unlock();
+
+                int received = 0;
+                sizes.clear();
+                if (batchSlots.empty()) {
+                    // The ring is full, drain the socket to keep the stream current
+                    while (recv(socketFd, overflowBuffer.data(), datagramSize, MSG_DONTWAIT) >= 0) {
+                        ++received;
+                    }
+                } else {
+#ifdef __linux__
+                    for (size_t i = 0; i < batchSlots.size(); ++i) {
+                        iovecs[i] = {slotData(batchSlots[i]), datagramSize};
+                        headers[i] = {};
+                        headers[i].msg_hdr.msg_iov = &iovecs[i];
+                        headers[i].msg_hdr.msg_iovlen = 1;
+                    }
+                    received = recvmmsg(socketFd, headers.data(), static_cast<unsigned int>(batchSlots.size()), MSG_DONTWAIT, nullptr);
+                    for (int i = 0; i < received; ++i) {
+                        sizes.push_back((headers[static_cast<size_t>(i)].msg_hdr.msg_flags & MSG_TRUNC) ? 0 : headers[static_cast<size_t>(i)].msg_len);
+                    }
+#else
+                    for (auto slot : batchSlots) {
+                        auto size = recv(socketFd, slotData(slot), datagramSize, MSG_DONTWAIT);
+                        if (size < 0) {
+                            break;
+                        }
+                        sizes.push_back(static_cast<uint32_t>(size));
+                        ++received;
+                    }
+#endif
+                }
+
+                lock.lock();
+                if (batchSlots.empty()) {
+                    statistics.overflows += static_cast<uint64_t>(received);
+                } else {
+                    const auto now = currentTimeMs();
+                    for (size_t i = 0; i < batchSlots.size(); ++i) {
+                        if (i < sizes.size() && sizes[i] > 0) {
+                            handleDatagram(batchSlots[i], sizes[i], now);
+                        } else {
+                            freeSlots.push_back(batchSlots[i]);
+                        }
+                    }
+                }
+            }
+            flushJitterBuffer(currentTimeMs());
+            const bool notify = !readable.empty();
+            lock.unlock();
+            if (notify) {
+                dataAvailable.notify_all();
+            }
+        }
+    }
+
+    void UdpStreamSourcePrivate::handleDatagram(uint32_t slot, uint32_t size, int64_t now) {
+        const uint8_t *data = slotData(slot);
+        ++statistics.datagrams;
+        statistics.bytes += size;
+
+        if (protocol == UdpStreamSource::Protocol::Auto) {
+            protocol = data[0] == TsSyncByte ? UdpStreamSource::Protocol::UDP : UdpStreamSource::Protocol::RTP;
+            qDebug() << "UdpStreamSource: detected" << (protocol == UdpStreamSource::Protocol::RTP ? "RTP" : "plain UDP");
+        }
+
+        if (protocol == UdpStreamSource::Protocol::UDP) {
+            deliver({slot, 0, size});
+            return;
+        }
+
+        // RTP header (RFC 3550), with CSRCs, extension and padding
+        uint32_t offset = RtpHeaderSize;
+        if (size < RtpHeaderSize || (data[0] >> 6) != 2) {
+            freeSlots.push_back(slot);
+            return;
+        }
+        offset += 4u * (data[0] & 0x0Fu);
+        if ((data[0] & 0x10) && offset + 4 <= size) {
+            offset += 4 + 4u * ((static_cast<uint32_t>(data[offset + 2]) << 8) | data[offset + 3]);
+        }
+        uint32_t end = size;
+        if ((data[0] & 0x20) && data[size - 1] <= size) {
+            end -= data[size - 1];
+        }
+        if (offset >= end) {
+            freeSlots.push_back(slot);
+            return;
+        }
+        const Datagram datagram{slot, offset, end - offset};
+        const auto sequence = static_cast<uint16_t>((data[2] << 8) | data[3]);
+
+        if (nextSequence < 0) {
+            nextSequence = sequence;
+        }
+        // Extend the 16 bit sequence number relative to the next expected one
+        const auto extended = nextSequence + static_cast<int16_t>(static_cast<uint16_t>(sequence - static_cast<uint16_t>(nextSequence)));
+        const auto distance = extended - nextSequence;
+        if (distance > MaxDropout || distance < -MaxMisorder) {
+            // A single stray packet is dropped, the next one in sequence confirms the sender restarted. It isn't counted as late,
+            // its position was never passed on.
+            if (sequence != badSequence) {
+                badSequence = static_cast<uint16_t>(sequence + 1);
+                freeSlots.push_back(slot);
+                return;
+            }
+            resynchronize(extended);
+        }
+        badSequence = -1;
+        if (extended < nextSequence || jitterBuffer.count(extended)) {
+            ++statistics.late;
+            freeSlots.push_back(slot);
+            return;
+        }
+
+        if (config.jitterLatency <= 0) {
+            statistics.lost += static_cast<uint64_t>(extended - nextSequence);
+            deliver(datagram);
+            nextSequence = extended + 1;
+            return;
+        }
+
+        if (!jitterBuffer.empty() && extended < jitterBuffer.rbegin()->first) {
+            ++statistics.reordered;
+        }
+        jitterBuffer[extended] = {datagram, now};
+        flushJitterBuffer(now);
+    }
+
+    void UdpStreamSourcePrivate::flushJitterBuffer(int64_t now) {
+        while (!jitterBuffer.empty()) {
+            auto first = jitterBuffer.begin();
+            if (first->first == nextSequence) {
+                deliver(first->second.datagram);
+                ++nextSequence;
+                jitterBuffer.erase(first);
+            } else if (now - first->second.arrival >= config.jitterLatency || freeSlots.empty()) {
+                // Waited long enough, or the buffer holds all slots
+                statistics.lost += static_cast<uint64_t>(first->first - nextSequence);
+                nextSequence = first->first;
+            } else {
+                break;
+            }
+        }
+    }
+
+    void UdpStreamSourcePrivate::resynchronize(int64_t sequence) {
+        qDebug() << "UdpStreamSource: RTP sequence jumped from" << static_cast<uint16_t>(nextSequence) << "to" << static_cast<uint16_t>(sequence)
+                 << ", resynchronizing";
+        // The buffered packets precede the jump, they are passed on without waiting for their gaps
+        for (const auto &buffered : jitterBuffer) {
+            deliver(buffered.second.datagram);
+        }
+        jitterBuffer.clear();
+        nextSequence = sequence;
+        ++statistics.resyncs;
+    }
+
+    void UdpStreamSourcePrivate::deliver(const Datagram &datagram) {
+        const uint8_t *data = slotData(datagram.slot) + datagram.offset;
+        for (uint32_t offset = 0; offset + TsPacketSize <= datagram.size; offset += TsPacketSize) {
+            const uint8_t *packet = data + offset;
+            if (packet[0] != TsSyncByte) {
+                continue;
+            }
+            const auto pid = static_cast<size_t>(((packet[1] & 0x1F) << 8) | packet[2]);
+            const bool hasPayload = packet[3] & 0x10;
+            const auto counter = static_cast<int8_t>(packet[3] & 0x0F);
+            if (pid == 0x1FFF || !hasPayload) {
+                continue;
+            }
+            const auto last = continuityCounters[pid];
+            // A repeated counter is an allowed duplicate
+            if (last >= 0 && counter != last && counter != ((last + 1) & 0x0F)) {
+                ++statistics.continuityErrors;
+            }
+            continuityCounters[pid] = counter;
+        }
+        readable.push_back(datagram);
+    }
+
+    uint8_t *UdpStreamSourcePrivate::slotData(uint32_t slot) {
+        return slotMemory.data() + slot * static_cast<size_t>(config.maxDatagramSize);
+    }
+}// namespace AVQt
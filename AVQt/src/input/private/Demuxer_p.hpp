@@ -22,6 +22,8 @@
 
 #include <QtCore>
 
+#include <mutex>
+
 extern "C" {
 #include <libavformat/avformat.h>
 #include <libavutil/avutil.h>
@@ -51,6 +53,11 @@ namespace AVQt {
 
         static int64_t seekIO(void *opaque, int64_t pos, int whence);
 
+        /**
+         * @brief Copies the enabled state of the streams to AVStream::discard, must not run concurrently to av_read_frame()
+         */
+        void applyStreamDiscard();
+
         Demuxer *q_ptr{nullptr};
 
         std::unique_ptr<QIODevice> inputDevice{};
@@ -64,9 +71,15 @@ namespace AVQt {
         std::unique_ptr<AVFormatContext, decltype(&destroyAVFormatContext)> pFormatCtx{nullptr, &destroyAVFormatContext};
         std::unique_ptr<AVIOContext, decltype(&destroyAVIOContext)> pIOCtx{nullptr, &destroyAVIOContext};
         bool loop{false};
+        bool preserveTimestamps{false};
 
         QMap<int64_t, int64_t> outputPadIds;
 
+        mutable std::mutex discardMutex{};
+        QSet<int64_t> enabledPads{};
+        std::atomic_bool discardChanged{false};
+        bool enableAllStreams{true};
+
         friend class Demuxer;
     };
 }// namespace AVQt
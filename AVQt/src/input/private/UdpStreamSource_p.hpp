@@ -0,0 +1,89 @@
+#ifndef LIBAVQT_UDPSTREAMSOURCE_P_HPP
+#define LIBAVQT_UDPSTREAMSOURCE_P_HPP
+
+#include "input/UdpStreamSource.hpp"
+
+#include <QtCore/QThread>
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace AVQt {
+    class UdpStreamSourcePrivate {
+        Q_DECLARE_PUBLIC(UdpStreamSource)
+    private:
+        /**
+         * @brief TS payload of a received datagram, located in a slot
+         */
+        struct Datagram {
+            uint32_t slot{0};
+            uint32_t offset{0};
+            uint32_t size{0};
+        };
+
+        struct PendingDatagram {
+            Datagram datagram{};
+            int64_t arrival{0};
+        };
+
+        explicit UdpStreamSourcePrivate(UdpStreamSource *q);
+        UdpStreamSource *q_ptr;
+
+        bool openSocket();
+        /**
+         * @brief Receiving thread, fills the slots until close()
+         */
+        void receiveLoop();
+        /**
+         * @brief Strips the RTP header and passes the datagram through the jitter buffer. Called with mutex locked.
+         */
+        void handleDatagram(uint32_t slot, uint32_t size, int64_t now);
+        /**
+         * @brief Passes on buffered RTP packets in sequence, skipping gaps older than Config::jitterLatency. Called with mutex locked.
+         */
+        void flushJitterBuffer(int64_t now);
+        /**
+         * @brief Passes on the jitter buffer and continues the sequence at sequence, after the sender restarted. Called with mutex locked.
+         */
+        void resynchronize(int64_t sequence);
+        /**
+         * @brief Appends the datagram to the readable data and checks the TS continuity counters. Called with mutex locked.
+         */
+        void deliver(const Datagram &datagram);
+        [[nodiscard]] uint8_t *slotData(uint32_t slot);
+
+        UdpStreamSource::Config config{};
+
+        int socketFd{-1};
+        quint16 localPort{0};
+        std::unique_ptr<QThread> receiveThread{};
+        std::atomic_bool receiving{false};
+
+        mutable std::mutex mutex{};
+        std::condition_variable dataAvailable{};
+
+        std::vector<uint8_t> slotMemory{};
+        std::vector<uint32_t> freeSlots{};
+        std::deque<Datagram> readable{};
+        // Bytes of the first readable datagram already read
+        uint32_t readOffset{0};
+
+        UdpStreamSource::Protocol protocol{UdpStreamSource::Protocol::Auto};
+        // Extended RTP sequence number of the next packet to pass on, -1 before the first packet
+        int64_t nextSequence{-1};
+        // Sequence number following a packet far off nextSequence, -1 if there was none
+        int32_t badSequence{-1};
+        std::map<int64_t, PendingDatagram> jitterBuffer{};
+
+        std::array<int8_t, 8192> continuityCounters{};
+        UdpStreamSource::Statistics statistics{};
+    };
+}// namespace AVQt
+
+
+#endif//LIBAVQT_UDPSTREAMSOURCE_P_HPP
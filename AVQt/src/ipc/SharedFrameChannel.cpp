@@ -0,0 +1,227 @@
+#include "SharedFrameChannel.hpp"
+
+#include <QtCore/QDebug>
+
+#include <cerrno>
+#include <cstring>
+#include <limits>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace AVQt::internal {
+    namespace {
+        bool fillAddress(const QString &path, sockaddr_un &address) {
+            const auto encoded = path.toLocal8Bit();
+            if (encoded.isEmpty() || static_cast<size_t>(encoded.size()) >= sizeof(address.sun_path)) {
+                qWarning() << "SharedFrameChannel: invalid socket path" << path;
+                return false;
+            }
+            std::memset(&address, 0, sizeof(address));
+            address.sun_family = AF_UNIX;
+            std::memcpy(address.sun_path, encoded.constData(), static_cast<size_t>(encoded.size()));
+            return true;
+        }
+    }// namespace
+
+    std::shared_ptr<SharedFrameRing> SharedFrameRing::create(uint32_t generation, uint32_t slotCount, size_t slotSize) {
+        int fd = memfd_create("avqt-frames", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+        if (fd < 0) {
+            qWarning() << "SharedFrameRing: memfd_create failed:" << strerror(errno);
+            return {};
+        }
+        const auto size = static_cast<off_t>(slotCount * slotSize);
+        if (ftruncate(fd, size) < 0) {
+            qWarning() << "SharedFrameRing: failed to resize memfd:" << strerror(errno);
+            ::close(fd);
+            return {};
+        }
+        // The receiver can't shrink the ring under our mapping
+        fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+        return map(fd, generation, slotCount, slotSize);
+    }
+
+    std::shared_ptr<SharedFrameRing> SharedFrameRing::map(int fd, uint32_t generation, uint32_t slotCount, size_t slotSize) {
+        if (slotCount == 0 || slotSize == 0 || slotSize > static_cast<size_t>(std::numeric_limits<off_t>::max()) / slotCount) {
+            qWarning() << "SharedFrameRing: invalid ring of" << slotCount << "slots of" << slotSize << "bytes";
+            ::close(fd);
+            return {};
+        }
+        const size_t size = slotCount * slotSize;
+        // Accessing the mapping beyond the end of the file raises SIGBUS, so the file must be large enough and stay so
+        struct stat status {};
+        if (fstat(fd, &status) < 0 || status.st_size < static_cast<off_t>(size)) {
+            qWarning() << "SharedFrameRing: memfd is smaller than" << size << "bytes";
+            ::close(fd);
+            return {};
+        }
+        const int seals = fcntl(fd, F_GET_SEALS);
+        if (seals < 0 || (seals & F_SEAL_SHRINK) == 0) {
+            qWarning() << "SharedFrameRing: memfd is not sealed against shrinking";
+            ::close(fd);
+            return {};
+        }
+
+        void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED) {
+            qWarning() << "SharedFrameRing: mmap failed:" << strerror(errno);
+            ::close(fd);
+            return {};
+        }
+        return std::shared_ptr<SharedFrameRing>(new SharedFrameRing(fd, generation, slotCount, slotSize, static_cast<uint8_t *>(data)));
+    }
+
+    SharedFrameRing::SharedFrameRing(int fd, uint32_t generation, uint32_t slotCount, size_t slotSize, uint8_t *data)
+        : m_fd(fd), m_generation(generation), m_slotCount(slotCount), m_slotSize(slotSize), m_data(data) {
+    }
+
+    SharedFrameRing::~SharedFrameRing() {
+        munmap(m_data, m_slotCount * m_slotSize);
+        ::close(m_fd);
+    }
+
+    int SharedFrameRing::fd() const {
+        return m_fd;
+    }
+
+    uint32_t SharedFrameRing::generation() const {
+        return m_generation;
+    }
+
+    uint32_t SharedFrameRing::slotCount() const {
+        return m_slotCount;
+    }
+
+    size_t SharedFrameRing::slotSize() const {
+        return m_slotSize;
+    }
+
+    uint8_t *SharedFrameRing::slot(uint32_t index) const {
+        return m_data + index * m_slotSize;
+    }
+
+    std::shared_ptr<SharedFrameChannel> SharedFrameChannel::connectTo(const QString &path) {
+        sockaddr_un address{};
+        if (!fillAddress(path, address)) {
+            return {};
+        }
+        int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            qWarning() << "SharedFrameChannel: failed to create socket:" << strerror(errno);
+            return {};
+        }
+        if (::connect(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) < 0) {
+            qWarning() << "SharedFrameChannel: failed to connect to" << path << ":" << strerror(errno);
+            ::close(fd);
+            return {};
+        }
+        return std::shared_ptr<SharedFrameChannel>(new SharedFrameChannel(fd));
+    }
+
+    int SharedFrameChannel::listenOn(const QString &path) {
+        sockaddr_un address{};
+        if (!fillAddress(path, address)) {
+            return -1;
+        }
+        int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            qWarning() << "SharedFrameChannel: failed to create socket:" << strerror(errno);
+            return -1;
+        }
+        unlink(address.sun_path);
+        if (bind(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) < 0 || listen(fd, 1) < 0) {
+            qWarning() << "SharedFrameChannel: failed to listen on" << path << ":" << strerror(errno);
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    std::shared_ptr<SharedFrameChannel> SharedFrameChannel::accept(int listenFd) {
+        int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            qWarning() << "SharedFrameChannel: accept failed:" << strerror(errno);
+            return {};
+        }
+        return std::shared_ptr<SharedFrameChannel>(new SharedFrameChannel(fd));
+    }
+
+    SharedFrameChannel::SharedFrameChannel(int fd) : m_fd(fd) {
+    }
+
+    SharedFrameChannel::~SharedFrameChannel() {
+        ::close(m_fd);
+    }
+
+    bool SharedFrameChannel::send(const ChannelMessage &message, int fd) {
+        iovec iov{const_cast<ChannelMessage *>(&message), sizeof(message)};
+        msghdr header{};
+        header.msg_iov = &iov;
+        header.msg_iovlen = 1;
+
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))]{};
+        if (fd >= 0) {
+            header.msg_control = control;
+            header.msg_controllen = sizeof(control);
+            auto *cmsg = CMSG_FIRSTHDR(&header);
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_RIGHTS;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+            std::memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+        }
+
+        std::lock_guard lock(m_sendMutex);
+        if (sendmsg(m_fd, &header, MSG_NOSIGNAL) != static_cast<ssize_t>(sizeof(message))) {
+            return false;
+        }
+        return true;
+    }
+
+    int SharedFrameChannel::receive(ChannelMessage &message, int &fd, int timeoutMs) {
+        fd = -1;
+
+        pollfd pfd{m_fd, POLLIN, 0};
+        int ret = poll(&pfd, 1, timeoutMs);
+        if (ret == 0 || (ret < 0 && errno == EINTR)) {
+            return 0;
+        } else if (ret < 0) {
+            return -1;
+        }
+
+        iovec iov{&message, sizeof(message)};
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))]{};
+        msghdr header{};
+        header.msg_iov = &iov;
+        header.msg_iovlen = 1;
+        header.msg_control = control;
+        header.msg_controllen = sizeof(control);
+
+        auto received = recvmsg(m_fd, &header, MSG_CMSG_CLOEXEC);
+        if (received <= 0) {
+            return -1;
+        }
+        for (auto *cmsg = CMSG_FIRSTHDR(&header); cmsg; cmsg = CMSG_NXTHDR(&header, cmsg)) {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+                std::memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+            }
+        }
+        if (received != static_cast<ssize_t>(sizeof(message))) {
+            qWarning() << "SharedFrameChannel: truncated message";
+            if (fd >= 0) {
+                ::close(fd);
+                fd = -1;
+            }
+            return -1;
+        }
+        return 1;
+    }
+
+    void SharedFrameChannel::close() {
+        shutdown(m_fd, SHUT_RDWR);
+    }
+}// namespace AVQt::internal
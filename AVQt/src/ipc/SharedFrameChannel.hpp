@@ -0,0 +1,130 @@
+#ifndef LIBAVQT_SHAREDFRAMECHANNEL_HPP
+#define LIBAVQT_SHAREDFRAMECHANNEL_HPP
+
+#include <QtCore/QString>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace AVQt::internal {
+    /**
+     * @brief Fixed size message exchanged over the SOCK_SEQPACKET socket between SharedMemoryFrameSender and SharedMemoryFrameReceiver.
+     *
+     * Frame data never passes the socket, only the index of the ring slot holding it. Rings are memfds, their descriptors are attached
+     * to Ring messages with SCM_RIGHTS. Every ring has a new generation, so releases of slots from a replaced ring are ignored.
+     */
+    struct ChannelMessage {
+        enum Type : uint32_t {
+            // Sender to receiver, mirroring the communication::Message actions
+            Init,
+            Cleanup,
+            Start,
+            Stop,
+            Pause,
+            Reset,
+            Frame,
+            // Sender to receiver, a new ring is attached
+            Ring,
+            // Receiver to sender, all references to the slot have been dropped
+            Release,
+        };
+
+        uint32_t type{Init};
+        uint32_t generation{0};
+        uint32_t slot{0};
+        uint32_t slotCount{0};
+        uint64_t slotSize{0};
+        int32_t width{0}, height{0}, format{-1};
+        int32_t flag{0};
+        int32_t colorRange{0}, colorSpace{0}, colorPrimaries{0}, colorTrc{0};
+        int64_t pts{0};
+    };
+
+    /**
+     * @brief A ring of equally sized slots in a memfd, mapped into this process.
+     */
+    class SharedFrameRing {
+    public:
+        /**
+         * @brief Creates a new sealed memfd of slotCount * slotSize bytes
+         * @return nullptr on error
+         */
+        static std::shared_ptr<SharedFrameRing> create(uint32_t generation, uint32_t slotCount, size_t slotSize);
+        /**
+         * @brief Maps a ring received from the other process, takes ownership of fd
+         * @return nullptr on error
+         */
+        static std::shared_ptr<SharedFrameRing> map(int fd, uint32_t generation, uint32_t slotCount, size_t slotSize);
+
+        ~SharedFrameRing();
+        SharedFrameRing(const SharedFrameRing &) = delete;
+        SharedFrameRing &operator=(const SharedFrameRing &) = delete;
+
+        [[nodiscard]] int fd() const;
+        [[nodiscard]] uint32_t generation() const;
+        [[nodiscard]] uint32_t slotCount() const;
+        [[nodiscard]] size_t slotSize() const;
+        [[nodiscard]] uint8_t *slot(uint32_t index) const;
+
+    private:
+        SharedFrameRing(int fd, uint32_t generation, uint32_t slotCount, size_t slotSize, uint8_t *data);
+
+        int m_fd;
+        uint32_t m_generation;
+        uint32_t m_slotCount;
+        size_t m_slotSize;
+        uint8_t *m_data;
+    };
+
+    /**
+     * @brief Connected SOCK_SEQPACKET socket, sends are serialized, so slots may be released from any thread.
+     */
+    class SharedFrameChannel {
+    public:
+        /**
+         * @brief Connects to a receiver listening on path
+         * @return nullptr on error
+         */
+        static std::shared_ptr<SharedFrameChannel> connectTo(const QString &path);
+        /**
+         * @brief Binds and listens on path, removing a stale socket file first
+         * @return the listening socket, -1 on error
+         */
+        static int listenOn(const QString &path);
+        /**
+         * @brief Accepts a pending connection on a socket returned by listenOn()
+         * @return nullptr on error
+         */
+        static std::shared_ptr<SharedFrameChannel> accept(int listenFd);
+
+        ~SharedFrameChannel();
+        SharedFrameChannel(const SharedFrameChannel &) = delete;
+        SharedFrameChannel &operator=(const SharedFrameChannel &) = delete;
+
+        /**
+         * @param fd Descriptor attached to the message, -1 for none
+         */
+        bool send(const ChannelMessage &message, int fd = -1);
+        /**
+         * @brief Waits up to timeoutMs for a message, a received descriptor is stored in fd (-1 if none)
+         * @return 1 on success, 0 on timeout, -1 if the peer disconnected or on error
+         */
+        int receive(ChannelMessage &message, int &fd, int timeoutMs);
+
+        /**
+         * @brief Shuts the socket down, pending and later sends fail
+         */
+        void close();
+
+    private:
+        explicit SharedFrameChannel(int fd);
+
+        std::mutex m_sendMutex{};
+        int m_fd;
+    };
+}// namespace AVQt::internal
+
+
+#endif//LIBAVQT_SHAREDFRAMECHANNEL_HPP
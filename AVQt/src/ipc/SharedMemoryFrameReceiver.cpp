@@ -0,0 +1,368 @@
+#include "ipc/SharedMemoryFrameReceiver.hpp"
+#include "private/SharedMemoryFrameReceiver_p.hpp"
+
+#include "communication/Message.hpp"
+
+#include <pgraph/impl/SimplePadFactory.hpp>
+#include <pgraph_network/impl/RegisteringPadFactory.hpp>
+
+#include <poll.h>
+#include <unistd.h>
+
+extern "C" {
+#include <libavutil/imgutils.h>
+}
+
+namespace AVQt {
+    namespace {
+        // Plane alignment inside a slot, has to match the sender
+        constexpr int SlotAlignment = 64;
+        // Poll interval of the receiving thread, bounds the latency of stop()
+        constexpr int PollTimeout = 100;
+
+        struct SlotReference {
+            std::shared_ptr<internal::SharedFrameRing> ring;
+            std::weak_ptr<internal::SharedFrameChannel> channel;
+            uint32_t slot;
+        };
+    }// namespace
+
+    SharedMemoryFrameReceiver::SharedMemoryFrameReceiver(const Config &config, std::shared_ptr<pgraph::network::api::PadRegistry> padRegistry, QObject *parent)
+        : QThread(parent),
+          pgraph::impl::SimpleProducer(pgraph::network::impl::RegisteringPadFactory::factoryFor(padRegistry)),
+          d_ptr(new SharedMemoryFrameReceiverPrivate(this)) {
+        Q_D(SharedMemoryFrameReceiver);
+        d->config = config;
+    }
+
+    SharedMemoryFrameReceiver::SharedMemoryFrameReceiver(const Config &config, QObject *parent)
+        : QThread(parent),
+          pgraph::impl::SimpleProducer(pgraph::impl::SimplePadFactory::getInstance()),
+          d_ptr(new SharedMemoryFrameReceiverPrivate(this)) {
+        Q_D(SharedMemoryFrameReceiver);
+        d->config = config;
+    }
+
+    SharedMemoryFrameReceiver::~SharedMemoryFrameReceiver() {
+        Q_D(SharedMemoryFrameReceiver);
+        if (d->open) {
+            SharedMemoryFrameReceiver::close();
+        }
+    }
+
+    bool SharedMemoryFrameReceiver::isOpen() const {
+        Q_D(const SharedMemoryFrameReceiver);
+        return d->open;
+    }
+
+    bool SharedMemoryFrameReceiver::isRunning() const {
+        Q_D(const SharedMemoryFrameReceiver);
+        return d->running;
+    }
+
+    bool SharedMemoryFrameReceiver::isPaused() const {
+        Q_D(const SharedMemoryFrameReceiver);
+        return d->paused;
+    }
+
+    int64_t SharedMemoryFrameReceiver::getOutputPadId() const {
+        Q_D(const SharedMemoryFrameReceiver);
+        return d->outputPadId;
+    }
+
+    bool SharedMemoryFrameReceiver::init() {
+        Q_D(SharedMemoryFrameReceiver);
+
+        bool shouldBe = false;
+        if (d->initialized.compare_exchange_strong(shouldBe, true)) {
+            if (d->config.socketPath.isEmpty()) {
+                qWarning() << "SharedMemoryFrameReceiver: socketPath must not be empty";
+                d->initialized = false;
+                return false;
+            }
+            d->outputPadParams = std::make_shared<communication::VideoPadParams>();
+            d->outputPadId = createOutputPad(d->outputPadParams);
+            if (d->outputPadId == pgraph::api::INVALID_PAD_ID) {
+                qWarning() << "SharedMemoryFrameReceiver: failed to create output pad";
+                d->initialized = false;
+                return false;
+            }
+            return true;
+        } else {
+            qWarning() << "SharedMemoryFrameReceiver::init() called multiple times";
+            return false;
+        }
+    }
+
+    bool SharedMemoryFrameReceiver::open() {
+        Q_D(SharedMemoryFrameReceiver);
+
+        if (!d->initialized) {
+            qWarning() << "SharedMemoryFrameReceiver::open() called before init()";
+            return false;
+        }
+
+        bool shouldBe = false;
+        if (d->open.compare_exchange_strong(shouldBe, true)) {
+            d->listenFd = internal::SharedFrameChannel::listenOn(d->config.socketPath);
+            if (d->listenFd < 0) {
+                d->open = false;
+                return false;
+            }
+            return true;
+        } else {
+            qWarning() << "SharedMemoryFrameReceiver::open() called multiple times";
+            return false;
+        }
+    }
+
+    void SharedMemoryFrameReceiver::close() {
+        Q_D(SharedMemoryFrameReceiver);
+
+        if (d->running) {
+            stop();
+        }
+
+        bool shouldBe = true;
+        if (d->open.compare_exchange_strong(shouldBe, false)) {
+            ::close(d->listenFd);
+            d->listenFd = -1;
+            unlink(d->config.socketPath.toLocal8Bit().constData());
+        } else {
+            qWarning() << "SharedMemoryFrameReceiver::close() called multiple times";
+        }
+    }
+
+    bool SharedMemoryFrameReceiver::start() {
+        Q_D(SharedMemoryFrameReceiver);
+
+        if (!d->open) {
+            qWarning() << "SharedMemoryFrameReceiver::start() called before open()";
+            return false;
+        }
+
+        bool shouldBe = false;
+        if (d->running.compare_exchange_strong(shouldBe, true)) {
+            d->paused = false;
+            QThread::start();
+            return true;
+        } else {
+            qWarning() << "SharedMemoryFrameReceiver::start() called multiple times";
+            return false;
+        }
+    }
+
+    void SharedMemoryFrameReceiver::stop() {
+        Q_D(SharedMemoryFrameReceiver);
+
+        bool shouldBe = true;
+        if (d->running.compare_exchange_strong(shouldBe, false)) {
+            QThread::wait();
+            d->disconnectSender();
+            emit stopped();
+        } else {
+            qWarning() << "SharedMemoryFrameReceiver::stop() called multiple times";
+        }
+    }
+
+    void SharedMemoryFrameReceiver::pause(bool state) {
+        Q_D(SharedMemoryFrameReceiver);
+
+        bool shouldBe = !state;
+        if (d->paused.compare_exchange_strong(shouldBe, state)) {
+            emit paused(state);
+        } else {
+            qDebug() << "SharedMemoryFrameReceiver::pause: state already" << state;
+        }
+    }
+
+    void SharedMemoryFrameReceiver::run() {
+        Q_D(SharedMemoryFrameReceiver);
+        emit started();
+
+        while (d->running) {
+            if (!d->channel) {
+                pollfd pfd{d->listenFd, POLLIN, 0};
+                if (poll(&pfd, 1, PollTimeout) > 0) {
+                    d->channel = internal::SharedFrameChannel::accept(d->listenFd);
+                    if (d->channel) {
+                        emit senderConnected();
+                    }
+                }
+                continue;
+            }
+
+            internal::ChannelMessage message{};
+            int fd = -1;
+            int ret = d->channel->receive(message, fd, PollTimeout);
+            if (ret > 0) {
+                d->handleMessage(message, fd);
+            } else if (ret < 0) {
+                d->disconnectSender();
+                emit senderDisconnected();
+            }
+        }
+    }
+
+    SharedMemoryFrameReceiverPrivate::SharedMemoryFrameReceiverPrivate(SharedMemoryFrameReceiver *q) : q_ptr(q) {}
+
+    void SharedMemoryFrameReceiverPrivate::handleMessage(const internal::ChannelMessage &message, int fd) {
+        Q_Q(SharedMemoryFrameReceiver);
+
+        switch (message.type) {
+            case internal::ChannelMessage::Init:
+                outputPadParams->frameSize = QSize(message.width, message.height);
+                outputPadParams->pixelFormat = static_cast<AVPixelFormat>(message.format);
+                outputPadParams->swPixelFormat = outputPadParams->pixelFormat;
+                outputPadParams->isHWAccel = false;
+                lastFrameSize = outputPadParams->frameSize;
+                q->produce(communication::Message::builder()
+                                   .withAction(communication::Message::Action::INIT)
+                                   .withPayload("videoParams", QVariant::fromValue(*outputPadParams))
+                                   .build(),
+                           outputPadId);
+                downstreamOpen = true;
+                break;
+            case internal::ChannelMessage::Cleanup:
+                if (downstreamOpen) {
+                    q->produce(communication::Message::builder().withAction(communication::Message::Action::CLEANUP).build(), outputPadId);
+                    downstreamOpen = false;
+                }
+                break;
+            case internal::ChannelMessage::Start:
+                q->produce(communication::Message::builder().withAction(communication::Message::Action::START).build(), outputPadId);
+                downstreamRunning = true;
+                break;
+            case internal::ChannelMessage::Stop:
+                if (downstreamRunning) {
+                    q->produce(communication::Message::builder().withAction(communication::Message::Action::STOP).build(), outputPadId);
+                    downstreamRunning = false;
+                }
+                break;
+            case internal::ChannelMessage::Pause:
+                q->produce(communication::Message::builder()
+                                   .withAction(communication::Message::Action::PAUSE)
+                                   .withPayload("state", message.flag != 0)
+                                   .build(),
+                           outputPadId);
+                break;
+            case internal::ChannelMessage::Reset:
+                q->produce(communication::Message::builder().withAction(communication::Message::Action::RESET).build(), outputPadId);
+                break;
+            case internal::ChannelMessage::Ring:
+                if (fd < 0) {
+                    qWarning() << "SharedMemoryFrameReceiver: ring message without descriptor";
+                    break;
+                }
+                // Frames of the previous ring keep their mapping alive through their buffers
+                ring = internal::SharedFrameRing::map(fd, message.generation, message.slotCount, message.slotSize);
+                fd = -1;
+                break;
+            case internal::ChannelMessage::Frame: {
+                auto frame = wrapSlot(message);
+                if (!frame || paused) {
+                    // Dropping the frame releases the slot
+                    break;
+                }
+                const QSize frameSize{frame->width, frame->height};
+                if (frameSize != lastFrameSize) {
+                    q->produce(communication::Message::builder()
+                                       .withAction(communication::Message::Action::RESIZE)
+                                       .withPayload("size", frameSize)
+                                       .withPayload("lastSize", lastFrameSize)
+                                       .build(),
+                               outputPadId);
+                    lastFrameSize = frameSize;
+                    outputPadParams->frameSize = frameSize;
+                }
+                q->produce(communication::Message::builder()
+                                   .withAction(communication::Message::Action::DATA)
+                                   .withPayload("frame", QVariant::fromValue(frame))
+                                   .build(),
+                           outputPadId);
+                break;
+            }
+            case internal::ChannelMessage::Release:
+                break;
+        }
+
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    std::shared_ptr<AVFrame> SharedMemoryFrameReceiverPrivate::wrapSlot(const internal::ChannelMessage &message) {
+        if (!ring || ring->generation() != message.generation || message.slot >= ring->slotCount()) {
+            qWarning() << "SharedMemoryFrameReceiver: frame in unknown slot" << message.generation << message.slot;
+            return {};
+        }
+
+        auto *reference = new SlotReference{ring, channel, message.slot};
+        AVBufferRef *buffer = av_buffer_create(ring->slot(message.slot), static_cast<int>(ring->slotSize()), &releaseSlot, reference, 0);
+        if (!buffer) {
+            releaseSlot(reference, nullptr);
+            return {};
+        }
+
+        std::shared_ptr<AVFrame> frame{av_frame_alloc(), &destroyAVFrame};
+        frame->buf[0] = buffer;
+        frame->width = message.width;
+        frame->height = message.height;
+        frame->format = message.format;
+        // Dropping the frame releases the slot
+        const int size = av_image_get_buffer_size(static_cast<AVPixelFormat>(message.format), message.width, message.height, SlotAlignment);
+        if (size < 0 || static_cast<size_t>(size) > ring->slotSize()) {
+            qWarning() << "SharedMemoryFrameReceiver: frame of" << message.width << "x" << message.height << "in format" << message.format
+                       << "doesn't fit into a slot of" << ring->slotSize() << "bytes";
+            return {};
+        }
+        if (av_image_fill_arrays(frame->data, frame->linesize, buffer->data, static_cast<AVPixelFormat>(message.format),
+                                 message.width, message.height, SlotAlignment) < 0) {
+            qWarning() << "SharedMemoryFrameReceiver: invalid frame format" << message.format;
+            return {};
+        }
+        frame->key_frame = message.flag;
+        frame->color_range = static_cast<AVColorRange>(message.colorRange);
+        frame->colorspace = static_cast<AVColorSpace>(message.colorSpace);
+        frame->color_primaries = static_cast<AVColorPrimaries>(message.colorPrimaries);
+        frame->color_trc = static_cast<AVColorTransferCharacteristic>(message.colorTrc);
+        frame->pts = message.pts;
+        return frame;
+    }
+
+    void SharedMemoryFrameReceiverPrivate::disconnectSender() {
+        Q_Q(SharedMemoryFrameReceiver);
+
+        if (downstreamRunning) {
+            q->produce(communication::Message::builder().withAction(communication::Message::Action::STOP).build(), outputPadId);
+            downstreamRunning = false;
+        }
+        if (downstreamOpen) {
+            q->produce(communication::Message::builder().withAction(communication::Message::Action::CLEANUP).build(), outputPadId);
+            downstreamOpen = false;
+        }
+        if (channel) {
+            channel->close();
+            channel.reset();
+        }
+        ring.reset();
+    }
+
+    void SharedMemoryFrameReceiverPrivate::releaseSlot(void *opaque, uint8_t *) {
+        auto *reference = static_cast<SlotReference *>(opaque);
+        if (auto channel = reference->channel.lock()) {
+            internal::ChannelMessage message{};
+            message.type = internal::ChannelMessage::Release;
+            message.generation = reference->ring->generation();
+            message.slot = reference->slot;
+            channel->send(message);
+        }
+        delete reference;
+    }
+
+    void SharedMemoryFrameReceiverPrivate::destroyAVFrame(AVFrame *frame) {
+        if (frame) {
+            av_frame_free(&frame);
+        }
+    }
+}// namespace AVQt
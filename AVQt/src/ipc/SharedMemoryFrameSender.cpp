@@ -0,0 +1,388 @@
+#include "ipc/SharedMemoryFrameSender.hpp"
+#include "private/SharedMemoryFrameSender_p.hpp"
+
+#include "communication/Message.hpp"
+
+#include <pgraph/api/Data.hpp>
+#include <pgraph/api/PadUserData.hpp>
+#include <pgraph/impl/SimplePadFactory.hpp>
+#include <pgraph_network/impl/RegisteringPadFactory.hpp>
+
+#include <QtCore/QElapsedTimer>
+
+#include <unistd.h>
+
+extern "C" {
+#include <libavutil/hwcontext.h>
+#include <libavutil/imgutils.h>
+}
+
+namespace AVQt {
+    // Plane alignment inside a slot, the receiver derives the same layout from width, height and format
+    static constexpr int SlotAlignment = 64;
+
+    SharedMemoryFrameSender::SharedMemoryFrameSender(const Config &config, std::shared_ptr<pgraph::network::api::PadRegistry> padRegistry, QObject *parent)
+        : QObject(parent),
+          pgraph::impl::SimpleConsumer(pgraph::network::impl::RegisteringPadFactory::factoryFor(padRegistry)),
+          d_ptr(new SharedMemoryFrameSenderPrivate(this)) {
+        Q_D(SharedMemoryFrameSender);
+        d->config = config;
+    }
+
+    SharedMemoryFrameSender::SharedMemoryFrameSender(const Config &config, QObject *parent)
+        : QObject(parent),
+          pgraph::impl::SimpleConsumer(pgraph::impl::SimplePadFactory::getInstance()),
+          d_ptr(new SharedMemoryFrameSenderPrivate(this)) {
+        Q_D(SharedMemoryFrameSender);
+        d->config = config;
+    }
+
+    SharedMemoryFrameSender::~SharedMemoryFrameSender() {
+        Q_D(SharedMemoryFrameSender);
+        if (d->open) {
+            close();
+        }
+    }
+
+    bool SharedMemoryFrameSender::init() {
+        Q_D(SharedMemoryFrameSender);
+
+        bool shouldBe = false;
+        if (d->initialized.compare_exchange_strong(shouldBe, true)) {
+            if (d->config.socketPath.isEmpty() || d->config.slotCount == 0) {
+                qWarning() << "SharedMemoryFrameSender: socketPath must not be empty and slotCount must be positive";
+                d->initialized = false;
+                return false;
+            }
+            d->inputPadId = pgraph::impl::SimpleConsumer::createInputPad(pgraph::api::PadUserData::emptyUserData());
+            if (d->inputPadId == pgraph::api::INVALID_PAD_ID) {
+                qWarning() << "SharedMemoryFrameSender: failed to create input pad";
+                d->initialized = false;
+                return false;
+            }
+            return true;
+        } else {
+            qWarning() << "SharedMemoryFrameSender::init() called multiple times";
+            return false;
+        }
+    }
+
+    bool SharedMemoryFrameSender::isOpen() const {
+        Q_D(const SharedMemoryFrameSender);
+        return d->open;
+    }
+
+    bool SharedMemoryFrameSender::isRunning() const {
+        Q_D(const SharedMemoryFrameSender);
+        return d->running;
+    }
+
+    bool SharedMemoryFrameSender::isPaused() const {
+        Q_D(const SharedMemoryFrameSender);
+        return d->paused;
+    }
+
+    int64_t SharedMemoryFrameSender::getInputPadId() const {
+        Q_D(const SharedMemoryFrameSender);
+        return d->inputPadId;
+    }
+
+    uint64_t SharedMemoryFrameSender::getDroppedFrames() const {
+        Q_D(const SharedMemoryFrameSender);
+        return d->droppedFrames;
+    }
+
+    void SharedMemoryFrameSender::consume(int64_t pad, std::shared_ptr<pgraph::api::Data> data) {
+        Q_D(SharedMemoryFrameSender);
+        if (pad != d->inputPadId) {
+            qWarning() << "SharedMemoryFrameSender: data on unknown pad" << pad;
+            return;
+        }
+        if (data->getType() == communication::Message::Type) {
+            auto message = std::dynamic_pointer_cast<communication::Message>(data);
+            switch (message->getAction()) {
+                case communication::Message::Action::INIT:
+                    d->videoParams = message->getPayload("videoParams").value<communication::VideoPadParams>();
+                    if (!open()) {
+                        qWarning() << "SharedMemoryFrameSender: failed to open";
+                    }
+                    break;
+                case communication::Message::Action::CLEANUP:
+                    close();
+                    break;
+                case communication::Message::Action::START:
+                    if (!start()) {
+                        qWarning() << "SharedMemoryFrameSender: failed to start";
+                    }
+                    break;
+                case communication::Message::Action::STOP:
+                    stop();
+                    break;
+                case communication::Message::Action::PAUSE:
+                    pause(message->getPayload("state").toBool());
+                    break;
+                case communication::Message::Action::RESET:
+                    if (d->open) {
+                        d->sendAction(internal::ChannelMessage::Reset);
+                    }
+                    break;
+                case communication::Message::Action::DATA:
+                    if (d->running && !d->paused) {
+                        auto frame = message->getPayload("frame").value<std::shared_ptr<AVFrame>>();
+                        if (frame && !d->sendFrame(frame)) {
+                            ++d->droppedFrames;
+                        }
+                    }
+                    break;
+                case communication::Message::Action::RESIZE:
+                case communication::Message::Action::NONE:
+                    // The receiver detects size changes from the frames
+                    break;
+            }
+        }
+    }
+
+    bool SharedMemoryFrameSender::open() {
+        Q_D(SharedMemoryFrameSender);
+
+        if (!d->initialized) {
+            qWarning() << "SharedMemoryFrameSender::open() called before init()";
+            return false;
+        }
+
+        bool shouldBe = false;
+        if (d->open.compare_exchange_strong(shouldBe, true)) {
+            d->channel = internal::SharedFrameChannel::connectTo(d->config.socketPath);
+            if (!d->channel) {
+                d->open = false;
+                return false;
+            }
+
+            internal::ChannelMessage message{};
+            message.type = internal::ChannelMessage::Init;
+            message.width = d->videoParams.frameSize.width();
+            message.height = d->videoParams.frameSize.height();
+            message.format = d->videoParams.isHWAccel ? d->videoParams.swPixelFormat : d->videoParams.pixelFormat;
+            if (!d->channel->send(message)) {
+                qWarning() << "SharedMemoryFrameSender: failed to send to" << d->config.socketPath;
+                d->channel.reset();
+                d->open = false;
+                return false;
+            }
+            return true;
+        } else {
+            qWarning() << "SharedMemoryFrameSender::open() called multiple times";
+            return false;
+        }
+    }
+
+    void SharedMemoryFrameSender::close() {
+        Q_D(SharedMemoryFrameSender);
+
+        if (d->running) {
+            stop();
+        }
+
+        bool shouldBe = true;
+        if (d->open.compare_exchange_strong(shouldBe, false)) {
+            d->sendAction(internal::ChannelMessage::Cleanup);
+            d->channel->close();
+            d->channel.reset();
+            // The receiver keeps its own mapping of the ring as long as it holds frames
+            d->ring.reset();
+            d->busySlots.clear();
+        } else {
+            qWarning() << "SharedMemoryFrameSender::close() called multiple times";
+        }
+    }
+
+    bool SharedMemoryFrameSender::start() {
+        Q_D(SharedMemoryFrameSender);
+
+        if (!d->open) {
+            qWarning() << "SharedMemoryFrameSender::start() called before open()";
+            return false;
+        }
+
+        bool shouldBe = false;
+        if (d->running.compare_exchange_strong(shouldBe, true)) {
+            d->paused = false;
+            d->droppedFrames = 0;
+            d->sendAction(internal::ChannelMessage::Start);
+            emit started();
+            return true;
+        } else {
+            qWarning() << "SharedMemoryFrameSender::start() called multiple times";
+            return false;
+        }
+    }
+
+    void SharedMemoryFrameSender::stop() {
+        Q_D(SharedMemoryFrameSender);
+
+        bool shouldBe = true;
+        if (d->running.compare_exchange_strong(shouldBe, false)) {
+            d->paused = false;
+            d->sendAction(internal::ChannelMessage::Stop);
+            if (d->droppedFrames > 0) {
+                qDebug() << "SharedMemoryFrameSender: dropped" << d->droppedFrames.load() << "frames, the receiver didn't release its slots in time";
+            }
+            emit stopped();
+        } else {
+            qWarning() << "SharedMemoryFrameSender::stop() called multiple times";
+        }
+    }
+
+    void SharedMemoryFrameSender::pause(bool state) {
+        Q_D(SharedMemoryFrameSender);
+
+        bool shouldBe = !state;
+        if (d->paused.compare_exchange_strong(shouldBe, state)) {
+            d->sendAction(internal::ChannelMessage::Pause, state ? 1 : 0);
+            emit paused(state);
+        } else {
+            qDebug() << "SharedMemoryFrameSender::pause: state already" << state;
+        }
+    }
+
+    SharedMemoryFrameSenderPrivate::SharedMemoryFrameSenderPrivate(SharedMemoryFrameSender *q) : q_ptr(q) {}
+
+    bool SharedMemoryFrameSenderPrivate::sendAction(internal::ChannelMessage::Type type, int32_t flag) {
+        if (!channel) {
+            return false;
+        }
+        internal::ChannelMessage message{};
+        message.type = type;
+        message.flag = flag;
+        if (!channel->send(message)) {
+            qWarning() << "SharedMemoryFrameSender: failed to send to" << config.socketPath;
+            return false;
+        }
+        return true;
+    }
+
+    bool SharedMemoryFrameSenderPrivate::ensureRing(int width, int height, AVPixelFormat format) {
+        const int size = av_image_get_buffer_size(format, width, height, SlotAlignment);
+        if (size < 0) {
+            qWarning() << "SharedMemoryFrameSender: unsupported frame format" << format << width << "x" << height;
+            return false;
+        }
+        if (ring && ring->slotSize() >= static_cast<size_t>(size)) {
+            return true;
+        }
+
+        ring = internal::SharedFrameRing::create(++generation, config.slotCount, static_cast<size_t>(size));
+        busySlots.assign(config.slotCount, false);
+        nextSlot = 0;
+        if (!ring) {
+            return false;
+        }
+
+        internal::ChannelMessage message{};
+        message.type = internal::ChannelMessage::Ring;
+        message.generation = ring->generation();
+        message.slotCount = ring->slotCount();
+        message.slotSize = ring->slotSize();
+        if (!channel->send(message, ring->fd())) {
+            qWarning() << "SharedMemoryFrameSender: failed to send ring to" << config.socketPath;
+            ring.reset();
+            return false;
+        }
+        return true;
+    }
+
+    int64_t SharedMemoryFrameSenderPrivate::acquireSlot() {
+        QElapsedTimer timer;
+        timer.start();
+
+        int timeout = 0;
+        while (true) {
+            internal::ChannelMessage message{};
+            int fd = -1;
+            int ret = channel->receive(message, fd, timeout);
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            if (ret < 0) {
+                qWarning() << "SharedMemoryFrameSender: receiver disconnected";
+                return -1;
+            } else if (ret > 0) {
+                if (message.type == internal::ChannelMessage::Release && message.generation == generation && message.slot < busySlots.size()) {
+                    busySlots[message.slot] = false;
+                }
+                // Drain all pending releases before picking a slot
+                timeout = 0;
+                continue;
+            }
+
+            for (uint32_t i = 0; i < busySlots.size(); ++i) {
+                const auto slot = (nextSlot + i) % static_cast<uint32_t>(busySlots.size());
+                if (!busySlots[slot]) {
+                    nextSlot = (slot + 1) % static_cast<uint32_t>(busySlots.size());
+                    return slot;
+                }
+            }
+
+            const auto remaining = config.slotTimeout - static_cast<int>(timer.elapsed());
+            if (remaining <= 0) {
+                return -1;
+            }
+            timeout = remaining;
+        }
+    }
+
+    bool SharedMemoryFrameSenderPrivate::sendFrame(const std::shared_ptr<AVFrame> &frame) {
+        char strBuf[AV_ERROR_MAX_STRING_SIZE];
+
+        std::shared_ptr<AVFrame> swFrame = frame;
+        if (frame->hw_frames_ctx) {
+            swFrame = std::shared_ptr<AVFrame>(av_frame_alloc(), &destroyAVFrame);
+            int ret = av_hwframe_transfer_data(swFrame.get(), frame.get(), 0);
+            if (ret < 0) {
+                qWarning() << "SharedMemoryFrameSender: failed to download frame:" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+                return false;
+            }
+            av_frame_copy_props(swFrame.get(), frame.get());
+        }
+
+        const auto format = static_cast<AVPixelFormat>(swFrame->format);
+        if (!ensureRing(swFrame->width, swFrame->height, format)) {
+            return false;
+        }
+        const auto slot = acquireSlot();
+        if (slot < 0) {
+            return false;
+        }
+
+        uint8_t *data[4]{};
+        int linesize[4]{};
+        av_image_fill_arrays(data, linesize, ring->slot(static_cast<uint32_t>(slot)), format, swFrame->width, swFrame->height, SlotAlignment);
+        av_image_copy(data, linesize, const_cast<const uint8_t **>(swFrame->data), swFrame->linesize, format, swFrame->width, swFrame->height);
+
+        internal::ChannelMessage message{};
+        message.type = internal::ChannelMessage::Frame;
+        message.generation = ring->generation();
+        message.slot = static_cast<uint32_t>(slot);
+        message.width = swFrame->width;
+        message.height = swFrame->height;
+        message.format = format;
+        message.flag = swFrame->key_frame;
+        message.colorRange = swFrame->color_range;
+        message.colorSpace = swFrame->colorspace;
+        message.colorPrimaries = swFrame->color_primaries;
+        message.colorTrc = swFrame->color_trc;
+        message.pts = swFrame->pts;
+        if (!channel->send(message)) {
+            qWarning() << "SharedMemoryFrameSender: failed to send frame to" << config.socketPath;
+            return false;
+        }
+        busySlots[static_cast<size_t>(slot)] = true;
+        return true;
+    }
+
+    void SharedMemoryFrameSenderPrivate::destroyAVFrame(AVFrame *frame) {
+        if (frame) {
+            av_frame_free(&frame);
+        }
+    }
+}// namespace AVQt
@@ -0,0 +1,64 @@
+#ifndef LIBAVQT_SHAREDMEMORYFRAMERECEIVER_P_HPP
+#define LIBAVQT_SHAREDMEMORYFRAMERECEIVER_P_HPP
+
+#include "ipc/SharedFrameChannel.hpp"
+#include "ipc/SharedMemoryFrameReceiver.hpp"
+
+#include "communication/VideoPadParams.hpp"
+
+#include <pgraph/api/Pad.hpp>
+
+#include <QtCore/QSize>
+
+#include <atomic>
+
+extern "C" {
+#include <libavutil/frame.h>
+}
+
+namespace AVQt {
+    class SharedMemoryFrameReceiverPrivate {
+        Q_DECLARE_PUBLIC(SharedMemoryFrameReceiver)
+    public:
+        static void destroyAVFrame(AVFrame *frame);
+        /**
+         * @brief AVBuffer free callback of the frames, sends the release of the slot to the sender
+         */
+        static void releaseSlot(void *opaque, uint8_t *data);
+
+    private:
+        explicit SharedMemoryFrameReceiverPrivate(SharedMemoryFrameReceiver *q);
+        SharedMemoryFrameReceiver *q_ptr;
+
+        /**
+         * @brief Relays a message of the sender to the output pad
+         */
+        void handleMessage(const internal::ChannelMessage &message, int fd);
+        /**
+         * @return a frame referencing the slot of the message, nullptr on error
+         */
+        std::shared_ptr<AVFrame> wrapSlot(const internal::ChannelMessage &message);
+        /**
+         * @brief Stops and cleans up the downstream components, if the sender didn't
+         */
+        void disconnectSender();
+
+        SharedMemoryFrameReceiver::Config config{};
+
+        int64_t outputPadId{pgraph::api::INVALID_PAD_ID};
+        std::shared_ptr<communication::VideoPadParams> outputPadParams{};
+        QSize lastFrameSize{};
+
+        int listenFd{-1};
+        std::shared_ptr<internal::SharedFrameChannel> channel{};
+        std::shared_ptr<internal::SharedFrameRing> ring{};
+
+        // State of the downstream components, as set by the sender
+        bool downstreamOpen{false}, downstreamRunning{false};
+
+        std::atomic_bool initialized{false}, open{false}, running{false}, paused{false};
+    };
+}// namespace AVQt
+
+
+#endif//LIBAVQT_SHAREDMEMORYFRAMERECEIVER_P_HPP
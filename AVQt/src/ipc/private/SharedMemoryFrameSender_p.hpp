@@ -0,0 +1,58 @@
+#ifndef LIBAVQT_SHAREDMEMORYFRAMESENDER_P_HPP
+#define LIBAVQT_SHAREDMEMORYFRAMESENDER_P_HPP
+
+#include "ipc/SharedMemoryFrameSender.hpp"
+#include "ipc/SharedFrameChannel.hpp"
+
+#include "communication/VideoPadParams.hpp"
+
+#include <pgraph/api/Pad.hpp>
+
+#include <atomic>
+#include <vector>
+
+extern "C" {
+#include <libavutil/frame.h>
+}
+
+namespace AVQt {
+    class SharedMemoryFrameSenderPrivate {
+        Q_DECLARE_PUBLIC(SharedMemoryFrameSender)
+    public:
+        static void destroyAVFrame(AVFrame *frame);
+
+    private:
+        explicit SharedMemoryFrameSenderPrivate(SharedMemoryFrameSender *q);
+        SharedMemoryFrameSender *q_ptr;
+
+        /**
+         * @brief Replaces the ring, if a frame of the given format doesn't fit into its slots
+         */
+        bool ensureRing(int width, int height, AVPixelFormat format);
+        /**
+         * @brief Processes pending releases, waits up to Config::slotTimeout for one if all slots are busy
+         * @return the index of a free slot, -1 on timeout or disconnect
+         */
+        int64_t acquireSlot();
+        bool sendFrame(const std::shared_ptr<AVFrame> &frame);
+        bool sendAction(internal::ChannelMessage::Type type, int32_t flag = 0);
+
+        SharedMemoryFrameSender::Config config{};
+
+        int64_t inputPadId{pgraph::api::INVALID_PAD_ID};
+        communication::VideoPadParams videoParams{};
+
+        std::shared_ptr<internal::SharedFrameChannel> channel{};
+        std::shared_ptr<internal::SharedFrameRing> ring{};
+        uint32_t generation{0};
+        std::vector<bool> busySlots{};
+        uint32_t nextSlot{0};
+
+        std::atomic_uint64_t droppedFrames{0};
+
+        std::atomic_bool initialized{false}, open{false}, running{false}, paused{false};
+    };
+}// namespace AVQt
+
+
+#endif//LIBAVQT_SHAREDMEMORYFRAMESENDER_P_HPP
@@ -0,0 +1,471 @@
+#include "output/ImageWriter.hpp"
+#include "private/ImageWriter_p.hpp"
+
+#include "communication/Message.hpp"
+
+#include <pgraph/api/Data.hpp>
+#include <pgraph/api/PadUserData.hpp>
+#include <pgraph/impl/SimplePadFactory.hpp>
+#include <pgraph_network/impl/RegisteringPadFactory.hpp>
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QThread>
+
+extern "C" {
+#include <libavutil/hwcontext.h>
+#include <libavutil/pixdesc.h>
+}
+
+namespace AVQt {
+    ImageWriter::ImageWriter(const Config &config, std::shared_ptr<pgraph::network::api::PadRegistry> padRegistry, QObject *parent)
+        : QObject(parent),
+          pgraph::impl::SimpleConsumer(pgraph::network::impl::RegisteringPadFactory::factoryFor(padRegistry)),
+          d_ptr(new ImageWriterPrivate(this)) {
+        Q_D(ImageWriter);
+        d->config = config;
+    }
+
+    ImageWriter::ImageWriter(const Config &config, QObject *parent)
+        : QObject(parent),
+          pgraph::impl::SimpleConsumer(pgraph::impl::SimplePadFactory::getInstance()),
+          d_ptr(new ImageWriterPrivate(this)) {
+        Q_D(ImageWriter);
+        d->config = config;
+    }
+
+    ImageWriter::~ImageWriter() {
+        Q_D(ImageWriter);
+        if (d->open) {
+            close();
+        }
+        d->workerPool.waitForDone();
+    }
+
+    bool ImageWriter::init() {
+        Q_D(ImageWriter);
+
+        bool shouldBe = false;
+        if (d->initialized.compare_exchange_strong(shouldBe, true)) {
+            if (d->config.pathTemplate.isEmpty() || d->config.interval <= 0 || d->config.maxQueued <= 0) {
+                qWarning() << "ImageWriter: pathTemplate must not be empty, interval and maxQueued must be positive";
+                d->initialized = false;
+                return false;
+            }
+            d->workerPool.setMaxThreadCount(d->config.threads > 0 ? d->config.threads : QThread::idealThreadCount());
+
+            d->inputPadId = pgraph::impl::SimpleConsumer::createInputPad(pgraph::api::PadUserData::emptyUserData());
+            if (d->inputPadId == pgraph::api::INVALID_PAD_ID) {
+                qWarning() << "ImageWriter: failed to create input pad";
+                d->initialized = false;
+                return false;
+            }
+            return true;
+        } else {
+            qWarning() << "ImageWriter::init() called multiple times";
+            return false;
+        }
+    }
+
+    bool ImageWriter::isOpen() const {
+        Q_D(const ImageWriter);
+        return d->open;
+    }
+
+    bool ImageWriter::isRunning() const {
+        Q_D(const ImageWriter);
+        return d->running;
+    }
+
+    bool ImageWriter::isPaused() const {
+        Q_D(const ImageWriter);
+        return d->paused;
+    }
+
+    int64_t ImageWriter::getInputPadId() const {
+        Q_D(const ImageWriter);
+        return d->inputPadId;
+    }
+
+    ImageWriter::Statistics ImageWriter::getStatistics() const {
+        Q_D(const ImageWriter);
+        Statistics statistics{};
+        statistics.written = d->written;
+        statistics.dropped = d->dropped;
+        statistics.failed = d->failed;
+        statistics.bytesWritten = d->bytesWritten;
+
+        std::unique_lock lock(d->timerMutex);
+        if (d->runTimer.isValid() && d->runTimer.elapsed() > 0) {
+            statistics.throughput = static_cast<double>(statistics.written) * 1000.0 / static_cast<double>(d->runTimer.elapsed());
+        }
+        return statistics;
+    }
+
+    void ImageWriter::consume(int64_t pad, std::shared_ptr<pgraph::api::Data> data) {
+        Q_D(ImageWriter);
+        if (pad != d->inputPadId) {
+            qWarning() << "ImageWriter: data on unknown pad" << pad;
+            return;
+        }
+        if (data->getType() == communication::Message::Type) {
+            auto message = std::dynamic_pointer_cast<communication::Message>(data);
+            switch (message->getAction()) {
+                case communication::Message::Action::INIT:
+                    if (!open()) {
+                        qWarning() << "ImageWriter: failed to open";
+                    }
+                    break;
+                case communication::Message::Action::CLEANUP:
+                    close();
+                    break;
+                case communication::Message::Action::START:
+                    if (!start()) {
+                        qWarning() << "ImageWriter: failed to start";
+                    }
+                    break;
+                case communication::Message::Action::STOP:
+                    stop();
+                    break;
+                case communication::Message::Action::PAUSE:
+                    pause(message->getPayload("state").toBool());
+                    break;
+                case communication::Message::Action::DATA: {
+                    if (!d->running || d->paused) {
+                        break;
+                    }
+                    auto frame = message->getPayload("frame").value<std::shared_ptr<AVFrame>>();
+                    if (!frame) {
+                        break;
+                    }
+                    const auto index = d->frameIndex++;
+                    if (index % d->config.interval != 0) {
+                        break;
+                    }
+                    if (d->queued >= d->config.maxQueued) {
+                        ++d->dropped;
+                        break;
+                    }
+                    ++d->queued;
+                    d->workerPool.start([d, frame, index] {
+                        d->writeImage(frame, index);
+                        --d->queued;
+                    });
+                    break;
+                }
+                case communication::Message::Action::RESET:
+                case communication::Message::Action::RESIZE:
+                case communication::Message::Action::NONE:
+                    // Frames carry their size, every image is encoded independently
+                    break;
+            }
+        }
+    }
+
+    bool ImageWriter::open() {
+        Q_D(ImageWriter);
+
+        if (!d->initialized) {
+            qWarning() << "ImageWriter::open() called before init()";
+            return false;
+        }
+
+        bool shouldBe = false;
+        if (d->open.compare_exchange_strong(shouldBe, true)) {
+            switch (d->config.format) {
+                case Format::JPEG:
+                    d->encoder = avcodec_find_encoder(AV_CODEC_ID_MJPEG);
+                    break;
+                case Format::PNG:
+                    d->encoder = avcodec_find_encoder(AV_CODEC_ID_PNG);
+                    break;
+                case Format::WebP:
+                    d->encoder = avcodec_find_encoder(AV_CODEC_ID_WEBP);
+                    break;
+            }
+            if (!d->encoder) {
+                qWarning() << "ImageWriter: no encoder for the image format, libavcodec lacks it";
+                d->open = false;
+                return false;
+            }
+            return true;
+        } else {
+            qWarning() << "ImageWriter::open() called multiple times";
+            return false;
+        }
+    }
+
+    void ImageWriter::close() {
+        Q_D(ImageWriter);
+
+        if (d->running) {
+            stop();
+        }
+
+        bool shouldBe = true;
+        if (d->open.compare_exchange_strong(shouldBe, false)) {
+            d->workerPool.waitForDone();
+            d->encoder = nullptr;
+        } else {
+            qWarning() << "ImageWriter::close() called multiple times";
+        }
+    }
+
+    bool ImageWriter::start() {
+        Q_D(ImageWriter);
+
+        if (!d->open) {
+            qWarning() << "ImageWriter::start() called before open()";
+            return false;
+        }
+
+        bool shouldBe = false;
+        if (d->running.compare_exchange_strong(shouldBe, true)) {
+            d->paused = false;
+            d->frameIndex = 0;
+            d->written = 0;
+            d->dropped = 0;
+            d->failed = 0;
+            d->bytesWritten = 0;
+            {
+                std::unique_lock lock(d->timerMutex);
+                d->runTimer.start();
+            }
+            emit started();
+            return true;
+        } else {
+            qWarning() << "ImageWriter::start() called multiple times";
+            return false;
+        }
+    }
+
+    void ImageWriter::stop() {
+        Q_D(ImageWriter);
+
+        bool shouldBe = true;
+        if (d->running.compare_exchange_strong(shouldBe, false)) {
+            d->paused = false;
+            // Queued images are still written
+            d->workerPool.waitForDone();
+            const auto statistics = getStatistics();
+            qDebug("ImageWriter: %lu images written, %lu dropped, %lu failed, %.1f images/s",
+                   static_cast<unsigned long>(statistics.written), static_cast<unsigned long>(statistics.dropped),
+                   static_cast<unsigned long>(statistics.failed), statistics.throughput);
+            emit stopped();
+        } else {
+            qWarning() << "ImageWriter::stop() called multiple times";
+        }
+    }
+
+    void ImageWriter::pause(bool state) {
+        Q_D(ImageWriter);
+
+        bool shouldBe = !state;
+        if (d->paused.compare_exchange_strong(shouldBe, state)) {
+            emit paused(state);
+        } else {
+            qDebug() << "ImageWriter::pause: state already" << state;
+        }
+    }
+
+    ImageWriterPrivate::ImageWriterPrivate(ImageWriter *q) : q_ptr(q) {}
+
+    QString ImageWriterPrivate::pathFor(int64_t index, int64_t timestamp) const {
+        QString path{config.pathTemplate};
+        path.replace(QLatin1String("{index}"), QString::number(index));
+        path.replace(QLatin1String("{timestamp}"), QString::number(timestamp));
+        return path;
+    }
+
+    std::shared_ptr<AVFrame> ImageWriterPrivate::prepareFrame(const std::shared_ptr<AVFrame> &frame) const {
+        char strBuf[AV_ERROR_MAX_STRING_SIZE];
+
+        std::shared_ptr<AVFrame> source{av_frame_alloc(), &destroyAVFrame};
+        if (frame->hw_frames_ctx) {
+            int ret = av_hwframe_transfer_data(source.get(), frame.get(), 0);
+            if (ret < 0) {
+                qWarning() << "ImageWriter: failed to download frame:" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+                return {};
+            }
+            av_frame_copy_props(source.get(), frame.get());
+        } else {
+            // A new reference, the frame is shared with other consumers and its properties are changed below
+            int ret = av_frame_ref(source.get(), frame.get());
+            if (ret < 0) {
+                qWarning() << "ImageWriter: failed to reference frame:" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+                return {};
+            }
+        }
+
+        const auto sourceFormat = static_cast<AVPixelFormat>(source->format);
+        const bool sourceFullRange = source->color_range == AVCOL_RANGE_JPEG || isYuvj(sourceFormat);
+        auto targetFormat = sourceFormat;
+        if (encoder->pix_fmts) {
+            bool supported = false;
+            for (auto *format = encoder->pix_fmts; *format != AV_PIX_FMT_NONE; ++format) {
+                supported |= *format == sourceFormat;
+            }
+            if (!supported) {
+                // E.g. nv12 to yuvj420p for JPEG, RGB for PNG
+                targetFormat = avcodec_find_best_pix_fmt_of_list(encoder->pix_fmts, sourceFormat, 0, nullptr);
+            }
+        }
+        if (encoder->id == AV_CODEC_ID_MJPEG && (!sourceFullRange || targetFormat != sourceFormat)) {
+            // JPEG is full range, limited range YUV is only accepted as non-standard and shown washed out. The planes are
+            // expanded to the yuvj format of the same layout, which is still no RGB round-trip.
+            targetFormat = toFullRange(targetFormat);
+        }
+        if (targetFormat == sourceFormat) {
+            return source;
+        }
+
+        std::unique_ptr<SwsContext, decltype(&destroySwsContext)> converter{
+                sws_getContext(source->width, source->height, sourceFormat, source->width, source->height, targetFormat, SWS_BICUBIC, nullptr, nullptr, nullptr),
+                &destroySwsContext};
+        if (!converter) {
+            qWarning() << "ImageWriter: no conversion from" << av_get_pix_fmt_name(sourceFormat) << "to" << av_get_pix_fmt_name(targetFormat);
+            return {};
+        }
+        if (sourceFullRange) {
+            // swscale only derives the range from the yuvj formats, not from the frame
+            int *inverseTable, *table, sourceRange, targetRange, brightness, contrast, saturation;
+            if (sws_getColorspaceDetails(converter.get(), &inverseTable, &sourceRange, &table, &targetRange, &brightness, &contrast, &saturation) >= 0) {
+                sws_setColorspaceDetails(converter.get(), inverseTable, 1, table, targetRange, brightness, contrast, saturation);
+            }
+        }
+
+        std::shared_ptr<AVFrame> converted{av_frame_alloc(), &destroyAVFrame};
+        converted->format = targetFormat;
+        converted->width = source->width;
+        converted->height = source->height;
+        int ret = av_frame_get_buffer(converted.get(), 0);
+        if (ret < 0) {
+            qWarning() << "ImageWriter: failed to allocate frame:" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+            return {};
+        }
+        sws_scale(converter.get(), source->data, source->linesize, 0, source->height, converted->data, converted->linesize);
+        av_frame_copy_props(converted.get(), source.get());
+        if (isYuvj(targetFormat)) {
+            converted->color_range = AVCOL_RANGE_JPEG;
+        }
+        return converted;
+    }
+
+    std::shared_ptr<AVPacket> ImageWriterPrivate::encode(const std::shared_ptr<AVFrame> &frame) const {
+        char strBuf[AV_ERROR_MAX_STRING_SIZE];
+
+        std::unique_ptr<AVCodecContext, decltype(&destroyAVCodecContext)> codecContext{avcodec_alloc_context3(encoder), &destroyAVCodecContext};
+        if (!codecContext) {
+            qWarning() << "ImageWriter: failed to allocate encoder context";
+            return {};
+        }
+        codecContext->width = frame->width;
+        codecContext->height = frame->height;
+        codecContext->pix_fmt = static_cast<AVPixelFormat>(frame->format);
+        // mjpeg checks the range of the context, full range frames in yuv420p etc. are accepted with it
+        codecContext->color_range = isYuvj(codecContext->pix_fmt) ? AVCOL_RANGE_JPEG : frame->color_range;
+        codecContext->time_base = {1, 1000000};// microseconds
+        codecContext->thread_count = 1;
+        if (config.quality >= 0 && config.format != ImageWriter::Format::PNG) {
+            codecContext->flags |= AV_CODEC_FLAG_QSCALE;
+            codecContext->global_quality = FF_QP2LAMBDA * config.quality;
+            frame->quality = codecContext->global_quality;
+        }
+        frame->pict_type = AV_PICTURE_TYPE_NONE;
+
+        int ret = avcodec_open2(codecContext.get(), encoder, nullptr);
+        if (ret < 0) {
+            qWarning() << "ImageWriter: failed to open encoder" << encoder->name << ":" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+            return {};
+        }
+
+        ret = avcodec_send_frame(codecContext.get(), frame.get());
+        if (ret < 0) {
+            qWarning() << "ImageWriter: failed to send frame:" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+            return {};
+        }
+        avcodec_send_frame(codecContext.get(), nullptr);
+
+        std::shared_ptr<AVPacket> packet{av_packet_alloc(), &destroyAVPacket};
+        ret = avcodec_receive_packet(codecContext.get(), packet.get());
+        if (ret < 0) {
+            qWarning() << "ImageWriter: failed to encode image:" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+            return {};
+        }
+        return packet;
+    }
+
+    void ImageWriterPrivate::writeImage(const std::shared_ptr<AVFrame> &frame, int64_t index) {
+        Q_Q(ImageWriter);
+
+        auto prepared = prepareFrame(frame);
+        auto packet = prepared ? encode(prepared) : nullptr;
+        if (!packet) {
+            ++failed;
+            return;
+        }
+
+        const auto timestamp = frame->pts != AV_NOPTS_VALUE ? frame->pts : index;
+        const auto path = pathFor(index, timestamp);
+        QDir().mkpath(QFileInfo(path).absolutePath());
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly) || file.write(reinterpret_cast<const char *>(packet->data), packet->size) != packet->size) {
+            qWarning() << "ImageWriter: failed to write" << path << ":" << file.errorString();
+            ++failed;
+            return;
+        }
+        file.close();
+
+        ++written;
+        bytesWritten += static_cast<uint64_t>(packet->size);
+        emit q->imageWritten(path, timestamp);
+    }
+
+    AVPixelFormat ImageWriterPrivate::toFullRange(AVPixelFormat format) {
+        switch (format) {
+            case AV_PIX_FMT_YUV420P:
+            case AV_PIX_FMT_YUVJ420P:
+                return AV_PIX_FMT_YUVJ420P;
+            case AV_PIX_FMT_YUV422P:
+            case AV_PIX_FMT_YUVJ422P:
+                return AV_PIX_FMT_YUVJ422P;
+            case AV_PIX_FMT_YUV444P:
+            case AV_PIX_FMT_YUVJ444P:
+                return AV_PIX_FMT_YUVJ444P;
+            case AV_PIX_FMT_YUV440P:
+            case AV_PIX_FMT_YUVJ440P:
+                return AV_PIX_FMT_YUVJ440P;
+            default:
+                return format;
+        }
+    }
+
+    bool ImageWriterPrivate::isYuvj(AVPixelFormat format) {
+        return format == AV_PIX_FMT_YUVJ420P || format == AV_PIX_FMT_YUVJ422P || format == AV_PIX_FMT_YUVJ444P || format == AV_PIX_FMT_YUVJ440P;
+    }
+
+    void ImageWriterPrivate::destroyAVCodecContext(AVCodecContext *codecContext) {
+        if (codecContext) {
+            avcodec_free_context(&codecContext);
+        }
+    }
+
+    void ImageWriterPrivate::destroySwsContext(SwsContext *swsContext) {
+        if (swsContext) {
+            sws_freeContext(swsContext);
+        }
+    }
+
+    void ImageWriterPrivate::destroyAVFrame(AVFrame *frame) {
+        if (frame) {
+            av_frame_free(&frame);
+        }
+    }
+
+    void ImageWriterPrivate::destroyAVPacket(AVPacket *packet) {
+        if (packet) {
+            av_packet_free(&packet);
+        }
+    }
+}// namespace AVQt
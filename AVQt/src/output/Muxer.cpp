@@ -19,6 +19,10 @@ extern "C" {
 }
 
 #include <QIODevice>
+#include <QSize>
+
+#include <algorithm>
+#include <chrono>
 
 namespace AVQt {
     Muxer::Muxer(Config config, std::shared_ptr<pgraph::network::api::PadRegistry> padRegistry, QObject *parent)
@@ -40,6 +44,9 @@ namespace AVQt {
     void MuxerPrivate::init(AVQt::Muxer::Config config) {
         Q_Q(Muxer);
         outputDevice = std::move(config.outputDevice);
+        copyTimestamps = config.copyTimestamps;
+        interleave = config.latency.interleave;
+        inputQueueMaxSize = static_cast<size_t>(std::max(config.latency.muxerQueueSize, 1));
         pOutputFormat = av_guess_format(config.containerFormat, nullptr, nullptr);
         if (!pOutputFormat) {
             qWarning() << "[Muxer] Could not find output format for " << config.containerFormat;
@@ -70,11 +77,15 @@ namespace AVQt {
         }
 
         pFormatCtx.reset(formatContext);
-        pBuffer = static_cast<uint8_t *>(av_malloc(MuxerPrivate::BUFFER_SIZE));
-        pIOCtx.reset(avio_alloc_context(pBuffer, MuxerPrivate::BUFFER_SIZE, 1, this, nullptr, MuxerPrivate::writeIO, MuxerPrivate::seekIO));
+        const auto bufferSize = static_cast<int>(std::max<size_t>(config.latency.ioBufferSize, 188));
+        pBuffer = static_cast<uint8_t *>(av_malloc(static_cast<size_t>(bufferSize)));
+        pIOCtx.reset(avio_alloc_context(pBuffer, bufferSize, 1, this, nullptr, MuxerPrivate::writeIO, MuxerPrivate::seekIO));
 
         pFormatCtx->pb = pIOCtx.get();
         pFormatCtx->flags |= AVFMT_FLAG_CUSTOM_IO;
+        if (config.latency.flushPackets) {
+            pFormatCtx->flags |= AVFMT_FLAG_FLUSH_PACKETS;
+        }
         pFormatCtx->oformat = const_cast<AVOutputFormat *>(pOutputFormat);
     }
 
@@ -202,7 +213,9 @@ namespace AVQt {
                     d->resetStream(pad);
                     break;
                 case communication::Message::Action::RESIZE: {
-                    qWarning() << "[Muxer] Unsupported action" << msg->getAction().name() << "please fix your code";
+                    // The header was written already, only containers with in-band parameter sets (e.g. MPEG-TS) pick up the new size
+                    qWarning() << "[Muxer] Stream" << pad << "changed its resolution to" << msg->getPayload("size").toSize();
+                    break;
                 }
                 default:
                     break;
@@ -296,12 +309,13 @@ namespace AVQt {
             //            }
             auto si = nextPacket->stream_index;
             std::unique_lock tsLock{d->streamResetMutex};
-            if (d->lastPackets.find(nextPacket->stream_index) != d->lastPackets.end()) {
+            // With stream copy, timestamps are already continuous and may be reordered
+            if (!d->copyTimestamps && d->lastPackets.find(nextPacket->stream_index) != d->lastPackets.end()) {
                 nextPacket->dts = d->streamDts[d->streamToPadMap[si]];
                 d->streamDts[d->streamToPadMap[si]] += nextPacket->duration;
                 nextPacket->pts = d->streamPts[d->streamToPadMap[si]];
                 d->streamPts[d->streamToPadMap[si]] += nextPacket->duration;
-            } else {
+            } else if (!d->copyTimestamps) {
                 d->streamDts[d->streamToPadMap[nextPacket->stream_index]] = nextPacket->dts;
                 d->streamPts[d->streamToPadMap[nextPacket->stream_index]] = nextPacket->pts;
             }
@@ -312,9 +326,10 @@ namespace AVQt {
             qDebug("Packet (Stream %s) pts: %ld, dts: %ld", d->pFormatCtx->streams[si]->codecpar->codec_type == AVMEDIA_TYPE_AUDIO ? "Audio" : "Video", d->lastPackets[si]->pts, d->lastPackets[si]->dts);
 
             AVPacket *pkt = av_packet_clone(d->lastPackets[si].get());
-            av_packet_rescale_ts(pkt, {1, 1000000}, d->pFormatCtx->streams[si]->time_base);
+            av_packet_rescale_ts(pkt, d->padTimeBases[d->streamToPadMap[si]], d->pFormatCtx->streams[si]->time_base);
 
-            int ret = av_interleaved_write_frame(d->pFormatCtx.get(), pkt);
+            // Without interleaving, packets are written in the order they arrive instead of waiting for the other streams
+            int ret = d->interleave ? av_interleaved_write_frame(d->pFormatCtx.get(), pkt) : av_write_frame(d->pFormatCtx.get(), pkt);
             av_packet_free(&pkt);
             if (ret == AVERROR(EAGAIN)) {
                 continue;
@@ -412,8 +427,12 @@ namespace AVQt {
             return false;
         }
         avcodec_parameters_copy(stream->codecpar, params->codecParams.get());
-        stream->time_base = {1, 1000000};// Microseconds
+        // The tag of the source container may be invalid in the output container, let libavformat choose one
+        stream->codecpar->codec_tag = 0;
+        // Only a hint, avformat_write_header() may choose a different time base
+        stream->time_base = params->timeBase.num > 0 && params->timeBase.den > 0 ? params->timeBase : AVRational{1, 1000000};
 
+        padTimeBases[padId] = stream->time_base;
         streams[padId] = stream;
         streamToPadMap[stream->index] = padId;
         streamResetFlags[padId] = false;
@@ -457,6 +476,13 @@ namespace AVQt {
         if (startedStreams.empty() && running) {
             qDebug() << "[Muxer] all streams stopped, stopping muxing";
 
+            // STOP follows the last packets of the streams, write the queued ones instead of letting stop() discard them
+            {
+                std::unique_lock<std::mutex> lock(inputQueueMutex);
+                while (!inputQueue.empty() && !paused && !q->isFinished()) {
+                    inputQueueCond.wait_for(lock, std::chrono::milliseconds(100));
+                }
+            }
             q->stop();
         }
     }
@@ -0,0 +1,295 @@
+#include "output/ThumbnailGenerator.hpp"
+#include "private/ThumbnailGenerator_p.hpp"
+
+#include <QtCore/QDebug>
+#include <QtCore/QThread>
+#include <QtGui/QPainter>
+
+#include <algorithm>
+#include <cmath>
+
+namespace AVQt {
+    ThumbnailGenerator::ThumbnailGenerator(const Config &config, QObject *parent)
+        : QObject(parent),
+          d_ptr(new ThumbnailGeneratorPrivate(this)) {
+        Q_D(ThumbnailGenerator);
+        d->config = config;
+        d->workerPool.setMaxThreadCount(config.maxParallel > 0 ? config.maxParallel : QThread::idealThreadCount());
+    }
+
+    ThumbnailGenerator::~ThumbnailGenerator() {
+        Q_D(ThumbnailGenerator);
+        d->workerPool.waitForDone();
+    }
+
+    QList<ThumbnailGenerator::Thumbnail> ThumbnailGenerator::generate() {
+        Q_D(ThumbnailGenerator);
+
+        if (d->config.count <= 0 || d->config.size.isEmpty()) {
+            qWarning() << "ThumbnailGenerator: count and size must be positive";
+            return {};
+        }
+
+        int64_t duration;
+        {
+            auto input = d->openInput();
+            if (!input) {
+                return {};
+            }
+            const int streamIndex = av_find_best_stream(input.get(), AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+            if (streamIndex < 0) {
+                qWarning() << "ThumbnailGenerator: no video stream in" << d->config.inputPath;
+                return {};
+            }
+            const auto *stream = input->streams[streamIndex];
+            // AV_TIME_BASE is microseconds
+            duration = input->duration;
+            if (duration <= 0 && stream->duration > 0) {
+                duration = av_rescale_q(stream->duration, stream->time_base, {1, 1000000});
+            }
+            d->startTime = input->start_time != AV_NOPTS_VALUE ? input->start_time : 0;
+        }
+        if (duration <= 0) {
+            qWarning() << "ThumbnailGenerator: unknown duration of" << d->config.inputPath;
+            return {};
+        }
+
+        const auto count = static_cast<size_t>(d->config.count);
+        d->targets.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            // Centered in each interval, so neither the first nor the last thumbnail hits the very start or end of the file
+            d->targets[i] = av_rescale(duration, static_cast<int64_t>(2 * i + 1), static_cast<int64_t>(2 * count));
+        }
+        {
+            std::unique_lock lock(d->resultMutex);
+            d->results.assign(count, std::nullopt);
+        }
+
+        // Contiguous groups, so each worker only seeks forward
+        const auto workers = std::min(count, static_cast<size_t>(std::max(d->workerPool.maxThreadCount(), 1)));
+        for (size_t worker = 0; worker < workers; ++worker) {
+            const auto first = count * worker / workers;
+            const auto last = count * (worker + 1) / workers;
+            d->workerPool.start([d, first, last] {
+                d->processRange(first, last);
+            });
+        }
+        d->workerPool.waitForDone();
+
+        QList<Thumbnail> thumbnails{};
+        std::unique_lock lock(d->resultMutex);
+        for (auto &result : d->results) {
+            if (result) {
+                thumbnails.append(*result);
+            }
+        }
+        d->results.clear();
+        return thumbnails;
+    }
+
+    QImage ThumbnailGenerator::createSprite(const QList<Thumbnail> &thumbnails, int columns) {
+        if (thumbnails.isEmpty()) {
+            return {};
+        }
+
+        const int count = static_cast<int>(thumbnails.size());
+        if (columns <= 0) {
+            columns = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+        }
+        const int rows = (count + columns - 1) / columns;
+
+        QSize cell{};
+        for (const auto &thumbnail : thumbnails) {
+            cell = cell.expandedTo(thumbnail.image.size());
+        }
+
+        QImage sprite(cell.width() * columns, cell.height() * rows, QImage::Format_RGB32);
+        sprite.fill(Qt::black);
+        QPainter painter(&sprite);
+        for (int i = 0; i < count; ++i) {
+            const auto &image = thumbnails[i].image;
+            const int x = (i % columns) * cell.width() + (cell.width() - image.width()) / 2;
+            const int y = (i / columns) * cell.height() + (cell.height() - image.height()) / 2;
+            painter.drawImage(x, y, image);
+        }
+        painter.end();
+        return sprite;
+    }
+
+    ThumbnailGeneratorPrivate::ThumbnailGeneratorPrivate(ThumbnailGenerator *q) : q_ptr(q) {}
+
+    ThumbnailGeneratorPrivate::FormatContextPtr ThumbnailGeneratorPrivate::openInput() const {
+        char strBuf[AV_ERROR_MAX_STRING_SIZE];
+
+        AVFormatContext *formatContext = nullptr;
+        int ret = avformat_open_input(&formatContext, config.inputPath.toLocal8Bit().constData(), nullptr, nullptr);
+        if (ret < 0) {
+            qWarning() << "ThumbnailGenerator: failed to open" << config.inputPath << ":" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+            return {nullptr, &destroyAVFormatContext};
+        }
+        FormatContextPtr result{formatContext, &destroyAVFormatContext};
+
+        ret = avformat_find_stream_info(result.get(), nullptr);
+        if (ret < 0) {
+            qWarning() << "ThumbnailGenerator: failed to find stream info:" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+            return {nullptr, &destroyAVFormatContext};
+        }
+        return result;
+    }
+
+    void ThumbnailGeneratorPrivate::processRange(size_t first, size_t last) {
+        Q_Q(ThumbnailGenerator);
+        char strBuf[AV_ERROR_MAX_STRING_SIZE];
+
+        auto input = openInput();
+        if (!input) {
+            return;
+        }
+        const int streamIndex = av_find_best_stream(input.get(), AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+        if (streamIndex < 0) {
+            return;
+        }
+        for (unsigned int i = 0; i < input->nb_streams; ++i) {
+            if (static_cast<int>(i) != streamIndex) {
+                input->streams[i]->discard = AVDISCARD_ALL;
+            }
+        }
+        auto *stream = input->streams[streamIndex];
+
+        const auto *decoder = avcodec_find_decoder(stream->codecpar->codec_id);
+        std::unique_ptr<AVCodecContext, decltype(&destroyAVCodecContext)> codecContext{avcodec_alloc_context3(decoder), &destroyAVCodecContext};
+        if (!decoder || !codecContext) {
+            qWarning() << "ThumbnailGenerator: no decoder for" << avcodec_get_name(stream->codecpar->codec_id);
+            return;
+        }
+        avcodec_parameters_to_context(codecContext.get(), stream->codecpar);
+        codecContext->pkt_timebase = stream->time_base;
+        // Parallelism comes from the workers, frame threading would only delay the first frame
+        codecContext->thread_count = 1;
+        if (config.keyframesOnly) {
+            codecContext->skip_frame = AVDISCARD_NONKEY;
+        }
+        int ret = avcodec_open2(codecContext.get(), decoder, nullptr);
+        if (ret < 0) {
+            qWarning() << "ThumbnailGenerator: failed to open decoder:" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+            return;
+        }
+
+        std::unique_ptr<SwsContext, decltype(&destroySwsContext)> scaler{nullptr, &destroySwsContext};
+        std::unique_ptr<AVPacket, decltype(&destroyAVPacket)> packet{av_packet_alloc(), &destroyAVPacket};
+        std::unique_ptr<AVFrame, decltype(&destroyAVFrame)> frame{av_frame_alloc(), &destroyAVFrame};
+        std::unique_ptr<AVFrame, decltype(&destroyAVFrame)> candidate{av_frame_alloc(), &destroyAVFrame};
+
+        for (size_t index = first; index < last; ++index) {
+            const auto target = targets[index];
+            const auto seekTarget = av_rescale_q(startTime + target, {1, 1000000}, stream->time_base);
+            ret = av_seek_frame(input.get(), streamIndex, seekTarget, AVSEEK_FLAG_BACKWARD);
+            if (ret < 0) {
+                qWarning() << "ThumbnailGenerator: failed to seek to" << target << ":" << av_make_error_string(strBuf, AV_ERROR_MAX_STRING_SIZE, ret);
+                continue;
+            }
+            avcodec_flush_buffers(codecContext.get());
+            av_frame_unref(candidate.get());
+
+            // The keyframe before the target in keyframe mode, else the first frame at or after it, or the last one of the file
+            bool found = false, draining = false;
+            while (!found) {
+                if (!draining) {
+                    ret = av_read_frame(input.get(), packet.get());
+                    if (ret < 0) {
+                        draining = true;
+                        avcodec_send_packet(codecContext.get(), nullptr);
+                    } else {
+                        if (packet->stream_index == streamIndex) {
+                            avcodec_send_packet(codecContext.get(), packet.get());
+                        }
+                        av_packet_unref(packet.get());
+                    }
+                }
+                while (!found) {
+                    ret = avcodec_receive_frame(codecContext.get(), frame.get());
+                    if (ret < 0) {
+                        break;
+                    }
+                    const auto pts = frame->best_effort_timestamp;
+                    const auto timestamp = pts != AV_NOPTS_VALUE ? av_rescale_q(pts, stream->time_base, {1, 1000000}) - startTime : target;
+                    found = config.keyframesOnly || timestamp >= target;
+                    av_frame_unref(candidate.get());
+                    av_frame_move_ref(candidate.get(), frame.get());
+                    candidate->pts = timestamp;
+                }
+                if (draining && ret < 0) {
+                    break;
+                }
+            }
+            if (!candidate->data[0]) {
+                qWarning() << "ThumbnailGenerator: no frame at" << target;
+                continue;
+            }
+
+            auto image = toImage(candidate.get(), av_guess_sample_aspect_ratio(input.get(), stream, candidate.get()), scaler);
+            if (image.isNull()) {
+                continue;
+            }
+            ThumbnailGenerator::Thumbnail thumbnail{};
+            thumbnail.timestamp = candidate->pts;
+            thumbnail.image = image;
+            {
+                std::unique_lock lock(resultMutex);
+                results[index] = thumbnail;
+            }
+            emit q->thumbnailReady(static_cast<int>(index), thumbnail.timestamp, thumbnail.image);
+        }
+    }
+
+    QImage ThumbnailGeneratorPrivate::toImage(const AVFrame *frame, AVRational sampleAspectRatio, std::unique_ptr<SwsContext, decltype(&destroySwsContext)> &scaler) const {
+        QSize displaySize{frame->width, frame->height};
+        if (sampleAspectRatio.num > 0 && sampleAspectRatio.den > 0) {
+            displaySize.setWidth(static_cast<int>(av_rescale(frame->width, sampleAspectRatio.num, sampleAspectRatio.den)));
+        }
+        const auto size = displaySize.scaled(config.size, Qt::KeepAspectRatio).expandedTo({1, 1});
+
+        scaler.reset(sws_getCachedContext(scaler.release(), frame->width, frame->height, static_cast<AVPixelFormat>(frame->format),
+                                          size.width(), size.height(), AV_PIX_FMT_RGB24, SWS_AREA, nullptr, nullptr, nullptr));
+        if (!scaler) {
+            qWarning() << "ThumbnailGenerator: failed to create scaler";
+            return {};
+        }
+
+        QImage image(size, QImage::Format_RGB888);
+        uint8_t *dstData[4]{image.bits(), nullptr, nullptr, nullptr};
+        int dstLinesize[4]{static_cast<int>(image.bytesPerLine()), 0, 0, 0};
+        sws_scale(scaler.get(), frame->data, frame->linesize, 0, frame->height, dstData, dstLinesize);
+        return image;
+    }
+
+    void ThumbnailGeneratorPrivate::destroyAVFormatContext(AVFormatContext *formatContext) {
+        if (formatContext) {
+            avformat_close_input(&formatContext);
+        }
+    }
+
+    void ThumbnailGeneratorPrivate::destroyAVCodecContext(AVCodecContext *codecContext) {
+        if (codecContext) {
+            avcodec_free_context(&codecContext);
+        }
+    }
+
+    void ThumbnailGeneratorPrivate::destroySwsContext(SwsContext *swsContext) {
+        if (swsContext) {
+            sws_freeContext(swsContext);
+        }
+    }
+
+    void ThumbnailGeneratorPrivate::destroyAVFrame(AVFrame *frame) {
+        if (frame) {
+            av_frame_free(&frame);
+        }
+    }
+
+    void ThumbnailGeneratorPrivate::destroyAVPacket(AVPacket *packet) {
+        if (packet) {
+            av_packet_free(&packet);
+        }
+    }
+}// namespace AVQt
@@ -0,0 +1,412 @@
+#include "output/UdpStreamSink.hpp"
+#include "private/UdpStreamSink_p.hpp"
+
+#include <QtCore/QDebug>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <random>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace AVQt {
+    namespace {
+        constexpr uint8_t TsSyncByte = 0x47;
+        constexpr uint32_t TsPacketSize = 188;
+        constexpr uint32_t RtpHeaderSize = 12;
+        constexpr uint8_t RtpPayloadTypeMP2T = 33;
+        // PCR runs at 27 MHz and wraps after 2^33 * 300 ticks
+        constexpr int64_t PcrWrap = (int64_t{1} << 33) * 300;
+        // PCR steps larger than this are treated as discontinuity
+        constexpr int64_t MaxPcrStep = 1000000;
+        constexpr int64_t BurstWindow = 10000;
+
+        int64_t currentTimeUs() {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        /**
+         * @return the PCR of a TS packet in 27 MHz ticks, -1 if it has none
+         */
+        int64_t readPcr(const uint8_t *packet, int &pid) {
+            pid = ((packet[1] & 0x1F) << 8) | packet[2];
+            const bool hasAdaptationField = packet[3] & 0x20;
+            if (packet[0] != TsSyncByte || !hasAdaptationField || packet[4] < 7 || !(packet[5] & 0x10)) {
+                return -1;
+            }
+            const auto *pcr = packet + 6;
+            const int64_t base = (int64_t{pcr[0]} << 25) | (int64_t{pcr[1]} << 17) | (int64_t{pcr[2]} << 9) | (int64_t{pcr[3]} << 1) | (pcr[4] >> 7);
+            const int64_t extension = ((pcr[4] & 0x01) << 8) | pcr[5];
+            return base * 300 + extension;
+        }
+    }// namespace
+
+    UdpStreamSink::UdpStreamSink(const Config &config, QObject *parent)
+        : QIODevice(parent),
+          d_ptr(new UdpStreamSinkPrivate(this)) {
+        Q_D(UdpStreamSink);
+        d->config = config;
+    }
+
+    UdpStreamSink::~UdpStreamSink() {
+        if (isOpen()) {
+            UdpStreamSink::close();
+        }
+    }
+
+    bool UdpStreamSink::open(OpenMode mode) {
+        Q_D(UdpStreamSink);
+
+        if (mode & ReadOnly) {
+            qWarning() << "UdpStreamSink: only WriteOnly is supported";
+            return false;
+        }
+        if (isOpen()) {
+            qWarning() << "UdpStreamSink::open() called multiple times";
+            return false;
+        }
+        if (d->config.packetsPerDatagram <= 0 || d->config.queueSize <= 0 || d->config.batchSize <= 0) {
+            qWarning() << "UdpStreamSink: packetsPerDatagram, queueSize and batchSize must be positive";
+            return false;
+        }
+
+        if (!d->openSocket()) {
+            return false;
+        }
+
+        d->headerSize = d->config.rtp ? RtpHeaderSize : 0;
+        d->payloadSize = static_cast<uint32_t>(d->config.packetsPerDatagram) * TsPacketSize;
+        d->slotSize = d->headerSize + d->payloadSize;
+
+        const auto queueSize = static_cast<uint32_t>(d->config.queueSize);
+        d->slotMemory.assign(queueSize * static_cast<size_t>(d->slotSize), 0);
+        d->freeSlots.clear();
+        for (uint32_t i = queueSize; i > 0; --i) {
+            d->freeSlots.push_back(i - 1);
+        }
+        d->queue.clear();
+        d->finishing = false;
+        d->pending.clear();
+        d->pcrPid = -1;
+        d->lastPcr = -1;
+        d->lastPcrTime = 0;
+        d->scheduleTime = 0;
+        d->bytesSincePcr = 0;
+        d->measuredRate = 0;
+        d->rtpSequence = 0;
+        d->rtpSsrc = std::random_device{}();
+        d->statistics = {};
+        d->firstSendTime = -1;
+
+        QIODevice::open(mode | Unbuffered);
+
+        d->sending = true;
+        d->sendThread.reset(QThread::create([d] { d->sendLoop(); }));
+        d->sendThread->start();
+        return true;
+    }
+
+    void UdpStreamSink::close() {
+        Q_D(UdpStreamSink);
+
+        if (d->sending) {
+            d->packetize(true);
+            {
+                std::lock_guard lock(d->mutex);
+                d->finishing = true;
+            }
+            d->queueChanged.notify_all();
+            d->sendThread->wait();
+            d->sendThread.reset();
+            d->sending = false;
+        }
+        if (d->socketFd >= 0) {
+            ::close(d->socketFd);
+            d->socketFd = -1;
+        }
+
+        const auto statistics = getStatistics();
+        qDebug("UdpStreamSink: sent %lu datagrams, %lu send errors, %lu resyncs, burstiness %.2f",
+               static_cast<unsigned long>(statistics.datagrams), static_cast<unsigned long>(statistics.sendErrors),
+               static_cast<unsigned long>(statistics.resyncs), statistics.burstiness);
+
+        d->slotMemory.clear();
+        d->slotMemory.shrink_to_fit();
+        d->freeSlots.clear();
+        QIODevice::close();
+    }
+
+    bool UdpStreamSink::isSequential() const {
+        return true;
+    }
+
+    UdpStreamSink::Statistics UdpStreamSink::getStatistics() const {
+        Q_D(const UdpStreamSink);
+        std::lock_guard lock(d->mutex);
+        return d->statistics;
+    }
+
+    qint64 UdpStreamSink::readData(char *data, qint64 maxSize) {
+        Q_UNUSED(data)
+        Q_UNUSED(maxSize)
+        return -1;
+    }
+
+    qint64 UdpStreamSink::writeData(const char *data, qint64 maxSize) {
+        Q_D(UdpStreamSink);
+
+        if (maxSize <= 0) {
+            return 0;
+        }
+        const auto *bytes = reinterpret_cast<const uint8_t *>(data);
+        d->pending.insert(d->pending.end(), bytes, bytes + maxSize);
+        if (!d->packetize(false)) {
+            return -1;
+        }
+        return maxSize;
+    }
+
+    UdpStreamSinkPrivate::UdpStreamSinkPrivate(UdpStreamSink *q) : q_ptr(q) {}
+
+    bool UdpStreamSinkPrivate::openSocket() {
+        in_addr address{};
+        if (inet_pton(AF_INET, config.address.toLatin1().constData(), &address) != 1) {
+            qWarning() << "UdpStreamSink: invalid IPv4 address" << config.address;
+            return false;
+        }
+
+        socketFd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        if (socketFd < 0) {
+            qWarning() << "UdpStreamSink: failed to create socket:" << strerror(errno);
+            return false;
+        }
+        if (config.sendBufferSize > 0) {
+            setsockopt(socketFd, SOL_SOCKET, SO_SNDBUF, &config.sendBufferSize, sizeof(config.sendBufferSize));
+        }
+        if (IN_MULTICAST(ntohl(address.s_addr))) {
+            setsockopt(socketFd, IPPROTO_IP, IP_MULTICAST_TTL, &config.multicastTtl, sizeof(config.multicastTtl));
+        }
+
+        // Connected, so sendmmsg needs no destination per datagram
+        sockaddr_in destination{};
+        destination.sin_family = AF_INET;
+        destination.sin_port = htons(config.port);
+        destination.sin_addr = address;
+        if (::connect(socketFd, reinterpret_cast<const sockaddr *>(&destination), sizeof(destination)) < 0) {
+            qWarning() << "UdpStreamSink: failed to connect to" << config.address << config.port << ":" << strerror(errno);
+            ::close(socketFd);
+            socketFd = -1;
+            return false;
+        }
+        return true;
+    }
+
+    bool UdpStreamSinkPrivate::packetize(bool flush) {
+        size_t offset = 0;
+        while (true) {
+            auto available = static_cast<uint32_t>(std::min<size_t>(pending.size() - offset, payloadSize));
+            if (available < payloadSize) {
+                // Only whole TS packets are sent, a partial one is incomplete output of the muxer
+                available -= available % TsPacketSize;
+                if (!flush || available == 0) {
+                    break;
+                }
+            }
+
+            const auto *packets = pending.data() + offset;
+            const auto sendTime = schedule(packets, available);
+
+            std::unique_lock lock(mutex);
+            queueChanged.wait(lock, [this] { return !freeSlots.empty() || !sending; });
+            if (!sending) {
+                return false;
+            }
+            const auto slot = freeSlots.back();
+            freeSlots.pop_back();
+            auto *data = slotData(slot);
+            if (config.rtp) {
+                const auto timestamp = static_cast<uint32_t>(sendTime * 9 / 100);// 90 kHz
+                data[0] = 0x80;
+                data[1] = RtpPayloadTypeMP2T;
+                data[2] = static_cast<uint8_t>(rtpSequence >> 8);
+                data[3] = static_cast<uint8_t>(rtpSequence & 0xFF);
+                for (int i = 0; i < 4; ++i) {
+                    data[4 + i] = static_cast<uint8_t>(timestamp >> (24 - 8 * i));
+                    data[8 + i] = static_cast<uint8_t>(rtpSsrc >> (24 - 8 * i));
+                }
+                ++rtpSequence;
+            }
+            std::memcpy(data + headerSize, packets, available);
+            queue.push_back({slot, headerSize + available, sendTime});
+            lock.unlock();
+            queueChanged.notify_all();
+
+            offset += available;
+            if (available < payloadSize) {
+                break;
+            }
+        }
+        pending.erase(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(offset));
+        if (flush) {
+            pending.clear();
+        }
+        return true;
+    }
+
+    int64_t UdpStreamSinkPrivate::schedule(const uint8_t *packets, uint32_t size) {
+        int64_t pcr = -1;
+        for (uint32_t offset = 0; offset + TsPacketSize <= size && pcr < 0; offset += TsPacketSize) {
+            int pid = -1;
+            const auto packetPcr = readPcr(packets + offset, pid);
+            if (packetPcr >= 0 && (pcrPid < 0 || pid == pcrPid)) {
+                pcrPid = pid;
+                pcr = packetPcr;
+            }
+        }
+
+        const double rate = config.muxRate > 0 ? static_cast<double>(config.muxRate) : measuredRate;
+        int64_t time = scheduleTime;
+        if (pcr >= 0 && lastPcr >= 0) {
+            auto step = (pcr - lastPcr + PcrWrap) % PcrWrap / 27;
+            if (step > 0 && step <= MaxPcrStep) {
+                measuredRate = static_cast<double>(bytesSincePcr) * 8e6 / static_cast<double>(step);
+                time = lastPcrTime + step;
+            } else {
+                // Discontinuity, continue the schedule from the bitrate
+                std::lock_guard lock(mutex);
+                ++statistics.resyncs;
+                if (rate > 0) {
+                    time = scheduleTime + static_cast<int64_t>(static_cast<double>(size) * 8e6 / rate);
+                }
+            }
+        } else if (pcr < 0 && lastPcr >= 0 && rate > 0) {
+            time = lastPcrTime + static_cast<int64_t>(static_cast<double>(bytesSincePcr) * 8e6 / rate);
+        }
+        // Before the first PCR there is no clock, those datagrams are sent immediately
+        time = std::max(time, scheduleTime);
+
+        if (pcr >= 0) {
+            lastPcr = pcr;
+            lastPcrTime = time;
+            bytesSincePcr = 0;
+        }
+        bytesSincePcr += size;
+        scheduleTime = time;
+        return time;
+    }
+
+    void UdpStreamSinkPrivate::sendLoop() {
+        const auto batchSize = static_cast<size_t>(config.batchSize);
+        std::vector<ScheduledDatagram> batch;
+        batch.reserve(batchSize);
+        std::vector<iovec> iovecs(batchSize);
+#ifdef __linux__
+        std::vector<mmsghdr> headers(batchSize);
+#endif
+        // Wall clock time of sendTime 0
+        int64_t scheduleStart = -1;
+
+        std::unique_lock lock(mutex);
+        while (true) {
+            queueChanged.wait(lock, [this] { return !queue.empty() || finishing; });
+            if (queue.empty()) {
+                break;
+            }
+
+            auto now = currentTimeUs();
+            if (scheduleStart < 0) {
+                scheduleStart = now - queue.front().sendTime;
+            }
+            const auto due = scheduleStart + queue.front().sendTime;
+            if (due > now) {
+                // Woken up early by new datagrams or close(), the front keeps its time
+                queueChanged.wait_for(lock, std::chrono::microseconds(due - now));
+                continue;
+            }
+            if (now - due > config.maxLag * int64_t{1000}) {
+                scheduleStart = now - queue.front().sendTime;
+                ++statistics.resyncs;
+            }
+
+            batch.clear();
+            while (batch.size() < batchSize && !queue.empty() && scheduleStart + queue.front().sendTime <= now) {
+                batch.push_back(queue.front());
+                queue.pop_front();
+            }
+            lock.unlock();
+
+            uint64_t bytes = 0;
+            size_t sent = 0;
+            for (size_t i = 0; i < batch.size(); ++i) {
+                iovecs[i] = {slotData(batch[i].slot), batch[i].size};
+            }
+#ifdef __linux__
+            for (size_t i = 0; i < batch.size(); ++i) {
+                headers[i] = {};
+                headers[i].msg_hdr.msg_iov = &iovecs[i];
+                headers[i].msg_hdr.msg_iovlen = 1;
+            }
+            while (sent < batch.size()) {
+                int ret = sendmmsg(socketFd, headers.data() + sent, static_cast<unsigned int>(batch.size() - sent), 0);
+                if (ret <= 0) {
+                    break;
+                }
+                sent += static_cast<size_t>(ret);
+            }
+#else
+            for (; sent < batch.size(); ++sent) {
+                if (send(socketFd, iovecs[sent].iov_base, iovecs[sent].iov_len, 0) < 0) {
+                    break;
+                }
+            }
+#endif
+            for (size_t i = 0; i < sent; ++i) {
+                bytes += batch[i].size;
+            }
+
+            lock.lock();
+            statistics.sendErrors += batch.size() - sent;
+            updateStatistics(sent, bytes, currentTimeUs());
+            for (const auto &datagram : batch) {
+                freeSlots.push_back(datagram.slot);
+            }
+            queueChanged.notify_all();
+        }
+    }
+
+    void UdpStreamSinkPrivate::updateStatistics(uint64_t datagrams, uint64_t bytes, int64_t now) {
+        if (firstSendTime < 0) {
+            firstSendTime = windowStart = secondStart = now;
+        }
+        statistics.datagrams += datagrams;
+        statistics.bytes += bytes;
+
+        if (now - windowStart >= BurstWindow) {
+            statistics.peakRate = std::max(statistics.peakRate, static_cast<double>(windowBytes) * 8e6 / static_cast<double>(now - windowStart));
+            windowStart = now;
+            windowBytes = 0;
+        }
+        windowBytes += bytes;
+
+        if (now - secondStart >= 1000000) {
+            statistics.sendRate = static_cast<double>(secondBytes) * 8e6 / static_cast<double>(now - secondStart);
+            secondStart = now;
+            secondBytes = 0;
+        }
+        secondBytes += bytes;
+
+        if (now > firstSendTime) {
+            const auto averageRate = static_cast<double>(statistics.bytes) * 8e6 / static_cast<double>(now - firstSendTime);
+            statistics.burstiness = averageRate > 0 ? statistics.peakRate / averageRate : 0;
+        }
+    }
+
+    uint8_t *UdpStreamSinkPrivate::slotData(uint32_t slot) {
+        return slotMemory.data() + slot * static_cast<size_t>(slotSize);
+    }
+}// namespace AVQt
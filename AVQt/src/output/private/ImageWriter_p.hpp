@@ -0,0 +1,70 @@
+#ifndef LIBAVQT_IMAGEWRITER_P_HPP
+#define LIBAVQT_IMAGEWRITER_P_HPP
+
+#include "output/ImageWriter.hpp"
+
+#include <pgraph/api/Pad.hpp>
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QThreadPool>
+
+#include <atomic>
+#include <mutex>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libswscale/swscale.h>
+}
+
+namespace AVQt {
+    class ImageWriterPrivate {
+        Q_DECLARE_PUBLIC(ImageWriter)
+    public:
+        static void destroyAVCodecContext(AVCodecContext *codecContext);
+        static void destroySwsContext(SwsContext *swsContext);
+        static void destroyAVFrame(AVFrame *frame);
+        static void destroyAVPacket(AVPacket *packet);
+
+        /**
+         * @return the yuvj variant of a planar YUV format, format itself for yuvj and all other formats
+         */
+        static AVPixelFormat toFullRange(AVPixelFormat format);
+        static bool isYuvj(AVPixelFormat format);
+
+    private:
+        explicit ImageWriterPrivate(ImageWriter *q);
+        ImageWriter *q_ptr;
+
+        [[nodiscard]] QString pathFor(int64_t index, int64_t timestamp) const;
+        /**
+         * @return frame in system memory, in a pixel format the encoder accepts, nullptr on error
+         */
+        [[nodiscard]] std::shared_ptr<AVFrame> prepareFrame(const std::shared_ptr<AVFrame> &frame) const;
+        /**
+         * @return the encoded image, nullptr on error
+         */
+        [[nodiscard]] std::shared_ptr<AVPacket> encode(const std::shared_ptr<AVFrame> &frame) const;
+        /**
+         * @brief Converts, encodes and writes frame, runs on the worker pool
+         */
+        void writeImage(const std::shared_ptr<AVFrame> &frame, int64_t index);
+
+        ImageWriter::Config config{};
+
+        int64_t inputPadId{pgraph::api::INVALID_PAD_ID};
+        const AVCodec *encoder{nullptr};
+
+        QThreadPool workerPool{};
+        std::atomic_int queued{0};
+        std::atomic_int64_t frameIndex{0};
+
+        std::atomic_uint64_t written{0}, dropped{0}, failed{0}, bytesWritten{0};
+        mutable std::mutex timerMutex{};
+        QElapsedTimer runTimer{};
+
+        std::atomic_bool initialized{false}, open{false}, running{false}, paused{false};
+    };
+}// namespace AVQt
+
+
+#endif//LIBAVQT_IMAGEWRITER_P_HPP
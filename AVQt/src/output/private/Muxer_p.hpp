@@ -47,7 +47,7 @@ namespace AVQt {
 
         void enqueueData(const std::shared_ptr<AVPacket> &newPacket);
 
-        constexpr static auto inputQueueMaxSize = 32;
+        size_t inputQueueMaxSize{32};
         std::mutex inputQueueMutex{};
         std::condition_variable inputQueueCond{};
         std::deque<std::shared_ptr<AVPacket>> inputQueue{};
@@ -65,8 +65,10 @@ namespace AVQt {
         std::map<int64_t, int> streamResetFlags{};
         std::map<int64_t, int64_t> streamPts{};
         std::map<int64_t, int64_t> streamDts{};
-
-        static constexpr size_t BUFFER_SIZE{32 * 1024};// 32KB
+        // Time base of the packets received on each pad
+        std::map<int64_t, AVRational> padTimeBases{};
+        bool copyTimestamps{false};
+        bool interleave{true};
         uint8_t *pBuffer{nullptr};
 
         std::unique_ptr<QIODevice> outputDevice{};
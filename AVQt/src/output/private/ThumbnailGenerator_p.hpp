@@ -0,0 +1,61 @@
+#ifndef LIBAVQT_THUMBNAILGENERATOR_P_HPP
+#define LIBAVQT_THUMBNAILGENERATOR_P_HPP
+
+#include "output/ThumbnailGenerator.hpp"
+
+#include <QtCore/QThreadPool>
+
+#include <mutex>
+#include <optional>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libswscale/swscale.h>
+}
+
+namespace AVQt {
+    class ThumbnailGeneratorPrivate {
+        Q_DECLARE_PUBLIC(ThumbnailGenerator)
+    public:
+        static void destroyAVFormatContext(AVFormatContext *formatContext);
+        static void destroyAVCodecContext(AVCodecContext *codecContext);
+        static void destroySwsContext(SwsContext *swsContext);
+        static void destroyAVFrame(AVFrame *frame);
+        static void destroyAVPacket(AVPacket *packet);
+
+    private:
+        using FormatContextPtr = std::unique_ptr<AVFormatContext, decltype(&destroyAVFormatContext)>;
+
+        explicit ThumbnailGeneratorPrivate(ThumbnailGenerator *q);
+        ThumbnailGenerator *q_ptr;
+
+        /**
+         * @return the opened input, nullptr on error
+         */
+        [[nodiscard]] FormatContextPtr openInput() const;
+        /**
+         * @brief Seeks to the targets from first to last (exclusive) with a single demuxer and decoder, runs on the worker pool
+         */
+        void processRange(size_t first, size_t last);
+        /**
+         * @return frame converted to RGB and scaled to fit into Config::size, a null image on error
+         */
+        QImage toImage(const AVFrame *frame, AVRational sampleAspectRatio, std::unique_ptr<SwsContext, decltype(&destroySwsContext)> &scaler) const;
+
+        ThumbnailGenerator::Config config{};
+
+        // Start time of the file in microseconds, targets and results are relative to it
+        int64_t startTime{0};
+        std::vector<int64_t> targets{};
+
+        std::mutex resultMutex{};
+        std::vector<std::optional<ThumbnailGenerator::Thumbnail>> results{};
+
+        QThreadPool workerPool{};
+    };
+}// namespace AVQt
+
+
+#endif//LIBAVQT_THUMBNAILGENERATOR_P_HPP
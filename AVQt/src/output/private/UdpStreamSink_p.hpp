@@ -0,0 +1,84 @@
+#ifndef LIBAVQT_UDPSTREAMSINK_P_HPP
+#define LIBAVQT_UDPSTREAMSINK_P_HPP
+
+#include "output/UdpStreamSink.hpp"
+
+#include <QtCore/QThread>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace AVQt {
+    class UdpStreamSinkPrivate {
+        Q_DECLARE_PUBLIC(UdpStreamSink)
+    private:
+        struct ScheduledDatagram {
+            uint32_t slot{0};
+            uint32_t size{0};
+            // Send time in microseconds, relative to the first datagram
+            int64_t sendTime{0};
+        };
+
+        explicit UdpStreamSinkPrivate(UdpStreamSink *q);
+        UdpStreamSink *q_ptr;
+
+        bool openSocket();
+        /**
+         * @brief Cuts complete datagrams from the pending data and queues them, blocks while the queue is full
+         * @param flush Also queue a last, shorter datagram of the remaining complete TS packets
+         * @return false, if the sink was closed while waiting
+         */
+        bool packetize(bool flush);
+        /**
+         * @return the send time of a datagram with the given TS packets, derived from their PCR or the bitrate since the last PCR
+         */
+        int64_t schedule(const uint8_t *packets, uint32_t size);
+        /**
+         * @brief Sending thread, sends the queued datagrams at their send time
+         */
+        void sendLoop();
+        void updateStatistics(uint64_t datagrams, uint64_t bytes, int64_t now);
+        [[nodiscard]] uint8_t *slotData(uint32_t slot);
+
+        UdpStreamSink::Config config{};
+        uint32_t headerSize{0};
+        uint32_t payloadSize{0};
+        uint32_t slotSize{0};
+
+        int socketFd{-1};
+        std::unique_ptr<QThread> sendThread{};
+        std::atomic_bool sending{false};
+
+        mutable std::mutex mutex{};
+        std::condition_variable queueChanged{};
+        std::vector<uint8_t> slotMemory{};
+        std::vector<uint32_t> freeSlots{};
+        std::deque<ScheduledDatagram> queue{};
+        bool finishing{false};
+
+        // Writer side: TS data not yet forming a full datagram
+        std::vector<uint8_t> pending{};
+
+        // Writer side: PCR schedule
+        int pcrPid{-1};
+        int64_t lastPcr{-1};
+        int64_t lastPcrTime{0};
+        int64_t scheduleTime{0};
+        uint64_t bytesSincePcr{0};
+        double measuredRate{0};
+        uint16_t rtpSequence{0};
+        uint32_t rtpSsrc{0};
+
+        // Sender side, guarded by mutex
+        UdpStreamSink::Statistics statistics{};
+        int64_t firstSendTime{-1};
+        int64_t windowStart{0}, secondStart{0};
+        uint64_t windowBytes{0}, secondBytes{0};
+    };
+}// namespace AVQt
+
+
+#endif//LIBAVQT_UDPSTREAMSINK_P_HPP
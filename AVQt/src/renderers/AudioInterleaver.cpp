@@ -0,0 +1,382 @@
+#include "AudioInterleaver.hpp"
+
+#include <atomic>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define AVQT_INTERLEAVE_X86
+#include <immintrin.h>
+#define AVQT_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(__ARM_NEON)
+#define AVQT_INTERLEAVE_NEON
+#include <arm_neon.h>
+#endif
+
+namespace AVQt::internal {
+    namespace {
+        /**
+         * Interleaves two planes of equally sized samples, works on bytes.
+         * Returns the number of bytes per plane that have been processed, the caller handles the tail.
+         */
+        using StereoKernel = size_t (*)(const uint8_t *left, const uint8_t *right, uint8_t *dst, size_t bytes);
+        /**
+         * Interleaves two planes of doubles into floats, returns the number of processed samples.
+         */
+        using NarrowStereoKernel = size_t (*)(const double *left, const double *right, float *dst, size_t samples);
+        /**
+         * Converts doubles to floats, returns the number of processed samples.
+         */
+        using NarrowKernel = size_t (*)(const double *src, float *dst, size_t samples);
+
+        struct Kernels {
+            const char *name;
+            StereoKernel stereo8;
+            StereoKernel stereo16;
+            StereoKernel stereo32;
+            NarrowStereoKernel narrowStereo;
+            NarrowKernel narrow;
+        };
+
+        size_t stereoScalar(const uint8_t *, const uint8_t *, uint8_t *, size_t) {
+            return 0;
+        }
+
+        size_t narrowStereoScalar(const double *, const double *, float *, size_t) {
+            return 0;
+        }
+
+        size_t narrowScalar(const double *, float *, size_t) {
+            return 0;
+        }
+
+        constexpr Kernels scalarKernels{
+                .name = "scalar",
+                .stereo8 = &stereoScalar,
+                .stereo16 = &stereoScalar,
+                .stereo32 = &stereoScalar,
+                .narrowStereo = &narrowStereoScalar,
+                .narrow = &narrowScalar,
+        };
+
+#if defined(AVQT_INTERLEAVE_X86)
+        // SSE2 is part of the x86_64 baseline, so it needs neither a target attribute nor a runtime check
+        template<size_t Size>
+        size_t stereoSse2(const uint8_t *left, const uint8_t *right, uint8_t *dst, size_t bytes) {
+            static_assert(Size == 1 || Size == 2 || Size == 4);
+            size_t i = 0;
+            for (; i + 16 <= bytes; i += 16) {
+                const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(left + i));
+                const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(right + i));
+                __m128i lo, hi;
+                if constexpr (Size == 1) {
+                    lo = _mm_unpacklo_epi8(a, b);
+                    hi = _mm_unpackhi_epi8(a, b);
+                } else if constexpr (Size == 2) {
+                    lo = _mm_unpacklo_epi16(a, b);
+                    hi = _mm_unpackhi_epi16(a, b);
+                } else {
+                    lo = _mm_unpacklo_epi32(a, b);
+                    hi = _mm_unpackhi_epi32(a, b);
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 2 * i), lo);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 2 * i + 16), hi);
+            }
+            return i;
+        }
+
+        size_t narrowStereoSse2(const double *left, const double *right, float *dst, size_t samples) {
+            size_t i = 0;
+            for (; i + 2 <= samples; i += 2) {
+                const auto l = _mm_cvtpd_ps(_mm_loadu_pd(left + i));
+                const auto r = _mm_cvtpd_ps(_mm_loadu_pd(right + i));
+                _mm_storeu_ps(dst + 2 * i, _mm_unpacklo_ps(l, r));
+            }
+            return i;
+        }
+
+        size_t narrowSse2(const double *src, float *dst, size_t samples) {
+            size_t i = 0;
+            for (; i + 4 <= samples; i += 4) {
+                const auto lo = _mm_cvtpd_ps(_mm_loadu_pd(src + i));
+                const auto hi = _mm_cvtpd_ps(_mm_loadu_pd(src + i + 2));
+                _mm_storeu_ps(dst + i, _mm_movelh_ps(lo, hi));
+            }
+            return i;
+        }
+
+        // The 256 bit unpack instructions work per 128 bit lane, so the lanes have to be recombined before storing
+        template<size_t Size>
+        AVQT_TARGET_AVX2 size_t stereoAvx2(const uint8_t *left, const uint8_t *right, uint8_t *dst, size_t bytes) {
+            static_assert(Size == 1 || Size == 2 || Size == 4);
+            size_t i = 0;
+            for (; i + 32 <= bytes; i += 32) {
+                const auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(left + i));
+                const auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(right + i));
+                __m256i lo, hi;
+                if constexpr (Size == 1) {
+                    lo = _mm256_unpacklo_epi8(a, b);
+                    hi = _mm256_unpackhi_epi8(a, b);
+                } else if constexpr (Size == 2) {
+                    lo = _mm256_unpacklo_epi16(a, b);
+                    hi = _mm256_unpackhi_epi16(a, b);
+                } else {
+                    lo = _mm256_unpacklo_epi32(a, b);
+                    hi = _mm256_unpackhi_epi32(a, b);
+                }
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 2 * i), _mm256_permute2x128_si256(lo, hi, 0x20));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 2 * i + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+            }
+            return i + stereoSse2<Size>(left + i, right + i, dst + 2 * i, bytes - i);
+        }
+
+        AVQT_TARGET_AVX2 size_t narrowStereoAvx2(const double *left, const double *right, float *dst, size_t samples) {
+            size_t i = 0;
+            for (; i + 4 <= samples; i += 4) {
+                const auto l = _mm256_cvtpd_ps(_mm256_loadu_pd(left + i));
+                const auto r = _mm256_cvtpd_ps(_mm256_loadu_pd(right + i));
+                _mm_storeu_ps(dst + 2 * i, _mm_unpacklo_ps(l, r));
+                _mm_storeu_ps(dst + 2 * i + 4, _mm_unpackhi_ps(l, r));
+            }
+            return i;
+        }
+
+        AVQT_TARGET_AVX2 size_t narrowAvx2(const double *src, float *dst, size_t samples) {
+            size_t i = 0;
+            for (; i + 4 <= samples; i += 4) {
+                _mm_storeu_ps(dst + i, _mm256_cvtpd_ps(_mm256_loadu_pd(src + i)));
+            }
+            return i;
+        }
+
+        constexpr Kernels sse2Kernels{
+                .name = "SSE2",
+                .stereo8 = &stereoSse2<1>,
+                .stereo16 = &stereoSse2<2>,
+                .stereo32 = &stereoSse2<4>,
+                .narrowStereo = &narrowStereoSse2,
+                .narrow = &narrowSse2,
+        };
+
+        constexpr Kernels avx2Kernels{
+                .name = "AVX2",
+                .stereo8 = &stereoAvx2<1>,
+                .stereo16 = &stereoAvx2<2>,
+                .stereo32 = &stereoAvx2<4>,
+                .narrowStereo = &narrowStereoAvx2,
+                .narrow = &narrowAvx2,
+        };
+#elif defined(AVQT_INTERLEAVE_NEON)
+        // vst2 does the interleaving while storing
+        template<size_t Size>
+        size_t stereoNeon(const uint8_t *left, const uint8_t *right, uint8_t *dst, size_t bytes) {
+            static_assert(Size == 1 || Size == 2 || Size == 4);
+            size_t i = 0;
+            for (; i + 16 <= bytes; i += 16) {
+                if constexpr (Size == 1) {
+                    const uint8x16x2_t v{{vld1q_u8(left + i), vld1q_u8(right + i)}};
+                    vst2q_u8(dst + 2 * i, v);
+                } else if constexpr (Size == 2) {
+                    const uint16x8x2_t v{{vld1q_u16(reinterpret_cast<const uint16_t *>(left + i)),
+                                          vld1q_u16(reinterpret_cast<const uint16_t *>(right + i))}};
+                    vst2q_u16(reinterpret_cast<uint16_t *>(dst + 2 * i), v);
+                } else {
+                    const uint32x4x2_t v{{vld1q_u32(reinterpret_cast<const uint32_t *>(left + i)),
+                                          vld1q_u32(reinterpret_cast<const uint32_t *>(right + i))}};
+                    vst2q_u32(reinterpret_cast<uint32_t *>(dst + 2 * i), v);
+                }
+            }
+            return i;
+        }
+
+#if defined(__aarch64__)
+        size_t narrowStereoNeon(const double *left, const double *right, float *dst, size_t samples) {
+            size_t i = 0;
+            for (; i + 2 <= samples; i += 2) {
+                const float32x2x2_t v{{vcvt_f32_f64(vld1q_f64(left + i)), vcvt_f32_f64(vld1q_f64(right + i))}};
+                vst2_f32(dst + 2 * i, v);
+            }
+            return i;
+        }
+
+        size_t narrowNeon(const double *src, float *dst, size_t samples) {
+            size_t i = 0;
+            for (; i + 4 <= samples; i += 4) {
+                vst1q_f32(dst + i, vcvt_high_f32_f64(vcvt_f32_f64(vld1q_f64(src + i)), vld1q_f64(src + i + 2)));
+            }
+            return i;
+        }
+#endif
+
+        constexpr Kernels neonKernels{
+                .name = "NEON",
+                .stereo8 = &stereoNeon<1>,
+                .stereo16 = &stereoNeon<2>,
+                .stereo32 = &stereoNeon<4>,
+#if defined(__aarch64__)
+                .narrowStereo = &narrowStereoNeon,
+                .narrow = &narrowNeon,
+#else
+                .narrowStereo = &narrowStereoScalar,
+                .narrow = &narrowScalar,
+#endif
+        };
+#endif
+
+        /**
+         * @return the kernel sets usable on this CPU, the preferred one last
+         */
+        std::vector<const Kernels *> availableKernels() {
+            std::vector<const Kernels *> available{&scalarKernels};
+#if defined(AVQT_INTERLEAVE_X86)
+            available.push_back(&sse2Kernels);
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2")) {
+                available.push_back(&avx2Kernels);
+            }
+#elif defined(AVQT_INTERLEAVE_NEON)
+            available.push_back(&neonKernels);
+#endif
+            return available;
+        }
+
+        std::atomic<const Kernels *> &selectedKernels() {
+            static std::atomic<const Kernels *> selected{availableKernels().back()};
+            return selected;
+        }
+
+        const Kernels &kernels() {
+            return *selectedKernels().load(std::memory_order_relaxed);
+        }
+
+        template<typename T>
+        void interleavePlanes(StereoKernel kernel, const AVFrame *frame, uint8_t *dst) {
+            const auto channels = static_cast<size_t>(frame->channels);
+            const auto samples = static_cast<size_t>(frame->nb_samples);
+            if (channels == 1) {
+                std::memcpy(dst, frame->extended_data[0], samples * sizeof(T));
+                return;
+            }
+
+            size_t done = 0;
+            if (channels == 2) {
+                done = kernel(frame->extended_data[0], frame->extended_data[1], dst, samples * sizeof(T)) / sizeof(T);
+            }
+
+            auto *out = reinterpret_cast<T *>(dst);
+            for (size_t c = 0; c < channels; ++c) {
+                const auto *in = reinterpret_cast<const T *>(frame->extended_data[c]);
+                for (size_t i = done; i < samples; ++i) {
+                    out[i * channels + c] = in[i];
+                }
+            }
+        }
+
+        void narrowPlanes(const Kernels &k, const AVFrame *frame, float *dst) {
+            const auto channels = static_cast<size_t>(frame->channels);
+            const auto samples = static_cast<size_t>(frame->nb_samples);
+
+            size_t done = 0;
+            if (channels == 1) {
+                done = k.narrow(reinterpret_cast<const double *>(frame->extended_data[0]), dst, samples);
+            } else if (channels == 2) {
+                done = k.narrowStereo(reinterpret_cast<const double *>(frame->extended_data[0]),
+                                      reinterpret_cast<const double *>(frame->extended_data[1]), dst, samples);
+            }
+
+            for (size_t c = 0; c < channels; ++c) {
+                const auto *in = reinterpret_cast<const double *>(frame->extended_data[c]);
+                for (size_t i = done; i < samples; ++i) {
+                    dst[i * channels + c] = static_cast<float>(in[i]);
+                }
+            }
+        }
+
+        void narrowPacked(const Kernels &k, const double *src, float *dst, size_t count) {
+            for (size_t i = k.narrow(src, dst, count); i < count; ++i) {
+                dst[i] = static_cast<float>(src[i]);
+            }
+        }
+    }// namespace
+
+    bool AudioInterleaver::isSupported(AVSampleFormat format) {
+        return outputBytesPerSample(format) > 0;
+    }
+
+    int AudioInterleaver::outputBytesPerSample(AVSampleFormat format) {
+        switch (format) {
+            case AV_SAMPLE_FMT_U8:
+            case AV_SAMPLE_FMT_U8P:
+            case AV_SAMPLE_FMT_S16:
+            case AV_SAMPLE_FMT_S16P:
+            case AV_SAMPLE_FMT_S32:
+            case AV_SAMPLE_FMT_S32P:
+            case AV_SAMPLE_FMT_FLT:
+            case AV_SAMPLE_FMT_FLTP:
+                return av_get_bytes_per_sample(format);
+            case AV_SAMPLE_FMT_DBL:
+            case AV_SAMPLE_FMT_DBLP:
+                return sizeof(float);
+            default:
+                return 0;
+        }
+    }
+
+    bool AudioInterleaver::interleave(const AVFrame *frame, QByteArray &dst) {
+        const auto format = static_cast<AVSampleFormat>(frame->format);
+        const auto bytesPerSample = outputBytesPerSample(format);
+        if (bytesPerSample == 0 || frame->channels <= 0 || frame->nb_samples < 0) {
+            return false;
+        }
+
+        const auto count = static_cast<size_t>(frame->nb_samples) * static_cast<size_t>(frame->channels);
+        dst.resize(static_cast<decltype(dst.size())>(count * static_cast<size_t>(bytesPerSample)));
+        auto *out = reinterpret_cast<uint8_t *>(dst.data());
+
+        const auto &k = kernels();
+        switch (format) {
+            case AV_SAMPLE_FMT_U8P:
+                interleavePlanes<uint8_t>(k.stereo8, frame, out);
+                break;
+            case AV_SAMPLE_FMT_S16P:
+                interleavePlanes<int16_t>(k.stereo16, frame, out);
+                break;
+            case AV_SAMPLE_FMT_S32P:
+            case AV_SAMPLE_FMT_FLTP:
+                interleavePlanes<int32_t>(k.stereo32, frame, out);
+                break;
+            case AV_SAMPLE_FMT_DBLP:
+                narrowPlanes(k, frame, reinterpret_cast<float *>(out));
+                break;
+            case AV_SAMPLE_FMT_DBL:
+                narrowPacked(k, reinterpret_cast<const double *>(frame->data[0]), reinterpret_cast<float *>(out), count);
+                break;
+            default:
+                // Already packed, linesize may contain padding, so only the samples are copied
+                std::memcpy(out, frame->data[0], count * static_cast<size_t>(bytesPerSample));
+                break;
+        }
+        return true;
+    }
+
+    const char *AudioInterleaver::instructionSet() {
+        return kernels().name;
+    }
+
+    std::vector<const char *> AudioInterleaver::availableInstructionSets() {
+        std::vector<const char *> names{};
+        for (const auto *k : availableKernels()) {
+            names.push_back(k->name);
+        }
+        return names;
+    }
+
+    bool AudioInterleaver::selectInstructionSet(const char *name) {
+        for (const auto *k : availableKernels()) {
+            if (std::strcmp(k->name, name) == 0) {
+                selectedKernels().store(k, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+}// namespace AVQt::internal
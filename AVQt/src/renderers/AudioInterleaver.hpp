@@ -0,0 +1,59 @@
+#ifndef LIBAVQT_AUDIOINTERLEAVER_HPP
+#define LIBAVQT_AUDIOINTERLEAVER_HPP
+
+#include <QByteArray>
+
+#include <vector>
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/samplefmt.h>
+}
+
+namespace AVQt::internal {
+    /**
+     * @brief Converts decoded audio frames into the packed layout expected by audio sinks.
+     *
+     * Planar U8P/S16P/S32P/FLTP are interleaved, DBLP/DBL are narrowed to float.
+     * The kernel set (AVX2, SSE2, NEON or scalar) is selected at runtime, selectInstructionSet() overrides the choice.
+     */
+    class AudioInterleaver {
+    public:
+        /**
+         * @return true, if frames of this sample format can be converted
+         */
+        static bool isSupported(AVSampleFormat format);
+
+        /**
+         * @return the size of one sample of the given format after conversion, 0 if unsupported
+         */
+        static int outputBytesPerSample(AVSampleFormat format);
+
+        /**
+         * @brief Writes the packed samples of frame into dst.
+         *
+         * dst is resized to the exact output size, its allocation is reused across calls.
+         * @return false, if the sample format isn't supported
+         */
+        static bool interleave(const AVFrame *frame, QByteArray &dst);
+
+        /**
+         * @return the name of the selected instruction set, for diagnostics
+         */
+        static const char *instructionSet();
+
+        /**
+         * @return the names of the instruction sets usable on this CPU, starting with "scalar"
+         */
+        static std::vector<const char *> availableInstructionSets();
+
+        /**
+         * @brief Replaces the instruction set selected at runtime, e.g. to compare the kernels with the scalar code
+         * @return false, if name isn't usable on this CPU
+         */
+        static bool selectInstructionSet(const char *name);
+    };
+}// namespace AVQt::internal
+
+
+#endif//LIBAVQT_AUDIOINTERLEAVER_HPP
@@ -11,6 +11,10 @@
 #include <pgraph/api/PadUserData.hpp>
 #include <pgraph_network/impl/RegisteringPadFactory.hpp>
 
+extern "C" {
+#include <libavutil/mathematics.h>
+}
+
 namespace AVQt {
     AudioOutput::AudioOutput(QObject *parent)
         : QObject(parent),
@@ -56,6 +60,35 @@ namespace AVQt {
         return d->paused;
     }
 
+    uint64_t AudioOutput::underrunCount() const {
+        Q_D(const AudioOutput);
+        return d->impl ? d->impl->underrunCount() : 0;
+    }
+
+    uint64_t AudioOutput::overrunCount() const {
+        Q_D(const AudioOutput);
+        return d->impl ? d->impl->overrunCount() : 0;
+    }
+
+    void AudioOutput::setClock(std::shared_ptr<common::MediaClock> clock) {
+        Q_D(AudioOutput);
+        std::lock_guard lock(d->clockMutex);
+        if (d->clock) {
+            d->clock->setMastered(false);
+        }
+        d->clock = std::move(clock);
+        if (d->clock) {
+            d->clock->setMastered(true);
+            d->clock->pause(d->paused);
+        }
+    }
+
+    std::shared_ptr<common::MediaClock> AudioOutput::clock() const {
+        Q_D(const AudioOutput);
+        std::lock_guard lock(d->clockMutex);
+        return d->clock;
+    }
+
     void AudioOutput::consume(int64_t pad, std::shared_ptr<pgraph::api::Data> data) {
         Q_D(AudioOutput);
         if (data->getType() == communication::Message::Type) {
@@ -85,11 +118,15 @@ namespace AVQt {
                     if (d->impl) {
                         d->impl->resetBuffer();
                     }
+                    if (auto clock = this->clock()) {
+                        clock->reset();
+                    }
                     break;
                 case communication::Message::Action::DATA:
                     if (d->impl && !d->paused) {
-                        // TODO: Frame timing and synchronization with an external clock
-                        d->impl->write(message->getPayload("frame").value<std::shared_ptr<AVFrame>>());
+                        auto frame = message->getPayload("frame").value<std::shared_ptr<AVFrame>>();
+                        d->impl->write(frame);
+                        d->updateClock(frame);
                     }
                     break;
                 case communication::Message::Action::RESIZE:
@@ -166,6 +203,9 @@ namespace AVQt {
         bool shouldBe = true;
         if (d->running.compare_exchange_strong(shouldBe, false)) {
             d->impl->close();
+            if (auto clock = this->clock()) {
+                clock->reset();
+            }
             emit stopped();
         } else {
             qWarning() << "AudioOutput::stop() called multiple times";
@@ -179,6 +219,9 @@ namespace AVQt {
             bool shouldBe = !state;
             if (d->paused.compare_exchange_strong(shouldBe, state)) {
                 d->impl->pause(state);
+                if (auto clock = this->clock()) {
+                    clock->pause(state);
+                }
                 emit paused(state);
             } else {
                 qWarning() << "AudioOutput::pause() called multiple times";
@@ -187,4 +230,14 @@ namespace AVQt {
     }
 
     AudioOutputPrivate::AudioOutputPrivate(AudioOutput *q) : q_ptr(q) {}
+
+    void AudioOutputPrivate::updateClock(const std::shared_ptr<AVFrame> &frame) {
+        std::lock_guard lock(clockMutex);
+        if (!clock || !frame || frame->pts == AV_NOPTS_VALUE || frame->sample_rate <= 0) {
+            return;
+        }
+        // write() returns once the frame is queued, so the device plays the end of this frame after everything queued
+        const auto frameEnd = frame->pts + av_rescale(frame->nb_samples, 1000000, frame->sample_rate);
+        clock->setTime(frameEnd - impl->queuedDuration());
+    }
 }// namespace AVQt
@@ -0,0 +1,76 @@
+#include "AudioRingBuffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace AVQt::internal {
+    namespace {
+        size_t nextPowerOfTwo(size_t value) {
+            size_t result = 1;
+            while (result < value) {
+                result <<= 1;
+            }
+            return result;
+        }
+    }// namespace
+
+    AudioRingBuffer::AudioRingBuffer(size_t capacity)
+        : m_capacity(nextPowerOfTwo(std::max<size_t>(capacity, 1))),
+          m_mask(m_capacity - 1),
+          m_data(std::make_unique<char[]>(m_capacity)) {
+    }
+
+    size_t AudioRingBuffer::capacityFor(size_t bytesPerSecond, std::chrono::milliseconds duration) {
+        return bytesPerSecond * static_cast<size_t>(duration.count()) / 1000;
+    }
+
+    size_t AudioRingBuffer::capacity() const {
+        return m_capacity;
+    }
+
+    size_t AudioRingBuffer::readAvailable() const {
+        return m_writePos.load(std::memory_order_acquire) - m_readPos.load(std::memory_order_acquire);
+    }
+
+    size_t AudioRingBuffer::writeAvailable() const {
+        return m_capacity - readAvailable();
+    }
+
+    bool AudioRingBuffer::write(const char *data, size_t size) {
+        const auto writePos = m_writePos.load(std::memory_order_relaxed);
+        const auto readPos = m_readPos.load(std::memory_order_acquire);
+        if (m_capacity - (writePos - readPos) < size) {
+            return false;
+        }
+
+        const auto offset = writePos & m_mask;
+        const auto first = std::min(size, m_capacity - offset);
+        std::memcpy(m_data.get() + offset, data, first);
+        std::memcpy(m_data.get(), data + first, size - first);
+
+        m_writePos.store(writePos + size, std::memory_order_release);
+        return true;
+    }
+
+    size_t AudioRingBuffer::read(char *data, size_t size) {
+        const auto writePos = m_writePos.load(std::memory_order_acquire);
+        auto readPos = m_readPos.load(std::memory_order_relaxed);
+        if (m_clearRequested.exchange(false, std::memory_order_acq_rel)) {
+            readPos = writePos;
+            m_readPos.store(readPos, std::memory_order_release);
+        }
+
+        const auto count = std::min(size, writePos - readPos);
+        const auto offset = readPos & m_mask;
+        const auto first = std::min(count, m_capacity - offset);
+        std::memcpy(data, m_data.get() + offset, first);
+        std::memcpy(data + first, m_data.get(), count - first);
+
+        m_readPos.store(readPos + count, std::memory_order_release);
+        return count;
+    }
+
+    void AudioRingBuffer::clear() {
+        m_clearRequested.store(true, std::memory_order_release);
+    }
+}// namespace AVQt::internal
@@ -0,0 +1,65 @@
+#ifndef LIBAVQT_AUDIORINGBUFFER_HPP
+#define LIBAVQT_AUDIORINGBUFFER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+
+namespace AVQt::internal {
+    /**
+     * @brief Lock-free single producer, single consumer byte ring for interleaved audio.
+     *
+     * write() is only called by the producer (decoder side), read() only by the consumer (audio device side).
+     * Writes are all-or-nothing, so the stream never contains partial frames.
+     */
+    class AudioRingBuffer {
+    public:
+        /**
+         * @param capacity Minimal capacity in bytes, rounded up to the next power of two
+         */
+        explicit AudioRingBuffer(size_t capacity);
+
+        AudioRingBuffer(const AudioRingBuffer &) = delete;
+        AudioRingBuffer &operator=(const AudioRingBuffer &) = delete;
+
+        /**
+         * @return the number of bytes needed to hold duration of audio at the given byte rate
+         */
+        static size_t capacityFor(size_t bytesPerSecond, std::chrono::milliseconds duration);
+
+        [[nodiscard]] size_t capacity() const;
+        [[nodiscard]] size_t readAvailable() const;
+        [[nodiscard]] size_t writeAvailable() const;
+
+        /**
+         * @brief Appends size bytes, if there is enough space for all of them. Producer only.
+         * @return false, if the ring doesn't have enough free space
+         */
+        bool write(const char *data, size_t size);
+
+        /**
+         * @brief Copies up to size bytes into data. Consumer only.
+         * @return the number of bytes copied
+         */
+        size_t read(char *data, size_t size);
+
+        /**
+         * @brief Discards all buffered data. May be called from any thread, takes effect on the next read().
+         */
+        void clear();
+
+    private:
+        size_t m_capacity;
+        size_t m_mask;
+        std::unique_ptr<char[]> m_data;
+
+        // Monotonic positions, the buffer offset is position & m_mask
+        alignas(64) std::atomic_size_t m_writePos{0};
+        alignas(64) std::atomic_size_t m_readPos{0};
+        std::atomic_bool m_clearRequested{false};
+    };
+}// namespace AVQt::internal
+
+
+#endif//LIBAVQT_AUDIORINGBUFFER_HPP
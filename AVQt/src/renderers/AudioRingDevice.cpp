@@ -0,0 +1,52 @@
+#include "AudioRingDevice.hpp"
+
+#include <QMetaObject>
+
+#include <utility>
+
+namespace AVQt::internal {
+    AudioRingDevice::AudioRingDevice(AudioRingBuffer &ringBuffer, std::function<void()> onRead, std::function<void()> onUnderrun, QObject *parent)
+        : QIODevice(parent),
+          m_ringBuffer(ringBuffer),
+          m_onRead(std::move(onRead)),
+          m_onUnderrun(std::move(onUnderrun)) {
+    }
+
+    bool AudioRingDevice::isSequential() const {
+        return true;
+    }
+
+    qint64 AudioRingDevice::bytesAvailable() const {
+        return static_cast<qint64>(m_ringBuffer.readAvailable()) + QIODevice::bytesAvailable();
+    }
+
+    void AudioRingDevice::notifyDataAvailable() {
+        if (m_starving.exchange(false)) {
+            // The sink lives in another thread, readyRead has to be emitted there
+            QMetaObject::invokeMethod(
+                    this, [this] { emit readyRead(); }, Qt::QueuedConnection);
+        }
+    }
+
+    qint64 AudioRingDevice::readData(char *data, qint64 maxSize) {
+        if (maxSize <= 0) {
+            return 0;
+        }
+        const auto read = m_ringBuffer.read(data, static_cast<size_t>(maxSize));
+        if (read == 0) {
+            // Report every starvation period once, not every request of the sink during it
+            if (!m_starving.exchange(true) && m_onUnderrun) {
+                m_onUnderrun();
+            }
+        } else if (m_onRead) {
+            m_onRead();
+        }
+        return static_cast<qint64>(read);
+    }
+
+    qint64 AudioRingDevice::writeData(const char *data, qint64 maxSize) {
+        Q_UNUSED(data)
+        Q_UNUSED(maxSize)
+        return -1;
+    }
+}// namespace AVQt::internal
@@ -0,0 +1,48 @@
+#ifndef LIBAVQT_AUDIORINGDEVICE_HPP
+#define LIBAVQT_AUDIORINGDEVICE_HPP
+
+#include "AudioRingBuffer.hpp"
+
+#include <QIODevice>
+
+#include <atomic>
+#include <functional>
+
+namespace AVQt::internal {
+    /**
+     * @brief Read-only QIODevice, that lets an audio sink pull its data from an AudioRingBuffer.
+     *
+     * The sink reads from its own notification, so there is no polling on the producer side.
+     */
+    class AudioRingDevice : public QIODevice {
+    public:
+        /**
+         * @param onRead Called on the device thread after data has been read, may be empty
+         * @param onUnderrun Called on the device thread, when the sink asks for data while the ring is empty, may be empty
+         */
+        explicit AudioRingDevice(AudioRingBuffer &ringBuffer, std::function<void()> onRead = {}, std::function<void()> onUnderrun = {}, QObject *parent = nullptr);
+        ~AudioRingDevice() override = default;
+
+        [[nodiscard]] bool isSequential() const override;
+        [[nodiscard]] qint64 bytesAvailable() const override;
+
+        /**
+         * @brief Wakes up the sink, if it starved since the last call. Called by the producer after writing.
+         */
+        void notifyDataAvailable();
+
+    protected:
+        qint64 readData(char *data, qint64 maxSize) override;
+        qint64 writeData(const char *data, qint64 maxSize) override;
+
+    private:
+        AudioRingBuffer &m_ringBuffer;
+        std::function<void()> m_onRead;
+        std::function<void()> m_onUnderrun;
+        // Starts starving, so waiting for the first frame isn't counted as underrun
+        std::atomic_bool m_starving{true};
+    };
+}// namespace AVQt::internal
+
+
+#endif//LIBAVQT_AUDIORINGDEVICE_HPP
@@ -280,16 +280,16 @@ namespace AVQt {
                 swFrame = hwFrame;
             }
 
+            // Reuses the context as long as size and format stay the same, rebuilds it otherwise
+            d->pSwsContext.reset(sws_getCachedContext(d->pSwsContext.release(),
+                                                      swFrame->width, swFrame->height,
+                                                      static_cast<AVPixelFormat>(swFrame->format),
+                                                      swFrame->width, swFrame->height,
+                                                      AV_PIX_FMT_RGBA,
+                                                      0, nullptr, nullptr, nullptr));
             if (!d->pSwsContext) {
-                d->pSwsContext.reset(sws_getContext(swFrame->width, swFrame->height,
-                                                    (AVPixelFormat) swFrame->format,
-                                                    swFrame->width, swFrame->height,
-                                                    AV_PIX_FMT_RGBA,
-                                                    0, nullptr, nullptr, nullptr));
-                if (!d->pSwsContext) {
-                    qWarning() << "Failed to create sws context";
-                    continue;
-                }
+                qWarning() << "Failed to create sws context";
+                continue;
             }
 
             //            switch (swFrame->format) {
@@ -1,10 +1,10 @@
 #include "Qt5AudioOutputImpl.hpp"
 #include "private/Qt5AudioOutputImpl_p.hpp"
 
+#include "renderers/AudioInterleaver.hpp"
 #include "renderers/AudioOutputFactory.hpp"
 
 #include <QCoreApplication>
-#include <QTimer>
 #include <static_block.hpp>
 
 namespace AVQt {
@@ -23,19 +23,6 @@ namespace AVQt {
         return info;
     }
 
-    template<typename SourceType, typename DestType>
-    static QByteArray interleavePlanar(const std::shared_ptr<AVFrame> &frame) {
-        QByteArray result{static_cast<int>(frame->nb_samples * frame->channels * sizeof(DestType)), 0};
-        auto *dst = reinterpret_cast<DestType *>(result.data());
-        auto *src = reinterpret_cast<SourceType **>(frame->data);
-        for (int i = 0; i < frame->nb_samples; ++i) {
-            for (int j = 0; j < frame->channels; ++j) {
-                dst[i * frame->channels + j] = static_cast<DestType>(src[j][i]);
-            }
-        }
-        return result;
-    }
-
     Qt5AudioOutputImpl::Qt5AudioOutputImpl(QObject *parent)
         : QThread(parent),
           d_ptr(new Qt5AudioOutputImplPrivate(this)) {
@@ -58,7 +45,7 @@ namespace AVQt {
         format.setSampleType(d->sampleFormatMap.value(params.format.sampleFormat()));
         format.setChannelCount(params.format.channels());
         format.setSampleRate(params.format.sampleRate());
-        format.setSampleSize(av_get_bytes_per_sample(params.format.sampleFormat()) * 8);
+        format.setSampleSize(internal::AudioInterleaver::outputBytesPerSample(params.format.sampleFormat()) * 8);
         format.setCodec("audio/pcm");
         format.setByteOrder(QAudioFormat::LittleEndian);
 
@@ -69,48 +56,75 @@ namespace AVQt {
         }
 
         d->audioFormat = params.format;
-        d->audioOutput = std::make_unique<QAudioOutput>(QAudioDeviceInfo::defaultOutputDevice(), format, this);
-        d->audioOutput->setBufferSize(Qt5AudioOutputImplPrivate::bufferSize);
-        d->audioOutput->setVolume(2.0);
-        d->audioOutputDevice = d->audioOutput->start();
-
+        d->sinkFormat = format;
+        d->bytesPerSecond = static_cast<size_t>(format.bytesPerFrame()) * static_cast<size_t>(format.sampleRate());
+        d->ringBuffer = std::make_unique<internal::AudioRingBuffer>(
+                internal::AudioRingBuffer::capacityFor(d->bytesPerSecond, Qt5AudioOutputImplPrivate::ringBufferDuration));
+        d->paused = false;
+        d->closing = false;
+        d->underruns = 0;
+        d->overruns = 0;
+        d->sinkQueuedBytes = 0;
+
+        d->sinkStarted = std::promise<bool>{};
+        auto sinkStarted = d->sinkStarted.get_future();
         start();
 
-        return d->audioOutputDevice != nullptr;
+        if (!sinkStarted.get()) {
+            qWarning() << "Qt5AudioOutputImpl::open(): failed to start audio output";
+            wait();
+            d->ringBuffer.reset();
+            return false;
+        }
+        return true;
     }
 
     void Qt5AudioOutputImpl::close() {
         Q_D(Qt5AudioOutputImpl);
         if (isRunning()) {
+            // Lets a blocked write() return, so the output thread can take writeMutex to release the device
+            d->closing = true;
+            d->spaceCond.notify_all();
             quit();
             wait();
-            d->audioOutput->stop();
-            d->audioOutput.reset();
-            d->audioOutputDevice = nullptr;
+
+            std::lock_guard writeLock(d->writeMutex);
+            d->ringBuffer.reset();
         }
     }
 
     void Qt5AudioOutputImpl::resetBuffer() {
         Q_D(Qt5AudioOutputImpl);
-        std::unique_lock lock(d->inputMutex);
-        d->inputBuffer.clear();
+        if (d->ringBuffer) {
+            d->ringBuffer->clear();
+            d->spaceCond.notify_all();
+        }
     }
 
     void Qt5AudioOutputImpl::pause(bool state) {
         Q_D(Qt5AudioOutputImpl);
-        if (!state && d->audioOutput->state() == QAudio::SuspendedState) {
-            QMetaObject::invokeMethod(d->audioOutputTimer.get(), "start", Q_ARG(int, 2));
-            d->audioOutput->resume();
-            d->inputCond.notify_all();
-        } else if (state && d->audioOutput->state() == QAudio::ActiveState) {
-            QMetaObject::invokeMethod(d->audioOutputTimer.get(), "stop");
-            d->audioOutput->suspend();
+        if (!isRunning()) {
+            return;
         }
+
+        d->paused = state;
+        auto *sink = d->audioOutput.get();
+        QMetaObject::invokeMethod(
+                sink, [sink, state] {
+                    if (!state && sink->state() == QAudio::SuspendedState) {
+                        sink->resume();
+                    } else if (state && (sink->state() == QAudio::ActiveState || sink->state() == QAudio::IdleState)) {
+                        sink->suspend();
+                    }
+                },
+                Qt::QueuedConnection);
+        d->spaceCond.notify_all();
     }
 
     void Qt5AudioOutputImpl::write(const std::shared_ptr<AVFrame> &frame) {
         Q_D(Qt5AudioOutputImpl);
-        if (d->audioOutputDevice == nullptr) {
+        std::lock_guard writeLock(d->writeMutex);
+        if (!isRunning() || d->closing || !d->ringBuffer || !d->ringDevice) {
             return;
         }
 
@@ -141,79 +155,90 @@ namespace AVQt {
             return;
         }
 
-        QByteArray data;
-
-        if (d->planarFormats.contains(static_cast<AVSampleFormat>(frame->format))) {
-            switch (frame->format) {
-                case AV_SAMPLE_FMT_U8P:
-                    data = interleavePlanar<uint8_t, uint8_t>(frame);
-                    break;
-                case AV_SAMPLE_FMT_S16P:
-                    data = interleavePlanar<int16_t, int16_t>(frame);
-                    break;
-                case AV_SAMPLE_FMT_S32P:
-                    data = interleavePlanar<int32_t, int32_t>(frame);
-                    break;
-                case AV_SAMPLE_FMT_FLTP:
-                    data = interleavePlanar<float, float>(frame);
-                    break;
-                case AV_SAMPLE_FMT_DBLP:
-                    data = interleavePlanar<double, float>(frame);
-                    break;
-                default:
-                    qWarning() << "Unsupported planar format:" << av_get_sample_fmt_name(static_cast<AVSampleFormat>(frame->format));
-                    return;
-            }
-        } else {
-            data = QByteArray{reinterpret_cast<const char *>(frame->data[0]), frame->linesize[0]};
+        if (!internal::AudioInterleaver::interleave(frame.get(), d->interleaveBuffer)) {
+            qWarning() << "Unsupported sample format:" << av_get_sample_fmt_name(static_cast<AVSampleFormat>(frame->format));
+            return;
         }
 
-        std::unique_lock lock(d->inputMutex);
-        if (d->inputBuffer.size() >= Qt5AudioOutputImplPrivate::bufferSize) {
-            d->inputCond.notify_one();
-            d->inputCond.wait(lock, [d, this] { return d->inputBuffer.size() < Qt5AudioOutputImplPrivate::bufferSize || !this->isRunning(); });
-            if (!this->isRunning() || d->inputBuffer.size() >= Qt5AudioOutputImplPrivate::bufferSize) {
+        const auto size = static_cast<size_t>(d->interleaveBuffer.size());
+        if (size > d->ringBuffer->capacity()) {
+            qWarning() << "Qt5AudioOutputImpl::write(): frame of" << size << "bytes exceeds the buffer, dropping it";
+            ++d->overruns;
+            return;
+        }
+
+        // Block while the sink catches up, but drop the frame, if it doesn't consume anything for a whole buffer duration
+        auto deadline = std::chrono::steady_clock::now() + Qt5AudioOutputImplPrivate::ringBufferDuration;
+        while (!d->ringBuffer->write(d->interleaveBuffer.constData(), size)) {
+            if (d->closing || !isRunning()) {
                 return;
             }
+            const auto now = std::chrono::steady_clock::now();
+            if (d->paused) {
+                deadline = now + Qt5AudioOutputImplPrivate::ringBufferDuration;
+            } else if (now >= deadline) {
+                ++d->overruns;
+                return;
+            }
+            std::unique_lock lock(d->spaceMutex);
+            d->spaceCond.wait_for(lock, Qt5AudioOutputImplPrivate::writeRetryInterval);
         }
-        d->inputBuffer.append(data);
+        d->ringDevice->notifyDataAvailable();
     }
 
-    void Qt5AudioOutputImpl::run() {
-        Q_D(Qt5AudioOutputImpl);
+    uint64_t Qt5AudioOutputImpl::underrunCount() const {
+        Q_D(const Qt5AudioOutputImpl);
+        return d->underruns;
+    }
 
-        d->audioOutputTimer = std::make_unique<QTimer>();
-        connect(d->audioOutputTimer.get(), &QTimer::timeout, d, &Qt5AudioOutputImplPrivate::trySendData, Qt::DirectConnection);
-        d->audioOutputTimer->start(2);
+    uint64_t Qt5AudioOutputImpl::overrunCount() const {
+        Q_D(const Qt5AudioOutputImpl);
+        return d->overruns;
+    }
 
-        exec();
-        d->audioOutputTimer->stop();
-        d->audioOutputTimer.reset();
+    int64_t Qt5AudioOutputImpl::queuedDuration() const {
+        Q_D(const Qt5AudioOutputImpl);
+        if (!d->ringBuffer || d->bytesPerSecond == 0) {
+            return 0;
+        }
+        const auto queuedBytes = d->ringBuffer->readAvailable() + d->sinkQueuedBytes;
+        return static_cast<int64_t>(queuedBytes * 1000000 / d->bytesPerSecond);
     }
 
-    Qt5AudioOutputImplPrivate::Qt5AudioOutputImplPrivate(Qt5AudioOutputImpl *q) : q_ptr(q) {}
+    void Qt5AudioOutputImpl::run() {
+        Q_D(Qt5AudioOutputImpl);
+
+        // Sink and device are created here, so the sink's notifications are handled by this thread's event loop
+        d->ringDevice = std::make_unique<internal::AudioRingDevice>(
+                *d->ringBuffer,
+                [d] {
+                    if (d->audioOutput) {
+                        d->sinkQueuedBytes = static_cast<size_t>(d->audioOutput->bufferSize() - d->audioOutput->bytesFree());
+                    }
+                    d->spaceCond.notify_one();
+                },
+                [d] { ++d->underruns; });
+        d->ringDevice->open(QIODevice::ReadOnly);
 
-    void Qt5AudioOutputImplPrivate::trySendData() {
-        Q_Q(Qt5AudioOutputImpl);
+        d->audioOutput = std::make_unique<QAudioOutput>(QAudioDeviceInfo::defaultOutputDevice(), d->sinkFormat);
+        d->audioOutput->setBufferSize(static_cast<int>(internal::AudioRingBuffer::capacityFor(d->bytesPerSecond, Qt5AudioOutputImplPrivate::sinkBufferDuration)));
+        d->audioOutput->setVolume(2.0);
+        d->audioOutput->start(d->ringDevice.get());
 
-        std::unique_lock lock(inputMutex);
-        if (inputBuffer.isEmpty()) {
-            inputCond.notify_one();
-            inputCond.wait(lock, [this, q] { return !inputBuffer.isEmpty() || !q->isRunning(); });
-            if (!q->isRunning() || inputBuffer.isEmpty()) {
-                return;
-            }
-        }
-        auto bytesFree = audioOutput->bytesFree();
-        if (bytesFree) {
-            auto bytesToSend = qMin(bytesFree, inputBuffer.size());
-            auto lenSent = audioOutputDevice->write(inputBuffer.constData(), bytesToSend);
-            if (lenSent) {
-                inputBuffer.remove(0, static_cast<int>(lenSent));
-            }
+        const bool started = d->audioOutput->error() == QAudio::NoError;
+        d->sinkStarted.set_value(started);
+        if (started) {
+            exec();
         }
-        inputCond.notify_one();
+
+        d->audioOutput->stop();
+        d->audioOutput.reset();
+
+        std::lock_guard writeLock(d->writeMutex);
+        d->ringDevice.reset();
     }
+
+    Qt5AudioOutputImplPrivate::Qt5AudioOutputImplPrivate(Qt5AudioOutputImpl *q) : q_ptr(q) {}
 }// namespace AVQt
 
 static_block {
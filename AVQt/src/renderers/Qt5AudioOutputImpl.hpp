@@ -25,6 +25,10 @@ namespace AVQt {
         void resetBuffer() override;
         void pause(bool state) override;
 
+        [[nodiscard]] uint64_t underrunCount() const override;
+        [[nodiscard]] uint64_t overrunCount() const override;
+        [[nodiscard]] int64_t queuedDuration() const override;
+
     protected:
         void run() override;
 
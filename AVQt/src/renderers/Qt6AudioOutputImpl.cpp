@@ -1,9 +1,9 @@
 #include "Qt6AudioOutputImpl.hpp"
 #include "private/Qt6AudioOutputImpl_p.hpp"
 
+#include "renderers/AudioInterleaver.hpp"
 #include "renderers/AudioOutputFactory.hpp"
 
-#include <QTimer>
 #include <static_block.hpp>
 
 namespace AVQt {
@@ -22,19 +22,6 @@ namespace AVQt {
         return info;
     }
 
-    template<typename SourceType, typename DestType>
-    static QByteArray interleavePlanar(const std::shared_ptr<AVFrame> &frame) {
-        QByteArray result{static_cast<qsizetype>(frame->nb_samples * frame->channels * sizeof(DestType)), 0};
-        auto *dst = reinterpret_cast<DestType *>(result.data());
-        auto *src = reinterpret_cast<SourceType **>(frame->data);
-        for (int i = 0; i < frame->nb_samples; ++i) {
-            for (int j = 0; j < frame->channels; ++j) {
-                dst[i * frame->channels + j] = static_cast<DestType>(src[j][i]);
-            }
-        }
-        return result;
-    }
-
     Qt6AudioOutputImpl::Qt6AudioOutputImpl(QObject *parent)
         : QThread(parent),
           d_ptr(new Qt6AudioOutputImplPrivate(this)) {
@@ -65,48 +52,75 @@ namespace AVQt {
         format.setChannelConfig(d->channelLayoutMap.value(params.format.channelLayout()));
 
         d->audioFormat = params.format;
-        d->audioSink = std::make_unique<QAudioSink>(format, this);
-        d->audioSink->setBufferSize(Qt6AudioOutputImplPrivate::bufferSize);
-        d->audioSink->setVolume(2.0);
-        d->audioOutputDevice = d->audioSink->start();
-
+        d->sinkFormat = format;
+        d->bytesPerSecond = static_cast<size_t>(format.bytesPerFrame()) * static_cast<size_t>(format.sampleRate());
+        d->ringBuffer = std::make_unique<internal::AudioRingBuffer>(
+                internal::AudioRingBuffer::capacityFor(d->bytesPerSecond, Qt6AudioOutputImplPrivate::ringBufferDuration));
+        d->paused = false;
+        d->closing = false;
+        d->underruns = 0;
+        d->overruns = 0;
+        d->sinkQueuedBytes = 0;
+
+        d->sinkStarted = std::promise<bool>{};
+        auto sinkStarted = d->sinkStarted.get_future();
         start();
 
-        return d->audioOutputDevice != nullptr;
+        if (!sinkStarted.get()) {
+            qWarning() << "Qt6AudioOutputImpl::open: failed to start audio sink";
+            wait();
+            d->ringBuffer.reset();
+            return false;
+        }
+        return true;
     }
 
     void Qt6AudioOutputImpl::close() {
         Q_D(Qt6AudioOutputImpl);
         if (isRunning()) {
+            // Lets a blocked write() return, so the output thread can take writeMutex to release the device
+            d->closing = true;
+            d->spaceCond.notify_all();
             quit();
             wait();
-            d->audioSink->stop();
-            d->audioSink.reset();
-            d->audioOutputDevice = nullptr;
+
+            std::lock_guard writeLock(d->writeMutex);
+            d->ringBuffer.reset();
         }
     }
 
     void Qt6AudioOutputImpl::resetBuffer() {
         Q_D(Qt6AudioOutputImpl);
-        std::unique_lock lock(d->inputMutex);
-        d->inputBuffer.clear();
+        if (d->ringBuffer) {
+            d->ringBuffer->clear();
+            d->spaceCond.notify_all();
+        }
     }
 
     void Qt6AudioOutputImpl::pause(bool state) {
         Q_D(Qt6AudioOutputImpl);
-        if (!state && d->audioSink->state() == QAudio::SuspendedState) {
-            QMetaObject::invokeMethod(d->audioOutputTimer.get(), "start", Q_ARG(int, 2));
-            d->audioSink->resume();
-            d->inputCond.notify_all();
-        } else if (state && d->audioSink->state() == QAudio::ActiveState) {
-            QMetaObject::invokeMethod(d->audioOutputTimer.get(), "stop");
-            d->audioSink->suspend();
+        if (!isRunning()) {
+            return;
         }
+
+        d->paused = state;
+        auto *sink = d->audioSink.get();
+        QMetaObject::invokeMethod(
+                sink, [sink, state] {
+                    if (!state && sink->state() == QAudio::SuspendedState) {
+                        sink->resume();
+                    } else if (state && (sink->state() == QAudio::ActiveState || sink->state() == QAudio::IdleState)) {
+                        sink->suspend();
+                    }
+                },
+                Qt::QueuedConnection);
+        d->spaceCond.notify_all();
     }
 
     void Qt6AudioOutputImpl::write(const std::shared_ptr<AVFrame> &frame) {
         Q_D(Qt6AudioOutputImpl);
-        if (d->audioOutputDevice == nullptr) {
+        std::lock_guard writeLock(d->writeMutex);
+        if (!isRunning() || d->closing || !d->ringBuffer || !d->ringDevice) {
             return;
         }
 
@@ -137,79 +151,90 @@ namespace AVQt {
             return;
         }
 
-        QByteArray data;
-
-        if (d->planarFormats.contains(frame->format)) {
-            switch (frame->format) {
-                case AV_SAMPLE_FMT_U8P:
-                    data = interleavePlanar<uint8_t, uint8_t>(frame);
-                    break;
-                case AV_SAMPLE_FMT_S16P:
-                    data = interleavePlanar<int16_t, int16_t>(frame);
-                    break;
-                case AV_SAMPLE_FMT_S32P:
-                    data = interleavePlanar<int32_t, int32_t>(frame);
-                    break;
-                case AV_SAMPLE_FMT_FLTP:
-                    data = interleavePlanar<float, float>(frame);
-                    break;
-                case AV_SAMPLE_FMT_DBLP:
-                    data = interleavePlanar<double, float>(frame);
-                    break;
-                default:
-                    qWarning() << "Unsupported planar format:" << av_get_sample_fmt_name(static_cast<AVSampleFormat>(frame->format));
-                    return;
-            }
-        } else {
-            data = QByteArray{reinterpret_cast<const char *>(frame->data[0]), frame->linesize[0]};
+        if (!internal::AudioInterleaver::interleave(frame.get(), d->interleaveBuffer)) {
+            qWarning() << "Unsupported sample format:" << av_get_sample_fmt_name(static_cast<AVSampleFormat>(frame->format));
+            return;
         }
 
-        std::unique_lock lock(d->inputMutex);
-        if (d->inputBuffer.size() >= Qt6AudioOutputImplPrivate::bufferSize) {
-            d->inputCond.notify_one();
-            d->inputCond.wait(lock, [d, this] { return d->inputBuffer.size() < Qt6AudioOutputImplPrivate::bufferSize || !this->isRunning(); });
-            if (!this->isRunning() || d->inputBuffer.size() >= Qt6AudioOutputImplPrivate::bufferSize) {
+        const auto size = static_cast<size_t>(d->interleaveBuffer.size());
+        if (size > d->ringBuffer->capacity()) {
+            qWarning() << "Qt6AudioOutputImpl::write: frame of" << size << "bytes exceeds the buffer, dropping it";
+            ++d->overruns;
+            return;
+        }
+
+        // Block while the sink catches up, but drop the frame, if it doesn't consume anything for a whole buffer duration
+        auto deadline = std::chrono::steady_clock::now() + Qt6AudioOutputImplPrivate::ringBufferDuration;
+        while (!d->ringBuffer->write(d->interleaveBuffer.constData(), size)) {
+            if (d->closing || !isRunning()) {
                 return;
             }
+            const auto now = std::chrono::steady_clock::now();
+            if (d->paused) {
+                deadline = now + Qt6AudioOutputImplPrivate::ringBufferDuration;
+            } else if (now >= deadline) {
+                ++d->overruns;
+                return;
+            }
+            std::unique_lock lock(d->spaceMutex);
+            d->spaceCond.wait_for(lock, Qt6AudioOutputImplPrivate::writeRetryInterval);
         }
-        d->inputBuffer.append(data);
+        d->ringDevice->notifyDataAvailable();
     }
 
-    void Qt6AudioOutputImpl::run() {
-        Q_D(Qt6AudioOutputImpl);
+    uint64_t Qt6AudioOutputImpl::underrunCount() const {
+        Q_D(const Qt6AudioOutputImpl);
+        return d->underruns;
+    }
 
-        d->audioOutputTimer = std::make_unique<QTimer>();
-        connect(d->audioOutputTimer.get(), &QTimer::timeout, d, &Qt6AudioOutputImplPrivate::trySendData, Qt::DirectConnection);
-        d->audioOutputTimer->start(2);
+    uint64_t Qt6AudioOutputImpl::overrunCount() const {
+        Q_D(const Qt6AudioOutputImpl);
+        return d->overruns;
+    }
 
-        exec();
-        d->audioOutputTimer->stop();
-        d->audioOutputTimer.reset();
+    int64_t Qt6AudioOutputImpl::queuedDuration() const {
+        Q_D(const Qt6AudioOutputImpl);
+        if (!d->ringBuffer || d->bytesPerSecond == 0) {
+            return 0;
+        }
+        const auto queuedBytes = d->ringBuffer->readAvailable() + d->sinkQueuedBytes;
+        return static_cast<int64_t>(queuedBytes * 1000000 / d->bytesPerSecond);
     }
 
-    Qt6AudioOutputImplPrivate::Qt6AudioOutputImplPrivate(Qt6AudioOutputImpl *q) : q_ptr(q) {}
+    void Qt6AudioOutputImpl::run() {
+        Q_D(Qt6AudioOutputImpl);
+
+        // Sink and device are created here, so the sink's notifications are handled by this thread's event loop
+        d->ringDevice = std::make_unique<internal::AudioRingDevice>(
+                *d->ringBuffer,
+                [d] {
+                    if (d->audioSink) {
+                        d->sinkQueuedBytes = static_cast<size_t>(d->audioSink->bufferSize() - d->audioSink->bytesFree());
+                    }
+                    d->spaceCond.notify_one();
+                },
+                [d] { ++d->underruns; });
+        d->ringDevice->open(QIODevice::ReadOnly);
 
-    void Qt6AudioOutputImplPrivate::trySendData() {
-        Q_Q(Qt6AudioOutputImpl);
+        d->audioSink = std::make_unique<QAudioSink>(d->sinkFormat);
+        d->audioSink->setBufferSize(static_cast<qsizetype>(internal::AudioRingBuffer::capacityFor(d->bytesPerSecond, Qt6AudioOutputImplPrivate::sinkBufferDuration)));
+        d->audioSink->setVolume(2.0);
+        d->audioSink->start(d->ringDevice.get());
 
-        std::unique_lock lock(inputMutex);
-        if (inputBuffer.isEmpty()) {
-            inputCond.notify_one();
-            inputCond.wait(lock, [this, q] { return !inputBuffer.isEmpty() || !q->isRunning(); });
-            if (!q->isRunning() || inputBuffer.isEmpty()) {
-                return;
-            }
-        }
-        auto bytesFree = audioSink->bytesFree();
-        if (bytesFree) {
-            auto bytesToSend = qMin(bytesFree, inputBuffer.size());
-            auto lenSent = audioOutputDevice->write(inputBuffer.constData(), bytesToSend);
-            if (lenSent) {
-                inputBuffer.remove(0, lenSent);
-            }
+        const bool started = d->audioSink->error() == QAudio::NoError;
+        d->sinkStarted.set_value(started);
+        if (started) {
+            exec();
         }
-        inputCond.notify_one();
+
+        d->audioSink->stop();
+        d->audioSink.reset();
+
+        std::lock_guard writeLock(d->writeMutex);
+        d->ringDevice.reset();
     }
+
+    Qt6AudioOutputImplPrivate::Qt6AudioOutputImplPrivate(Qt6AudioOutputImpl *q) : q_ptr(q) {}
 }// namespace AVQt
 
 static_block {
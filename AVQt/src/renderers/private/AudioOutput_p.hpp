@@ -1,6 +1,7 @@
 #ifndef LIBAVQT_AUDIOOUTPUT_P_HPP
 #define LIBAVQT_AUDIOOUTPUT_P_HPP
 
+#include "common/MediaClock.hpp"
 #include "communication/AudioPadParams.hpp"
 #include "renderers/IAudioOutputImpl.hpp"
 
@@ -8,6 +9,7 @@
 
 #include <QObject>
 
+#include <mutex>
 #include <optional>
 
 namespace AVQt {
@@ -18,11 +20,16 @@ namespace AVQt {
         explicit AudioOutputPrivate(AudioOutput *q);
         AudioOutput *q_ptr;
 
+        void updateClock(const std::shared_ptr<AVFrame> &frame);
+
         int64_t inputPadId{pgraph::api::INVALID_PAD_ID};
 
         std::optional<communication::AudioPadParams> audioParams;
         std::shared_ptr<api::IAudioOutputImpl> impl{};
 
+        mutable std::mutex clockMutex{};
+        std::shared_ptr<common::MediaClock> clock{};
+
         std::atomic_bool initialized{false}, open{false}, running{false}, paused{false};
     };
 }// namespace AVQt
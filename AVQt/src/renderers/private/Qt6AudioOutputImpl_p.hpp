@@ -2,38 +2,60 @@
 #define LIBAVQT_QT6AUDIOOUTPUTIMPL_P_HPP
 
 #include "common/AudioFormat.hpp"
+#include "renderers/AudioRingBuffer.hpp"
+#include "renderers/AudioRingDevice.hpp"
 
 #include <QObject>
-#include <QTimer>
 
 #include <QAudioDevice>
 #include <QAudioFormat>
 #include <QAudioSink>
 
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <future>
 #include <mutex>
+#include <optional>
 
 namespace AVQt {
     class Qt6AudioOutputImpl;
     class Qt6AudioOutputImplPrivate : public QObject {
         Q_OBJECT
         Q_DECLARE_PUBLIC(Qt6AudioOutputImpl)
-    private slots:
-        void trySendData();
-
     private:
         explicit Qt6AudioOutputImplPrivate(Qt6AudioOutputImpl *q);
         Qt6AudioOutputImpl *q_ptr;
 
         std::optional<common::AudioFormat> audioFormat{};
+        QAudioFormat sinkFormat{};
+        size_t bytesPerSecond{0};
+
+        // Owned by the output thread, the sink pulls from ringDevice
         std::unique_ptr<QAudioSink> audioSink{};
-        QIODevice *audioOutputDevice{};
-        std::unique_ptr<QTimer> audioOutputTimer{};
+        std::unique_ptr<internal::AudioRingDevice> ringDevice{};
+        std::promise<bool> sinkStarted{};
+
+        static constexpr std::chrono::milliseconds ringBufferDuration{200};
+        static constexpr std::chrono::milliseconds sinkBufferDuration{50};
+        // The device notifies without locking spaceMutex, this bounds the delay of a lost wakeup
+        static constexpr std::chrono::milliseconds writeRetryInterval{5};
+        std::unique_ptr<internal::AudioRingBuffer> ringBuffer{};
+        // Only used to sleep while the ring is full, the data itself never passes a lock
+        std::mutex spaceMutex{};
+        std::condition_variable spaceCond{};
+
+        // Held by write() while it uses ringBuffer and ringDevice, which are only released under it after the sink stopped
+        std::mutex writeMutex{};
+        std::atomic_bool closing{false};
 
-        static constexpr int bufferSize = 65536;
-        std::mutex inputMutex{};
-        std::condition_variable inputCond{};
-        QByteArray inputBuffer{};
+        std::atomic_bool paused{false};
+        std::atomic_uint64_t underruns{0}, overruns{0};
+        // Bytes in the sink's own buffer, sampled in the output thread whenever the sink reads
+        std::atomic_size_t sinkQueuedBytes{0};
+
+        // Reused for every frame, so the interleaving doesn't allocate once the buffer has grown
+        QByteArray interleaveBuffer{};
 
         const QMap<AVSampleFormat, QAudioFormat::SampleFormat> sampleFormatMap{
                 {AV_SAMPLE_FMT_U8, QAudioFormat::SampleFormat::UInt8},
@@ -48,14 +70,6 @@ namespace AVQt {
                 {AV_SAMPLE_FMT_DBLP, QAudioFormat::SampleFormat::Float},
         };
 
-        const QList<AVSampleFormat> planarFormats{
-                AV_SAMPLE_FMT_U8P,
-                AV_SAMPLE_FMT_S16P,
-                AV_SAMPLE_FMT_S32P,
-                AV_SAMPLE_FMT_FLTP,
-                AV_SAMPLE_FMT_DBLP,
-        };
-
         const QMap<uint64_t, QAudioFormat::ChannelConfig> channelLayoutMap{
                 {AV_CH_LAYOUT_MONO, QAudioFormat::ChannelConfig::ChannelConfigMono},
                 {AV_CH_LAYOUT_STEREO, QAudioFormat::ChannelConfig::ChannelConfigStereo},
@@ -0,0 +1,173 @@
+/**
+ * Compares the SIMD kernels of the AudioInterleaver with its scalar code and measures their throughput:
+ *
+ *     ./AudioInterleaverCheck
+ *
+ * Every supported sample format is converted with 1 to 8 channels, frame sizes around the vector widths and planes starting at
+ * unaligned addresses. The output of each instruction set usable on this CPU has to be bit-identical to the scalar output.
+ * Exits with 0 on success.
+ */
+
+#include "renderers/AudioInterleaver.hpp"
+
+#include <QElapsedTimer>
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/samplefmt.h>
+}
+
+namespace {
+    using AVQt::internal::AudioInterleaver;
+
+    constexpr AVSampleFormat SampleFormats[] = {AV_SAMPLE_FMT_U8P, AV_SAMPLE_FMT_S16P, AV_SAMPLE_FMT_S32P, AV_SAMPLE_FMT_FLTP,
+                                                AV_SAMPLE_FMT_DBLP, AV_SAMPLE_FMT_U8, AV_SAMPLE_FMT_S16, AV_SAMPLE_FMT_S32,
+                                                AV_SAMPLE_FMT_FLT, AV_SAMPLE_FMT_DBL};
+    // Empty, odd, around the 16 and 32 byte vectors of every sample size, and a typical decoder frame with a tail
+    constexpr int SampleCounts[] = {0, 1, 3, 7, 8, 9, 15, 16, 17, 31, 33, 63, 65, 1023, 1025};
+
+    /**
+     * Audio frame pointing into one buffer, the planes start misalignment bytes after a 64 byte boundary
+     */
+    class TestFrame {
+    public:
+        TestFrame(AVSampleFormat format, int channels, int samples, size_t misalignment, std::mt19937 &random)
+            : m_frame(av_frame_alloc(), [](AVFrame *frame) { av_frame_free(&frame); }) {
+            const bool planar = av_sample_fmt_is_planar(format);
+            const auto bytesPerSample = static_cast<size_t>(av_get_bytes_per_sample(format));
+            const size_t planes = planar ? static_cast<size_t>(channels) : 1;
+            const size_t planeSize = bytesPerSample * static_cast<size_t>(samples) * (planar ? 1 : static_cast<size_t>(channels));
+            const size_t planeStride = (planeSize + 64 + 63) / 64 * 64;
+            m_buffer.resize(planes * planeStride + 64);
+
+            auto *base = m_buffer.data() + (64 - reinterpret_cast<uintptr_t>(m_buffer.data()) % 64) % 64;
+            for (size_t p = 0; p < planes; ++p) {
+                auto *plane = base + p * planeStride + misalignment;
+                fill(format, plane, planeSize / bytesPerSample, random);
+                m_frame->data[p] = plane;
+            }
+            m_frame->extended_data = m_frame->data;
+            m_frame->format = format;
+            m_frame->channels = channels;
+            m_frame->nb_samples = samples;
+            m_frame->linesize[0] = static_cast<int>(planeSize);
+        }
+
+        [[nodiscard]] const AVFrame *get() const {
+            return m_frame.get();
+        }
+
+    private:
+        static void fill(AVSampleFormat format, uint8_t *plane, size_t count, std::mt19937 &random) {
+            const auto packed = av_get_packed_sample_fmt(format);
+            if (packed == AV_SAMPLE_FMT_FLT || packed == AV_SAMPLE_FMT_DBL) {
+                // Values of every magnitude, including denormals after narrowing, rounding has to match as well
+                std::uniform_real_distribution<double> mantissa(-1.0, 1.0);
+                std::uniform_int_distribution<int> exponent(-140, 2);
+                for (size_t i = 0; i < count; ++i) {
+                    const double value = std::ldexp(mantissa(random), exponent(random));
+                    if (packed == AV_SAMPLE_FMT_FLT) {
+                        const auto sample = static_cast<float>(value);
+                        std::memcpy(plane + i * sizeof(float), &sample, sizeof(float));
+                    } else {
+                        std::memcpy(plane + i * sizeof(double), &value, sizeof(double));
+                    }
+                }
+            } else {
+                const auto bytes = count * static_cast<size_t>(av_get_bytes_per_sample(format));
+                for (size_t i = 0; i < bytes; ++i) {
+                    plane[i] = static_cast<uint8_t>(random());
+                }
+            }
+        }
+
+        std::unique_ptr<AVFrame, void (*)(AVFrame *)> m_frame;
+        std::vector<uint8_t> m_buffer{};
+    };
+
+    bool interleaveWith(const char *instructionSet, const AVFrame *frame, QByteArray &dst) {
+        AudioInterleaver::selectInstructionSet(instructionSet);
+        return AudioInterleaver::interleave(frame, dst);
+    }
+
+    /**
+     * @return the number of mismatching conversions
+     */
+    int compareWithScalar(const std::vector<const char *> &instructionSets) {
+        std::mt19937 random(42);
+        int mismatches = 0, conversions = 0;
+        QByteArray reference, output;
+        for (const auto format : SampleFormats) {
+            for (int channels = 1; channels <= 8; ++channels) {
+                for (const int samples : SampleCounts) {
+                    for (size_t offset = 0; offset < 4; ++offset) {
+                        // Shifted by whole samples, so the vector loads are unaligned, but every sample is naturally aligned
+                        const size_t misalignment = offset * static_cast<size_t>(av_get_bytes_per_sample(format));
+                        const TestFrame frame(format, channels, samples, misalignment, random);
+                        if (!interleaveWith("scalar", frame.get(), reference)) {
+                            std::cout << av_get_sample_fmt_name(format) << " not supported" << std::endl;
+                            ++mismatches;
+                            continue;
+                        }
+                        for (const auto *instructionSet : instructionSets) {
+                            ++conversions;
+                            if (!interleaveWith(instructionSet, frame.get(), output) || output != reference) {
+                                std::cout << instructionSet << ": " << av_get_sample_fmt_name(format) << ", " << channels << " channels, " << samples
+                                          << " samples, misaligned by " << misalignment << " bytes differs from scalar" << std::endl;
+                                ++mismatches;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        std::cout << conversions << " conversions compared with scalar, " << mismatches << " mismatches" << std::endl;
+        return mismatches;
+    }
+
+    void measureThroughput(const std::vector<const char *> &instructionSets) {
+        constexpr int Samples = 1024;
+        constexpr int Iterations = 20000;
+        std::mt19937 random(1);
+        QByteArray output;
+        for (const auto format : {AV_SAMPLE_FMT_S16P, AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_DBLP}) {
+            const TestFrame frame(format, 2, Samples, 0, random);
+            std::cout << av_get_sample_fmt_name(format) << " stereo, " << Samples << " samples:";
+            for (const auto *instructionSet : instructionSets) {
+                AudioInterleaver::selectInstructionSet(instructionSet);
+                AudioInterleaver::interleave(frame.get(), output);
+                QElapsedTimer timer;
+                timer.start();
+                for (int i = 0; i < Iterations; ++i) {
+                    AudioInterleaver::interleave(frame.get(), output);
+                }
+                const auto seconds = static_cast<double>(timer.nsecsElapsed()) / 1e9;
+                std::cout << " " << instructionSet << " " << static_cast<double>(output.size()) * Iterations / seconds / 1e9 << " GB/s";
+            }
+            std::cout << std::endl;
+        }
+    }
+}// namespace
+
+int main() {
+    const auto instructionSets = AudioInterleaver::availableInstructionSets();
+    std::cout << "Instruction sets:";
+    for (const auto *instructionSet : instructionSets) {
+        std::cout << " " << instructionSet;
+    }
+    std::cout << ", selected " << AudioInterleaver::instructionSet() << std::endl;
+    const auto preferred = AudioInterleaver::instructionSet();
+
+    const int mismatches = compareWithScalar(instructionSets);
+    measureThroughput(instructionSets);
+
+    AudioInterleaver::selectInstructionSet(preferred);
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,196 @@
+/**
+ * Transcodes the video stream of a short file in chunks and checks the packets at the chunk boundaries:
+ *
+ *     ./ChunkedTranscodeCheck input.mp4 [chunk duration in ms] [encoder]
+ *
+ * The default chunk duration is 2000 ms, the input has to be long enough for at least two chunks. The encoded packets have to be
+ * produced with strictly increasing timestamps, starting at 0, with at least one keyframe per chunk, and the number of packets
+ * has to match the number of frames decoded from the input, starting at its first keyframe. Exits with 0 on success.
+ */
+
+#include <AVQt/AVQt>
+#include <pgraph/api/PadUserData.hpp>
+#include <pgraph/impl/SimpleConsumer.hpp>
+#include <pgraph_network/impl/RegisteringPadFactory.hpp>
+#include <pgraph_network/impl/SimplePadRegistry.hpp>
+
+#include <QCoreApplication>
+
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+}
+
+namespace {
+    constexpr int64_t DefaultChunkDuration = 2000;
+
+    class PacketProbe : public pgraph::impl::SimpleConsumer {
+    public:
+        explicit PacketProbe(std::shared_ptr<pgraph::network::api::PadRegistry> padRegistry)
+            : pgraph::impl::SimpleConsumer(pgraph::network::impl::RegisteringPadFactory::factoryFor(std::move(padRegistry))) {
+        }
+
+        void init() {
+            m_inputPadId = createInputPad(pgraph::api::PadUserData::emptyUserData());
+        }
+
+        void consume(int64_t pad, std::shared_ptr<pgraph::api::Data> data) override {
+            if (pad != m_inputPadId || data->getType() != AVQt::communication::Message::Type) {
+                return;
+            }
+            auto message = std::dynamic_pointer_cast<AVQt::communication::Message>(data);
+            if (message->getAction() == AVQt::communication::Message::Action::STOP) {
+                ++stopCount;
+                return;
+            } else if (message->getAction() != AVQt::communication::Message::Action::DATA) {
+                return;
+            }
+            auto packet = message->getPayload("packet").value<std::shared_ptr<AVPacket>>();
+            std::lock_guard lock(m_mutex);
+            timestamps.push_back(packet->pts);
+            if (packet->flags & AV_PKT_FLAG_KEY) {
+                ++keyframes;
+            }
+        }
+
+        std::atomic_int stopCount{0};
+        std::vector<int64_t> timestamps{};
+        size_t keyframes{0};
+
+    private:
+        std::mutex m_mutex{};
+        int64_t m_inputPadId{pgraph::api::INVALID_PAD_ID};
+    };
+
+    /**
+     * @return the number of frames of the best video stream, which aren't before its first keyframe, -1 on error
+     */
+    int64_t countFrames(const char *filename) {
+        AVFormatContext *formatContext = nullptr;
+        if (avformat_open_input(&formatContext, filename, nullptr, nullptr) < 0 || avformat_find_stream_info(formatContext, nullptr) < 0) {
+            std::cerr << "Could not open " << filename << std::endl;
+            avformat_close_input(&formatContext);
+            return -1;
+        }
+        const int streamIndex = av_find_best_stream(formatContext, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+        const auto *decoder = streamIndex >= 0 ? avcodec_find_decoder(formatContext->streams[streamIndex]->codecpar->codec_id) : nullptr;
+        AVCodecContext *codecContext = decoder ? avcodec_alloc_context3(decoder) : nullptr;
+        if (!codecContext || avcodec_parameters_to_context(codecContext, formatContext->streams[streamIndex]->codecpar) < 0 ||
+            avcodec_open2(codecContext, decoder, nullptr) < 0) {
+            std::cerr << "Could not decode the video stream of " << filename << std::endl;
+            avcodec_free_context(&codecContext);
+            avformat_close_input(&formatContext);
+            return -1;
+        }
+
+        // Like the ChunkedTranscoder, which starts the first chunk at the first keyframe and skips frames without timestamp
+        int64_t frames = 0, firstKeyframe = AV_NOPTS_VALUE;
+        std::vector<int64_t> timestamps{};
+        AVPacket *packet = av_packet_alloc();
+        AVFrame *frame = av_frame_alloc();
+        auto receiveFrames = [&] {
+            while (avcodec_receive_frame(codecContext, frame) >= 0) {
+                if (frame->best_effort_timestamp != AV_NOPTS_VALUE) {
+                    timestamps.push_back(frame->best_effort_timestamp);
+                }
+                av_frame_unref(frame);
+            }
+        };
+        while (av_read_frame(formatContext, packet) >= 0) {
+            if (packet->stream_index == streamIndex) {
+                if ((packet->flags & AV_PKT_FLAG_KEY) && packet->pts != AV_NOPTS_VALUE && (firstKeyframe == AV_NOPTS_VALUE || packet->pts < firstKeyframe)) {
+                    firstKeyframe = packet->pts;
+                }
+                avcodec_send_packet(codecContext, packet);
+                receiveFrames();
+            }
+            av_packet_unref(packet);
+        }
+        avcodec_send_packet(codecContext, nullptr);
+        receiveFrames();
+        for (const auto timestamp : timestamps) {
+            frames += firstKeyframe == AV_NOPTS_VALUE || timestamp >= firstKeyframe ? 1 : 0;
+        }
+
+        av_frame_free(&frame);
+        av_packet_free(&packet);
+        avcodec_free_context(&codecContext);
+        avformat_close_input(&formatContext);
+        return frames;
+    }
+}// namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    const int64_t chunkDuration = argc > 2 ? QString(argv[2]).toLongLong() : DefaultChunkDuration;
+    if (argc < 2 || argc > 4 || chunkDuration <= 0) {
+        std::cerr << "Usage: " << argv[0] << " <input> [chunk duration in ms] [encoder]" << std::endl;
+        return 1;
+    }
+
+    const int64_t expectedFrames = countFrames(argv[1]);
+    if (expectedFrames <= 0) {
+        return 1;
+    }
+
+    auto registry = std::make_shared<pgraph::network::impl::SimplePadRegistry>();
+
+    AVQt::ChunkedTranscoder::Config config{};
+    config.inputPath = argv[1];
+    config.encoderName = argc > 3 ? argv[3] : "";
+    config.chunkDuration = chunkDuration * 1000;
+    auto transcoder = std::make_shared<AVQt::ChunkedTranscoder>(config, registry);
+    auto probe = std::make_shared<PacketProbe>(registry);
+
+    if (!transcoder->init()) {
+        return 1;
+    }
+    probe->init();
+    probe->getInputPads().begin()->second->link(transcoder->getOutputPad(transcoder->getOutputPadId()));
+
+    std::atomic_bool chunkFailed{false};
+    QObject::connect(transcoder.get(), &AVQt::ChunkedTranscoder::chunkFailed, [&chunkFailed](size_t chunk) {
+        std::cout << "Chunk " << chunk << " failed" << std::endl;
+        chunkFailed = true;
+    });
+    // The thread ends after the last chunk was produced, or after a chunk failed
+    QObject::connect(transcoder.get(), &QThread::finished, &app, &QCoreApplication::quit);
+    if (!transcoder->open()) {
+        return 1;
+    }
+    const auto chunks = transcoder->chunkCount();
+    if (!transcoder->start()) {
+        return 1;
+    }
+    QCoreApplication::exec();
+    transcoder->close();
+
+    bool success = !chunkFailed && probe->stopCount == 1;
+    if (chunks < 2) {
+        std::cout << "Only " << chunks << " chunk, choose a shorter chunk duration or a longer input" << std::endl;
+        success = false;
+    }
+
+    size_t nonMonotonic = 0;
+    for (size_t i = 1; i < probe->timestamps.size(); ++i) {
+        if (probe->timestamps[i] <= probe->timestamps[i - 1]) {
+            if (nonMonotonic++ == 0) {
+                std::cout << "Packet " << i << " has pts " << probe->timestamps[i] << " us after " << probe->timestamps[i - 1] << " us" << std::endl;
+            }
+        }
+    }
+    const int64_t firstPts = probe->timestamps.empty() ? AV_NOPTS_VALUE : probe->timestamps.front();
+    success = success && nonMonotonic == 0 && firstPts == 0 && probe->keyframes >= chunks &&
+              static_cast<int64_t>(probe->timestamps.size()) == expectedFrames;
+
+    std::cout << chunks << " chunks, " << probe->timestamps.size() << "/" << expectedFrames << " frames, " << probe->keyframes << " keyframes, first pts "
+              << firstPts << " us, " << nonMonotonic << " packets out of order, " << probe->stopCount << " STOP messages" << std::endl;
+    return success ? 0 : 1;
+}
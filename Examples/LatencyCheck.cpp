@@ -0,0 +1,202 @@
+/**
+ * Measures the latency of a live encode and decode pipeline with the default and the low latency profile:
+ *
+ *     ./LatencyCheck [frames]
+ *
+ * Synthetic 720p frames are handed to a VAAPI VideoEncoder at 30 fps, the encoded packets go to a VideoDecoder. The latency of a frame
+ * is the time from handing it to the encoder until the decoder outputs it. Frames, which are only released when the encoder is
+ * stopped, are counted as held back. Requires a VAAPI device, exits with 0, if all frames arrived with both profiles and the low
+ * latency profile held back no more frames than the default one.
+ */
+
+#include <AVQt/AVQt>
+#include <pgraph/api/PadUserData.hpp>
+#include <pgraph/impl/SimpleConsumer.hpp>
+#include <pgraph_network/impl/RegisteringPadFactory.hpp>
+#include <pgraph_network/impl/SimplePadRegistry.hpp>
+
+#include <QCoreApplication>
+#include <QThread>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <vector>
+
+extern "C" {
+#include <libavutil/time.h>
+}
+
+namespace {
+    constexpr int Width = 1280;
+    constexpr int Height = 720;
+    constexpr int FrameRate = 30;
+    constexpr int DefaultFrameCount = 300;
+
+    class LatencyProbe : public pgraph::impl::SimpleConsumer {
+    public:
+        explicit LatencyProbe(std::shared_ptr<pgraph::network::api::PadRegistry> padRegistry)
+            : pgraph::impl::SimpleConsumer(pgraph::network::impl::RegisteringPadFactory::factoryFor(std::move(padRegistry))) {
+        }
+
+        void init() {
+            m_inputPadId = createInputPad(pgraph::api::PadUserData::emptyUserData());
+        }
+
+        void frameSent(int64_t pts, int64_t time) {
+            std::lock_guard lock(m_mutex);
+            m_sendTimes[pts] = time;
+        }
+
+        void consume(int64_t pad, std::shared_ptr<pgraph::api::Data> data) override {
+            if (pad != m_inputPadId || data->getType() != AVQt::communication::Message::Type) {
+                return;
+            }
+            auto message = std::dynamic_pointer_cast<AVQt::communication::Message>(data);
+            if (message->getAction() != AVQt::communication::Message::Action::DATA) {
+                return;
+            }
+            auto frame = message->getPayload("frame").value<std::shared_ptr<AVFrame>>();
+            const int64_t now = av_gettime_relative();
+            std::lock_guard lock(m_mutex);
+            // Encoder and decoder keep the timestamps in microseconds
+            auto sendTime = m_sendTimes.find(frame->pts);
+            if (sendTime == m_sendTimes.end()) {
+                ++unmatchedFrames;
+                return;
+            }
+            if (stopping) {
+                ++heldBackFrames;
+            } else {
+                latencies.push_back(now - sendTime->second);
+            }
+            m_sendTimes.erase(sendTime);
+        }
+
+        std::atomic_bool stopping{false};
+        std::vector<int64_t> latencies{};
+        uint64_t heldBackFrames{0}, unmatchedFrames{0};
+
+    private:
+        std::mutex m_mutex{};
+        std::map<int64_t, int64_t> m_sendTimes{};
+        int64_t m_inputPadId{pgraph::api::INVALID_PAD_ID};
+    };
+
+    struct Result {
+        uint64_t frames{0}, heldBackFrames{0};
+        int64_t meanLatency{0}, maxLatency{0};
+    };
+
+    Result runPipeline(const char *name, const AVQt::common::LatencyProfile &latency, int frameCount) {
+        auto registry = std::make_shared<pgraph::network::impl::SimplePadRegistry>();
+
+        AVQt::VideoEncoder::Config encoderConfig{};
+        encoderConfig.codec = AVQt::VideoCodec::H264;
+        encoderConfig.encoderPriority << "VAAPI";
+        encoderConfig.encodeParameters.bitrate = 4000000;
+        encoderConfig.latency = latency;
+        auto encoder = std::make_shared<AVQt::VideoEncoder>(encoderConfig, registry);
+
+        AVQt::VideoDecoder::Config decoderConfig{};
+        decoderConfig.decoderPriority << "VAAPI";
+        decoderConfig.latency = latency;
+        auto decoder = std::make_shared<AVQt::VideoDecoder>(decoderConfig, registry);
+
+        auto probe = std::make_shared<LatencyProbe>(registry);
+
+        encoder->init();
+        decoder->init();
+        probe->init();
+        decoder->getInputPad(decoder->getInputPadId())->link(encoder->getOutputPad(encoder->getOutputPadId()));
+        probe->getInputPads().begin()->second->link(decoder->getOutputPad(decoder->getOutputPadId()));
+
+        const auto pad = encoder->getInputPadId();
+        AVQt::communication::VideoPadParams params{};
+        params.frameSize = QSize(Width, Height);
+        params.pixelFormat = AV_PIX_FMT_YUV420P;
+        params.swPixelFormat = AV_PIX_FMT_YUV420P;
+        encoder->consume(pad, AVQt::communication::Message::builder()
+                                      .withAction(AVQt::communication::Message::Action::INIT)
+                                      .withPayload("videoParams", QVariant::fromValue(params))
+                                      .build());
+        encoder->consume(pad, AVQt::communication::Message::builder().withAction(AVQt::communication::Message::Action::START).build());
+
+        // Paced like a capturer, a new frame every interval, with content moving so the encoder has to work
+        constexpr int64_t frameInterval = 1000000 / FrameRate;
+        const int64_t startTime = av_gettime_relative();
+        for (int i = 0; i < frameCount; ++i) {
+            std::shared_ptr<AVFrame> frame{av_frame_alloc(), [](AVFrame *frame) {
+                                               av_frame_free(&frame);
+                                           }};
+            frame->format = AV_PIX_FMT_YUV420P;
+            frame->width = Width;
+            frame->height = Height;
+            if (av_frame_get_buffer(frame.get(), 0) < 0) {
+                break;
+            }
+            for (int y = 0; y < Height; ++y) {
+                for (int x = 0; x < Width; ++x) {
+                    frame->data[0][y * frame->linesize[0] + x] = static_cast<uint8_t>(x + y + i * 4);
+                }
+            }
+            std::memset(frame->data[1], 0x80, static_cast<size_t>(frame->linesize[1]) * Height / 2);
+            std::memset(frame->data[2], 0x80, static_cast<size_t>(frame->linesize[2]) * Height / 2);
+
+            const int64_t due = startTime + i * frameInterval;
+            const int64_t now = av_gettime_relative();
+            if (due > now) {
+                QThread::usleep(static_cast<unsigned long>(due - now));
+            }
+            frame->pts = i * frameInterval;
+            probe->frameSent(frame->pts, av_gettime_relative());
+            encoder->consume(pad, AVQt::communication::Message::builder()
+                                          .withAction(AVQt::communication::Message::Action::DATA)
+                                          .withPayload("frame", QVariant::fromValue(frame))
+                                          .build());
+        }
+
+        // Everything, which doesn't arrive within a second, waits for the flush at the end of the stream
+        QThread::sleep(1);
+        probe->stopping = true;
+        encoder->consume(pad, AVQt::communication::Message::builder().withAction(AVQt::communication::Message::Action::STOP).build());
+        encoder->consume(pad, AVQt::communication::Message::builder().withAction(AVQt::communication::Message::Action::CLEANUP).build());
+
+        Result result{};
+        result.frames = probe->latencies.size() + probe->heldBackFrames;
+        result.heldBackFrames = probe->heldBackFrames;
+        if (!probe->latencies.empty()) {
+            int64_t sum = 0;
+            for (const auto latency : probe->latencies) {
+                sum += latency;
+            }
+            result.meanLatency = sum / static_cast<int64_t>(probe->latencies.size());
+            result.maxLatency = *std::max_element(probe->latencies.begin(), probe->latencies.end());
+        }
+        std::cout << name << ": " << result.frames << "/" << frameCount << " frames, latency mean " << static_cast<double>(result.meanLatency) / 1000.0
+                  << " ms, max " << static_cast<double>(result.maxLatency) / 1000.0 << " ms, " << result.heldBackFrames << " held back until the flush, "
+                  << probe->unmatchedFrames << " with unknown timestamps" << std::endl;
+        return result;
+    }
+}// namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    const int frameCount = argc > 1 ? QString(argv[1]).toInt() : DefaultFrameCount;
+    if (frameCount <= 0) {
+        std::cerr << "Usage: " << argv[0] << " [frames]" << std::endl;
+        return 1;
+    }
+
+    const auto defaultResult = runPipeline("default", AVQt::common::LatencyProfile{}, frameCount);
+    const auto lowLatencyResult = runPipeline("lowLatency", AVQt::common::LatencyProfile::lowLatency(), frameCount);
+
+    const auto expected = static_cast<uint64_t>(frameCount);
+    const bool success = defaultResult.frames == expected && lowLatencyResult.frames == expected &&
+                         lowLatencyResult.heldBackFrames <= defaultResult.heldBackFrames;
+    return success ? 0 : 1;
+}
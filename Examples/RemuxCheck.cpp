@@ -0,0 +1,197 @@
+/**
+ * Copies the first video and audio stream of a file into another container without decoding and compares the packets of both files:
+ *
+ *     ./RemuxCheck input.mp4 output.ts h264_mp4toannexb
+ *     ./RemuxCheck input.ts output.mp4 "" aac_adtstoasc
+ *
+ * The container is guessed from the output file name, the optional third and fourth argument are the bitstream filters of the video
+ * and the audio stream. Both files have to contain the same number of packets and keyframes per stream, with the same timestamps
+ * relative to the first packet, up to the rounding between the time bases. Exits with 0 on success.
+ */
+
+#include <AVQt/AVQt>
+#include <pgraph_network/impl/SimplePadRegistry.hpp>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QTimer>
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <vector>
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+namespace {
+    struct PacketInfo {
+        int64_t pts, dts;
+        bool key;
+    };
+
+    struct StreamPackets {
+        AVRational timeBase{0, 1};
+        std::vector<PacketInfo> packets{};
+    };
+
+    /**
+     * @return the packets of the first video and audio stream of a file, in file order
+     */
+    std::map<AVMediaType, StreamPackets> readPackets(const char *filename) {
+        std::map<AVMediaType, StreamPackets> result{};
+        AVFormatContext *formatContext = nullptr;
+        if (avformat_open_input(&formatContext, filename, nullptr, nullptr) < 0 || avformat_find_stream_info(formatContext, nullptr) < 0) {
+            std::cerr << "Could not open " << filename << std::endl;
+            avformat_close_input(&formatContext);
+            return result;
+        }
+
+        std::map<int, AVMediaType> streams{};
+        for (unsigned int i = 0; i < formatContext->nb_streams; ++i) {
+            const auto type = formatContext->streams[i]->codecpar->codec_type;
+            if ((type == AVMEDIA_TYPE_VIDEO || type == AVMEDIA_TYPE_AUDIO) && result.find(type) == result.end()) {
+                streams[static_cast<int>(i)] = type;
+                result[type].timeBase = formatContext->streams[i]->time_base;
+            }
+        }
+
+        AVPacket *packet = av_packet_alloc();
+        while (av_read_frame(formatContext, packet) >= 0) {
+            auto stream = streams.find(packet->stream_index);
+            if (stream != streams.end()) {
+                result[stream->second].packets.push_back({packet->pts, packet->dts, (packet->flags & AV_PKT_FLAG_KEY) != 0});
+            }
+            av_packet_unref(packet);
+        }
+        av_packet_free(&packet);
+        avformat_close_input(&formatContext);
+        return result;
+    }
+
+    /**
+     * @return true, if both streams have the same packets, compared in microseconds relative to the first dts of each stream
+     */
+    bool comparePackets(const char *name, const StreamPackets &input, const StreamPackets &output) {
+        size_t inputKeyframes = 0, outputKeyframes = 0;
+        for (const auto &packet : input.packets) {
+            inputKeyframes += packet.key ? 1 : 0;
+        }
+        for (const auto &packet : output.packets) {
+            outputKeyframes += packet.key ? 1 : 0;
+        }
+        std::cout << name << ": " << input.packets.size() << " -> " << output.packets.size() << " packets, " << inputKeyframes << " -> "
+                  << outputKeyframes << " keyframes" << std::endl;
+        if (input.packets.empty() || input.packets.size() != output.packets.size() || inputKeyframes != outputKeyframes) {
+            return false;
+        }
+
+        // One tick of each time base, the muxer rounds when rescaling
+        const int64_t tolerance = av_rescale_q(1, input.timeBase, AV_TIME_BASE_Q) + av_rescale_q(1, output.timeBase, AV_TIME_BASE_Q) + 1;
+        const int64_t inputStart = input.packets.front().dts, outputStart = output.packets.front().dts;
+        auto relative = [](int64_t timestamp, int64_t start, AVRational timeBase) {
+            return timestamp == AV_NOPTS_VALUE ? AV_NOPTS_VALUE : av_rescale_q(timestamp - start, timeBase, AV_TIME_BASE_Q);
+        };
+        for (size_t i = 0; i < input.packets.size(); ++i) {
+            const auto &in = input.packets[i];
+            const auto &out = output.packets[i];
+            const int64_t inPts = relative(in.pts, inputStart, input.timeBase), outPts = relative(out.pts, outputStart, output.timeBase);
+            const int64_t inDts = relative(in.dts, inputStart, input.timeBase), outDts = relative(out.dts, outputStart, output.timeBase);
+            const bool ptsMatch = inPts == AV_NOPTS_VALUE || outPts == AV_NOPTS_VALUE ? inPts == outPts : std::llabs(inPts - outPts) <= tolerance;
+            const bool dtsMatch = inDts == AV_NOPTS_VALUE || outDts == AV_NOPTS_VALUE ? inDts == outDts : std::llabs(inDts - outDts) <= tolerance;
+            if (!ptsMatch || !dtsMatch || in.key != out.key) {
+                std::cout << name << ": packet " << i << " differs, pts " << inPts << " -> " << outPts << " us, dts " << inDts << " -> " << outDts
+                          << " us, key " << in.key << " -> " << out.key << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+}// namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    if (argc < 3 || argc > 5) {
+        std::cerr << "Usage: " << argv[0] << " <input> <output> [video bitstream filters] [audio bitstream filters]" << std::endl;
+        return 1;
+    }
+    const AVOutputFormat *outputFormat = av_guess_format(nullptr, argv[2], nullptr);
+    if (!outputFormat) {
+        std::cerr << "Unknown container for " << argv[2] << std::endl;
+        return 1;
+    }
+
+    auto registry = std::make_shared<pgraph::network::impl::SimplePadRegistry>();
+
+    AVQt::Demuxer::Config demuxerConfig{};
+    demuxerConfig.inputDevice = std::make_unique<QFile>(argv[1]);
+    if (!demuxerConfig.inputDevice->open(QIODevice::ReadOnly)) {
+        std::cerr << "Could not open " << argv[1] << std::endl;
+        return 1;
+    }
+    demuxerConfig.preserveTimestamps = true;
+    auto demuxer = std::make_shared<AVQt::Demuxer>(std::move(demuxerConfig), registry);
+
+    AVQt::Muxer::Config muxerConfig{};
+    muxerConfig.containerFormat = outputFormat->name;
+    muxerConfig.outputDevice = std::make_unique<QFile>(argv[2]);
+    muxerConfig.copyTimestamps = true;
+    auto muxer = std::make_shared<AVQt::Muxer>(std::move(muxerConfig), registry);
+
+    AVQt::BitstreamFilter::Config videoFilterConfig{}, audioFilterConfig{};
+    videoFilterConfig.filters = argc > 3 ? argv[3] : "";
+    audioFilterConfig.filters = argc > 4 ? argv[4] : "";
+    auto videoFilter = std::make_shared<AVQt::BitstreamFilter>(videoFilterConfig, registry);
+    auto audioFilter = std::make_shared<AVQt::BitstreamFilter>(audioFilterConfig, registry);
+
+    if (!demuxer->init() || !muxer->init() || !videoFilter->init() || !audioFilter->init()) {
+        return 1;
+    }
+
+    // The first stream of each type, like readPackets() picks them
+    std::map<AVMediaType, std::pair<int64_t, std::shared_ptr<pgraph::api::Pad>>> demuxerPads{};
+    for (const auto &pad : demuxer->getOutputPads()) {
+        if (pad.second->getUserData()->getType() != AVQt::communication::PacketPadParams::Type) {
+            continue;
+        }
+        const auto params = std::dynamic_pointer_cast<const AVQt::communication::PacketPadParams>(pad.second->getUserData());
+        if (params->mediaType != AVMEDIA_TYPE_VIDEO && params->mediaType != AVMEDIA_TYPE_AUDIO) {
+            continue;
+        }
+        auto existing = demuxerPads.find(params->mediaType);
+        if (existing == demuxerPads.end() || params->streamIdx < existing->second.first) {
+            demuxerPads[params->mediaType] = {params->streamIdx, pad.second};
+        }
+    }
+    if (demuxerPads.empty()) {
+        std::cerr << "No video or audio stream in " << argv[1] << std::endl;
+        return 1;
+    }
+    for (const auto &[type, pad] : demuxerPads) {
+        const auto &filter = type == AVMEDIA_TYPE_VIDEO ? videoFilter : audioFilter;
+        filter->getInputPad(filter->getInputPadId())->link(pad.second);
+        muxer->getInputPad(muxer->createStreamPad())->link(filter->getOutputPad(filter->getOutputPadId()));
+    }
+
+    // The demuxer thread ends at the end of the input, closing the demuxer stops and closes the filters and the muxer
+    QObject::connect(demuxer.get(), &QThread::finished, &app, [demuxer] {
+        demuxer->close();
+        QCoreApplication::quit();
+    });
+    if (!demuxer->open() || !demuxer->start()) {
+        return 1;
+    }
+    QCoreApplication::exec();
+
+    const auto input = readPackets(argv[1]);
+    const auto output = readPackets(argv[2]);
+    bool success = true;
+    for (const auto &[type, pad] : demuxerPads) {
+        const char *name = type == AVMEDIA_TYPE_VIDEO ? "video" : "audio";
+        const auto in = input.find(type), out = output.find(type);
+        success = in != input.end() && out != output.end() && comparePackets(name, in->second, out->second) && success;
+    }
+    return success ? 0 : 1;
+}
@@ -0,0 +1,138 @@
+/**
+ * Sends RTP packets over loopback to a UdpStreamSource and checks what it passes on:
+ *
+ *     ./RtpJitterCheck
+ *
+ * Two packets are swapped and one is never sent, afterwards the sender restarts its sequence far behind and then far ahead.
+ * The data read from the source has to be in sequence order without the missing packet and the first packet after each restart,
+ * with one lost, one reordered and two resynchronizations in the statistics. Exits with 0 on success.
+ */
+
+#include <AVQt/AVQt>
+
+#include <QCoreApplication>
+#include <QThread>
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+    constexpr size_t TsPacketSize = 188;
+    constexpr size_t PacketsPerDatagram = 7;
+    constexpr size_t RtpHeaderSize = 12;
+
+    class RtpSender {
+    public:
+        explicit RtpSender(quint16 port) : m_fd(socket(AF_INET, SOCK_DGRAM, 0)) {
+            m_address.sin_family = AF_INET;
+            m_address.sin_port = htons(port);
+            m_address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        }
+        ~RtpSender() {
+            ::close(m_fd);
+        }
+        RtpSender(const RtpSender &) = delete;
+        RtpSender &operator=(const RtpSender &) = delete;
+
+        /**
+         * @return the TS payload of a datagram with the next continuity counters
+         */
+        std::vector<uint8_t> nextPayload() {
+            std::vector<uint8_t> payload(PacketsPerDatagram * TsPacketSize);
+            for (size_t i = 0; i < PacketsPerDatagram; ++i) {
+                uint8_t *packet = payload.data() + i * TsPacketSize;
+                packet[0] = 0x47;
+                packet[1] = 0x01;
+                packet[2] = 0x00;
+                packet[3] = static_cast<uint8_t>(0x10 | (m_counter++ & 0x0F));
+                for (size_t k = 4; k < TsPacketSize; ++k) {
+                    packet[k] = static_cast<uint8_t>(m_counter * 31 + k);
+                }
+            }
+            return payload;
+        }
+
+        void send(uint16_t sequence, const std::vector<uint8_t> &payload) {
+            std::vector<uint8_t> datagram(RtpHeaderSize);
+            datagram[0] = 0x80;
+            datagram[1] = 33;// MP2T
+            datagram[2] = static_cast<uint8_t>(sequence >> 8);
+            datagram[3] = static_cast<uint8_t>(sequence);
+            datagram.insert(datagram.end(), payload.begin(), payload.end());
+            sendto(m_fd, datagram.data(), datagram.size(), 0, reinterpret_cast<const sockaddr *>(&m_address), sizeof(m_address));
+            // Loopback drops datagrams, if the receiving thread isn't scheduled in time
+            QThread::usleep(500);
+        }
+
+    private:
+        int m_fd;
+        sockaddr_in m_address{};
+        uint32_t m_counter{0};
+    };
+}// namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    AVQt::UdpStreamSource::Config config{};
+    config.address = "127.0.0.1";
+    config.protocol = AVQt::UdpStreamSource::Protocol::RTP;
+    config.jitterLatency = 50;
+    config.readTimeout = 500;
+    AVQt::UdpStreamSource source(config);
+    if (!source.open(QIODevice::ReadOnly)) {
+        return 1;
+    }
+
+    RtpSender sender(source.getLocalPort());
+    std::vector<uint8_t> expected{};
+    // The first run swaps two packets and leaves one out, the others restart the sequence at first
+    auto sendRun = [&](uint16_t first, bool restart) {
+        const auto missing = static_cast<uint16_t>(first + 50);
+        std::vector<std::pair<uint16_t, std::vector<uint8_t>>> packets{};
+        for (uint16_t i = 0; i < 100; ++i) {
+            const auto sequence = static_cast<uint16_t>(first + i);
+            packets.emplace_back(sequence, sender.nextPayload());
+            // The first packet after a restart is dropped, the source waits for the next one to confirm the new sequence
+            if ((restart || sequence != missing) && !(restart && i == 0)) {
+                expected.insert(expected.end(), packets.back().second.begin(), packets.back().second.end());
+            }
+        }
+        if (!restart) {
+            std::swap(packets[10], packets[11]);
+        }
+        for (const auto &packet : packets) {
+            if (restart || packet.first != missing) {
+                sender.send(packet.first, packet.second);
+            }
+        }
+        QThread::msleep(100);
+    };
+    sendRun(1000, false);
+    // Restart far behind, more than half the sequence space away, then far ahead
+    sendRun(40000, true);
+    sendRun(10, true);
+
+    std::vector<uint8_t> received{};
+    std::vector<char> buffer(65536);
+    qint64 count;
+    while ((count = source.read(buffer.data(), static_cast<qint64>(buffer.size()))) > 0) {
+        received.insert(received.end(), buffer.begin(), buffer.begin() + count);
+    }
+    const auto statistics = source.getStatistics();
+    source.close();
+
+    const bool inOrder = received == expected;
+    std::cout << "Received " << received.size() << " of " << expected.size() << " expected bytes" << (inOrder ? " in order" : ", mismatch") << std::endl;
+    std::cout << "datagrams " << statistics.datagrams << ", lost " << statistics.lost << ", late " << statistics.late << ", reordered "
+              << statistics.reordered << ", resyncs " << statistics.resyncs << ", continuity errors " << statistics.continuityErrors << std::endl;
+
+    const bool success = inOrder && statistics.lost == 1 && statistics.reordered == 1 && statistics.late == 0 && statistics.resyncs == 2;
+    return success ? 0 : 1;
+}
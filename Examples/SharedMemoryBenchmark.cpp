@@ -0,0 +1,206 @@
+/**
+ * Sends 4K frames from a child process through SharedMemoryFrameSender to a SharedMemoryFrameReceiver and reports the throughput
+ * and the latency from handing a frame to the sender until the receiving graph gets it:
+ *
+ *     ./SharedMemoryBenchmark [frames]
+ *
+ * Every frame is stamped with its index in the first luma and the last chroma byte, the receiving side checks the stamps.
+ * Exits with 0, if all frames arrived intact.
+ */
+
+#include <AVQt/AVQt>
+#include <pgraph/api/PadUserData.hpp>
+#include <pgraph/impl/SimpleConsumer.hpp>
+#include <pgraph_network/impl/RegisteringPadFactory.hpp>
+#include <pgraph_network/impl/SimplePadRegistry.hpp>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QProcess>
+#include <QTimer>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+
+extern "C" {
+#include <libavutil/imgutils.h>
+#include <libavutil/time.h>
+}
+
+namespace {
+    constexpr int Width = 3840;
+    constexpr int Height = 2160;
+    constexpr int DefaultFrameCount = 600;
+
+    uint8_t *lastChromaByte(AVFrame *frame) {
+        return frame->data[2] + static_cast<ptrdiff_t>(frame->linesize[2]) * (frame->height / 2 - 1) + frame->width / 2 - 1;
+    }
+
+    class FrameChecker : public pgraph::impl::SimpleConsumer {
+    public:
+        explicit FrameChecker(std::shared_ptr<pgraph::network::api::PadRegistry> padRegistry)
+            : pgraph::impl::SimpleConsumer(pgraph::network::impl::RegisteringPadFactory::factoryFor(std::move(padRegistry))) {
+        }
+
+        void init() {
+            m_inputPadId = createInputPad(pgraph::api::PadUserData::emptyUserData());
+        }
+
+        void consume(int64_t pad, std::shared_ptr<pgraph::api::Data> data) override {
+            if (pad != m_inputPadId || data->getType() != AVQt::communication::Message::Type) {
+                return;
+            }
+            auto message = std::dynamic_pointer_cast<AVQt::communication::Message>(data);
+            switch (message->getAction()) {
+                case AVQt::communication::Message::Action::DATA: {
+                    auto frame = message->getPayload("frame").value<std::shared_ptr<AVFrame>>();
+                    const int64_t now = av_gettime_relative();
+                    if (frames == 0) {
+                        firstFrameTime = now;
+                    }
+                    lastFrameTime = now;
+                    // Both processes use the monotonic clock
+                    const int64_t latency = now - frame->pts;
+                    latencySum += latency;
+                    maxLatency = std::max(maxLatency.load(), latency);
+
+                    const auto stamp = static_cast<uint8_t>(frames);
+                    if (frame->width != Width || frame->height != Height || frame->format != AV_PIX_FMT_YUV420P ||
+                        frame->data[0][0] != stamp || *lastChromaByte(frame.get()) != stamp) {
+                        ++corruptFrames;
+                    }
+                    ++frames;
+                    break;
+                }
+                case AVQt::communication::Message::Action::CLEANUP:
+                    QMetaObject::invokeMethod(qApp, &QCoreApplication::quit, Qt::QueuedConnection);
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        std::atomic_uint64_t frames{0}, corruptFrames{0};
+        std::atomic_int64_t latencySum{0}, maxLatency{0}, firstFrameTime{0}, lastFrameTime{0};
+
+    private:
+        int64_t m_inputPadId{pgraph::api::INVALID_PAD_ID};
+    };
+
+    int runSender(const QString &socketPath, int frameCount) {
+        AVQt::SharedMemoryFrameSender::Config config{};
+        config.socketPath = socketPath;
+        config.slotCount = 4;
+        config.slotTimeout = 1000;
+        AVQt::SharedMemoryFrameSender sender(config);
+        if (!sender.init()) {
+            return 1;
+        }
+        const auto pad = sender.getInputPadId();
+
+        AVQt::communication::VideoPadParams params{};
+        params.frameSize = QSize(Width, Height);
+        params.pixelFormat = AV_PIX_FMT_YUV420P;
+        params.swPixelFormat = AV_PIX_FMT_YUV420P;
+        sender.consume(pad, AVQt::communication::Message::builder()
+                                    .withAction(AVQt::communication::Message::Action::INIT)
+                                    .withPayload("videoParams", QVariant::fromValue(params))
+                                    .build());
+        if (!sender.isOpen()) {
+            std::cerr << "Could not connect to " << socketPath.toStdString() << std::endl;
+            return 1;
+        }
+        sender.consume(pad, AVQt::communication::Message::builder().withAction(AVQt::communication::Message::Action::START).build());
+
+        std::shared_ptr<AVFrame> frame{av_frame_alloc(), [](AVFrame *frame) {
+                                           av_frame_free(&frame);
+                                       }};
+        frame->format = AV_PIX_FMT_YUV420P;
+        frame->width = Width;
+        frame->height = Height;
+        if (av_frame_get_buffer(frame.get(), 0) < 0) {
+            return 1;
+        }
+        for (int plane = 0; plane < 3; ++plane) {
+            const int planeHeight = plane == 0 ? Height : Height / 2;
+            std::memset(frame->data[plane], 0x80, static_cast<size_t>(frame->linesize[plane]) * planeHeight);
+        }
+
+        // The sender copies the frame into a slot before consume() returns, so the frame can be reused
+        for (int i = 0; i < frameCount; ++i) {
+            frame->data[0][0] = static_cast<uint8_t>(i);
+            *lastChromaByte(frame.get()) = static_cast<uint8_t>(i);
+            frame->pts = av_gettime_relative();
+            sender.consume(pad, AVQt::communication::Message::builder()
+                                        .withAction(AVQt::communication::Message::Action::DATA)
+                                        .withPayload("frame", QVariant::fromValue(frame))
+                                        .build());
+        }
+
+        const auto droppedFrames = sender.getDroppedFrames();
+        sender.consume(pad, AVQt::communication::Message::builder().withAction(AVQt::communication::Message::Action::STOP).build());
+        sender.consume(pad, AVQt::communication::Message::builder().withAction(AVQt::communication::Message::Action::CLEANUP).build());
+        std::cout << "Sender dropped " << droppedFrames << " frames" << std::endl;
+        return droppedFrames == 0 ? 0 : 1;
+    }
+}// namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    const auto arguments = QCoreApplication::arguments();
+
+    if (arguments.size() == 4 && arguments[1] == "--send") {
+        return runSender(arguments[2], arguments[3].toInt());
+    }
+    const int frameCount = arguments.size() > 1 ? arguments[1].toInt() : DefaultFrameCount;
+    if (frameCount <= 0) {
+        std::cerr << "Usage: " << argv[0] << " [frames]" << std::endl;
+        return 1;
+    }
+
+    auto registry = std::make_shared<pgraph::network::impl::SimplePadRegistry>();
+    AVQt::SharedMemoryFrameReceiver::Config config{};
+    config.socketPath = QDir::temp().filePath(QString("avqt-shm-benchmark-%1.sock").arg(QCoreApplication::applicationPid()));
+    auto receiver = std::make_shared<AVQt::SharedMemoryFrameReceiver>(config, registry);
+    auto checker = std::make_shared<FrameChecker>(registry);
+    receiver->init();
+    checker->init();
+    checker->getInputPads().begin()->second->link(receiver->getOutputPads().begin()->second);
+    if (!receiver->open() || !receiver->start()) {
+        std::cerr << "Could not listen on " << config.socketPath.toStdString() << std::endl;
+        return 1;
+    }
+
+    QProcess sender;
+    sender.setProcessChannelMode(QProcess::ForwardedChannels);
+    QObject::connect(&sender, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), [](int exitCode, QProcess::ExitStatus status) {
+        // Otherwise the receiver quits on the CLEANUP forwarded from the sender
+        if (exitCode != 0 || status != QProcess::NormalExit) {
+            QCoreApplication::quit();
+        }
+    });
+    sender.start(QCoreApplication::applicationFilePath(), {"--send", config.socketPath, QString::number(frameCount)});
+    QTimer::singleShot(60000, &app, &QCoreApplication::quit);
+    QCoreApplication::exec();
+
+    sender.waitForFinished();
+    receiver->stop();
+    receiver->close();
+
+    const uint64_t frames = checker->frames;
+    const double seconds = static_cast<double>(checker->lastFrameTime - checker->firstFrameTime) / 1e6;
+    const double frameSize = av_image_get_buffer_size(AV_PIX_FMT_YUV420P, Width, Height, 1);
+    std::cout << "Received " << frames << "/" << frameCount << " frames of " << Width << "x" << Height << ", " << checker->corruptFrames
+              << " corrupt" << std::endl;
+    if (frames > 1 && seconds > 0) {
+        std::cout << (static_cast<double>(frames - 1) / seconds) << " fps, " << (static_cast<double>(frames - 1) * frameSize / seconds / 1e9)
+                  << " GB/s, latency mean " << (static_cast<double>(checker->latencySum) / static_cast<double>(frames) / 1000.0) << " ms, max "
+                  << (static_cast<double>(checker->maxLatency) / 1000.0) << " ms" << std::endl;
+    }
+
+    const bool success = sender.exitStatus() == QProcess::NormalExit && sender.exitCode() == 0 && frames == static_cast<uint64_t>(frameCount) &&
+                         checker->corruptFrames == 0;
+    return success ? 0 : 1;
+}
@@ -0,0 +1,131 @@
+/**
+ * Writes a synthetic 4 Mbit/s MPEG-TS stream of 3 seconds into a UdpStreamSink as fast as possible and receives it with a
+ * UdpStreamSource over loopback, once as plain UDP and once as RTP:
+ *
+ *     ./UdpLoopbackCheck
+ *
+ * The sink paces the datagrams by the PCRs, so sending has to take about as long as the stream, the received data has to be
+ * identical to the written one. Prints the send rate and burstiness of the sink and the statistics of the source, exits with 0 on success.
+ */
+
+#include <AVQt/AVQt>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QThread>
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+namespace {
+    constexpr size_t TsPacketSize = 188;
+    constexpr int64_t Bitrate = 4000000;
+    constexpr double Duration = 3.0;
+    constexpr double PcrInterval = 0.02;
+
+    /**
+     * @return a constant bitrate stream on one PID, with a PCR every PcrInterval
+     */
+    std::vector<uint8_t> generateStream() {
+        const auto packets = static_cast<size_t>(Duration * Bitrate / 8 / TsPacketSize);
+        const double packetDuration = TsPacketSize * 8.0 / Bitrate;
+        std::vector<uint8_t> stream(packets * TsPacketSize);
+        double nextPcr = 0;
+        for (size_t i = 0; i < packets; ++i) {
+            uint8_t *packet = stream.data() + i * TsPacketSize;
+            const double time = static_cast<double>(i) * packetDuration;
+            const bool hasPcr = time >= nextPcr;
+            packet[0] = 0x47;
+            packet[1] = 0x01;
+            packet[2] = 0x00;
+            packet[3] = static_cast<uint8_t>((hasPcr ? 0x30 : 0x10) | (i & 0x0F));
+            size_t offset = 4;
+            if (hasPcr) {
+                nextPcr += PcrInterval;
+                // 90 kHz PCR base, the 27 MHz extension stays 0
+                const auto base = static_cast<uint64_t>(time * 90000);
+                packet[4] = 7;
+                packet[5] = 0x10;
+                packet[6] = static_cast<uint8_t>(base >> 25);
+                packet[7] = static_cast<uint8_t>(base >> 17);
+                packet[8] = static_cast<uint8_t>(base >> 9);
+                packet[9] = static_cast<uint8_t>(base >> 1);
+                packet[10] = static_cast<uint8_t>(((base & 1) << 7) | 0x7E);
+                packet[11] = 0;
+                offset = 12;
+            }
+            for (size_t k = offset; k < TsPacketSize; ++k) {
+                packet[k] = static_cast<uint8_t>(i * 31 + k);
+            }
+        }
+        return stream;
+    }
+
+    bool runLoopback(const std::vector<uint8_t> &stream, bool rtp) {
+        AVQt::UdpStreamSource::Config sourceConfig{};
+        sourceConfig.address = "127.0.0.1";
+        sourceConfig.readTimeout = 2000;
+        AVQt::UdpStreamSource source(sourceConfig);
+        if (!source.open(QIODevice::ReadOnly)) {
+            return false;
+        }
+
+        AVQt::UdpStreamSink::Config sinkConfig{};
+        sinkConfig.address = "127.0.0.1";
+        sinkConfig.port = source.getLocalPort();
+        sinkConfig.rtp = rtp;
+        AVQt::UdpStreamSink sink(sinkConfig);
+        if (!sink.open(QIODevice::WriteOnly)) {
+            return false;
+        }
+
+        std::vector<uint8_t> received{};
+        std::unique_ptr<QThread> reader{QThread::create([&source, &received, &stream] {
+            std::vector<char> buffer(65536);
+            qint64 count;
+            while (received.size() < stream.size() && (count = source.read(buffer.data(), static_cast<qint64>(buffer.size()))) > 0) {
+                received.insert(received.end(), buffer.begin(), buffer.begin() + count);
+            }
+        })};
+        reader->start();
+
+        // Like a muxer faster than realtime, the sink blocks once its queue is full
+        QElapsedTimer timer;
+        timer.start();
+        constexpr size_t chunkSize = 50 * TsPacketSize;
+        for (size_t offset = 0; offset < stream.size(); offset += chunkSize) {
+            const auto size = static_cast<qint64>(std::min(chunkSize, stream.size() - offset));
+            if (sink.write(reinterpret_cast<const char *>(stream.data() + offset), size) != size) {
+                std::cerr << "Writing to the sink failed" << std::endl;
+                break;
+            }
+        }
+        const auto sinkStatistics = sink.getStatistics();
+        sink.close();
+        const double sendTime = static_cast<double>(timer.elapsed()) / 1000.0;
+
+        reader->wait();
+        const auto sourceStatistics = source.getStatistics();
+        source.close();
+
+        const bool identical = received == stream;
+        std::cout << (rtp ? "RTP: " : "UDP: ") << received.size() << " of " << stream.size() << " bytes" << (identical ? " identical" : ", mismatch")
+                  << ", sent in " << sendTime << " s, " << sinkStatistics.sendRate / 1e6 << " Mbit/s, peak " << sinkStatistics.peakRate / 1e6
+                  << " Mbit/s, burstiness " << sinkStatistics.burstiness << std::endl;
+        std::cout << "     datagrams " << sourceStatistics.datagrams << ", lost " << sourceStatistics.lost << ", overflows " << sourceStatistics.overflows
+                  << ", continuity errors " << sourceStatistics.continuityErrors << std::endl;
+
+        // An unpaced sink would be done in a few milliseconds
+        return identical && sendTime > Duration * 0.9 && sourceStatistics.continuityErrors == 0;
+    }
+}// namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    const auto stream = generateStream();
+    const bool udp = runLoopback(stream, false);
+    const bool rtp = runLoopback(stream, true);
+    return udp && rtp ? 0 : 1;
+}
@@ -0,0 +1,89 @@
+/**
+ * Captures the X11 root window for a few seconds and checks the frames, works headless under Xvfb:
+ *
+ *     Xvfb :99 -screen 0 1280x720x24 &
+ *     DISPLAY=:99 ./X11CaptureCheck
+ *
+ * Run Xvfb with `-extension MIT-SHM` to check the XGetImage fallback. Exits with 0, if enough frames of the screen's size arrived.
+ */
+
+#include <AVQt/AVQt>
+
+#include <QCoreApplication>
+#include <QTimer>
+
+#include <iostream>
+#include <set>
+
+extern "C" {
+#include <libavutil/pixdesc.h>
+}
+
+class FrameCounter : public QObject {
+    Q_OBJECT
+public:
+    explicit FrameCounter(AVPixelFormat format) : m_format(format) {}
+
+    uint64_t frames{0}, invalidFrames{0};
+    int width{0}, height{0};
+    std::set<const uint8_t *> buffers{};
+
+public slots:
+    void onFrame(const std::shared_ptr<AVFrame> &frame) {
+        ++frames;
+        if (frame->format != m_format || frame->width <= 0 || frame->height <= 0 || !frame->data[0]) {
+            ++invalidFrames;
+            return;
+        }
+        width = frame->width;
+        height = frame->height;
+        // Pooled shared memory images are reused, so only a few distinct buffers should show up
+        buffers.insert(frame->data[0]);
+    }
+
+private:
+    AVPixelFormat m_format;
+};
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    constexpr int fps = 10;
+    constexpr int durationMs = 3000;
+
+    auto capture = AVQt::DesktopCaptureFactory::getInstance().createCapture("AVQt::X11DesktopCapture");
+    if (!capture) {
+        std::cerr << "X11DesktopCapture is not available" << std::endl;
+        return 1;
+    }
+
+    AVQt::api::IDesktopCaptureImpl::Config config{};
+    config.sourceClass = AVQt::api::IDesktopCaptureImpl::SourceClass::Screen;
+    config.fps = fps;
+    if (!capture->open(config)) {
+        std::cerr << "Could not open X11DesktopCapture, is DISPLAY set?" << std::endl;
+        return 1;
+    }
+
+    FrameCounter counter(capture->getOutputFormat());
+    QObject::connect(std::dynamic_pointer_cast<QObject>(capture).get(), SIGNAL(frameReady(std::shared_ptr<AVFrame>)),
+                     &counter, SLOT(onFrame(std::shared_ptr<AVFrame>)), Qt::DirectConnection);
+
+    if (!capture->start()) {
+        std::cerr << "Could not start X11DesktopCapture" << std::endl;
+        return 1;
+    }
+    QTimer::singleShot(durationMs, &app, &QCoreApplication::quit);
+    QCoreApplication::exec();
+    capture->close();
+
+    std::cout << "Captured " << counter.frames << " frames of " << counter.width << "x" << counter.height << " "
+              << av_get_pix_fmt_name(capture->getOutputFormat()) << " in " << counter.buffers.size() << " distinct buffers, "
+              << counter.invalidFrames << " invalid" << std::endl;
+
+    // Timers are not exact, especially on loaded CI machines
+    const uint64_t expectedFrames = fps * durationMs / 1000 / 2;
+    return counter.frames >= expectedFrames && counter.invalidFrames == 0 ? 0 : 1;
+}
+
+#include "X11CaptureCheck.moc"
@@ -110,6 +110,20 @@ void OpenGLWidgetRenderer::consume(int64_t pad, std::shared_ptr<pgraph::api::Dat
     }
 }
 
+void OpenGLWidgetRenderer::setClock(std::shared_ptr<AVQt::common::MediaClock> clock) {
+    Q_D(OpenGLWidgetRenderer);
+    if (!clock) {
+        clock = std::make_shared<AVQt::common::MediaClock>();
+    }
+    std::lock_guard lock(d->clockMutex);
+    d->clock = std::move(clock);
+}
+
+AVQt::common::MediaClock::SyncStatistics OpenGLWidgetRenderer::syncStatistics() const {
+    Q_D(const OpenGLWidgetRenderer);
+    return d->currentClock()->statistics();
+}
+
 void OpenGLWidgetRenderer::initializeGL() {
     Q_D(OpenGLWidgetRenderer);
     initializeOpenGLFunctions();
@@ -132,38 +146,26 @@ void OpenGLWidgetRenderer::paintGL() {
     Q_D(OpenGLWidgetRenderer);
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
-    bool updateRequired = false;
-    int64_t updateTimestamp;
     if (!d->paused) {
-        if (d->renderQueue.size() >= 2) {
-            auto timestamp = d->getTimestamp();
-            if (timestamp >= d->renderQueue.first().first || !d->currentFrame.second) {
-                updateRequired = true;
-                updateTimestamp = timestamp;
+        const auto clock = d->currentClock();
+        while (!d->renderQueue.isEmpty()) {
+            const auto pts = d->renderQueue.first().first;
+            if (d->currentFrame.second && pts < d->currentFrame.first && !clock->isMastered()) {
+                qDebug() << "Received frame with pts" << pts << "before current timestamp" << d->currentFrame.first << "Resetting clock";
+                clock->reset();
+                d->currentFrame = {};
+            }
+            const auto nextPts = d->renderQueue.size() > 1 ? d->renderQueue.at(1).first : AV_NOPTS_VALUE;
+            const auto action = clock->syncFrame(pts, nextPts);
+            if (action == AVQt::common::MediaClock::FrameAction::Wait) {
+                break;
             }
-        }
-        if (updateRequired && d->renderQueue.size() >= 2) {
             auto frame = d->renderQueue.dequeue();
-            while (!d->renderQueue.isEmpty()) {
-                if (d->renderQueue.first().first < frame.first) {
-                    qDebug() << "Received frame with pts" << d->renderQueue.first().first << "before current timestamp"
-                             << frame.first << "Resetting clock";
-                    d->renderTimer.invalidate();
-                    updateTimestamp = d->renderQueue.first().first;
-                    d->lastPaused = d->renderQueue.first().first;
-                    d->currentFrame = {};
-                }
-                if (frame.first <= updateTimestamp) {
-                    if (d->renderQueue.first().first >= updateTimestamp || d->renderQueue.size() == 1) {
-                        break;
-                    } else {
-                        qWarning("Discarding video frame at PTS: %lld < PTS: %ld", static_cast<long long>(frame.first), updateTimestamp);
-                    }
-                }
-                frame = d->renderQueue.dequeue();
+            if (action == AVQt::common::MediaClock::FrameAction::Show) {
+                d->currentFrame = frame;
+                break;
             }
-            qDebug("Deleting frame with PTS: %lld", static_cast<long long>(frame.first));
-            d->currentFrame = frame;
+            qWarning("Discarding video frame at PTS: %lld", static_cast<long long>(frame.first));
         }
     }
     if (d->blitter && d->currentFrame.second) {
@@ -221,13 +223,9 @@ void OpenGLWidgetRenderer::pause(bool state) {
     if (d->paused.compare_exchange_strong(shouldBe, state)) {
         qDebug("Paused: %d", state);
         paused(state);
-        if (state) {
-            d->lastPaused += d->renderTimer.nsecsElapsed() / 1000;
-            d->renderTimer.invalidate();
-        } else {
-            if (d->currentFrame.second) {// Only start when a frame is available
-                d->renderTimer.restart();
-            }
+        // A mastered clock is paused by its master
+        if (const auto clock = d->currentClock(); !clock->isMastered()) {
+            clock->pause(state);
         }
         update();
     } else {
@@ -296,8 +294,15 @@ void OpenGLWidgetRenderer::stop() {
     bool shouldBe = true;
     if (d->running.compare_exchange_strong(shouldBe, false)) {
         QWidget::close();
-        d->lastPaused = 0;
-        d->renderTimer.invalidate();
+        const auto clock = d->currentClock();
+        const auto statistics = clock->statistics();
+        qDebug("Renderer %zu: %llu frames shown, %llu dropped, %llu repeated, A/V drift mean %lld us, max %lld us", d->id,
+               static_cast<unsigned long long>(statistics.shownFrames), static_cast<unsigned long long>(statistics.droppedFrames),
+               static_cast<unsigned long long>(statistics.repeatedFrames), static_cast<long long>(statistics.meanAbsoluteDrift),
+               static_cast<long long>(statistics.maxDrift));
+        if (!clock->isMastered()) {
+            clock->reset();
+        }
 
         //        if (d->mapper) {
         //            d->mapper->stop();
@@ -312,17 +317,3 @@ void OpenGLWidgetRenderer::stop() {
         qDebug("OpenGLWidgetRenderer::stop() called while not running");
     }
 }
-
-int64_t OpenGLWidgetRendererPrivate::getTimestamp() {
-    if (!renderTimer.isValid() && !paused) {
-        renderTimer.restart();
-    }
-    auto now = renderTimer.nsecsElapsed() / 1000;
-    if (!currentFrame.second) {
-        return 0;
-    } else if (paused) {
-        return lastPaused;
-    } else {
-        return lastPaused + now;
-    }
-}
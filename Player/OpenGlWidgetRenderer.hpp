@@ -52,6 +52,12 @@ public:
 
     void consume(int64_t pad, std::shared_ptr<pgraph::api::Data> data) override;
 
+    /**
+     * @brief Presents frames according to clock instead of the renderer's own wall clock
+     */
+    void setClock(std::shared_ptr<AVQt::common::MediaClock> clock);
+    [[nodiscard]] AVQt::common::MediaClock::SyncStatistics syncStatistics() const;
+
 signals:
     void started() override;
     void stopped() override;
@@ -21,10 +21,12 @@
 #ifndef LIBAVQT_OPENGLWIDGETRENDERERPRIVATE_HPP
 #define LIBAVQT_OPENGLWIDGETRENDERERPRIVATE_HPP
 
+#include <AVQt/common/MediaClock.hpp>
 #include <AVQt/renderers/IOpenGLFrameMapper.hpp>
 #include <AVQt/communication/VideoPadParams.hpp>
 #include <QObject>
 #include <QtOpenGL>
+#include <mutex>
 #include <pgraph/api/PadFactory.hpp>
 
 class OpenGLWidgetRenderer;
@@ -34,7 +36,13 @@ private:
     explicit OpenGLWidgetRendererPrivate(OpenGLWidgetRenderer *q) : q_ptr(q), id(nextId++) {
     }
 
-    int64_t getTimestamp();
+    /**
+     * @return the current clock, setClock() may replace it from another thread at any time
+     */
+    std::shared_ptr<AVQt::common::MediaClock> currentClock() const {
+        std::lock_guard lock(clockMutex);
+        return clock;
+    }
 
     OpenGLWidgetRenderer *q_ptr;
 
@@ -43,11 +51,13 @@ private:
 
     std::shared_ptr<AVQt::api::IOpenGLFrameMapper> mapper{};
     int64_t inputPadId{pgraph::api::INVALID_PAD_ID};
-    QElapsedTimer renderTimer{};
     QPair<int64_t, std::shared_ptr<QOpenGLFramebufferObject>> currentFrame{0, nullptr};
 
+    // Own wall clock, unless an audio output shares its clock through setClock()
+    mutable std::mutex clockMutex{};
+    std::shared_ptr<AVQt::common::MediaClock> clock{std::make_shared<AVQt::common::MediaClock>()};
+
     std::atomic_bool paused{false}, running{false};
-    std::atomic_int64_t lastPaused{0};
 
     AVQt::communication::VideoPadParams params{};
 
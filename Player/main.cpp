@@ -244,7 +244,14 @@ int main(int argc, char *argv[]) {
     aEncoderInPad->link(aDecoderOutPad);
     muxerInPad1->link(aEncoderOutPad);
     //        ccInPad->link(aEncoderOutPad);
-    //        aoutputInPad->link(aDecoderOutPad);
+    // Audio and video share one clock, the audio output masters it and the renderer presents the frames in sync.
+    // A mastered clock only starts with the first played samples, so without an audio stream the renderer keeps its own clock
+    if (demuxerAOutPad) {
+        aoutputInPad->link(aDecoderOutPad);
+        auto clock = std::make_shared<AVQt::common::MediaClock>();
+        aoutput->setClock(clock);
+        renderer1->setClock(clock);
+    }
     decoder1InPad->link(demuxerOutPad);
     //        ccInPad->link(decoder1OutPad);
     encoder1InPad->link(decoder1OutPad);